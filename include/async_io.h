@@ -0,0 +1,89 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace wf {
+
+// Batched positional file IO. On Linux requests go through an io_uring instance (raw
+// syscalls, no liburing); when the kernel refuses the ring, or off Linux, a dedicated
+// thread pool issues pread/pwrite/fsync instead. A ring that fails later is abandoned for good:
+// its unsubmitted requests and every later batch move to the pool. Completion is
+// reported once per batch.
+class AsyncIO {
+public:
+    enum class Backend : uint8_t { kIoUring, kThreadPool };
+
+    struct Request {
+        // kSync flushes the file to disk (fsync); offset, data and size are unused. Requests
+        // of one batch run in any order, so a sync goes in the batch after its writes.
+        enum class Op : uint8_t { kRead, kWrite, kSync };
+        Op op = Op::kRead;
+        int fd = -1;
+        std::uint64_t offset = 0;
+        void* data = nullptr;     // read destination or write source, owned by the caller
+        std::size_t size = 0;
+        std::int64_t result = 0;  // bytes transferred (short at EOF), 0 for a sync, or -errno
+
+        bool complete() const { return result >= 0 && static_cast<std::size_t>(result) == size; }
+    };
+    using Batch = std::vector<Request>;
+    using BatchCallback = std::function<void(Batch&)>;
+
+    // Falls back to the thread pool when io_uring is preferred but unavailable.
+    explicit AsyncIO(Backend preferred = Backend::kIoUring, std::size_t pool_threads = 4, unsigned queue_depth = 128);
+    ~AsyncIO();
+    AsyncIO(const AsyncIO&) = delete;
+    AsyncIO& operator=(const AsyncIO&) = delete;
+
+    Backend backend() const { return backend_.load(std::memory_order_acquire); }
+    const char* backend_name() const;
+
+    // `done` runs once on an IO thread after every request of the batch has completed.
+    void submit(Batch batch, BatchCallback done);
+    std::future<Batch> submit(Batch batch);
+    // Blocks until the batch completes; true if every request transferred its full size.
+    bool run(Batch& batch);
+
+    // Process-wide engine used by RegionIO; WF_IO_BACKEND=pool forces the thread pool.
+    static AsyncIO& shared();
+
+private:
+    struct BatchState;
+    struct Pending {
+        std::shared_ptr<BatchState> state;
+        std::size_t index = 0;
+    };
+    struct Uring;
+
+    static void finish(Pending& pending, std::int64_t result);
+    void start_pool(std::size_t threads);
+    void pool_main();
+    bool start_uring(unsigned queue_depth);
+    // False once the ring has failed; `ops` then holds the requests the kernel never took.
+    bool uring_submit(std::vector<Pending>& ops);
+    void uring_main();
+    void fall_back_to_pool();
+
+    std::atomic<Backend> backend_{Backend::kThreadPool};
+    std::size_t pool_threads_ = 1;
+
+    std::mutex pool_mutex_;
+    std::condition_variable pool_cv_;
+    std::deque<Pending> pool_queue_;
+    std::vector<std::thread> pool_workers_;
+    bool pool_quit_ = false;
+
+    std::unique_ptr<Uring> uring_;
+};
+
+} // namespace wf
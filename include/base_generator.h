@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstdint>
+
+#include "chunk.h"
+#include "height_tile_cache.h"
+#include "planet.h"
+
+namespace wf {
+
+// Fills `chunk` with the base terrain of `key` (rock, dirt, water, caves) from its column's
+// height tile, which must have been built for (key.face, key.i, key.j).
+// `open_sky` (N words, bit x of word y) receives the columns where the voxel above the
+// chunk is air or water in the base terrain; may be null.
+void generate_base_chunk(const PlanetConfig& cfg, const FaceChunkKey& key, const HeightTile& heights,
+                         Chunk64& chunk, uint64_t* open_sky);
+
+} // namespace wf
@@ -18,6 +18,8 @@ public:
 
     uint32_t size() const { return size_; }
     uint32_t bpp() const { return bits_per_; }
+    // Packed storage, for hashing and bulk copies.
+    const std::vector<uint64_t>& words() const { return data_; }
 
     void set(uint32_t i, uint32_t v) {
         const uint64_t bit = uint64_t(i) * bits_per_;
@@ -19,9 +19,9 @@ struct LookInput {
 };
 
 struct CameraSnapshot {
-    wf::Mat4 view{};
+    wf::Mat4 view{};        // camera-relative: apply to (world position - position)
     wf::Mat4 projection{};
-    wf::Float3 position{0.0f, 0.0f, 0.0f};
+    wf::Double3 position{0.0, 0.0, 0.0};
     wf::Float3 forward{1.0f, 0.0f, 0.0f};
     wf::Float3 up{0.0f, 1.0f, 0.0f};
     float fov_deg = 60.0f;
@@ -68,7 +68,7 @@ public:
     void apply_settings(const CameraControllerSettings& settings);
     CameraControllerSettings settings() const;
 
-    void sync_state(const wf::Float3& position, float yaw_rad, float pitch_rad, bool walk_mode);
+    void sync_state(const wf::Double3& position, float yaw_rad, float pitch_rad, bool walk_mode);
 
     CameraUpdateResult update(const CameraUpdateInput& input);
 
@@ -76,7 +76,7 @@ public:
     void toggle_invert_x();
     void toggle_invert_y();
 
-    wf::Float3 position() const;
+    wf::Double3 position() const;
     float yaw() const { return cam_yaw_; }
     float pitch() const { return cam_pitch_; }
     bool walk_mode() const { return walk_mode_; }
@@ -9,6 +9,41 @@
 
 namespace wf {
 
+// Per-voxel light: sky level (0..15) in the high nibble, block level in the low nibble.
+// Chunks of uniform light (open air, buried rock) keep only `fill`; unlit chunks read as
+// open sky so meshes built without a light pass look as they did before lighting.
+struct ChunkLight {
+    static constexpr uint32_t kVoxels = 64u * 64u * 64u;
+    static constexpr uint8_t kFullSky = 0xF0;
+
+    uint8_t fill = kFullSky;
+    std::vector<uint8_t> levels; // kVoxels entries, or empty when uniform
+
+    uint8_t get(uint32_t i) const { return levels.empty() ? fill : levels[i]; }
+    void set(uint32_t i, uint8_t v) {
+        if (levels.empty()) {
+            if (v == fill) return;
+            levels.assign(kVoxels, fill);
+        }
+        levels[i] = v;
+    }
+    void reset(uint8_t v) {
+        fill = v;
+        std::vector<uint8_t>().swap(levels);
+    }
+    // Drops the array again when every voxel ended up at the same level.
+    void compact() {
+        if (levels.empty()) return;
+        const uint8_t first = levels[0];
+        for (uint8_t v : levels) if (v != first) return;
+        reset(first);
+    }
+};
+
+inline uint8_t light_sky(uint8_t l) { return static_cast<uint8_t>(l >> 4); }
+inline uint8_t light_block(uint8_t l) { return static_cast<uint8_t>(l & 15); }
+inline uint8_t pack_light(uint8_t sky, uint8_t block) { return static_cast<uint8_t>((sky << 4) | block); }
+
 struct Chunk64 {
     static constexpr int N = 64;
     static constexpr int N3 = N * N * N;
@@ -17,6 +52,8 @@ struct Chunk64 {
     std::unordered_map<uint16_t, uint16_t> palette_lut;       // material id -> palette index
     BitArray indices;                                         // paletted indices (start 8bpp)
     std::array<uint64_t, (N3 + 63) / 64> occ{};               // occupancy bitset (non-air)
+    ChunkLight light;                                         // filled by the light engine
+    static_assert(ChunkLight::kVoxels == (uint32_t)N3, "light array covers one chunk");
 
     bool dirty_mesh = true;
 
@@ -3,6 +3,8 @@
 #include <cstdint>
 #include <vector>
 
+#include "planet.h"
+
 namespace wf {
 
 struct Chunk64;
@@ -26,6 +28,7 @@ struct ChunkDelta {
     std::vector<uint64_t>         dirty_mask;    // Bitset tracking touched voxels (shared across modes)
     bool                          dirty = false; // Set when runtime edits require persistence
     uint32_t                      override_count = 0; // number of active overrides
+    GeneratorStamp                base{};        // base world the overrides were recorded against
 
     bool empty() const { return override_count == 0; }
 
@@ -52,4 +55,9 @@ struct ChunkDelta {
 
 void apply_chunk_delta(const ChunkDelta& delta, Chunk64& chunk);
 
+// Re-targets a delta recorded against another base world: overrides that now equal
+// the new base material are dropped, so only real player edits survive. Returns the
+// number of overrides removed; the delta is marked dirty when anything changed.
+uint32_t rebase_chunk_delta(ChunkDelta& delta, const Chunk64& new_base, const GeneratorStamp& stamp);
+
 } // namespace wf
@@ -2,8 +2,16 @@
 #pragma once
 
 #include <vulkan/vulkan.h>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
 #include <vector>
 #include <string>
+#include <utility>
+
+#include "streaming_service.h"
+#include "wf_math.h"
 
 namespace wf {
 
@@ -16,18 +24,92 @@ struct ChunkDrawItem {
     uint32_t first_index = 0;
     int32_t  base_vertex = 0;
     uint32_t vertex_count = 0;
-    float center[3] = {0,0,0};
+    // Registered draw record: selects the per-draw origin offset (drawn as firstInstance).
+    uint32_t draw_record = 0xFFFFFFFFu;
+    float center[3] = {0,0,0}; // relative to the camera
     float radius = 0;
 };
 
+struct ChunkRecordStats {
+    int visible = 0;
+    uint64_t indices = 0;
+    uint32_t secondaries = 0;
+    // CPU time of record_buckets: wall clock on the calling thread, and per lane (cull, sort
+    // and recording of one bucket) summed and at its slowest. sum / wall is the parallel gain.
+    double wall_ms = 0.0;
+    double lane_sum_ms = 0.0;
+    double lane_max_ms = 0.0;
+};
+
+// Frustum planes are relative to the eye: a sphere is culled when dot(center - eye, n) + d < -radius.
+// Centers come from the camera-relative draw offsets; eye is planet-centered for the horizon test.
+struct GpuCullParams {
+    float planes[6][4] = {};
+    float eye[3] = {0, 0, 0};
+    float occluder_radius = 0; // planet horizon occluder; 0 disables horizon culling
+    float near_split = 0;      // view depth below which compacted draws go into the first (near) range
+    bool frustum = true;
+};
+
+// Draws are ordered front-to-back so early depth testing rejects hidden fragments.
+// Depth is the sphere's nearest point along the view axis, quantized to 16 bits over [near, far].
+struct DrawSortView {
+    bool enabled = false;
+    float eye[3] = {0, 0, 0}; // in the space of ChunkDrawItem::center (0 when camera-relative)
+    float forward[3] = {0, 0, 1};
+    float near_m = 0.1f;
+    float far_m = 1000.0f;
+    float near_split_m = 250.0f; // nearer chunks get a full sort, farther ones a coarse single pass
+};
+
 class ChunkRenderer {
 public:
+    static constexpr uint32_t kNoDrawRecord = 0xFFFFFFFFu;
+    // Mesh indices are segment-relative; every draw supplies the segment's vertexOffset.
+    static constexpr VkIndexType kIndexType = VK_INDEX_TYPE_UINT16;
+
+    // Visible chunks are split into buckets (cube face x 2x2 tile parity) that
+    // are culled and recorded into secondary command buffers in parallel.
+    static constexpr uint32_t kRecordBuckets = 24;
+    static constexpr int64_t kBucketTileChunks = 8;
+    static uint32_t record_bucket(int face, int64_t ci, int64_t cj);
+    // Appends the visible draw items of one bucket; called concurrently from record workers.
+    using BucketCullFn = std::function<void(uint32_t bucket, std::vector<ChunkDrawItem>& out)>;
+
     void init(VkPhysicalDevice phys, VkDevice device, VkRenderPass renderPass, VkExtent2D extent, const char* shaderDir);
     void recreate(VkRenderPass renderPass, VkExtent2D extent, const char* shaderDir);
     void cleanup(VkDevice device);
 
+    // Meshes are stored relative to a double-precision origin per draw record. Once per frame,
+    // before any draw, the origins are rebased onto the camera and written to the slot's
+    // instance-rate offset buffer, so the MVP passed below must be camera-relative (eye at 0).
+    void update_draw_offsets(size_t frame_slot, const double camera[3]);
+    // Without drawIndirectFirstInstance the offsets cannot be selected from indirect draws:
+    // pooled draws fall back to direct calls and GPU culling is disabled.
+    void set_indirect_first_instance(bool supported) { indirect_first_instance_ = supported; }
+
     // Record draw commands for provided chunks; expects MVP as 16 floats in column-major order (GLSL default)
     void record(VkCommandBuffer cmd, const float mvp[16], const std::vector<ChunkDrawItem>& items);
+    // Translucent segments (water), recorded after every opaque draw of the pass: alpha
+    // blended, depth tested without depth writes, chunks back-to-front by center distance.
+    void record_translucent(VkCommandBuffer cmd, const float mvp[16], const std::vector<ChunkDrawItem>& items);
+
+    // 0 disables parallel recording (everything stays inline in the primary).
+    void set_record_threads(size_t count, uint32_t graphics_queue_family);
+    size_t record_threads() const { return record_threads_; }
+    bool parallel_record_enabled() const { return record_threads_ > 0 && pipeline_ != VK_NULL_HANDLE; }
+    // Culls and records every bucket on the record workers; the returned secondaries must be
+    // executed inside a render pass begun with VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS.
+    void record_buckets(size_t frame_slot, VkRenderPass render_pass, VkFramebuffer framebuffer,
+                        const float mvp[16], const BucketCullFn& cull,
+                        std::vector<VkCommandBuffer>& out_secondaries, ChunkRecordStats& stats);
+    // Begun secondary for draws the caller records itself after the chunk buckets.
+    VkCommandBuffer begin_main_secondary(size_t frame_slot, VkRenderPass render_pass, VkFramebuffer framebuffer);
+
+    // Applies to the next record()/record_buckets(); read-only while workers record.
+    void set_sort_view(const DrawSortView& view) { sort_view_ = view; }
+    // Secondaries inherit these statistics so a query in the primary keeps counting through them.
+    void set_inherited_statistics(VkQueryPipelineStatisticFlags flags) { inherited_statistics_ = flags; }
 
     bool is_ready() const { return pipeline_ != VK_NULL_HANDLE; }
     void set_logging(bool enabled) { log_ = enabled; }
@@ -37,12 +119,46 @@ public:
     void set_pool_log_every(int n_frames) { log_every_n_ = n_frames > 0 ? n_frames : 120; }
     void set_pool_caps_bytes(VkDeviceSize vtx_bytes, VkDeviceSize idx_bytes) { vtx_initial_cap_ = vtx_bytes; idx_initial_cap_ = idx_bytes; }
     void set_device_local(bool enable) { use_device_local_ = enable; }
+    // Live pool reconfiguration; the caller must have waited for the device to idle.
+    // Live meshes are copied over, so capacity never drops below the allocated tail.
+    void resize_pools(VkDeviceSize vtx_bytes, VkDeviceSize idx_bytes, bool device_local);
     void set_transfer_context(uint32_t queue_family, VkQueue queue) { transfer_queue_family_ = queue_family; transfer_queue_ = queue; }
 
+    // GPU-driven visibility: chunks keep a persistent draw record that a compute pass
+    // culls and compacts into an indirect buffer consumed by DrawIndexedIndirectCount.
+    void set_gpu_cull(bool enabled, bool draw_indirect_count, bool multi_draw_indirect);
+    bool gpu_cull_active() const { return gpu_cull_enabled_ && cull_pipeline_ != VK_NULL_HANDLE && pipeline_ != VK_NULL_HANDLE && vtx_pool_ && idx_pool_; }
+    // Records registered with gpu_cull = false only get an origin slot: the cull pass never
+    // emits them (translucent segments are drawn by record_translucent instead).
+    uint32_t register_draw(const ChunkDrawItem& item, const Double3& origin, bool gpu_cull = true);
+    void unregister_draw(uint32_t record);
+    // Outside the render pass: sync dirty records, reset the counter and dispatch the cull.
+    void record_gpu_cull(VkCommandBuffer cmd, size_t frame_slot, const GpuCullParams& params);
+    // Inside the render pass: one indirect-count draw for every visible chunk.
+    void record_gpu_draws(VkCommandBuffer cmd, size_t frame_slot, const float mvp[16]);
+    // After the render pass: make the counter visible to the host for next use of the slot.
+    void finish_gpu_cull(VkCommandBuffer cmd, size_t frame_slot);
+    // Results of the last completed cull in the slot (read back once its fence retired).
+    int gpu_visible() const { return gpu_visible_; }
+    uint64_t gpu_visible_indices() const { return gpu_visible_indices_; }
+
+    // Debug parity check: every dispatch is replayed on the CPU over the same records,
+    // offsets and params, and the slot's counter read-back is compared against it.
+    struct GpuCullParity {
+        uint64_t checked = 0;     // read-backs compared
+        uint64_t mismatched = 0;  // read-backs whose draw or index count differed
+        int last_gpu = 0;
+        int last_cpu = 0;
+        int max_draw_diff = 0;
+    };
+    void set_gpu_cull_check(bool enabled) { gpu_cull_check_ = enabled; }
+    bool gpu_cull_check() const { return gpu_cull_check_; }
+    const GpuCullParity& gpu_cull_parity() const { return gpu_cull_parity_; }
+
     // Upload a mesh into the shared pools; returns offsets for indirect drawing
     // Returns false if the pool has no space (mesh not uploaded)
     bool upload_mesh(const struct Vertex* vertices, size_t vcount,
-                     const uint32_t* indices, size_t icount,
+                     const uint16_t* indices, size_t icount,
                      uint32_t& out_first_index,
                      int32_t& out_base_vertex);
     void free_mesh(uint32_t first_index, uint32_t index_count,
@@ -56,6 +172,7 @@ private:
     VkExtent2D extent_{};
     VkPipelineLayout layout_ = VK_NULL_HANDLE;
     VkPipeline pipeline_ = VK_NULL_HANDLE;
+    VkPipeline translucent_pipeline_ = VK_NULL_HANDLE;
     std::string shader_dir_;
     bool log_ = false;
     int log_every_n_ = 120;
@@ -101,7 +218,139 @@ private:
     VkCommandPool transfer_pool_ = VK_NULL_HANDLE;
     VkFence transfer_fence_ = VK_NULL_HANDLE;
 
+    // GPU culling: master draw records mirrored into one SSBO per frame slot.
+    // Bounds centers live in the per-frame offset buffer, not in the record.
+    struct GpuDrawRecord {
+        float radius;
+        uint32_t index_count;
+        uint32_t first_index;
+        int32_t base_vertex;
+    };
+    // Camera-relative origin per draw record (vec4, w unused), one buffer per frame slot.
+    // Bound as an instance-rate vertex stream for drawing and as an SSBO for the cull pass.
+    struct OffsetSlot {
+        VkBuffer buffer = VK_NULL_HANDLE;
+        VkDeviceMemory memory = VK_NULL_HANDLE;
+        void* map = nullptr;
+        size_t capacity = 0; // records
+    };
+    struct GpuCullSlot {
+        VkBuffer records = VK_NULL_HANDLE;
+        VkDeviceMemory records_mem = VK_NULL_HANDLE;
+        void* records_map = nullptr;
+        VkBuffer commands = VK_NULL_HANDLE;
+        VkDeviceMemory commands_mem = VK_NULL_HANDLE;
+        VkBuffer counter = VK_NULL_HANDLE;
+        VkDeviceMemory counter_mem = VK_NULL_HANDLE;
+        void* counter_map = nullptr;
+        VkDescriptorSet set = VK_NULL_HANDLE;
+        VkBuffer bound_offsets = VK_NULL_HANDLE; // offset buffer the set currently points at
+        size_t capacity = 0;          // records
+        uint32_t dispatched = 0;      // record count culled by the last dispatch
+        int cpu_visible = -1;         // CPU replay of the last dispatch, -1 when not checked
+        uint64_t cpu_indices = 0;
+        std::vector<uint32_t> dirty;  // record indices changed since this slot last synced
+        bool full_sync = true;
+    };
+    bool gpu_cull_enabled_ = false;
+    bool draw_indirect_count_ = false;
+    bool multi_draw_indirect_ = true;
+    PFN_vkCmdDrawIndexedIndirectCountKHR draw_indexed_indirect_count_ = nullptr;
+    VkDescriptorSetLayout cull_set_layout_ = VK_NULL_HANDLE;
+    VkDescriptorPool cull_descriptor_pool_ = VK_NULL_HANDLE;
+    VkPipelineLayout cull_layout_ = VK_NULL_HANDLE;
+    VkPipeline cull_pipeline_ = VK_NULL_HANDLE;
+    std::vector<GpuDrawRecord> draw_records_;
+    std::vector<Double3> draw_origins_;
+    std::vector<uint32_t> free_draw_records_;
+    OffsetSlot offset_slots_[2];
+    size_t active_offset_slot_ = 0;
+    bool indirect_first_instance_ = false;
+    GpuCullSlot gpu_slots_[2];
+    int gpu_visible_ = 0;
+    uint64_t gpu_visible_indices_ = 0;
+    bool gpu_cull_check_ = false;
+    GpuCullParity gpu_cull_parity_{};
+
+    // Material palette: one host-visible SSBO indexed by material id, read by chunk.frag.
+    VkDescriptorSetLayout palette_set_layout_ = VK_NULL_HANDLE;
+    VkDescriptorPool palette_descriptor_pool_ = VK_NULL_HANDLE;
+    VkDescriptorSet palette_set_ = VK_NULL_HANDLE;
+    VkBuffer palette_buffer_ = VK_NULL_HANDLE;
+    VkDeviceMemory palette_mem_ = VK_NULL_HANDLE;
+
+    void create_cull_pipeline();
+    void destroy_gpu_cull(VkDevice device);
+    // Uploads the active material table; false leaves chunk rendering disabled.
+    bool create_palette();
+    void destroy_palette(VkDevice device);
+    void bind_palette(VkCommandBuffer cmd) const;
+    bool ensure_gpu_slot_capacity(GpuCullSlot& slot, size_t records);
+    void write_cull_descriptors(GpuCullSlot& slot, VkBuffer offsets);
+    // chunk_cull.comp on the host: visible draws and their index total for one dispatch.
+    void replay_gpu_cull(const GpuCullParams& params, size_t frame_slot, int& visible, uint64_t& indices) const;
+    void destroy_offset_slots(VkDevice device);
+    // Binds the active offset stream at binding 1; false when no offsets were written.
+    bool bind_draw_offsets(VkCommandBuffer cmd) const;
+    // One vkCmdDrawIndexed per item in `order`; pooled items share the pool buffers.
+    void record_direct_draws(VkCommandBuffer cmd, const std::vector<ChunkDrawItem>& items,
+                             const std::vector<uint32_t>& order) const;
+    void mark_draw_record_dirty(uint32_t record);
+
+    // Front-to-back ordering (16-bit LSD radix sort on quantized depth).
+    struct DrawSortKey {
+        uint16_t depth;
+        uint32_t index;
+    };
+    struct DrawSortScratch {
+        std::vector<DrawSortKey> near_keys;
+        std::vector<DrawSortKey> far_keys;
+        std::vector<DrawSortKey> tmp;
+        std::vector<uint32_t> order;
+    };
+    DrawSortView sort_view_{};
+    DrawSortScratch sort_scratch_;
+    std::vector<std::pair<float, uint32_t>> translucent_keys_; // squared distance, item index
+    std::vector<uint32_t> translucent_order_;
+    VkQueryPipelineStatisticFlags inherited_statistics_ = 0;
+    // Fills scratch.order with item indices, nearest first; returns the nearest depth in meters.
+    float sort_draw_order(const std::vector<ChunkDrawItem>& items, DrawSortScratch& scratch) const;
+
+    // Parallel recording: one lane per bucket plus a main-thread lane, per frame slot.
+    // Each lane owns its command pool and indirect buffer so workers never share state.
+    struct RecordLane {
+        VkCommandPool pool = VK_NULL_HANDLE;
+        VkCommandBuffer cmd = VK_NULL_HANDLE;
+        VkBuffer indirect = VK_NULL_HANDLE;
+        VkDeviceMemory indirect_mem = VK_NULL_HANDLE;
+        void* indirect_map = nullptr;
+        size_t indirect_capacity_cmds = 0;
+        std::vector<ChunkDrawItem> items;
+        DrawSortScratch sort;
+        float nearest = 0.0f;
+        uint64_t indices = 0;
+        double record_ms = 0.0;
+        bool recorded = false;
+    };
+    static constexpr size_t kRecordSlots = 2;
+    static constexpr size_t kLanesPerSlot = kRecordBuckets + 1;
+    size_t record_threads_ = 0;
+    uint32_t graphics_queue_family_ = 0;
+    std::vector<RecordLane> lanes_;
+    StreamingService record_workers_;
+    std::mutex record_mutex_;
+    std::condition_variable record_cv_;
+    size_t record_pending_ = 0;
+
+    RecordLane* lane(size_t frame_slot, size_t index);
+    bool ensure_lane_command_buffer(RecordLane& lane);
+    bool ensure_lane_indirect(RecordLane& lane, size_t draw_count);
+    void record_lane(RecordLane& lane, uint32_t bucket, const VkCommandBufferInheritanceInfo& inheritance,
+                     const float mvp[16], const BucketCullFn& cull);
+    void destroy_record_lanes();
+
     bool ensure_pool_capacity(VkDeviceSize add_vtx_bytes, VkDeviceSize add_idx_bytes);
+    void migrate_pool(bool isVertex, VkDeviceSize new_cap, bool device_local);
     static inline VkDeviceSize align_up(VkDeviceSize x, VkDeviceSize a) {
         if (a == 0) return x;
         return ((x + a - 1) / a) * a;
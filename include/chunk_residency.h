@@ -0,0 +1,104 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "chunk.h"
+
+namespace wf {
+
+// Lifecycle of one chunk, from ring request to GPU residency.
+enum class ChunkResidencyState : uint8_t {
+    kRequested,
+    kGenerating,
+    kGenerated,   // voxels cached, no mesh in flight
+    kMeshing,
+    kMeshReady,   // mesh result queued for the main thread
+    kUploading,   // handed to the renderer's upload queue
+    kResident,
+    kEvicting,    // pruned; waiting for the GPU release
+};
+inline constexpr std::size_t kChunkResidencyStateCount = 8;
+
+const char* chunk_residency_state_name(ChunkResidencyState state);
+
+struct ChunkResidencyStats {
+    std::array<std::size_t, kChunkResidencyStateCount> counts{};
+    uint64_t rejected = 0;   // invalid or stale transitions since start
+};
+
+// Single source of truth for where each chunk is in the streaming pipeline. Workers,
+// remeshes, uploads and prune all move keys through validated transitions:
+//  - request generations only move forward, so an aborted job cannot overwrite a newer one;
+//  - every Meshing transition takes a fresh ticket, and only the result carrying the
+//    latest ticket may advance, so superseded meshes are dropped deterministically;
+//  - releases of keys that re-entered the pipeline while evicting are skipped.
+// Thread-safe; one short lock per transition.
+class ChunkResidencyTable {
+public:
+    // Any entry (or none) -> Requested; refused if gen is older than the entry's.
+    bool request(const FaceChunkKey& key, uint64_t gen);
+    // Requested -> Generating -> Generated (a cache hit goes straight to Generated).
+    bool advance(const FaceChunkKey& key, ChunkResidencyState to, uint64_t gen);
+    // Generated/Meshing/MeshReady/Resident -> Meshing. Returns the mesh ticket, 0 if refused.
+    // gen 0 keeps the entry's generation (main-thread remeshes).
+    uint64_t begin_mesh(const FaceChunkKey& key, uint64_t gen);
+    // Meshing -> MeshReady when a mesh was produced, else back to Generated.
+    bool finish_mesh(const FaceChunkKey& key, uint64_t ticket, bool has_mesh);
+    // MeshReady -> Uploading.
+    bool begin_upload(const FaceChunkKey& key, uint64_t ticket);
+    // True while the key is Uploading under this ticket.
+    bool accepts_upload(const FaceChunkKey& key, uint64_t ticket) const;
+    // Uploading -> Resident, or back to Generated when the renderer refused the mesh.
+    bool finish_upload(const FaceChunkKey& key, uint64_t ticket, bool uploaded);
+    // Any -> Evicting.
+    void begin_evict(const FaceChunkKey& key);
+    // Forgets an Evicting key. False when the key re-entered the pipeline, in which case
+    // the caller must keep its GPU mesh (a newer upload replaces it in place).
+    bool finish_evict(const FaceChunkKey& key);
+
+    template <typename Pred>
+    void evict_if(Pred&& pred, std::vector<FaceChunkKey>& out);
+
+    bool state(const FaceChunkKey& key, ChunkResidencyState& out) const;
+    ChunkResidencyStats stats() const;
+    void clear();
+
+    // Debug builds log every accepted transition when enabled; rejected ones always.
+    void set_trace(bool enabled) { trace_.store(enabled, std::memory_order_relaxed); }
+
+private:
+    struct Entry {
+        ChunkResidencyState state = ChunkResidencyState::kRequested;
+        uint64_t gen = 0;
+        uint64_t ticket = 0;
+    };
+
+    void log_transition(const FaceChunkKey& key, ChunkResidencyState from, ChunkResidencyState to,
+                        uint64_t gen, bool accepted) const;
+    bool reject(const FaceChunkKey& key, const Entry* entry, ChunkResidencyState to, uint64_t gen);
+    void set_state(const FaceChunkKey& key, Entry& entry, ChunkResidencyState to);
+
+    mutable std::mutex mutex_;
+    std::unordered_map<FaceChunkKey, Entry, FaceChunkKeyHash> entries_;
+    uint64_t next_ticket_ = 1;
+    uint64_t rejected_ = 0;
+    std::atomic<bool> trace_{false};  // toggled by live config while workers log
+};
+
+template <typename Pred>
+void ChunkResidencyTable::evict_if(Pred&& pred, std::vector<FaceChunkKey>& out) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& kv : entries_) {
+        if (kv.second.state == ChunkResidencyState::kEvicting || !pred(kv.first)) continue;
+        set_state(kv.first, kv.second, ChunkResidencyState::kEvicting);
+        out.push_back(kv.first);
+    }
+}
+
+} // namespace wf
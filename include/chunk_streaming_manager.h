@@ -1,17 +1,23 @@
 #pragma once
 
 #include <atomic>
+#include <chrono>
 #include <deque>
 #include <functional>
+#include <future>
 #include <mutex>
 #include <optional>
+#include <span>
 #include <string>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "planet.h"
 #include "chunk.h"
 #include "chunk_delta.h"
+#include "chunk_residency.h"
+#include "light_engine.h"
 #include "mesh.h"
 #include "region_io.h"
 #include "wf_math.h"
@@ -29,15 +35,29 @@ struct VoxelHit {
     uint16_t material = MAT_AIR;
 };
 
+// Scheduling classes, highest priority first. Edit, near and far share the loader pool and
+// steal from each other when idle. Disk IO has its own pool, which loader restarts leave
+// running: a dropped save would lose edits and a dropped prefetch would strand its ring job.
+enum class StreamingClass : std::size_t {
+    kEdit,   // interactive edit remeshes
+    kNear,   // ring jobs and the generation/meshing of tiles near the ring center
+    kFar,    // the rest of the ring
+    kIo,     // region saves and delta prefetches
+};
+inline constexpr std::size_t kStreamingClassCount = 4;
+inline constexpr std::size_t kLoaderClassCount = 3;  // the classes of the loader pool
+
 class ChunkStreamingManager {
 public:
     struct MeshResult {
         std::vector<Vertex> vertices;
-        std::vector<uint32_t> indices;
-        float center[3] = {0.0f, 0.0f, 0.0f};
+        std::vector<uint16_t> indices;
+        std::vector<MeshSegment> segments;
+        double center[3] = {0.0, 0.0, 0.0}; // planet-centered; vertices are relative to it
         float radius = 0.0f;
         FaceChunkKey key{0, 0, 0, 0};
         uint64_t job_gen = 0;
+        uint64_t ticket = 0;              // residency mesh ticket
         uint32_t first_index = 0;
         int32_t base_vertex = 0;
     };
@@ -53,6 +73,10 @@ public:
         float fwd_s = 0.0f;
         float fwd_t = 0.0f;
         uint64_t gen = 0;
+        // Ring delta: cached chunks are reused instead of regenerated, and tiles
+        // strictly inside keep_radius (already meshed) are not meshed again.
+        bool reuse_cached = false;
+        int keep_radius = -1;
     };
 
     using LoadJob = std::function<void(const LoadRequest&)>;
@@ -68,18 +92,61 @@ public:
     void set_save_chunks_enabled(bool enabled);
     bool save_chunks_enabled() const { return save_chunks_enabled_; }
 
-    void set_log_stream(bool enabled) { log_stream_ = enabled; }
-    bool log_stream() const { return log_stream_; }
+    // Stamp of the current planet config; deltas recorded under another one are stale.
+    const GeneratorStamp& current_stamp() const { return stamp_; }
+    void set_rebase_stale_deltas(bool enabled) { rebase_stale_deltas_.store(enabled, std::memory_order_relaxed); }
+
+    void set_log_stream(bool enabled) {
+        log_stream_.store(enabled, std::memory_order_relaxed);
+        residency_.set_trace(enabled);
+    }
+    bool log_stream() const { return log_stream_.load(std::memory_order_relaxed); }
+
+    // Seconds between background saves of dirty deltas; 0 disables autosave.
+    void set_autosave_interval(double seconds) { autosave_interval_s_ = seconds; }
+    double autosave_interval() const { return autosave_interval_s_; }
 
     void set_remesh_per_frame_cap(std::size_t cap) { remesh_per_frame_cap_ = cap; }
     std::size_t remesh_per_frame_cap() const { return remesh_per_frame_cap_; }
 
+    // Near-class workers (0 = hardware concurrency); edit and far workers (far 0 = half of near).
     void set_worker_count(std::size_t count);
+    void set_class_threads(std::size_t edit_threads, std::size_t far_threads);
+    // IO workers (at least 1) and their nice offset; applied by start() or restart_workers(),
+    // which first lets queued saves finish.
+    void set_io_threads(std::size_t threads, int nice);
+    // Aborts the running job and restarts the loader pool at the current worker count.
+    void restart_workers();
+    // Aborts the running job and joins the loader pool without restarting it, so the planet
+    // config ring jobs read can be replaced; restart_workers() brings the pool back.
+    void stop_workers();
     void set_load_job(LoadJob job);
     void start();
     void stop();
+    // Terrain changed: aborts in-flight jobs and drops generated chunks and queued
+    // results; player deltas are kept.
+    void invalidate_generated();
 
     uint64_t enqueue_request(LoadRequest req);
+    template <typename Fn>
+    void parallel_for(StreamingClass cls, std::size_t count, Fn&& fn) {
+        if (cls == StreamingClass::kIo) {
+            io_pool_.parallel_for(0, count, std::forward<Fn>(fn));
+            return;
+        }
+        worker_pool_.parallel_for(static_cast<std::size_t>(cls), count, std::forward<Fn>(fn));
+    }
+    StreamingService::ClassStats class_stats(StreamingClass cls) const {
+        if (cls == StreamingClass::kIo) return io_pool_.class_stats(0);
+        return worker_pool_.class_stats(static_cast<std::size_t>(cls));
+    }
+    void submit(StreamingClass cls, StreamingService::Task task) {
+        if (cls == StreamingClass::kIo) {
+            io_pool_.submit(std::move(task));
+            return;
+        }
+        worker_pool_.submit(static_cast<std::size_t>(cls), std::move(task));
+    }
     bool try_pop_result(MeshResult& out);
     void push_mesh_result(MeshResult res);
 
@@ -108,34 +175,78 @@ public:
     bool with_chunk(const FaceChunkKey& key, F&& func) const;
     template <typename F>
     bool update_chunk(const FaceChunkKey& key, F&& func);
+    // Calls func(LightNeighborhood&, const FaceChunkKey (&keys)[27]) on the cached chunk and
+    // its 26 same-face neighbors with the cache locked; chunks not cached are null.
+    template <typename F>
+    void with_neighborhood(const FaceChunkKey& key, F&& func);
+    // Read-only: func(const Chunk64* const (&chunks)[27]) in the same slot order.
+    template <typename F>
+    void visit_neighborhood(const FaceChunkKey& key, F&& func) const;
 
     std::unordered_map<FaceChunkKey, ChunkDelta, FaceChunkKeyHash>& chunk_deltas();
     const std::unordered_map<FaceChunkKey, ChunkDelta, FaceChunkKeyHash>& chunk_deltas() const;
     std::mutex& chunk_delta_mutex() const;
 
+    ChunkResidencyTable& residency() { return residency_; }
+    const ChunkResidencyTable& residency() const { return residency_; }
+
     std::deque<FaceChunkKey>& remesh_queue();
     std::mutex& remesh_mutex() const;
 
     void normalize_chunk_delta_representation(ChunkDelta& delta);
+    // Applies the key's delta to a freshly generated base chunk, rebasing or
+    // refusing deltas recorded under another generator stamp first.
     void overlay_chunk_delta(const FaceChunkKey& key, Chunk64& chunk);
+    // Reads the on-disk deltas of keys not yet in memory in one batched async pass, so the
+    // overlay above finds them in the map instead of opening a region file per tile.
+    void prefetch_chunk_deltas(std::span<const FaceChunkKey> keys);
+    // Same, queued on the IO worker behind pending saves; the future is ready once the
+    // deltas are in the map (or the pool was stopped).
+    std::future<void> prefetch_chunk_deltas_async(std::vector<FaceChunkKey> keys);
+    // out[i] = 1 when keys[i] may carry player edits, without reading deltas: exact for keys
+    // whose delta is in memory, otherwise whether the key's region file exists.
+    void may_have_chunk_deltas(std::span<const FaceChunkKey> keys, std::vector<uint8_t>& out) const;
+    // Snapshots the dirty deltas and saves them grouped by region, one region per IO task.
+    // Waits for the previous flush first: every snapshot holds whole deltas, so an older
+    // batch finishing after a newer one would undo its edits.
     void flush_dirty_chunk_deltas();
+    // Called once per frame; starts a flush when the interval elapsed and none is running.
+    void tick_autosave();
     void wait_for_pending_saves();
 
 private:
+    void resolve_stale_delta(const FaceChunkKey& key, ChunkDelta& delta, const Chunk64& base);
+    using RegionSaveBatch = std::vector<std::pair<FaceChunkKey, ChunkDelta>>;
+    void save_region_batch(const RegionSaveBatch& batch);
+    void start_worker_pool();
+    void start_io_pool();
+
     PlanetConfig planet_cfg_{};
+    GeneratorStamp stamp_ = generator_stamp(PlanetConfig{});
+    // Flags ring jobs read mid-run; configure() rewrites them under running workers.
+    std::atomic<bool> rebase_stale_deltas_{true};
     bool save_chunks_enabled_ = false;
-    bool log_stream_ = false;
+    std::atomic<bool> log_stream_{false};
     std::string region_root_ = "regions";
     std::size_t remesh_per_frame_cap_ = 4;
+    double autosave_interval_s_ = 60.0;
+    std::chrono::steady_clock::time_point last_autosave_ = std::chrono::steady_clock::now();
 
     LoadJob load_job_;
     mutable std::mutex job_mutex_;
 
     StreamingService worker_pool_;
-    StreamingService save_pool_;
+    StreamingService io_pool_;
     std::atomic<bool> stop_flag_{false};
     std::size_t worker_count_hint_ = 1;
-    std::atomic<bool> save_pool_started_{false};
+    std::size_t edit_threads_ = 1;
+    std::size_t far_threads_ = 0;
+    std::size_t io_threads_ = 4;
+    int io_nice_ = 0;
+    std::size_t io_threads_running_ = 0;
+    int io_nice_running_ = 0;
+    std::atomic<bool> io_pool_started_{false};
+    std::atomic<std::size_t> saves_in_flight_{0};
 
     mutable std::mutex results_mutex_;
     std::deque<MeshResult> results_queue_;
@@ -154,6 +265,8 @@ private:
 
     std::deque<FaceChunkKey> remesh_queue_;
     mutable std::mutex remesh_mutex_;
+
+    ChunkResidencyTable residency_;
 };
 
 template <typename F>
@@ -183,6 +296,39 @@ bool ChunkStreamingManager::with_chunk(const FaceChunkKey& key, F&& func) const
     return true;
 }
 
+template <typename F>
+void ChunkStreamingManager::with_neighborhood(const FaceChunkKey& key, F&& func) {
+    LightNeighborhood nbh;
+    FaceChunkKey keys[27];
+    std::lock_guard<std::mutex> lock(chunk_cache_mutex_);
+    for (int dz = -1; dz <= 1; ++dz) {
+        for (int dy = -1; dy <= 1; ++dy) {
+            for (int dx = -1; dx <= 1; ++dx) {
+                const int s = LightNeighborhood::slot(dx, dy, dz);
+                keys[s] = FaceChunkKey{key.face, key.i + dx, key.j + dy, key.k + dz};
+                auto it = chunk_cache_.find(keys[s]);
+                nbh.chunks[s] = (it != chunk_cache_.end()) ? &it->second : nullptr;
+            }
+        }
+    }
+    func(nbh, keys);
+}
+
+template <typename F>
+void ChunkStreamingManager::visit_neighborhood(const FaceChunkKey& key, F&& func) const {
+    const Chunk64* chunks[27] = {};
+    std::lock_guard<std::mutex> lock(chunk_cache_mutex_);
+    for (int dz = -1; dz <= 1; ++dz) {
+        for (int dy = -1; dy <= 1; ++dy) {
+            for (int dx = -1; dx <= 1; ++dx) {
+                auto it = chunk_cache_.find(FaceChunkKey{key.face, key.i + dx, key.j + dy, key.k + dz});
+                if (it != chunk_cache_.end()) chunks[LightNeighborhood::slot(dx, dy, dz)] = &it->second;
+            }
+        }
+    }
+    func(chunks);
+}
+
 template <typename F>
 bool ChunkStreamingManager::update_chunk(const FaceChunkKey& key, F&& func) {
     std::lock_guard<std::mutex> lock(chunk_cache_mutex_);
@@ -4,6 +4,7 @@
 #include <filesystem>
 #include <optional>
 #include <string>
+#include <vector>
 
 #include "planet.h"
 
@@ -29,6 +30,9 @@ struct AppConfig {
     int ring_radius = 14;
     int prune_margin = 3;
     bool cull_enabled = true;
+    bool gpu_cull = true;
+    bool gpu_cull_check = false; // debug: replay the GPU cull on the CPU and compare read-back counts
+    bool draw_sort = true;
     bool draw_stats_enabled = true;
 
     float hud_scale = 2.0f;
@@ -38,6 +42,9 @@ struct AppConfig {
     bool log_stream = false;
     bool log_pool = false;
     bool save_chunks_enabled = false;
+    // Deltas saved against another generator/config: rebase onto the new base (true) or refuse them
+    bool rebase_stale_deltas = true;
+    float autosave_sec = 60.0f;  // background save of dirty deltas, 0 = only on exit
     bool debug_chunk_keys = false;
 
     bool profile_csv_enabled = true;
@@ -48,7 +55,12 @@ struct AppConfig {
     int pool_idx_mb = 128;
 
     int uploads_per_frame_limit = 16;
-    int loader_threads = 0;
+    int loader_threads = 0;  // near-ring workers, 0 = auto
+    int edit_threads = 1;    // edit remesh workers; 0 = edits only steal idle loader workers
+    int far_threads = 0;     // far-ring workers, 0 = half of loader_threads
+    int io_threads = 4;      // disk IO workers (region saves, delta prefetch), at least 1
+    int io_nice = 0;         // IO worker nice offset from the process (Linux); > 0 yields to the loader
+    int record_threads = -1; // -1 = auto, 0 = record chunk draws inline on the main thread
     int k_down = 3;
     int k_up = 3;
     int k_prune_margin = 1;
@@ -63,6 +75,37 @@ struct AppConfig {
 bool operator==(const AppConfig& a, const AppConfig& b);
 bool operator!=(const AppConfig& a, const AppConfig& b);
 
+// Field-level difference between two configs. Changed fields are grouped by
+// the cheapest runtime response that makes the new values take effect.
+struct AppConfigDiff {
+    std::vector<const char*> fields; // changed keys, spelled as in the config file
+    bool camera = false;             // camera and controls: applied in place
+    bool render = false;             // renderer, HUD and logging toggles: applied in place
+    bool ring = false;               // ring extents: stream only the difference
+    bool ring_grew_only = false;     // ring_radius grew and nothing else about the ring changed
+    bool remesh = false;             // meshing parameters: remesh cached chunks
+    bool pools = false;              // chunk pool sizes or memory type: resized in place
+    bool loader_threads = false;     // loader pool restarted at the new sizes
+    bool terrain = false;            // planet/terrain: drop generated chunks, keep player deltas
+    bool storage = false;            // region root and save policy
+    bool empty() const { return fields.empty(); }
+};
+
+AppConfigDiff diff_configs(const AppConfig& before, const AppConfig& after);
+
+// Streaming response to a diff. Ring jobs read the planet config for their whole run, so a
+// terrain change joins the loader before the new config is applied.
+struct StreamingDiffPlan {
+    bool stop_loader = false;           // before the streaming subsystem is reconfigured
+    bool invalidate = false;            // drop generated chunks and meshes, restream the ring
+    bool restart_loader = false;        // new pool sizes
+    std::optional<int> ring_delta_keep; // re-request the ring, keeping tiles inside this radius (-1: none)
+};
+
+StreamingDiffPlan plan_streaming_diff(const AppConfigDiff& diff, const AppConfig& before, const AppConfig& after,
+                                      bool loader_busy);
+std::string describe_config_diff(const AppConfigDiff& diff);
+
 class AppConfigManager {
 public:
     explicit AppConfigManager(AppConfig defaults);
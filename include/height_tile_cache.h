@@ -0,0 +1,70 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include "planet.h"
+
+namespace wf {
+
+// Unit direction of column (x, y) in chunk column (i, j) of `face` (basis from face_basis).
+// It does not depend on the shell k, so every shell of a column samples the same heights.
+Float3 column_direction(const PlanetConfig& cfg, const Float3& right, const Float3& up, const Float3& forward,
+                        std::int64_t i, std::int64_t j, int x, int y);
+
+// terrain_height_m at the 64x64 column directions of one chunk column (face, i, j).
+struct HeightTile {
+    static constexpr int kSize = 64;
+    std::array<float, kSize * kSize> height_m{}; // above cfg.radius_m, index y * kSize + x
+    float min_m = 0.0f;
+    float max_m = 0.0f;
+
+    float at(int x, int y) const { return height_m[static_cast<std::size_t>(y * kSize + x)]; }
+};
+
+void build_height_tile(const PlanetConfig& cfg, int face, std::int64_t i, std::int64_t j, HeightTile& out);
+
+// Shared height tiles of recently generated chunk columns. A ring job generates
+// k_down + k_up + 1 shells per column, and the next job revisits most columns, so each
+// column pays for its terrain_height_m evaluations once. Least recently used tiles are
+// dropped past the capacity; tiles still held by callers stay alive. Thread-safe.
+class HeightTileCache {
+public:
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;         // tiles built: 64x64 height evaluations each
+        std::size_t entries = 0;
+    };
+
+    explicit HeightTileCache(std::size_t capacity_tiles = 4096);
+
+    // Never returns null. Tiles built for another PlanetConfig (by planet_config_hash)
+    // are dropped on first use of the new one.
+    std::shared_ptr<const HeightTile> get(const PlanetConfig& cfg, int face, std::int64_t i, std::int64_t j);
+
+    Stats stats() const;
+    void clear();
+
+private:
+    struct Entry {
+        std::shared_ptr<const HeightTile> tile;
+        std::list<FaceChunkKey>::iterator lru;  // position in lru_
+    };
+
+    void evict_over_capacity();
+
+    mutable std::mutex mutex_;
+    std::unordered_map<FaceChunkKey, Entry, FaceChunkKeyHash> entries_; // k is always 0
+    std::list<FaceChunkKey> lru_;  // most recently used first
+    std::size_t capacity_ = 0;
+    std::uint64_t config_hash_ = 0;
+    uint64_t hits_ = 0;
+    uint64_t misses_ = 0;
+};
+
+} // namespace wf
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+
+#include "chunk.h"
+
+namespace wf {
+
+inline constexpr uint8_t kMaxLight = 15;
+
+// Block light a material emits into its surroundings: its material table level (0 = none).
+uint8_t material_light_emission(uint16_t mat);
+
+// A chunk and its 26 neighbors on the same face grid (x = i, y = j, z = k); null slots are
+// not loaded and neither pass nor receive light.
+struct LightNeighborhood {
+    static constexpr int kCenter = 13;
+    static constexpr int slot(int dx, int dy, int dz) { return (dx + 1) + (dy + 1) * 3 + (dz + 1) * 9; }
+
+    Chunk64* chunks[27] = {};
+};
+
+// Sunlight, emitters and their spread inside a freshly generated chunk. +z points away from
+// the planet, so sunlight falls along -z without fading. Sky enters the top layer from
+// `above` when given, else through the columns set in `open_sky` (bit x of word y; null = none).
+void light_chunk(Chunk64& c, const Chunk64* above, const uint64_t* open_sky);
+
+// Pulls light across the faces from lit neighbors (nb = -X,+X,-Y,+Y,-Z,+Z; null = skip) and
+// spreads it inside the chunk. Neighbors are only read and the result goes to `out`, so the
+// chunks of a ring band can gather in parallel. False (and `out` untouched) if nothing brightened.
+bool light_gather(const Chunk64& c, const Chunk64* const nb[6], ChunkLight& out);
+
+// Incremental relight after voxels (linear indices) of the center chunk changed material.
+// The new materials are already set and the light still holds the old levels: a removal
+// pass clears what the old voxels lit, then an add pass refills from the surviving sources.
+// Returns a bitmask of slots whose light changed or whose mesh reads a changed boundary cell.
+uint32_t relight_edit(LightNeighborhood& nbh, std::span<const uint32_t> changed);
+
+} // namespace wf
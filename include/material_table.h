@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstdint>
+#include <istream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "planet.h"
+
+namespace wf {
+
+// How the (future) voxel simulation moves a material.
+enum class SimClass : uint8_t { Solid, Granular, Fluid, Gas };
+
+struct MaterialInfo {
+    std::string name;
+    float color[3] = {0.82f, 0.75f, 0.66f};
+    float alpha = 1.0f;          // coverage of translucent (non-opaque) surfaces such as water
+    bool opaque = true;
+    uint8_t emissive = 0;        // block light level 0..15
+    SimClass sim = SimClass::Solid;
+    float density = 1000.0f;     // kg/m^3
+    float hardness = 1.0f;       // relative dig effort; negative = indestructible
+    bool defined = false;        // false for ids the table never named
+};
+
+// std430 palette entry read by shaders/chunk.frag, indexed by material id.
+struct GpuMaterial {
+    float color[4];     // rgb, alpha used by the translucent pass
+    float emissive;     // 0..1 share of the base color shown regardless of light
+    uint32_t flags;
+    uint32_t pad[2];
+};
+static_assert(sizeof(GpuMaterial) == 32, "GpuMaterial must match the std430 layout in chunk.frag");
+
+// Material properties by id. The built-in ids of `Material` (planet.h) are what the
+// generator writes and what region files store, so a loaded table may restyle them but
+// not move them; new materials take any free id.
+class MaterialTable {
+public:
+    static constexpr uint32_t kGpuOpaque = 1u;
+    static constexpr uint32_t kGpuEmissive = 2u;
+
+    // Built-in air, rock, dirt, water and lava.
+    MaterialTable();
+
+    // Applies a config on top of the current entries: one `[name]` section per material with
+    // id, color (r g b or #rrggbb), alpha, opaque, emissive, sim, density and hardness keys.
+    // On error the table is unchanged and `error` names the offending line.
+    bool load_file(const std::string& path, std::string* error = nullptr);
+    bool parse(std::istream& in, std::string* error = nullptr);
+
+    std::size_t size() const { return entries_.size(); }
+    // Unknown ids resolve to a default opaque solid.
+    const MaterialInfo& info(uint16_t id) const { return id < entries_.size() ? entries_[id] : fallback_; }
+    bool opaque(uint16_t id) const { return info(id).opaque; }
+    uint8_t emissive(uint16_t id) const { return info(id).emissive; }
+    SimClass sim(uint16_t id) const { return info(id).sim; }
+    std::optional<uint16_t> find(std::string_view name) const;
+
+    std::vector<GpuMaterial> gpu_palette() const;
+
+private:
+    void define(uint16_t id, MaterialInfo m);
+
+    std::vector<MaterialInfo> entries_;
+    MaterialInfo fallback_{};
+};
+
+// Process-wide table read by generation, meshing, lighting, editing and the renderer without
+// locking. Replace it only at startup, before streaming workers or the renderer read it.
+const MaterialTable& material_table();
+void set_material_table(MaterialTable table);
+
+// True when the chunk's palette names an occupied material that is not opaque (water): such
+// voxels let light through and are meshed into the translucent pass.
+bool has_clear_materials(const struct Chunk64& c);
+
+} // namespace wf
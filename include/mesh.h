@@ -9,22 +9,104 @@ struct Vertex {
     float x, y, z;
     float nx, ny, nz;
     uint16_t mat;
+    uint8_t ao = 3;        // baked corner occlusion, 0 (fully occluded) .. 3 (open)
+    uint8_t light = 0xF0;  // sky << 4 | block light of the cell in front of the face (0..15 each)
 };
 
+// Contiguous vertex/index range whose 16-bit indices are relative to base_vertex.
+struct MeshSegment {
+    uint32_t first_index = 0;
+    uint32_t index_count = 0;
+    uint32_t base_vertex = 0;
+    uint32_t vertex_count = 0;
+    bool translucent = false;  // blended after all opaque geometry (water)
+};
+
+// Chunk meshes use 16-bit indices. A mesh that outgrows 65536 vertices is split
+// into further segments, each drawn with its own vertex offset. Translucent geometry
+// follows the opaque geometry in segments of its own.
 struct Mesh {
+    static constexpr uint32_t kMaxSegmentVertices = 65536;
+
     std::vector<Vertex> vertices;
-    std::vector<uint32_t> indices;
+    std::vector<uint16_t> indices;
+    std::vector<MeshSegment> segments;
+    bool translucent = false;  // segments opened from now on are translucent
+
+    void clear() { vertices.clear(); indices.clear(); segments.clear(); translucent = false; }
+
+    // Everything appended after this call lands in translucent segments.
+    void begin_translucent() { translucent = true; }
+
+    // Segment-relative index of the first of `count` vertices about to be appended;
+    // opens a new segment when the current one would overflow or switches pass.
+    uint32_t begin_vertices(uint32_t count) {
+        if (segments.empty() || segments.back().translucent != translucent ||
+            segments.back().vertex_count + count > kMaxSegmentVertices) {
+            segments.push_back(MeshSegment{(uint32_t)indices.size(), 0, (uint32_t)vertices.size(), 0, translucent});
+        }
+        MeshSegment& seg = segments.back();
+        uint32_t local = seg.vertex_count;
+        seg.vertex_count += count;
+        return local;
+    }
+    void push_index(uint32_t local) {
+        indices.push_back((uint16_t)local);
+        segments.back().index_count++;
+    }
+
+    // Calls fn(i0, i1, i2) with absolute vertex indices for every triangle.
+    template <typename Fn>
+    void for_each_triangle(Fn&& fn) const {
+        for (const MeshSegment& seg : segments) {
+            const uint16_t* idx = indices.data() + seg.first_index;
+            for (uint32_t i = 0; i + 2 < seg.index_count; i += 3) {
+                fn(seg.base_vertex + idx[i], seg.base_vertex + idx[i + 1], seg.base_vertex + idx[i + 2]);
+            }
+        }
+    }
 };
 
+// Cells one voxel outside a chunk that no face neighbor covers: the 12 edge strips (a row
+// along one axis, outside the chunk on the other two) and the 8 corner cells. The greedy
+// mesher reads them only for AO at the chunk's edges and corners.
+struct ChunkEdgeCells {
+    // Strip along `axis`; side_a / side_b place the other two axes (in x, y, z order) at
+    // -1 (0) or N (1).
+    static constexpr int edge(int axis, int side_a, int side_b) { return axis * 4 + side_a * 2 + side_b; }
+    static constexpr int corner(int sx, int sy, int sz) { return sx + sy * 2 + sz * 4; }
+
+    uint64_t solid[12] = {};  // bit t: cell t along the strip is occupied
+    uint64_t clear[12] = {};  // occupied by a non-opaque material (water)
+    uint8_t corner_solid = 0; // bit per corner()
+    uint8_t corner_clear = 0;
+};
+
+// Fills `out` from the diagonal chunks of a 3x3x3 neighborhood on one face grid, slot
+// (dx + 1) + (dy + 1) * 3 + (dz + 1) * 9; null slots read as air.
+void gather_edge_cells(const struct Chunk64* const nbh[27], ChunkEdgeCells& out);
+
 // Meshing APIs
 void mesh_chunk_naive(const struct Chunk64& c, Mesh& out, float voxel_size_m);
 void mesh_chunk_greedy(const struct Chunk64& c, Mesh& out, float voxel_size_m);
 // Neighbor-aware greedy mesher to correctly close seams across chunk boundaries without emitting outer walls.
 // Neighbor pointers may be null; when null, boundaries toward that neighbor are treated as seamless (no faces emitted).
+// `owned` (bit x of word y + z*N) restricts emission to faces of owned solid voxels; unowned
+// voxels still occlude. Null means the whole chunk is owned.
+// Each vertex carries 3-neighbor corner AO and the light of the cell in front of its face;
+// quads only merge across cells with matching corner AO and light. AO at the chunk's edges
+// and corners reads `edges`; null reads those cells as air. `ambient_occlusion` = false
+// leaves every corner open (benchmark baseline).
+// Opaque voxels emit faces toward any non-opaque cell (air or water) into opaque segments.
+// Non-opaque occupied voxels (water) emit faces toward air only, without AO, into trailing
+// translucent segments; faces between two such voxels are culled.
 void mesh_chunk_greedy_neighbors(const struct Chunk64& c,
                                  const struct Chunk64* negX, const struct Chunk64* posX,
                                  const struct Chunk64* negY, const struct Chunk64* posY,
                                  const struct Chunk64* negZ, const struct Chunk64* posZ,
-                                 Mesh& out, float voxel_size_m);
+                                 Mesh& out, float voxel_size_m,
+                                 const uint64_t* owned = nullptr,
+                                 const ChunkEdgeCells* edges = nullptr,
+                                 bool ambient_occlusion = true);
 
 } // namespace wf
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include "chunk.h"
+#include "mesh.h"
+
+namespace wf {
+
+// 128-bit content hash of everything the greedy mesher reads: the chunk's occupancy,
+// palette, indices and light, each neighbor's facing boundary slab (occupancy, see-through
+// voxels and light), the edge and corner cells, the owned mask and scale.
+struct MeshCacheKey {
+    uint64_t h0 = 0;
+    uint64_t h1 = 0;
+    bool operator==(const MeshCacheKey& o) const { return h0 == o.h0 && h1 == o.h1; }
+};
+
+struct MeshCacheKeyHash {
+    std::size_t operator()(const MeshCacheKey& k) const noexcept { return static_cast<std::size_t>(k.h0); }
+};
+
+// Shared, refcounted neighbor-aware greedy meshes in chunk-local voxel space. Identical
+// chunks (uniform fills, repeated terrain, neighbors remeshed after an edit elsewhere,
+// edits that were reverted) reuse one mesh instead of meshing again. Least recently used
+// entries are dropped past the byte budget; meshes still held by callers stay alive.
+// Thread-safe.
+class MeshCache {
+public:
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        double saved_ms = 0.0;   // mesh time of hits minus their hashing time
+        std::size_t entries = 0;
+        std::size_t bytes = 0;
+    };
+
+    explicit MeshCache(std::size_t budget_bytes = 64u << 20);
+
+    static MeshCacheKey key_for(const Chunk64& c,
+                                const Chunk64* nx, const Chunk64* px,
+                                const Chunk64* ny, const Chunk64* py,
+                                const Chunk64* nz, const Chunk64* pz,
+                                float voxel_size_m, const uint64_t* owned,
+                                const ChunkEdgeCells* edges = nullptr);
+
+    // mesh_chunk_greedy_neighbors through the cache. Never returns null.
+    std::shared_ptr<const Mesh> mesh_greedy(const Chunk64& c,
+                                            const Chunk64* nx, const Chunk64* px,
+                                            const Chunk64* ny, const Chunk64* py,
+                                            const Chunk64* nz, const Chunk64* pz,
+                                            float voxel_size_m, const uint64_t* owned = nullptr,
+                                            const ChunkEdgeCells* edges = nullptr);
+
+    Stats stats() const;
+    void clear();
+
+private:
+    struct Entry {
+        std::shared_ptr<const Mesh> mesh;
+        std::size_t bytes = 0;
+        double mesh_ms = 0.0;
+        std::list<MeshCacheKey>::iterator lru;  // position in lru_
+    };
+
+    void evict_over_budget();
+
+    mutable std::mutex mutex_;
+    std::unordered_map<MeshCacheKey, Entry, MeshCacheKeyHash> entries_;
+    std::list<MeshCacheKey> lru_;  // most recently used first
+    std::size_t budget_bytes_ = 0;
+    std::size_t bytes_ = 0;
+    uint64_t hits_ = 0;
+    uint64_t misses_ = 0;
+    double saved_ms_ = 0.0;
+};
+
+} // namespace wf
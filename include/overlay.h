@@ -15,9 +15,15 @@ public:
     void recreate_swapchain(VkRenderPass renderPass, VkExtent2D extent, const char* shaderDir);
     void cleanup(VkDevice dev);
 
+    // Queue used for the one-time glyph atlas upload.
+    void set_transfer_context(uint32_t queue_family, VkQueue queue) { transfer_queue_family_ = queue_family; transfer_queue_ = queue; }
+
     void upload_draw_data(size_t frameSlot, const ui::UIDrawData& drawData);
     void record_draw(VkCommandBuffer cmd, size_t frameSlot);
 
+    double last_upload_ms() const { return last_upload_ms_; }
+    size_t last_upload_bytes() const { return last_upload_bytes_; }
+
 private:
     // Pipeline
     VkPhysicalDevice phys_ = VK_NULL_HANDLE;
@@ -26,16 +32,36 @@ private:
     VkPipeline pipeline_ = VK_NULL_HANDLE;
     VkExtent2D extent_{};
 
-    // Per-frame overlay vertex buffers (NDC position + RGBA)
+    // Glyph atlas (R8, built from the 6x8 UI font) and its descriptor
+    uint32_t transfer_queue_family_ = 0;
+    VkQueue transfer_queue_ = VK_NULL_HANDLE;
+    VkImage atlas_image_ = VK_NULL_HANDLE;
+    VkDeviceMemory atlas_mem_ = VK_NULL_HANDLE;
+    VkImageView atlas_view_ = VK_NULL_HANDLE;
+    VkSampler atlas_sampler_ = VK_NULL_HANDLE;
+    VkDescriptorSetLayout set_layout_ = VK_NULL_HANDLE;
+    VkDescriptorPool descriptor_pool_ = VK_NULL_HANDLE;
+    VkDescriptorSet descriptor_set_ = VK_NULL_HANDLE;
+
+    // Per-frame persistently mapped geometry: [vertices | uint32 indices]
     static constexpr size_t kFrames = 2;
     VkBuffer vbuf_[kFrames] = {VK_NULL_HANDLE, VK_NULL_HANDLE};
     VkDeviceMemory vmem_[kFrames] = {VK_NULL_HANDLE, VK_NULL_HANDLE};
-    uint32_t vertex_count_[kFrames] = {0, 0};
+    void* mapped_[kFrames] = {nullptr, nullptr};
     VkDeviceSize capacity_bytes_[kFrames] = {0, 0};
+    VkDeviceSize index_offset_[kFrames] = {0, 0};
+    uint32_t index_count_[kFrames] = {0, 0};
+    ui::Color shadow_color_[kFrames]{};
+    uint64_t slot_revision_[kFrames] = {0, 0};
+    bool slot_valid_[kFrames] = {false, false};
+    double last_upload_ms_ = 0.0;
+    size_t last_upload_bytes_ = 0;
 
     // Helpers
     uint32_t find_memory_type(uint32_t typeBits, VkMemoryPropertyFlags properties);
     void create_host_buffer(VkDeviceSize size, VkBufferUsageFlags usage, VkBuffer& buf, VkDeviceMemory& mem, const void* data);
+    bool create_atlas();
+    void destroy_atlas(VkDevice dev);
 };
 
 } // namespace wf
@@ -2,7 +2,10 @@
 
 #include <cstdint>
 #include <functional>
+#include <span>
+#include <vector>
 #include "wf_math.h"
+#include "wf_noise.h"
 
 namespace wf {
 
@@ -27,10 +30,36 @@ struct PlanetConfig {
     int    terrain_octaves = 4;   // number of FBM octaves
     float  terrain_lacunarity = 2.0f; // octave frequency multiplier
     float  terrain_gain = 0.5f;        // amplitude falloff per octave
+    NoiseBasis terrain_noise = NoiseBasis::Value; // value | gradient | simplex
+    float  terrain_warp = 0.0f;        // domain warp strength in base-octave lattice units
 };
 
-// Map a 3D direction to cube face index (0..5) – utility for future chunking
+// Bump whenever the base generator produces different voxels for the same
+// PlanetConfig; everything persisted from the old output becomes stale.
+inline constexpr uint32_t kGeneratorVersion = 2;
+
+// Identifies the base world that a chunk blob, delta or cache entry was derived from.
+struct GeneratorStamp {
+    uint32_t generator_version = 0; // 0 = unknown (written before stamping existed)
+    std::uint64_t config_hash = 0;
+    bool known() const { return generator_version != 0; }
+};
+
+inline bool operator==(const GeneratorStamp& a, const GeneratorStamp& b) {
+    return a.generator_version == b.generator_version && a.config_hash == b.config_hash;
+}
+inline bool operator!=(const GeneratorStamp& a, const GeneratorStamp& b) { return !(a == b); }
+
+// Canonical hash of every PlanetConfig field that affects generated voxels
+// (independent of struct padding and field order). Extend it with new fields.
+std::uint64_t planet_config_hash(const PlanetConfig& cfg);
+GeneratorStamp generator_stamp(const PlanetConfig& cfg);
+
+// Map a 3D direction to cube face index (0..5) – utility for future chunking. Ties go to
+// the lower face index: ±X before ±Y before ±Z. The double version treats components within
+// rounding of the largest as tied, so it is stable across face grids.
 int face_from_direction(Float3 dir);
+int face_from_direction(const Double3& dir);
 
 // Given a face index and local [-1,1] uv on that face, return unit direction on the sphere
 Float3 direction_from_face_uv(int face, float u, float v);
@@ -67,11 +96,68 @@ struct FaceChunkKeyHash {
     }
 };
 
-// Sample the base world (procedural, read-only).
+// Cube face adjacency across the 12 edges. Edges of a face: 0 = +right, 1 = -right,
+// 2 = +up, 3 = -up. `edge` is the shared edge as seen from the neighbor. The three
+// faces at a corner are the face itself plus its neighbors across the two edges.
+struct FaceEdge { int face; int edge; };
+FaceEdge face_edge_neighbor(int face, int edge);
+
+// Face-local chunk grids: a point (S, T, R) in meters (S/T along the face's right/up,
+// R radial) maps to the direction (S/R, T/R, sqrt(1 - (S/R)^2 - (T/R)^2)) in the face
+// frame. The grid stays valid past the face's cube edges while S^2 + T^2 < R^2, so
+// each face also samples a strip of its neighbors.
+Double3 face_grid_direction(int face, double S, double T, double R);
+// Inverse on any face; false when `dir` points away from it.
+bool face_grid_coords(int face, const Double3& dir, double R, double& S, double& T);
+
+// Every voxel is meshed and edited on exactly one face: the one its center direction is
+// dominant on, ties broken as in face_from_direction. Neighbor faces' grids reach past
+// the edge, but the voxels there belong to the neighbor.
+bool face_owns_direction(int face, const Double3& dir);
+bool face_owns_grid_point(int face, double S, double T, double R);
+
+enum class FaceOwnership : uint8_t { kNone, kPartial, kFull };
+FaceOwnership chunk_face_ownership(const PlanetConfig& cfg, const FaceChunkKey& key);
+// Per-voxel ownership of a kPartial chunk: bit x of word (y + z * 64).
+void chunk_ownership_mask(const PlanetConfig& cfg, const FaceChunkKey& key, std::vector<std::uint64_t>& out);
+// The owned voxel holding the planet-centered point p (meters): its chunk and its voxel
+// within the chunk. p's dominant face is tried first, then the neighbors whose grids reach
+// it. False at the center, or in the slivers between the faces' owned voxels.
+bool owned_voxel_at(const PlanetConfig& cfg, const Double3& p, FaceChunkKey& key, int& lx, int& ly, int& lz);
+
+// Sample the base world (procedural, read-only). The surface height is the one chunk
+// generation uses for the generator column the voxel's direction falls in, so samples
+// agree with generated chunks at the surface.
 BaseSample sample_base(const PlanetConfig& cfg, Int3 voxel);
 
+// sample_base over a span of voxels: out[i] == sample_base(cfg, voxels[i]). The terrain
+// height is evaluated once per generator column the voxels fall in, voxels are classified
+// against the surface, and the cave noise of those deep enough to be carved runs as one
+// batch. out must hold voxels.size() samples.
+void sample_base_batch(const PlanetConfig& cfg, std::span<const Int3> voxels, std::span<BaseSample> out);
+
+// The base world at dir * radii_m[i] (meters from the center, not snapped to voxels), the
+// same rules as sample_base. The terrain height of dir is evaluated once for the column.
+void sample_base_radial(const PlanetConfig& cfg, Float3 dir, std::span<const double> radii_m,
+                        std::span<BaseSample> out);
+
+// Cave noise at points given in meters, as coordinate arrays of n points. sample_base
+// carves rock more than kCaveMinDepthM below the surface where it exceeds
+// kCaveNoiseThreshold.
+inline constexpr float kCaveNoiseThreshold = 0.35f;
+inline constexpr double kCaveMinDepthM = 3.0;
+void cave_noise_batch(const PlanetConfig& cfg, const float* xs_m, const float* ys_m, const float* zs_m, std::size_t n,
+                      float* out);
+
 // Deterministic terrain height at a direction on the sphere, in meters above cfg.radius_m.
 // Mirrors the elevation logic used in sample_base (no caves/water/biomes); used for ground following.
 double terrain_height_m(const PlanetConfig& cfg, Float3 direction);
 
+// The same height from face-UV coordinates ([-1,1] on the direction's dominant face).
+double terrain_height_uv(const PlanetConfig& cfg, float u, float v);
+
+// Upper bound on |d terrain_height_uv / du| (and / dv) over face-UV coordinates, in meters
+// per unit of u. Keep it in step with the noise behind terrain_height_m.
+double terrain_height_slope_bound(const PlanetConfig& cfg);
+
 } // namespace wf
@@ -1,16 +1,24 @@
 // Minimal region IO scaffolding: 32x32 face-local tiles per file, per-k shell.
 // Format is versioned with a simple header + TOC + uncompressed chunk blobs.
+// V2 headers and blobs carry the GeneratorStamp of the base world they came from;
+// V1 data reads back with an unknown stamp.
 
 #pragma once
 
 #include <cstdint>
+#include <optional>
+#include <span>
 #include <string>
+#include <utility>
+#include <vector>
 #include "planet.h"
 #include "chunk.h"
 #include "chunk_delta.h"
 
 namespace wf {
 
+class AsyncIO;
+
 struct RegionHeaderV1 {
     char     magic[8];      // "WFREGN1\0"
     uint32_t version;       // 1
@@ -26,6 +34,13 @@ struct RegionHeaderV1 {
     std::uint64_t data_offset; // absolute file offset where blobs can start
 };
 
+// V2 region header = V1 header followed by the stamp of the last writer.
+struct RegionHeaderStampV2 {
+    uint32_t generator_version; // kGeneratorVersion of the writer
+    uint32_t reserved;
+    std::uint64_t config_hash;  // planet_config_hash of the writer
+};
+
 struct RegionTocEntryV1 {
     std::uint64_t offset;   // absolute file offset of chunk blob (0 = empty)
     std::uint32_t size;     // blob size in bytes (compressed or raw)
@@ -45,6 +60,20 @@ struct ChunkBlobHeaderV1 {
     std::uint32_t occ_words;     // number of 64-bit words in occupancy
 };
 
+// V2 chunk blob: V1 fields plus the stamp of the generator that produced it
+struct ChunkBlobHeaderV2 {
+    char     magic[8];      // "WFCHK2\0"
+    uint32_t version;       // 2
+    uint16_t palette_count;
+    uint8_t  bpp;
+    uint8_t  reserved;
+    std::uint32_t indices_bytes;
+    std::uint32_t occ_words;
+    std::uint32_t generator_version;
+    std::uint32_t reserved2;
+    std::uint64_t config_hash;
+};
+
 struct ChunkDeltaHeaderV1 {
     char     magic[8];      // "WFDEL1\0"
     uint32_t version;       // 1
@@ -52,6 +81,16 @@ struct ChunkDeltaHeaderV1 {
     uint32_t reserved;      // storage mode: 0 = sparse entries, 1 = dense payload
 };
 
+// V2 delta: V1 fields plus the stamp of the base world the overrides were made against
+struct ChunkDeltaHeaderV2 {
+    char     magic[8];      // "WFDEL2\0"
+    uint32_t version;       // 2
+    uint32_t entry_count;
+    uint32_t reserved;      // storage mode: 0 = sparse entries, 1 = dense payload
+    uint32_t generator_version;
+    std::uint64_t config_hash;
+};
+
 class RegionIO {
 public:
     // Compute region file path for a given face chunk key.
@@ -59,11 +98,30 @@ public:
     static std::string region_path(const FaceChunkKey& key, int tile = 32, const std::string& root = "regions");
 
     // Save/load a chunk to/from its region file. Returns true on success.
-    static bool save_chunk(const FaceChunkKey& key, const Chunk64& c, int tile = 32, const std::string& root = "regions");
-    static bool load_chunk(const FaceChunkKey& key, Chunk64& out, int tile = 32, const std::string& root = "regions");
+    // With `expect` set, a blob generated under any other stamp is refused (returns false).
+    static bool save_chunk(const FaceChunkKey& key, const Chunk64& c, int tile = 32, const std::string& root = "regions",
+                           const GeneratorStamp& stamp = {});
+    static bool load_chunk(const FaceChunkKey& key, Chunk64& out, int tile = 32, const std::string& root = "regions",
+                           const GeneratorStamp* expect = nullptr);
 
+    // Deltas load regardless of stamp; out.base reports what they were recorded against
+    // so the caller can rebase or refuse them. Saving uses delta.base.
     static bool save_chunk_delta(const FaceChunkKey& key, const ChunkDelta& delta, int tile = 32, const std::string& root = "regions");
     static bool load_chunk_delta(const FaceChunkKey& key, ChunkDelta& out, int tile = 32, const std::string& root = "regions");
+    // Saves several deltas of one region as a single commit: the whole region is rewritten
+    // to a temp file, synced and renamed over the old one, so a crash mid-save leaves the
+    // previous region intact. Returns false (writing nothing) if the keys span regions.
+    // The temp file's writes and sync go through io (nullptr uses AsyncIO::shared()).
+    static bool save_region_deltas(std::span<const std::pair<FaceChunkKey, ChunkDelta>> deltas, int tile = 32,
+                                   const std::string& root = "regions", AsyncIO* io = nullptr);
+    // Batched load_chunk_delta: each region file is opened once and its headers, TOCs and
+    // delta blobs are read in three async batches (io = nullptr uses AsyncIO::shared()).
+    // out[i] holds keys[i]'s delta when it has one; returns how many were found.
+    static std::size_t load_chunk_deltas(std::span<const FaceChunkKey> keys, std::vector<std::optional<ChunkDelta>>& out,
+                                         int tile = 32, const std::string& root = "regions", AsyncIO* io = nullptr);
+
+    // Stamp of the last writer of a region file; false if missing or unreadable (V1 files read as unknown).
+    static bool read_region_stamp(const std::string& path, GeneratorStamp& out);
 
     // Utility: convert chunk key to its local tile indices and region origin.
     static void region_coords(const FaceChunkKey& key, int tile, std::int64_t& i0, std::int64_t& j0, int& ti, int& tj);
@@ -23,9 +23,11 @@ public:
         FaceChunkKey key{};
         const Vertex* vertices = nullptr;
         std::size_t vertex_count = 0;
-        const uint32_t* indices = nullptr;
+        const uint16_t* indices = nullptr;
         std::size_t index_count = 0;
-        float center[3] = {0.0f, 0.0f, 0.0f};
+        const MeshSegment* segments = nullptr;
+        std::size_t segment_count = 0;
+        double center[3] = {0.0, 0.0, 0.0}; // mesh origin; vertices are relative to it
         float radius = 0.0f;
     };
 
@@ -49,10 +51,13 @@ public:
         uint32_t first_index = 0;
         int32_t base_vertex = 0;
         uint32_t vertex_count = 0;
-        float center[3] = {0.0f, 0.0f, 0.0f};
+        // One draw per mesh segment, relative to first_index/base_vertex above.
+        std::vector<MeshSegment> segments;
+        double center[3] = {0.0, 0.0, 0.0};
         float radius = 0.0f;
         FaceChunkKey key{0, 0, 0, 0};
         ChunkRenderer* chunk_renderer = nullptr;
+        std::vector<uint32_t> draw_records; // one per segment
 
         ChunkInstance() = default;
         ~ChunkInstance() { release(); }
@@ -69,6 +74,11 @@ public:
         }
 
         void release() {
+            if (chunk_renderer) {
+                for (uint32_t record : draw_records) chunk_renderer->unregister_draw(record);
+            }
+            draw_records.clear();
+            segments.clear();
             if (chunk_renderer && index_count > 0 && vertex_count > 0) {
                 chunk_renderer->free_mesh(first_index, index_count, base_vertex, vertex_count);
             }
@@ -78,7 +88,7 @@ public:
             base_vertex = 0;
             vertex_count = 0;
             radius = 0.0f;
-            center[0] = center[1] = center[2] = 0.0f;
+            center[0] = center[1] = center[2] = 0.0;
             key = FaceChunkKey{0, 0, 0, 0};
             vbuf.reset();
             vmem.reset();
@@ -96,21 +106,25 @@ public:
             first_index = other.first_index;
             base_vertex = other.base_vertex;
             vertex_count = other.vertex_count;
+            segments = std::move(other.segments);
             center[0] = other.center[0];
             center[1] = other.center[1];
             center[2] = other.center[2];
             radius = other.radius;
             key = other.key;
             chunk_renderer = other.chunk_renderer;
+            draw_records = std::move(other.draw_records);
 
             other.index_count = 0;
             other.first_index = 0;
             other.base_vertex = 0;
             other.vertex_count = 0;
             other.radius = 0.0f;
-            other.center[0] = other.center[1] = other.center[2] = 0.0f;
+            other.center[0] = other.center[1] = other.center[2] = 0.0;
             other.key = FaceChunkKey{0, 0, 0, 0};
             other.chunk_renderer = nullptr;
+            other.segments.clear();
+            other.draw_records.clear();
         }
     };
 
@@ -150,6 +164,8 @@ public:
                                       VkDeviceSize pool_idx_bytes,
                                       bool log_pool);
     void cleanup_swapchain_dependents();
+    // Waits for the device, then migrates the chunk pools to the new size/memory type.
+    void resize_chunk_pools(bool device_local_enabled, VkDeviceSize pool_vtx_bytes, VkDeviceSize pool_idx_bytes);
 
     bool upload_chunk_mesh(const ChunkMeshData& data, bool log_stream);
     bool release_chunk(const FaceChunkKey& key, bool log_stream);
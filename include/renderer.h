@@ -64,6 +64,11 @@ public:
     void advance_frame();
 
     bool validation_enabled() const { return enable_validation_; }
+    bool draw_indirect_count_supported() const { return draw_indirect_count_supported_; }
+    bool multi_draw_indirect_supported() const { return multi_draw_indirect_supported_; }
+    bool draw_indirect_first_instance_supported() const { return draw_indirect_first_instance_supported_; }
+    bool pipeline_statistics_supported() const { return pipeline_statistics_supported_; }
+    bool inherited_queries_supported() const { return inherited_queries_supported_; }
     bool swapchain_needs_recreate() const { return swapchain_needs_recreate_; }
     void clear_swapchain_flag() { swapchain_needs_recreate_ = false; }
 
@@ -95,6 +100,11 @@ private:
 
     GLFWwindow* window_ = nullptr;
     bool enable_validation_ = false;
+    bool draw_indirect_count_supported_ = false;
+    bool multi_draw_indirect_supported_ = false;
+    bool draw_indirect_first_instance_supported_ = false;
+    bool pipeline_statistics_supported_ = false;
+    bool inherited_queries_supported_ = false;
 
     VkInstance instance_ = VK_NULL_HANDLE;
     VkDebugUtilsMessengerEXT debug_messenger_ = VK_NULL_HANDLE;
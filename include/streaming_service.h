@@ -1,37 +1,126 @@
 #pragma once
 
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <cstddef>
+#include <cstdint>
 #include <deque>
 #include <functional>
+#include <memory>
 #include <mutex>
+#include <span>
 #include <thread>
 #include <vector>
 
 namespace wf {
 
+// Worker pool with scheduling classes. Each class has its own queue and dedicated
+// workers; a lower class index is a higher priority. A worker serves its own class
+// first and only steals from the others (in priority order) when its queue is empty.
 class StreamingService {
 public:
     using Task = std::function<void()>;
 
-    void start(std::size_t thread_count);
+    struct ClassStats {
+        std::size_t threads = 0;
+        std::size_t pending = 0;
+        std::size_t active = 0;
+        uint64_t completed = 0;
+        double wait_ms_avg = 0.0;   // submit -> start, smoothed
+        double wait_ms_peak = 0.0;  // decaying peak of the same
+    };
+
+    // Single class with thread_count workers (0 = hardware concurrency).
+    void start(std::size_t thread_count, int nice = 0);
+    // One class per entry; a class with 0 threads is served only by stealing. A class's
+    // workers run at its nice offset from the process (Linux; missing entries are 0).
+    void start(std::span<const std::size_t> threads_per_class, std::span<const int> nice_per_class = {});
     void stop();
 
     void submit(Task task);
+    // Non-stealable tasks run only on the class's own workers (long-running coordinators).
+    void submit(std::size_t cls, Task task, bool stealable = true);
+
+    // Runs fn(i) for every i in [0, count) on helpers queued in `cls` plus the calling thread,
+    // and returns once all indices are done. The caller keeps claiming indices itself, so this
+    // is safe to call from a worker and never waits on a helper that has not started.
+    template <typename Fn>
+    void parallel_for(std::size_t cls, std::size_t count, Fn&& fn);
+
     bool busy() const;
     bool idle() const;
+    bool idle(std::size_t cls) const;
     std::size_t pending_tasks() const;
+    std::size_t class_count() const;
+    ClassStats class_stats(std::size_t cls) const;
 
 private:
-    void worker_main(std::size_t index);
+    struct Queued {
+        Task task;
+        std::chrono::steady_clock::time_point enqueued;
+        bool stealable = true;
+    };
+    struct ClassState {
+        std::deque<Queued> tasks;
+        std::size_t threads = 0;
+        std::size_t active = 0;
+        uint64_t completed = 0;
+        double wait_ms_avg = 0.0;
+        double wait_ms_peak = 0.0;
+    };
+
+    void worker_main(std::size_t cls, int nice);
+    // Caller holds mutex_. Own class first, then stealable work by priority.
+    bool take_task(std::size_t own_cls, Queued& out, std::size_t& out_cls);
 
     mutable std::mutex mutex_;
     std::condition_variable cv_;
-    std::deque<Task> tasks_;
+    std::vector<ClassState> classes_;
     std::vector<std::thread> workers_;
     std::atomic<bool> quit_{false};
     std::atomic<std::size_t> active_workers_{0};
 };
 
+template <typename Fn>
+void StreamingService::parallel_for(std::size_t cls, std::size_t count, Fn&& fn) {
+    if (count == 0) return;
+    struct Shared {
+        std::atomic<std::size_t> next{0};
+        std::size_t done = 0;  // guarded by mutex
+        std::mutex mutex;
+        std::condition_variable cv;
+    };
+    auto shared = std::make_shared<Shared>();
+    // Helpers that start after every index is claimed return without touching fn.
+    auto body = [shared, count, &fn]() {
+        std::size_t finished = 0;
+        for (;;) {
+            std::size_t i = shared->next.fetch_add(1, std::memory_order_relaxed);
+            if (i >= count) break;
+            fn(i);
+            ++finished;
+        }
+        if (finished == 0) return;
+        std::lock_guard<std::mutex> lock(shared->mutex);
+        shared->done += finished;
+        if (shared->done == count) shared->cv.notify_all();
+    };
+
+    std::size_t helpers = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::size_t threads = 0;
+        for (const ClassState& state : classes_) threads += state.threads;
+        helpers = std::min(count - 1, threads);
+    }
+    for (std::size_t h = 0; h < helpers; ++h) {
+        submit(cls, body);
+    }
+    body();
+    // Indices still running on helpers finish without this thread spinning on them.
+    std::unique_lock<std::mutex> lock(shared->mutex);
+    shared->cv.wait(lock, [&] { return shared->done == count; });
+}
+
 } // namespace wf
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "planet.h"
+
+namespace wf {
+
+// Terrain height range in meters above cfg.radius_m. min/max are conservative: every
+// terrain_height_m in the covered area lies inside them. avg is the mean of the samples.
+struct HeightBounds {
+    float min_m = 0.0f;
+    float max_m = 0.0f;
+    float avg_m = 0.0f;
+};
+
+// Lazily built min/max/avg pyramid of terrain_height_m over each cube face's UV square.
+// A face is split into tiles_per_face^2 tiles of kTileCells^2 cells; a tile samples its
+// cell corners once and pads each cell by terrain_height_slope_bound, so bounds hold
+// between samples too. Coarser levels merge 2x2 cells, inside tiles and then across
+// tiles up to one cell per face, and are only built where a query reaches; a coarse node
+// whose tiles are not all built samples its own area sparsely instead of building them.
+// Queries pick the level whose cells cover the area with at most 2x2 cells. Thread-safe.
+class TerrainHeightPyramid {
+public:
+    static constexpr int kTileCells = 64;
+    static constexpr int kTileLevels = 7; // 64x64 .. 1x1 cells per tile
+
+    struct Stats {
+        uint64_t tiles_built = 0;
+        uint64_t tiles_loaded = 0;
+        std::size_t tiles = 0;
+    };
+
+    explicit TerrainHeightPyramid(int tiles_per_face = 64);
+
+    // Drops everything built for another config (by generator stamp).
+    void set_config(const PlanetConfig& cfg);
+    // A copy: set_config may replace the config while the caller uses it.
+    PlanetConfig config() const;
+
+    // Over the face-UV rectangle [u0, u1] x [v0, v1] of `face`, clamped to [-1, 1].
+    HeightBounds bounds_uv(int face, double u0, double v0, double u1, double v1);
+    // At the finest cell holding the direction.
+    HeightBounds bounds_at(const Float3& direction);
+    // Over a chunk column of the face-local grid (all k shells). Columns reaching past
+    // their face's edge get the full terrain range.
+    HeightBounds column_bounds(const FaceChunkKey& key);
+    // [0, terrain_amp_m]: what any unbuilt or unknown area may hold.
+    HeightBounds full_range() const;
+
+    // Built tiles go to disk under the generator stamp; load() ignores files written for
+    // another stamp or resolution and keeps what is built.
+    bool save(const std::string& path) const;
+    bool load(const std::string& path);
+
+    Stats stats() const;
+
+private:
+    struct Tile {
+        // Cell corner samples, (kTileCells + 1)^2, row-major in v.
+        std::vector<float> samples;
+        // levels[l] holds (kTileCells >> l)^2 cells.
+        std::array<std::vector<HeightBounds>, kTileLevels> levels;
+    };
+    struct Node {
+        HeightBounds b;
+        bool built = false;
+    };
+    struct Face {
+        std::vector<std::shared_ptr<const Tile>> tiles;  // tiles_per_face^2, null until built
+        // upper[l] holds (tiles_per_face >> l)^2 nodes; upper[0] are the tile roots.
+        std::vector<std::vector<Node>> upper;
+    };
+
+    // Global level g has finest_cells >> g cells per side.
+    HeightBounds cell_bounds(int face, int level, int cx, int cy);
+    std::shared_ptr<const Tile> tile(int face, int tx, int ty);
+    HeightBounds node_bounds(int face, int level, int nx, int ny);
+    HeightBounds sample_node(int level, int nx, int ny) const;
+    std::shared_ptr<Tile> build_tile(const PlanetConfig& cfg, float margin_m, int tx, int ty) const;
+    // Cells and levels from the samples; amp_m and margin_m come from the config the samples
+    // were taken under, read by the caller while holding the mutex.
+    static void finish_tile(Tile& t, float amp_m, float margin_m);
+    void reset_faces();
+
+    mutable std::mutex mutex_;
+    PlanetConfig cfg_{};
+    GeneratorStamp stamp_{};
+    int tiles_per_face_ = 64;
+    int upper_levels_ = 1;
+    int finest_cells_ = 64 * kTileCells;
+    float margin_m_ = 0.0f;   // per-cell padding at the finest level
+    std::array<Face, 6> faces_;
+    uint64_t tiles_built_ = 0;
+    uint64_t tiles_loaded_ = 0;
+    std::size_t tile_count_ = 0;
+};
+
+// Radial chunk shells [k_lo, k_hi] (k = floor(r / chunk size)) that terrain inside `b` can
+// cross, extended margin_m under its lowest point. The base world above k_hi is all air.
+void surface_shell_range(const PlanetConfig& cfg, const HeightBounds& b, double margin_m, std::int64_t& k_lo,
+                         std::int64_t& k_hi);
+
+} // namespace wf
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstdint>
+#include <unordered_map>
 #include <vector>
 
 #include "ui/ui_types.h"
@@ -20,25 +22,75 @@ struct ContextParams {
     UIStyle style{};
 };
 
+struct UIRetainedStats {
+    std::uint32_t widgets = 0;
+    std::uint32_t widgets_rebuilt = 0;
+    bool layout_changed = false;
+};
+
+// Retained draw list: every widget owns a fixed quad range in a persistent
+// vertex/index array. Widgets whose content hash is unchanged skip geometry
+// generation entirely; changed widgets are patched in place when they still
+// fit their range, otherwise the whole list is repacked.
 class UIContext {
 public:
     void begin(const ContextParams& params);
 
+    // Open a widget scope. Returns true when the caller must emit geometry;
+    // false means the cached range is reused. Always pair with end_widget().
+    bool begin_widget(UIID id, std::uint64_t content_hash);
+    void end_widget();
+
     // Basic primitive builders operating in screen-space pixels.
     void add_quad_pixels(const Rect& rect, const Color& color);
     void add_shadowed_quad_pixels(const Rect& rect, const Color& color);
+    // One atlas-textured quad per glyph; the drop shadow is resolved in the shader.
+    void add_glyph_pixels(const Rect& rect, int glyph_index, const Color& color);
 
     UIDrawData end();
 
     const ContextParams& params() const { return params_; }
     const std::vector<UIDrawVertex>& vertices() const { return vertices_; }
+    const std::vector<std::uint32_t>& indices() const { return indices_; }
+    const UIRetainedStats& stats() const { return stats_; }
 
 private:
+    struct WidgetRange {
+        UIID id = 0;
+        std::uint64_t hash = 0;
+        std::uint32_t first_quad = 0;
+        std::uint32_t capacity_quads = 0;
+    };
+    struct FrameWidget {
+        UIID id = 0;
+        std::uint64_t hash = 0;
+        bool rebuilt = false;
+        std::uint32_t scratch_first = 0; // in vertices
+        std::uint32_t scratch_count = 0;
+    };
+
     ContextParams params_{};
+    std::uint64_t params_hash_ = 0;
     std::vector<UIDrawVertex> vertices_;
+    std::vector<std::uint32_t> indices_;
+    std::vector<WidgetRange> ranges_;         // layout of vertices_, in draw order
+    std::unordered_map<UIID, std::size_t> range_lookup_;
+    std::vector<FrameWidget> frame_widgets_;  // widgets visited this frame, in draw order
+    std::vector<UIDrawVertex> scratch_;       // geometry of rebuilt widgets this frame
+    std::vector<UIDirtyRange> dirty_;         // vertex patches newer than patch_base_revision_
+    bool widget_open_ = false;
+    std::uint32_t implicit_count_ = 0;
+    std::uint64_t revision_ = 0;
+    std::uint64_t layout_revision_ = 0;
+    std::uint64_t patch_base_revision_ = 0;
+    UIRetainedStats stats_{};
     UIDrawData draw_data_{};
 
-    void push_quad_ndc(const Rect& rect_px, const Color& color) noexcept;
+    void ensure_scope();
+    void repack();
+    void write_range(const WidgetRange& range, const UIDrawVertex* src, std::uint32_t vertex_count);
+    void push_quad_ndc(const Rect& rect_px, const Color& color, const Rect& uv, float shadow_texels) noexcept;
+    void push_solid_quad_ndc(const Rect& rect_px, const Color& color) noexcept;
 };
 
 } // namespace wf::ui
@@ -56,10 +56,15 @@ public:
 
     FrameOutput build_frame(const FrameInput& input);
     const UIDrawData& draw_data() const;
+    // CPU time of the last build_frame and how much of the retained list it touched.
+    double last_build_ms() const { return last_build_ms_; }
+    const UIRetainedStats& retained_stats() const { return context_.stats(); }
 
 private:
     Settings settings_{};
     UIContext context_{};
+    float hud_text_height_ = 0.0f;
+    double last_build_ms_ = 0.0;
     UIBackend backend_{};
     UIDrawData draw_data_{};
     std::string hud_text_{};
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <bit>
 #include <cstdint>
 #include <string_view>
 
@@ -25,4 +26,25 @@ inline constexpr UIID hash_id(UIID seed, std::string_view value) {
     return hash;
 }
 
+// Content hashing for retained widgets (FNV-1a over the raw value bits).
+inline constexpr UIID hash_mix(UIID seed, std::uint64_t value) {
+    for (int i = 0; i < 8; ++i) {
+        seed ^= (value >> (i * 8)) & 0xFFu;
+        seed *= 1099511628211ull;
+    }
+    return seed;
+}
+
+inline constexpr UIID hash_mix(UIID seed, float value) {
+    return hash_mix(seed, static_cast<std::uint64_t>(std::bit_cast<std::uint32_t>(value)));
+}
+
+inline constexpr UIID hash_mix(UIID seed, const Rect& r) {
+    return hash_mix(hash_mix(hash_mix(hash_mix(seed, r.x), r.y), r.w), r.h);
+}
+
+inline constexpr UIID hash_mix(UIID seed, const Color& c) {
+    return hash_mix(hash_mix(hash_mix(hash_mix(seed, c.r), c.g), c.b), c.a);
+}
+
 } // namespace wf::ui
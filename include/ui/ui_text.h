@@ -1,6 +1,8 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
+#include <vector>
 
 #include "ui/ui_context.h"
 
@@ -20,4 +22,29 @@ float add_text_block(UIContext& ctx, const char* text, int screen_width, const T
 inline constexpr int kFont6x8Width = 6;
 inline constexpr int kFont6x8Height = 8;
 
+// R8 glyph atlas layout: 16 columns of padded 6x8 cells. The padding keeps
+// shadow taps inside the cell; the extra cell after ASCII 127 is solid white
+// so untextured quads can share the same pipeline.
+inline constexpr int kGlyphAtlasPad = 2;
+inline constexpr int kGlyphAtlasCellW = kFont6x8Width + kGlyphAtlasPad * 2;
+inline constexpr int kGlyphAtlasCellH = kFont6x8Height + kGlyphAtlasPad * 2;
+inline constexpr int kGlyphAtlasCols = 16;
+inline constexpr int kGlyphAtlasGlyphs = 97;
+inline constexpr int kGlyphAtlasSolidIndex = 96;
+inline constexpr int kGlyphAtlasRows = (kGlyphAtlasGlyphs + kGlyphAtlasCols - 1) / kGlyphAtlasCols;
+inline constexpr int kGlyphAtlasWidth = kGlyphAtlasCols * kGlyphAtlasCellW;
+inline constexpr int kGlyphAtlasHeight = kGlyphAtlasRows * kGlyphAtlasCellH;
+
+struct GlyphAtlas {
+    int width = kGlyphAtlasWidth;
+    int height = kGlyphAtlasHeight;
+    std::vector<std::uint8_t> pixels; // width*height, 0 or 255
+};
+
+// Built once from the 6x8 font on first use.
+const GlyphAtlas& glyph_atlas();
+
+// Top-left texel of the glyph's 6x8 box (glyph index = ASCII - 32).
+Vec2 glyph_atlas_origin(int glyph_index);
+
 } // namespace wf::ui
@@ -26,18 +26,40 @@ struct Rect {
     float h = 0.0f;
 };
 
+// NDC position, glyph atlas UV, RGBA and shadow offset in atlas texels (0 = no shadow).
 struct UIDrawVertex {
     float x = 0.0f;
     float y = 0.0f;
+    float u = 0.0f;
+    float v = 0.0f;
     float r = 1.0f;
     float g = 1.0f;
     float b = 1.0f;
     float a = 1.0f;
+    float shadow = 0.0f;
+};
+
+// Vertex span rewritten at `revision`; indices only change with the layout.
+struct UIDirtyRange {
+    std::uint64_t revision = 0;
+    std::uint32_t first_vertex = 0;
+    std::uint32_t vertex_count = 0;
 };
 
 struct UIDrawData {
     const UIDrawVertex* vertices = nullptr;
     std::size_t vertex_count = 0;
+    const std::uint32_t* indices = nullptr;
+    std::size_t index_count = 0;
+    Color shadow_color{0.0f, 0.0f, 0.0f, 0.6f};
+    // Change tracking for persistent GPU copies: a copy at revision R can be
+    // brought up to date by applying every dirty range newer than R, provided
+    // R >= layout_revision and R >= patch_base_revision.
+    std::uint64_t revision = 0;
+    std::uint64_t layout_revision = 0;
+    std::uint64_t patch_base_revision = 0;
+    const UIDirtyRange* dirty_ranges = nullptr;
+    std::size_t dirty_range_count = 0;
 };
 
 } // namespace wf::ui
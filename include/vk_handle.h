@@ -71,5 +71,6 @@ using UniqueDeviceMemory = UniqueHandle<VkDeviceMemory, vkFreeMemory>;
 using UniquePipeline = UniqueHandle<VkPipeline, vkDestroyPipeline>;
 using UniquePipelineLayout = UniqueHandle<VkPipelineLayout, vkDestroyPipelineLayout>;
 using UniqueShaderModule = UniqueHandle<VkShaderModule, vkDestroyShaderModule>;
+using UniqueQueryPool = UniqueHandle<VkQueryPool, vkDestroyQueryPool>;
 
 } // namespace wf::vk
@@ -39,6 +39,34 @@ namespace wf {
     }
 
     inline Float3 to_float3(Int3 a, float s = 1.0f) { return {float(a.x) * s, float(a.y) * s, float(a.z) * s}; }
+
+    // Planet-centered world positions. Float loses sub-meter precision past a few
+    // thousand km, so positions stay double and only camera-relative offsets become float.
+    struct Double3 {
+        double x, y, z;
+
+        Double3() : x(0), y(0), z(0) {
+        }
+
+        Double3(double X, double Y, double Z) : x(X), y(Y), z(Z) {
+        }
+    };
+
+    inline Double3 operator+(Double3 a, Double3 b) { return {a.x + b.x, a.y + b.y, a.z + b.z}; }
+    inline Double3 operator-(Double3 a, Double3 b) { return {a.x - b.x, a.y - b.y, a.z - b.z}; }
+    inline Double3 operator*(Double3 a, double s) { return {a.x * s, a.y * s, a.z * s}; }
+    inline Double3 operator/(Double3 a, double s) { return {a.x / s, a.y / s, a.z / s}; }
+    inline double dot(Double3 a, Double3 b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+    inline double length(Double3 a) { return std::sqrt(dot(a, a)); }
+
+    inline Double3 normalize(Double3 a) {
+        double l = length(a);
+        return (l > 0) ? a / l : Double3{0, 0, 0};
+    }
+
+    inline Float3 to_float3(Double3 a) { return {float(a.x), float(a.y), float(a.z)}; }
+    inline Double3 to_double3(Float3 a) { return {double(a.x), double(a.y), double(a.z)}; }
+    inline Double3 to_double3(Int3 a, double s = 1.0) { return {double(a.x) * s, double(a.y) * s, double(a.z) * s}; }
 } // namespace wf
 
 
@@ -1,7 +1,10 @@
 #pragma once
 
+#include <array>
 #include <cstdint>
 #include <cmath>
+#include <string_view>
+#include <utility>
 #include "wf_math.h"
 
 namespace wf {
@@ -15,21 +18,30 @@ inline uint32_t hash_u32(uint32_t x) {
     return x;
 }
 
+inline constexpr uint32_t kHashMulX = 0x9E3779B1u;
+inline constexpr uint32_t kHashMulY = 0x85EBCA77u;
+inline constexpr uint32_t kHashMulZ = 0xC2B2AE3Du;
+
+// Each lattice axis is mixed on its own before the corners combine, so a cell's corners
+// share 2 axis hashes per dimension instead of hashing every coordinate per corner.
+inline uint32_t hash_axis(int c, uint32_t mul) { return hash_u32(uint32_t(c) * mul); }
+inline uint32_t hash_corner(uint32_t seed, uint32_t hx, uint32_t hy, uint32_t hz) { return hash_u32(seed ^ hx ^ hy ^ hz); }
+
 inline uint32_t hash3(int x, int y, int z, uint32_t seed) {
-    uint32_t h = seed;
-    h ^= hash_u32(uint32_t(x) * 0x9E3779B1u);
-    h ^= hash_u32(uint32_t(y) * 0x85EBCA77u);
-    h ^= hash_u32(uint32_t(z) * 0xC2B2AE3Du);
-    return hash_u32(h);
+    return hash_corner(seed, hash_axis(x, kHashMulX), hash_axis(y, kHashMulY), hash_axis(z, kHashMulZ));
 }
 
+inline float lattice_value(uint32_t h) { return (h / float(0xFFFFFFFFu)) * 2.0f - 1.0f; }
+
 // Value noise in [-1,1]
 inline float value_noise(Int3 p, uint32_t seed) {
-    return (hash3(int(p.x), int(p.y), int(p.z), seed) / float(0xFFFFFFFFu)) * 2.0f - 1.0f;
+    return lattice_value(hash3(int(p.x), int(p.y), int(p.z), seed));
 }
 
 inline float lerp(float a, float b, float t) { return a + (b - a) * t; }
 inline float smoothstep(float t) { return t*t*(3.0f - 2.0f*t); }
+// Quintic fade of gradient noise: C2 continuous, derivative at most 1.875.
+inline float fade5(float t) { return t*t*t*(t*(t*6.0f - 15.0f) + 10.0f); }
 
 // Trilinear interpolated value noise at floating point position
 inline float value_noise_trilinear(Float3 p, uint32_t seed) {
@@ -38,14 +50,17 @@ inline float value_noise_trilinear(Float3 p, uint32_t seed) {
     int zi = int(std::floor(p.z)); float tz = p.z - zi;
     tx = smoothstep(tx); ty = smoothstep(ty); tz = smoothstep(tz);
 
-    float c000 = value_noise({xi, yi, zi}, seed);
-    float c100 = value_noise({xi+1, yi, zi}, seed);
-    float c010 = value_noise({xi, yi+1, zi}, seed);
-    float c110 = value_noise({xi+1, yi+1, zi}, seed);
-    float c001 = value_noise({xi, yi, zi+1}, seed);
-    float c101 = value_noise({xi+1, yi, zi+1}, seed);
-    float c011 = value_noise({xi, yi+1, zi+1}, seed);
-    float c111 = value_noise({xi+1, yi+1, zi+1}, seed);
+    const uint32_t hx0 = hash_axis(xi, kHashMulX), hx1 = hash_axis(xi + 1, kHashMulX);
+    const uint32_t hy0 = hash_axis(yi, kHashMulY), hy1 = hash_axis(yi + 1, kHashMulY);
+    const uint32_t hz0 = hash_axis(zi, kHashMulZ), hz1 = hash_axis(zi + 1, kHashMulZ);
+    float c000 = lattice_value(hash_corner(seed, hx0, hy0, hz0));
+    float c100 = lattice_value(hash_corner(seed, hx1, hy0, hz0));
+    float c010 = lattice_value(hash_corner(seed, hx0, hy1, hz0));
+    float c110 = lattice_value(hash_corner(seed, hx1, hy1, hz0));
+    float c001 = lattice_value(hash_corner(seed, hx0, hy0, hz1));
+    float c101 = lattice_value(hash_corner(seed, hx1, hy0, hz1));
+    float c011 = lattice_value(hash_corner(seed, hx0, hy1, hz1));
+    float c111 = lattice_value(hash_corner(seed, hx1, hy1, hz1));
 
     float x00 = lerp(c000, c100, tx);
     float x10 = lerp(c010, c110, tx);
@@ -56,6 +71,184 @@ inline float value_noise_trilinear(Float3 p, uint32_t seed) {
     return lerp(y0, y1, tz);
 }
 
+// value_noise_trilinear on the z = 0 plane, bit for bit, with half the corners.
+inline float value_noise_bilinear(float x, float y, uint32_t seed) {
+    int xi = int(std::floor(x)); float tx = smoothstep(x - xi);
+    int yi = int(std::floor(y)); float ty = smoothstep(y - yi);
+    const uint32_t hx0 = hash_axis(xi, kHashMulX), hx1 = hash_axis(xi + 1, kHashMulX);
+    const uint32_t hy0 = hash_axis(yi, kHashMulY), hy1 = hash_axis(yi + 1, kHashMulY);
+    const uint32_t hz0 = hash_axis(0, kHashMulZ);
+    float x00 = lerp(lattice_value(hash_corner(seed, hx0, hy0, hz0)), lattice_value(hash_corner(seed, hx1, hy0, hz0)), tx);
+    float x10 = lerp(lattice_value(hash_corner(seed, hx0, hy1, hz0)), lattice_value(hash_corner(seed, hx1, hy1, hz0)), tx);
+    return lerp(x00, x10, ty);
+}
+
+// Gradient (Perlin) noise in [-1,1]: corners hold random gradients instead of values, so
+// features are not aligned with the lattice the way value noise peaks are.
+inline constexpr float kDiag2 = 0.70710678f;
+inline constexpr std::array<float, 8> kGrad2X = {1.0f, -1.0f, 0.0f, 0.0f, kDiag2, -kDiag2, kDiag2, -kDiag2};
+inline constexpr std::array<float, 8> kGrad2Y = {0.0f, 0.0f, 1.0f, -1.0f, kDiag2, kDiag2, -kDiag2, -kDiag2};
+inline float grad2(uint32_t h, float x, float y) { return kGrad2X[h & 7u] * x + kGrad2Y[h & 7u] * y; }
+
+// Cube edge midpoints, padded to 16 so the hash selects with a mask.
+inline constexpr std::array<std::array<int8_t, 3>, 16> kGrad3 = {{
+    {{1, 1, 0}}, {{-1, 1, 0}}, {{1, -1, 0}}, {{-1, -1, 0}}, {{1, 0, 1}}, {{-1, 0, 1}}, {{1, 0, -1}}, {{-1, 0, -1}},
+    {{0, 1, 1}}, {{0, -1, 1}}, {{0, 1, -1}}, {{0, -1, -1}}, {{1, 1, 0}}, {{-1, 1, 0}}, {{0, -1, 1}}, {{0, -1, -1}},
+}};
+inline float grad3(uint32_t h, float x, float y, float z) {
+    const auto& g = kGrad3[h & 15u];
+    return g[0] * x + g[1] * y + g[2] * z;
+}
+
+inline float gradient_noise2(float x, float y, uint32_t seed) {
+    int xi = int(std::floor(x)); float fx = x - xi;
+    int yi = int(std::floor(y)); float fy = y - yi;
+    const uint32_t hx0 = hash_axis(xi, kHashMulX), hx1 = hash_axis(xi + 1, kHashMulX);
+    const uint32_t hy0 = hash_axis(yi, kHashMulY), hy1 = hash_axis(yi + 1, kHashMulY);
+    const float n00 = grad2(hash_corner(seed, hx0, hy0, 0u), fx, fy);
+    const float n10 = grad2(hash_corner(seed, hx1, hy0, 0u), fx - 1.0f, fy);
+    const float n01 = grad2(hash_corner(seed, hx0, hy1, 0u), fx, fy - 1.0f);
+    const float n11 = grad2(hash_corner(seed, hx1, hy1, 0u), fx - 1.0f, fy - 1.0f);
+    const float tx = fade5(fx), ty = fade5(fy);
+    // Unit gradients peak at sqrt(1/2); scale to [-1,1].
+    return 1.41421356f * lerp(lerp(n00, n10, tx), lerp(n01, n11, tx), ty);
+}
+
+inline float gradient_noise3(Float3 p, uint32_t seed) {
+    int xi = int(std::floor(p.x)); float fx = p.x - xi;
+    int yi = int(std::floor(p.y)); float fy = p.y - yi;
+    int zi = int(std::floor(p.z)); float fz = p.z - zi;
+    const uint32_t hx0 = hash_axis(xi, kHashMulX), hx1 = hash_axis(xi + 1, kHashMulX);
+    const uint32_t hy0 = hash_axis(yi, kHashMulY), hy1 = hash_axis(yi + 1, kHashMulY);
+    const uint32_t hz0 = hash_axis(zi, kHashMulZ), hz1 = hash_axis(zi + 1, kHashMulZ);
+    const float tx = fade5(fx), ty = fade5(fy), tz = fade5(fz);
+    const float x00 = lerp(grad3(hash_corner(seed, hx0, hy0, hz0), fx, fy, fz),
+                           grad3(hash_corner(seed, hx1, hy0, hz0), fx - 1.0f, fy, fz), tx);
+    const float x10 = lerp(grad3(hash_corner(seed, hx0, hy1, hz0), fx, fy - 1.0f, fz),
+                           grad3(hash_corner(seed, hx1, hy1, hz0), fx - 1.0f, fy - 1.0f, fz), tx);
+    const float x01 = lerp(grad3(hash_corner(seed, hx0, hy0, hz1), fx, fy, fz - 1.0f),
+                           grad3(hash_corner(seed, hx1, hy0, hz1), fx - 1.0f, fy, fz - 1.0f), tx);
+    const float x11 = lerp(grad3(hash_corner(seed, hx0, hy1, hz1), fx, fy - 1.0f, fz - 1.0f),
+                           grad3(hash_corner(seed, hx1, hy1, hz1), fx - 1.0f, fy - 1.0f, fz - 1.0f), tx);
+    const float n = lerp(lerp(x00, x10, ty), lerp(x01, x11, ty), tz);
+    return std::fmax(-1.0f, std::fmin(1.0f, n));
+}
+
+inline constexpr float kSimplex2Scale = 98.0f; // unit-gradient kernels peak just above 1 / 99
+
+// Simplex noise in [-1,1]: sums radial kernels of the 3 (2D) or 4 (3D) corners of the
+// simplex holding the point, so it has no axis-aligned cell seams at all.
+inline float simplex_noise2(float x, float y, uint32_t seed) {
+    constexpr float F2 = 0.36602540f; // (sqrt(3) - 1) / 2
+    constexpr float G2 = 0.21132487f; // (3 - sqrt(3)) / 6
+    const float s = (x + y) * F2;
+    const int i = int(std::floor(x + s));
+    const int j = int(std::floor(y + s));
+    const float t = float(i + j) * G2;
+    const float x0 = x - (float(i) - t);
+    const float y0 = y - (float(j) - t);
+    const int i1 = x0 > y0 ? 1 : 0;
+    const int j1 = 1 - i1;
+    const float x1 = x0 - float(i1) + G2, y1 = y0 - float(j1) + G2;
+    const float x2 = x0 - 1.0f + 2.0f * G2, y2 = y0 - 1.0f + 2.0f * G2;
+    const uint32_t hx0 = hash_axis(i, kHashMulX), hx1 = hash_axis(i + 1, kHashMulX);
+    const uint32_t hy0 = hash_axis(j, kHashMulY), hy1 = hash_axis(j + 1, kHashMulY);
+    auto corner = [&](uint32_t h, float cx, float cy) {
+        float k = 0.5f - cx * cx - cy * cy;
+        if (k <= 0.0f) return 0.0f;
+        k *= k;
+        return k * k * grad2(h, cx, cy);
+    };
+    const float n = corner(hash_corner(seed, hx0, hy0, 0u), x0, y0) +
+                    corner(hash_corner(seed, i1 ? hx1 : hx0, j1 ? hy1 : hy0, 0u), x1, y1) +
+                    corner(hash_corner(seed, hx1, hy1, 0u), x2, y2);
+    return std::fmax(-1.0f, std::fmin(1.0f, kSimplex2Scale * n));
+}
+
+inline float simplex_noise3(Float3 p, uint32_t seed) {
+    constexpr float F3 = 1.0f / 3.0f;
+    constexpr float G3 = 1.0f / 6.0f;
+    const float s = (p.x + p.y + p.z) * F3;
+    const int i = int(std::floor(p.x + s));
+    const int j = int(std::floor(p.y + s));
+    const int k = int(std::floor(p.z + s));
+    const float t = float(i + j + k) * G3;
+    const float x0 = p.x - (float(i) - t), y0 = p.y - (float(j) - t), z0 = p.z - (float(k) - t);
+    // Second and third corners walk the axes in decreasing order of the offsets.
+    int i1, j1, k1, i2, j2, k2;
+    if (x0 >= y0) {
+        if (y0 >= z0)      { i1 = 1; j1 = 0; k1 = 0; i2 = 1; j2 = 1; k2 = 0; }
+        else if (x0 >= z0) { i1 = 1; j1 = 0; k1 = 0; i2 = 1; j2 = 0; k2 = 1; }
+        else               { i1 = 0; j1 = 0; k1 = 1; i2 = 1; j2 = 0; k2 = 1; }
+    } else {
+        if (y0 < z0)       { i1 = 0; j1 = 0; k1 = 1; i2 = 0; j2 = 1; k2 = 1; }
+        else if (x0 < z0)  { i1 = 0; j1 = 1; k1 = 0; i2 = 0; j2 = 1; k2 = 1; }
+        else               { i1 = 0; j1 = 1; k1 = 0; i2 = 1; j2 = 1; k2 = 0; }
+    }
+    const uint32_t hx[2] = {hash_axis(i, kHashMulX), hash_axis(i + 1, kHashMulX)};
+    const uint32_t hy[2] = {hash_axis(j, kHashMulY), hash_axis(j + 1, kHashMulY)};
+    const uint32_t hz[2] = {hash_axis(k, kHashMulZ), hash_axis(k + 1, kHashMulZ)};
+    auto corner = [&](int a, int b, int c, float cx, float cy, float cz) {
+        float w = 0.6f - cx * cx - cy * cy - cz * cz;
+        if (w <= 0.0f) return 0.0f;
+        w *= w;
+        return w * w * grad3(hash_corner(seed, hx[a], hy[b], hz[c]), cx, cy, cz);
+    };
+    const float n = corner(0, 0, 0, x0, y0, z0) +
+                    corner(i1, j1, k1, x0 - i1 + G3, y0 - j1 + G3, z0 - k1 + G3) +
+                    corner(i2, j2, k2, x0 - i2 + 2.0f * G3, y0 - j2 + 2.0f * G3, z0 - k2 + 2.0f * G3) +
+                    corner(1, 1, 1, x0 - 1.0f + 3.0f * G3, y0 - 1.0f + 3.0f * G3, z0 - 1.0f + 3.0f * G3);
+    return std::fmax(-1.0f, std::fmin(1.0f, 32.0f * n));
+}
+
+// Noise family behind an fbm. Value is the original lattice-value noise.
+enum class NoiseBasis : uint8_t { Value = 0, Gradient = 1, Simplex = 2 };
+inline constexpr int kNoiseBasisCount = 3;
+
+inline const char* noise_basis_name(NoiseBasis b) {
+    switch (b) {
+        case NoiseBasis::Gradient: return "gradient";
+        case NoiseBasis::Simplex: return "simplex";
+        default: return "value";
+    }
+}
+
+inline bool parse_noise_basis(std::string_view s, NoiseBasis& out) {
+    if (s == "value") { out = NoiseBasis::Value; return true; }
+    if (s == "gradient" || s == "perlin") { out = NoiseBasis::Gradient; return true; }
+    if (s == "simplex") { out = NoiseBasis::Simplex; return true; }
+    return false;
+}
+
+// Upper bound of |d noise / dx| (and dy) of the 2D basis, per lattice unit. Conservative
+// bounds from the kernels, used to pad terrain height ranges between samples:
+//  value:    smoothstep slope 1.5 times a corner difference of at most 2;
+//  gradient: fade slope 1.875 times a corner difference of at most 1 + sqrt(2), plus the
+//            unit gradient itself, times the sqrt(2) output scale;
+//  simplex:  3 corners of at most max (0.5 - r^2)^3 (0.5 + 7 r^2) = 0.0787 each, times
+//            the output scale.
+inline double noise2_slope_bound(NoiseBasis b) {
+    switch (b) {
+        case NoiseBasis::Gradient: return 1.41421356 * (1.875 * 2.41421357 + 1.0);
+        case NoiseBasis::Simplex: return 3.0 * 0.0787 * kSimplex2Scale;
+        default: return 3.0;
+    }
+}
+
+template <NoiseBasis B>
+inline float noise2(float x, float y, uint32_t seed) {
+    if constexpr (B == NoiseBasis::Gradient) return gradient_noise2(x, y, seed);
+    else if constexpr (B == NoiseBasis::Simplex) return simplex_noise2(x, y, seed);
+    else return value_noise_bilinear(x, y, seed);
+}
+
+template <NoiseBasis B>
+inline float noise3(Float3 p, uint32_t seed) {
+    if constexpr (B == NoiseBasis::Gradient) return gradient_noise3(p, seed);
+    else if constexpr (B == NoiseBasis::Simplex) return simplex_noise3(p, seed);
+    else return value_noise_trilinear(p, seed);
+}
+
 // Fractional Brownian motion (FBM) with N octaves
 inline float fbm(Float3 p, int octaves, float lacunarity, float gain, uint32_t seed) {
     float amp = 0.5f, freq = 1.0f, sum = 0.0f, norm = 0.0f;
@@ -68,5 +261,146 @@ inline float fbm(Float3 p, int octaves, float lacunarity, float gain, uint32_t s
     return (norm > 0.0f) ? sum / norm : 0.0f;
 }
 
-} // namespace wf
+namespace detail {
+
+// Octaves accumulate in the same order as fbm(), so the value basis matches it bit for bit.
+template <NoiseBasis B, int... I>
+inline float fbm3_unrolled(Float3 p, float lacunarity, float gain, uint32_t seed, std::integer_sequence<int, I...>) {
+    float amp = 0.5f, freq = 1.0f, sum = 0.0f, norm = 0.0f;
+    ((sum += amp * noise3<B>({p.x * freq, p.y * freq, p.z * freq}, seed + I * 1013u),
+      norm += amp, freq *= lacunarity, amp *= gain), ...);
+    return (norm > 0.0f) ? sum / norm : 0.0f;
+}
+
+template <NoiseBasis B, int... I>
+inline float fbm2_unrolled(float x, float y, float lacunarity, float gain, uint32_t seed, std::integer_sequence<int, I...>) {
+    float amp = 0.5f, freq = 1.0f, sum = 0.0f, norm = 0.0f;
+    ((sum += amp * noise2<B>(x * freq, y * freq, seed + I * 1013u), norm += amp, freq *= lacunarity, amp *= gain), ...);
+    return (norm > 0.0f) ? sum / norm : 0.0f;
+}
 
+} // namespace detail
+
+// fbm with the octave count fixed at compile time: the loop unrolls and each octave's
+// seed and scale fold into constants.
+template <int Octaves, NoiseBasis B = NoiseBasis::Value>
+inline float fbm(Float3 p, float lacunarity, float gain, uint32_t seed) {
+    return detail::fbm3_unrolled<B>(p, lacunarity, gain, seed, std::make_integer_sequence<int, Octaves>{});
+}
+
+// floor for |x| < 2^31 without a libm call, so loops using it can vectorize.
+inline int floor_to_int(float x) {
+    const int i = int(x);
+    return i - (x < float(i) ? 1 : 0);
+}
+
+// One octave of value noise over n points in structure-of-arrays form, accumulated into
+// out: branch-free, so optimizing builds vectorize it (hashes and lerps lane by lane).
+inline void value_noise_octave_batch(const float* __restrict xs, const float* __restrict ys, const float* __restrict zs,
+                                     std::size_t n, float freq, float amp, uint32_t seed, float* __restrict out) {
+    for (std::size_t i = 0; i < n; ++i) {
+        const float x = xs[i] * freq, y = ys[i] * freq, z = zs[i] * freq;
+        const int xi = floor_to_int(x), yi = floor_to_int(y), zi = floor_to_int(z);
+        const float tx = smoothstep(x - xi), ty = smoothstep(y - yi), tz = smoothstep(z - zi);
+        const uint32_t hx0 = hash_axis(xi, kHashMulX), hx1 = hash_axis(xi + 1, kHashMulX);
+        const uint32_t hy0 = hash_axis(yi, kHashMulY), hy1 = hash_axis(yi + 1, kHashMulY);
+        const uint32_t hz0 = hash_axis(zi, kHashMulZ), hz1 = hash_axis(zi + 1, kHashMulZ);
+        const float x00 = lerp(lattice_value(hash_corner(seed, hx0, hy0, hz0)), lattice_value(hash_corner(seed, hx1, hy0, hz0)), tx);
+        const float x10 = lerp(lattice_value(hash_corner(seed, hx0, hy1, hz0)), lattice_value(hash_corner(seed, hx1, hy1, hz0)), tx);
+        const float x01 = lerp(lattice_value(hash_corner(seed, hx0, hy0, hz1)), lattice_value(hash_corner(seed, hx1, hy0, hz1)), tx);
+        const float x11 = lerp(lattice_value(hash_corner(seed, hx0, hy1, hz1)), lattice_value(hash_corner(seed, hx1, hy1, hz1)), tx);
+        out[i] += amp * lerp(lerp(x00, x10, ty), lerp(x01, x11, ty), tz);
+    }
+}
+
+// Value-noise fbm<Octaves> over n points given as coordinate arrays, octave by octave.
+// out[i] equals fbm<Octaves>({xs[i], ys[i], zs[i]}, ...) bit for bit.
+template <int Octaves>
+inline void fbm_batch(const float* xs, const float* ys, const float* zs, std::size_t n, float lacunarity, float gain,
+                      uint32_t seed, float* out) {
+    for (std::size_t i = 0; i < n; ++i) out[i] = 0.0f;
+    float amp = 0.5f, freq = 1.0f, norm = 0.0f;
+    for (int o = 0; o < Octaves; ++o) {
+        value_noise_octave_batch(xs, ys, zs, n, freq, amp, seed + o * 1013u, out);
+        norm += amp;
+        freq *= lacunarity;
+        amp *= gain;
+    }
+    if (norm > 0.0f) {
+        for (std::size_t i = 0; i < n; ++i) out[i] /= norm;
+    }
+}
+
+// 2D fbm over (x, y); for the value basis equal to fbm({x, y, 0}, ...).
+template <int Octaves, NoiseBasis B = NoiseBasis::Value>
+inline float fbm2(float x, float y, float lacunarity, float gain, uint32_t seed) {
+    return detail::fbm2_unrolled<B>(x, y, lacunarity, gain, seed, std::make_integer_sequence<int, Octaves>{});
+}
+
+template <NoiseBasis B>
+inline float fbm2_loop(float x, float y, int octaves, float lacunarity, float gain, uint32_t seed) {
+    float amp = 0.5f, freq = 1.0f, sum = 0.0f, norm = 0.0f;
+    for (int i = 0; i < octaves; ++i) {
+        sum += amp * noise2<B>(x * freq, y * freq, seed + i * 1013u);
+        norm += amp;
+        freq *= lacunarity;
+        amp *= gain;
+    }
+    return (norm > 0.0f) ? sum / norm : 0.0f;
+}
+
+// Runtime selection of an unrolled fbm2: octave counts up to kMaxUnrolledOctaves map to
+// their instantiation, anything above to the loop. Pick once per batch, not per sample.
+inline constexpr int kMaxUnrolledOctaves = 8;
+using Fbm2Fn = float (*)(float x, float y, int octaves, float lacunarity, float gain, uint32_t seed);
+
+namespace detail {
+
+template <NoiseBasis B, int Octaves>
+float fbm2_entry(float x, float y, int, float lacunarity, float gain, uint32_t seed) {
+    return fbm2<Octaves, B>(x, y, lacunarity, gain, seed);
+}
+
+template <NoiseBasis B, int... I>
+constexpr std::array<Fbm2Fn, kMaxUnrolledOctaves + 1> fbm2_table(std::integer_sequence<int, I...>) {
+    return {{&fbm2_entry<B, I>...}};
+}
+
+inline constexpr std::array<std::array<Fbm2Fn, kMaxUnrolledOctaves + 1>, kNoiseBasisCount> kFbm2Table = {{
+    fbm2_table<NoiseBasis::Value>(std::make_integer_sequence<int, kMaxUnrolledOctaves + 1>{}),
+    fbm2_table<NoiseBasis::Gradient>(std::make_integer_sequence<int, kMaxUnrolledOctaves + 1>{}),
+    fbm2_table<NoiseBasis::Simplex>(std::make_integer_sequence<int, kMaxUnrolledOctaves + 1>{}),
+}};
+
+} // namespace detail
+
+inline Fbm2Fn select_fbm2(NoiseBasis basis, int octaves) {
+    const int b = static_cast<int>(basis) < kNoiseBasisCount ? static_cast<int>(basis) : 0;
+    if (octaves > kMaxUnrolledOctaves) {
+        constexpr Fbm2Fn loops[kNoiseBasisCount] = {&fbm2_loop<NoiseBasis::Value>, &fbm2_loop<NoiseBasis::Gradient>,
+                                                    &fbm2_loop<NoiseBasis::Simplex>};
+        return loops[b];
+    }
+    return detail::kFbm2Table[b][octaves < 0 ? 0 : octaves];
+}
+
+// Domain warp: offsets (x, y) by up to `strength` lattice units along two decorrelated
+// 2-octave gradient fbms, bending straight ridges into folds.
+inline constexpr uint32_t kWarpSeedX = 0x68E31DA4u;
+inline constexpr uint32_t kWarpSeedY = 0xB5297A4Du;
+
+inline void domain_warp2(float& x, float& y, float strength, uint32_t seed) {
+    const float wx = fbm2<2, NoiseBasis::Gradient>(x, y, 2.0f, 0.5f, seed ^ kWarpSeedX);
+    const float wy = fbm2<2, NoiseBasis::Gradient>(x + 5.2f, y + 1.3f, 2.0f, 0.5f, seed ^ kWarpSeedY);
+    x += strength * wx;
+    y += strength * wy;
+}
+
+// Factor by which domain_warp2 can stretch distances (sum of |dx| and |dy|): each offset
+// moves at most strength * its fbm slope per unit of either input.
+inline double domain_warp2_stretch(float strength) {
+    const double fbm_slope = (0.5 * 1.0 + 0.25 * 2.0) / 0.75 * noise2_slope_bound(NoiseBasis::Gradient);
+    return 1.0 + 2.0 * std::fabs(static_cast<double>(strength)) * fbm_slope;
+}
+
+} // namespace wf
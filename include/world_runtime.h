@@ -41,11 +41,17 @@ struct StreamStatus {
     double last_mesh_ms = 0.0;
     int last_meshed_chunks = 0;
     bool loader_busy = false;
+    // Edit to visible: from apply_voxel_edit until the renderer takes the edited chunk's mesh.
+    double edit_latency_ms = 0.0;
+    double edit_latency_avg_ms = 0.0;   // smoothed
+    double edit_latency_peak_ms = 0.0;  // largest since start
+    int edit_latency_frames = 0;        // updates between the edit and the upload
+    std::uint64_t edit_latency_samples = 0;
 };
 
 struct ChunkRenderable {
     FaceChunkKey key{};
-    wf::Float3 center{0.0f, 0.0f, 0.0f};
+    wf::Double3 center{0.0, 0.0, 0.0};
     float radius = 0.0f;
     std::uint64_t mesh_handle = 0;
 };
@@ -71,10 +77,11 @@ inline bool operator!=(const AllowRegion& a, const AllowRegion& b) {
 
 struct MeshUpload {
     FaceChunkKey key{};
-    wf::Mesh mesh{};
-    float center[3] = {0.0f, 0.0f, 0.0f};
+    wf::Mesh mesh{};               // vertices relative to center
+    double center[3] = {0.0, 0.0, 0.0};
     float radius = 0.0f;
     uint64_t job_generation = 0;
+    uint64_t residency_ticket = 0;
 };
 
 struct WorldRenderSnapshot {
@@ -149,7 +156,7 @@ public:
     void queue_edit(EditCommand edit);
     void clear_pending_edits();
     void consume_mesh_transfer_queues(std::size_t uploads_processed, std::size_t releases_processed);
-    void sync_camera_state(const wf::Float3& position, float yaw_rad, float pitch_rad, bool walk_mode);
+    void sync_camera_state(const wf::Double3& position, float yaw_rad, float pitch_rad, bool walk_mode);
     void queue_chunk_remesh(const FaceChunkKey& key);
     bool apply_voxel_edit(const VoxelHit& target, uint16_t new_material, int brush_dim);
     bool process_pending_remeshes(std::size_t max_count = 0);
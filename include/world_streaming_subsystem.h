@@ -1,16 +1,22 @@
 #pragma once
 
+#include <atomic>
 #include <chrono>
 #include <cstdint>
 #include <deque>
 #include <functional>
 #include <mutex>
 #include <optional>
+#include <span>
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
 #include "chunk_streaming_manager.h"
+#include "height_tile_cache.h"
+#include "mesh_cache.h"
+#include "terrain_pyramid.h"
 
 namespace wf {
 
@@ -21,6 +27,45 @@ public:
     using MeshResult = ChunkStreamingManager::MeshResult;
     using LoadRequest = ChunkStreamingManager::LoadRequest;
 
+    // One chunk of a ring request. Rings continue across cube edges and corners onto the
+    // neighboring faces' grids; (di, dj) is the request-face tile the chunk was reached from.
+    struct RingTile {
+        FaceChunkKey key{};
+        int di = 0;
+        int dj = 0;
+    };
+    // Nearest-first (ties toward fwd_s/fwd_t): the request-face tiles that face owns any part
+    // of, plus the neighbor-face tiles covering whatever lies past its edges.
+    static void collect_ring_tiles(const PlanetConfig& cfg,
+                                   int face,
+                                   std::int64_t center_i,
+                                   std::int64_t center_j,
+                                   std::int64_t center_k,
+                                   int ring_radius,
+                                   int k_down,
+                                   int k_up,
+                                   float fwd_s,
+                                   float fwd_t,
+                                   std::vector<RingTile>& out);
+    // Same over the given shells (ascending k) instead of a window around center_k.
+    static void collect_ring_tiles(const PlanetConfig& cfg,
+                                   int face,
+                                   std::int64_t center_i,
+                                   std::int64_t center_j,
+                                   int ring_radius,
+                                   std::span<const std::int64_t> shells,
+                                   float fwd_s,
+                                   float fwd_t,
+                                   std::vector<RingTile>& out);
+
+    // Ground streamed under a column's lowest surface: the water band (5 m) and the cave
+    // roofs seen through it.
+    static constexpr double kSurfaceBandMarginM = 8.0;
+    // Shells a ring around center_k may stream, ascending: the k_down/k_up window plus every
+    // shell the terrain can cross anywhere. Each column streams only some of them.
+    static void ring_shells(const PlanetConfig& cfg, std::int64_t center_k, int k_down, int k_up,
+                            std::vector<std::int64_t>& out);
+
     struct NeighborChunks {
         std::optional<Chunk64> neg_x;
         std::optional<Chunk64> pos_x;
@@ -28,6 +73,7 @@ public:
         std::optional<Chunk64> pos_y;
         std::optional<Chunk64> neg_z;
         std::optional<Chunk64> pos_z;
+        ChunkEdgeCells edges;  // from the edge and corner neighbors, for AO
         const Chunk64* nx_ptr() const { return neg_x ? &*neg_x : nullptr; }
         const Chunk64* px_ptr() const { return pos_x ? &*pos_x : nullptr; }
         const Chunk64* ny_ptr() const { return neg_y ? &*neg_y : nullptr; }
@@ -52,9 +98,36 @@ public:
     void start();
     void stop();
     void wait_for_pending_saves();
+    void restart_workers() { manager_.restart_workers(); }
+    void stop_workers() { manager_.stop_workers(); }
+    void invalidate_generated() { manager_.invalidate_generated(); }
+    void set_rebase_stale_deltas(bool enabled) { manager_.set_rebase_stale_deltas(enabled); }
+    void set_autosave_interval(double seconds) { manager_.set_autosave_interval(seconds); }
+    void tick_autosave() { manager_.tick_autosave(); }
+    // Takes effect at the next start() or restart_workers().
+    void set_class_threads(std::size_t edit_threads, std::size_t far_threads) {
+        manager_.set_class_threads(edit_threads, far_threads);
+    }
+    void set_io_threads(std::size_t threads, int nice) { manager_.set_io_threads(threads, nice); }
+    template <typename Fn>
+    void parallel_for(StreamingClass cls, std::size_t count, Fn&& fn) {
+        manager_.parallel_for(cls, count, std::forward<Fn>(fn));
+    }
+    StreamingService::ClassStats class_stats(StreamingClass cls) const { return manager_.class_stats(cls); }
 
     ChunkStreamingManager& manager() { return manager_; }
     const ChunkStreamingManager& manager() const { return manager_; }
+    ChunkResidencyTable& residency() { return manager_.residency(); }
+    const ChunkResidencyTable& residency() const { return manager_.residency(); }
+    MeshCache::Stats mesh_cache_stats() const { return mesh_cache_.stats(); }
+    HeightTileCache::Stats height_tile_stats() const { return height_tiles_.stats(); }
+    // Conservative terrain height ranges; persisted under the region root between runs.
+    TerrainHeightPyramid& terrain_bounds() { return terrain_bounds_; }
+    TerrainHeightPyramid::Stats terrain_bounds_stats() const { return terrain_bounds_.stats(); }
+    // Chunks generated as all air from the bounds alone, without reading terrain heights.
+    uint64_t bounds_air_chunks() const { return bounds_air_chunks_.load(std::memory_order_relaxed); }
+    // Window shells ring jobs skipped because no terrain or delta reaches them.
+    uint64_t band_skipped_chunks() const { return band_skipped_chunks_.load(std::memory_order_relaxed); }
 
     uint64_t enqueue_request(LoadRequest req);
     bool should_abort(uint64_t job_gen) const;
@@ -91,6 +164,13 @@ public:
     void queue_remesh(const FaceChunkKey& key);
     std::deque<FaceChunkKey> take_remesh_batch(std::size_t max_count);
 
+    // Voxels of `key` (linear indices) whose material changed. An edit worker relights them
+    // incrementally, then queues remeshes for the chunks whose light or seam faces changed.
+    void queue_light_edit(const FaceChunkKey& key, std::vector<uint32_t> voxels);
+    // Starts a light task for the queued edits unless one is already queued or running.
+    void dispatch_light_edits();
+    bool light_task_active() const { return light_task_active_.load(std::memory_order_acquire); }
+
     std::optional<Chunk64> find_chunk_copy(const FaceChunkKey& key) const;
     void store_chunk(const FaceChunkKey& key, const Chunk64& chunk);
 
@@ -107,6 +187,7 @@ public:
                           const Chunk64* py,
                           const Chunk64* nz,
                           const Chunk64* pz,
+                          const ChunkEdgeCells* edges,
                           MeshResult& out) const;
 
     bool build_chunk_mesh(const FaceChunkKey& key,
@@ -130,8 +211,7 @@ public:
     template <typename ChunkFn, typename DeltaFn>
     bool modify_chunk_and_delta(const FaceChunkKey& key,
                                 ChunkFn&& chunk_fn,
-                                DeltaFn&& delta_fn,
-                                std::vector<FaceChunkKey>& neighbors_out) {
+                                DeltaFn&& delta_fn) {
         bool updated = manager_.update_chunk(key, [&](Chunk64& chunk) {
             chunk_fn(chunk);
         });
@@ -140,11 +220,6 @@ public:
         modify_chunk_delta(key, [&](ChunkDelta& delta) {
             delta_fn(delta);
         });
-
-        neighbors_out.clear();
-        manager_.visit_neighbors(key, [&](const FaceChunkKey& neighbor_key, const Chunk64* chunk_ptr) {
-            if (chunk_ptr) neighbors_out.push_back(neighbor_key);
-        });
         return true;
     }
 
@@ -182,12 +257,23 @@ public:
     void set_face_keep_timer_s(float value) { face_keep_timer_s_ = value; }
 
 private:
+    struct LightEdit {
+        FaceChunkKey key{};
+        std::vector<uint32_t> voxels;
+    };
+
     void build_ring_job(const LoadRequest& request);
-    void generate_base_chunk(const FaceChunkKey& key,
-                             const Float3& right,
-                             const Float3& up,
-                             const Float3& forward,
-                             Chunk64& chunk);
+    // Shells a column streams without edits: its terrain band plus one shell of headroom.
+    void column_shells(const FaceChunkKey& key, std::int64_t& k_lo, std::int64_t& k_hi) const;
+    // Keeps the shells of each column that its terrain bounds can cross, and the shells of
+    // possible deltas with one more shell each way, so digging down or building up finds
+    // its neighbor streamed. band_top gets each column's column_shells top (k = 0 keys).
+    // Returns how many shells of the k_down/k_up window were dropped.
+    std::size_t select_ring_shells(std::int64_t window_lo,
+                                   std::int64_t window_hi,
+                                   std::vector<RingTile>& tiles,
+                                   std::unordered_map<FaceChunkKey, std::int64_t, FaceChunkKeyHash>& band_top);
+    void run_light_edits();
     bool build_chunk_mesh_result(const FaceChunkKey& key,
                                  const Chunk64& chunk,
                                  const Chunk64* nx,
@@ -196,15 +282,24 @@ private:
                                  const Chunk64* py,
                                  const Chunk64* nz,
                                  const Chunk64* pz,
+                                 const ChunkEdgeCells* edges,
                                  MeshResult& out) const;
 
     ChunkStreamingManager manager_;
+    mutable MeshCache mesh_cache_;
+    HeightTileCache height_tiles_;
+    mutable TerrainHeightPyramid terrain_bounds_;
+    std::string terrain_bounds_path_;
+    std::atomic<uint64_t> bounds_air_chunks_{0};
+    std::atomic<uint64_t> band_skipped_chunks_{0};
+    std::mutex light_mutex_;
+    std::vector<LightEdit> light_edits_;
+    std::atomic<bool> light_task_active_{false};
     float surface_push_m_ = 0.0f;
     bool debug_chunk_keys_ = false;
     bool profile_enabled_ = false;
     std::function<void(const std::string&)> profile_sink_;
     std::chrono::steady_clock::time_point profile_start_tp_{};
-    std::size_t worker_count_hint_ = 0;
     int stream_face_ = 0;
     bool stream_face_ready_ = false;
     uint64_t pending_request_gen_ = 0;
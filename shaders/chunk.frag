@@ -1,23 +1,33 @@
 #version 450
 layout(location=0) in vec3 vNormal;
 layout(location=1) flat in uint vMat;
+layout(location=2) in float vOcclusion;
+layout(location=3) in vec2 vLight;
 layout(location=0) out vec4 outColor;
 
-vec3 matColor(uint m) {
-  // Basic palette: rock, dirt, water, lava
-  if (m == 1u) return vec3(0.6, 0.6, 0.6);     // rock
-  if (m == 2u) return vec3(0.47, 0.28, 0.09);   // dirt
-  if (m == 3u) return vec3(0.1, 0.4, 0.9);      // water
-  if (m == 4u) return vec3(0.9, 0.3, 0.1);      // lava
-  return vec3(0.82, 0.75, 0.66);                // default
-}
+// Material palette indexed by material id (GpuMaterial in material_table.h).
+struct Material {
+  vec4 color;
+  float emissive;
+  uint flags;
+  uint pad0;
+  uint pad1;
+};
+layout(std430, set=0, binding=0) readonly buffer Materials { Material materials[]; };
 
 void main() {
   vec3 N = normalize(vNormal);
   vec3 L = normalize(vec3(0.5, 0.8, 0.2));
   float diff = max(dot(N, L), 0.0);
-  float ao = 0.2; // simple ambient
-  vec3 base = matColor(vMat);
-  vec3 col = base * (ao + (1.0 - ao) * diff);
-  outColor = vec4(col, 1.0);
+  float ambient = 0.2;
+  // Ids past the table fall back to entry 0.
+  Material m = materials[vMat < uint(materials.length()) ? vMat : 0u];
+  vec3 base = m.color.rgb;
+  // The sun only reaches what the sky light reaches; block light (lava) adds a warm tint.
+  vec3 sun = vec3((ambient + (1.0 - ambient) * diff) * vLight.x);
+  vec3 block = vec3(1.0, 0.78, 0.55) * vLight.y;
+  vec3 col = base * max(sun + block, vec3(0.03)) * vOcclusion;
+  col = mix(col, base, m.emissive); // emissive materials glow regardless of light
+  // Alpha only matters in the blended translucent pass (opaque entries carry 1).
+  outColor = vec4(col, m.color.a);
 }
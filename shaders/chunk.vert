@@ -2,9 +2,17 @@
 layout(location=0) in vec3 inPos;
 layout(location=1) in vec3 inNormal;
 layout(location=2) in uint inMat;
+// Per-instance: chunk origin relative to the camera (firstInstance = draw record).
+layout(location=3) in vec3 inOffset;
+// Baked corner ambient occlusion, 0 (three occluders) .. 3 (open).
+layout(location=4) in uint inAo;
+// Voxel light of the cell in front of the face: sky level << 4 | block level.
+layout(location=5) in uint inLight;
 
 layout(location=0) out vec3 vNormal;
 layout(location=1) flat out uint vMat;
+layout(location=2) out float vOcclusion;
+layout(location=3) out vec2 vLight; // sky, block in [0, 1]
 
 layout(push_constant) uniform PC {
   mat4 mvp;
@@ -13,5 +21,10 @@ layout(push_constant) uniform PC {
 void main() {
   vNormal = inNormal;
   vMat = inMat;
-  gl_Position = pc.mvp * vec4(inPos, 1.0);
+  const float kAoCurve[4] = float[4](0.35, 0.55, 0.78, 1.0);
+  vOcclusion = kAoCurve[min(inAo, 3u)];
+  // Each level below 15 dims by 20 %, so light fades out over the 15-voxel falloff.
+  vLight = pow(vec2(0.8), vec2(15.0) - vec2(float(inLight >> 4u), float(inLight & 15u)));
+  // pc.mvp is camera-relative, so positions stay small at any planet radius.
+  gl_Position = pc.mvp * vec4(inPos + inOffset, 1.0);
 }
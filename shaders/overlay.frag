@@ -1,7 +1,18 @@
 #version 450
+layout(set=0, binding=0) uniform sampler2D uAtlas;
+layout(push_constant) uniform PC { vec4 shadowColor; } pc;
 layout(location=0) in vec4 vColor;
+layout(location=1) in vec2 vUV;
+layout(location=2) in float vShadow;
 layout(location=0) out vec4 outColor;
 void main(){
-  outColor = vColor;
+  float glyph = texture(uAtlas, vUV).r;
+  float shadow = 0.0;
+  if (vShadow > 0.0) {
+    vec2 texel = 1.0 / vec2(textureSize(uAtlas, 0));
+    shadow = texture(uAtlas, vUV - vec2(vShadow) * texel).r * pc.shadowColor.a;
+  }
+  float a = glyph * vColor.a;
+  vec3 rgb = mix(pc.shadowColor.rgb, vColor.rgb, glyph);
+  outColor = vec4(rgb, a + shadow * (1.0 - a));
 }
-
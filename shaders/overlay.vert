@@ -1,9 +1,14 @@
 #version 450
 layout(location=0) in vec2 inPos;      // NDC coordinates [-1,1]
-layout(location=1) in vec4 inColor;    // RGBA
+layout(location=1) in vec2 inUV;       // glyph atlas UV
+layout(location=2) in vec4 inColor;    // RGBA
+layout(location=3) in float inShadow;  // shadow offset in atlas texels (0 = none)
 layout(location=0) out vec4 vColor;
+layout(location=1) out vec2 vUV;
+layout(location=2) out float vShadow;
 void main(){
   vColor = inColor;
+  vUV = inUV;
+  vShadow = inShadow;
   gl_Position = vec4(inPos, 0.0, 1.0);
 }
-
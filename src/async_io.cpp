@@ -0,0 +1,409 @@
+#include "async_io.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <utility>
+
+#include <unistd.h>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#if defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter)
+#define WF_ASYNC_IO_URING 1
+#endif
+#endif
+
+namespace wf {
+
+struct AsyncIO::BatchState {
+    Batch batch;
+    BatchCallback done;
+    std::atomic<std::size_t> remaining{0};
+};
+
+namespace {
+
+// Loops over short transfers; stops early only at EOF or on an error.
+std::int64_t transfer_blocking(const AsyncIO::Request& req, std::size_t already = 0) {
+    if (req.op == AsyncIO::Request::Op::kSync) {
+        while (::fsync(req.fd) != 0) {
+            if (errno != EINTR) return -static_cast<std::int64_t>(errno);
+        }
+        return 0;
+    }
+    std::size_t done = already;
+    char* data = static_cast<char*>(req.data);
+    while (done < req.size) {
+        ssize_t n = req.op == AsyncIO::Request::Op::kRead
+                        ? ::pread(req.fd, data + done, req.size - done, static_cast<off_t>(req.offset + done))
+                        : ::pwrite(req.fd, data + done, req.size - done, static_cast<off_t>(req.offset + done));
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -static_cast<std::int64_t>(errno);
+        }
+        if (n == 0) break;
+        done += static_cast<std::size_t>(n);
+    }
+    return static_cast<std::int64_t>(done);
+}
+
+} // namespace
+
+#ifdef WF_ASYNC_IO_URING
+struct AsyncIO::Uring {
+    int fd = -1;
+    unsigned entries = 0;
+    void* sq_ring = MAP_FAILED;
+    std::size_t sq_ring_bytes = 0;
+    void* cq_ring = MAP_FAILED;
+    std::size_t cq_ring_bytes = 0;
+    io_uring_sqe* sqes = static_cast<io_uring_sqe*>(MAP_FAILED);
+    std::size_t sqes_bytes = 0;
+    unsigned* sq_head = nullptr;
+    unsigned* sq_tail = nullptr;
+    unsigned* sq_mask = nullptr;
+    unsigned* sq_array = nullptr;
+    unsigned* cq_head = nullptr;
+    unsigned* cq_tail = nullptr;
+    unsigned* cq_mask = nullptr;
+    io_uring_cqe* cqes = nullptr;
+
+    // Requests in flight are capped at the SQ size so the CQ (twice as large) never overflows.
+    std::mutex mutex;
+    std::condition_variable space_cv;
+    unsigned in_flight = 0;
+    std::atomic<bool> failed{false};
+    std::atomic<bool> reaper_done{false};
+    std::thread reaper;
+
+    // Marks the ring unusable after a hard io_uring_enter error; submitters move to the pool.
+    void fail(const char* what, int err) {
+        if (!failed.exchange(true)) {
+            std::cerr << "[io] " << what << " failed: " << std::strerror(err)
+                      << "; falling back to the pread/pwrite thread pool\n";
+        }
+        space_cv.notify_all();
+    }
+
+    ~Uring() {
+        if (sqes != MAP_FAILED) ::munmap(sqes, sqes_bytes);
+        if (cq_ring != MAP_FAILED && cq_ring != sq_ring) ::munmap(cq_ring, cq_ring_bytes);
+        if (sq_ring != MAP_FAILED) ::munmap(sq_ring, sq_ring_bytes);
+        if (fd >= 0) ::close(fd);
+    }
+};
+
+namespace {
+int uring_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+    return static_cast<int>(::syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0));
+}
+} // namespace
+
+bool AsyncIO::start_uring(unsigned queue_depth) {
+    auto ring = std::make_unique<Uring>();
+    io_uring_params params{};
+    ring->fd = static_cast<int>(::syscall(__NR_io_uring_setup, queue_depth, &params));
+    if (ring->fd < 0) return false;
+    ring->entries = params.sq_entries;
+
+    ring->sq_ring_bytes = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    ring->cq_ring_bytes = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    const bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single_mmap) {
+        ring->sq_ring_bytes = std::max(ring->sq_ring_bytes, ring->cq_ring_bytes);
+        ring->cq_ring_bytes = ring->sq_ring_bytes;
+    }
+    ring->sq_ring = ::mmap(nullptr, ring->sq_ring_bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                           ring->fd, IORING_OFF_SQ_RING);
+    if (ring->sq_ring == MAP_FAILED) return false;
+    ring->cq_ring = single_mmap
+                        ? ring->sq_ring
+                        : ::mmap(nullptr, ring->cq_ring_bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                                 ring->fd, IORING_OFF_CQ_RING);
+    if (ring->cq_ring == MAP_FAILED) return false;
+    ring->sqes_bytes = params.sq_entries * sizeof(io_uring_sqe);
+    ring->sqes = static_cast<io_uring_sqe*>(::mmap(nullptr, ring->sqes_bytes, PROT_READ | PROT_WRITE,
+                                                   MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQES));
+    if (ring->sqes == MAP_FAILED) return false;
+
+    char* sq = static_cast<char*>(ring->sq_ring);
+    char* cq = static_cast<char*>(ring->cq_ring);
+    ring->sq_head = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+    ring->sq_tail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+    ring->sq_mask = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+    ring->sq_array = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+    ring->cq_head = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+    ring->cq_tail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+    ring->cq_mask = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+    ring->cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+    uring_ = std::move(ring);
+    uring_->reaper = std::thread([this]() { uring_main(); });
+    return true;
+}
+
+bool AsyncIO::uring_submit(std::vector<Pending>& ops) {
+    Uring& ring = *uring_;
+    std::unique_lock<std::mutex> lock(ring.mutex);
+    std::vector<Pending> unsent;
+    std::size_t next = 0;
+    while (next < ops.size()) {
+        ring.space_cv.wait(lock, [&] { return ring.failed || ring.in_flight < ring.entries; });
+        if (ring.failed) break;
+        unsigned tail = *ring.sq_tail;
+        unsigned queued = 0;
+        while (next < ops.size() && ring.in_flight < ring.entries) {
+            const unsigned slot = tail & *ring.sq_mask;
+            io_uring_sqe& sqe = ring.sqes[slot];
+            std::memset(&sqe, 0, sizeof(sqe));
+            Pending* pending = new Pending(std::move(ops[next++]));
+            const Request& req = pending->state->batch[pending->index];
+            sqe.opcode = req.op == Request::Op::kRead    ? IORING_OP_READ
+                         : req.op == Request::Op::kWrite ? IORING_OP_WRITE
+                                                          : IORING_OP_FSYNC;
+            sqe.fd = req.fd;
+            sqe.off = req.offset;
+            sqe.addr = reinterpret_cast<std::uint64_t>(req.data);
+            sqe.len = static_cast<std::uint32_t>(req.size);
+            sqe.user_data = reinterpret_cast<std::uint64_t>(pending);
+            ring.sq_array[slot] = slot;
+            ++tail;
+            ++queued;
+            ++ring.in_flight;
+        }
+        __atomic_store_n(ring.sq_tail, tail, __ATOMIC_RELEASE);
+        while (queued > 0) {
+            int consumed = uring_enter(ring.fd, queued, 0, 0);
+            if (consumed < 0) {
+                if (errno == EINTR || errno == EAGAIN || errno == EBUSY) continue;
+                ring.fail("io_uring_enter", errno);
+                break;
+            }
+            queued -= std::min<unsigned>(queued, static_cast<unsigned>(consumed));
+        }
+        if (ring.failed) {
+            // Only submitters (under the mutex) make the kernel consume SQEs, so everything
+            // past its head is still ours to take back.
+            const unsigned head = __atomic_load_n(ring.sq_head, __ATOMIC_ACQUIRE);
+            for (unsigned i = head; i != tail; ++i) {
+                Pending* pending = reinterpret_cast<Pending*>(ring.sqes[i & *ring.sq_mask].user_data);
+                unsent.push_back(std::move(*pending));
+                delete pending;
+                --ring.in_flight;
+            }
+            __atomic_store_n(ring.sq_tail, head, __ATOMIC_RELEASE);
+            break;
+        }
+    }
+    if (!ring.failed) return true;
+    for (; next < ops.size(); ++next) unsent.push_back(std::move(ops[next]));
+    ops = std::move(unsent);
+    return false;
+}
+
+void AsyncIO::uring_main() {
+    Uring& ring = *uring_;
+    for (;;) {
+        unsigned head = *ring.cq_head;
+        unsigned tail = __atomic_load_n(ring.cq_tail, __ATOMIC_ACQUIRE);
+        if (head == tail) {
+            if (ring.failed) {
+                // No more waiting in the kernel: poll the CQ until what it already took completes.
+                std::unique_lock<std::mutex> lock(ring.mutex);
+                if (ring.in_flight == 0) break;
+                lock.unlock();
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                continue;
+            }
+            if (uring_enter(ring.fd, 0, 1, IORING_ENTER_GETEVENTS) < 0 && errno != EINTR && errno != EAGAIN &&
+                errno != EBUSY) {
+                ring.fail("io_uring wait", errno);
+            }
+            continue;
+        }
+        bool quit = false;
+        unsigned reaped = 0;
+        for (; head != tail; ++head) {
+            const io_uring_cqe& cqe = ring.cqes[head & *ring.cq_mask];
+            Pending* pending = reinterpret_cast<Pending*>(cqe.user_data);
+            std::int64_t res = cqe.res;
+            __atomic_store_n(ring.cq_head, head + 1, __ATOMIC_RELEASE);
+            if (!pending) {
+                quit = true;
+                continue;
+            }
+            const Request& req = pending->state->batch[pending->index];
+            // Short transfers and kernels without IORING_OP_READ/WRITE/FSYNC finish synchronously here.
+            if (res == -EINVAL || res == -EOPNOTSUPP) {
+                res = transfer_blocking(req);
+            } else if (res > 0 && static_cast<std::size_t>(res) < req.size) {
+                res = transfer_blocking(req, static_cast<std::size_t>(res));
+            }
+            finish(*pending, res);
+            delete pending;
+            ++reaped;
+        }
+        if (reaped > 0) {
+            std::lock_guard<std::mutex> lock(ring.mutex);
+            ring.in_flight -= reaped;
+        }
+        ring.space_cv.notify_all();
+        if (quit) break;
+    }
+    ring.reaper_done = true;
+}
+#else
+struct AsyncIO::Uring {};
+
+bool AsyncIO::start_uring(unsigned) { return false; }
+bool AsyncIO::uring_submit(std::vector<Pending>&) { return false; }
+void AsyncIO::uring_main() {}
+#endif
+
+AsyncIO::AsyncIO(Backend preferred, std::size_t pool_threads, unsigned queue_depth)
+    : pool_threads_(pool_threads == 0 ? 1 : pool_threads) {
+    if (preferred == Backend::kIoUring && start_uring(queue_depth)) {
+        backend_ = Backend::kIoUring;
+        return;
+    }
+    if (preferred == Backend::kIoUring) {
+        std::cout << "[io] io_uring unavailable; using the pread/pwrite thread pool\n";
+    }
+    backend_ = Backend::kThreadPool;
+    start_pool(pool_threads_);
+}
+
+AsyncIO::~AsyncIO() {
+#ifdef WF_ASYNC_IO_URING
+    if (uring_ && uring_->reaper.joinable()) {
+        Uring& ring = *uring_;
+        // Drain, then wake the reaper with a sentinel NOP (user_data 0).
+        std::unique_lock<std::mutex> lock(ring.mutex);
+        ring.space_cv.wait(lock, [&] { return ring.in_flight == 0; });
+        bool woken = ring.reaper_done;
+        if (!woken) {
+            unsigned tail = *ring.sq_tail;
+            const unsigned slot = tail & *ring.sq_mask;
+            std::memset(&ring.sqes[slot], 0, sizeof(io_uring_sqe));
+            ring.sqes[slot].opcode = IORING_OP_NOP;
+            ring.sq_array[slot] = slot;
+            __atomic_store_n(ring.sq_tail, tail + 1, __ATOMIC_RELEASE);
+            int rc;
+            while ((rc = uring_enter(ring.fd, 1, 0, 0)) < 0 && errno == EINTR) {}
+            woken = rc >= 0 || ring.reaper_done;
+        }
+        lock.unlock();
+        if (woken) {
+            ring.reaper.join();
+        } else {
+            // A reaper parked on a dead ring cannot be woken; leave it and the ring mapped.
+            ring.reaper.detach();
+            (void)uring_.release();
+        }
+    }
+#endif
+    {
+        std::lock_guard<std::mutex> lock(pool_mutex_);
+        pool_quit_ = true;
+    }
+    pool_cv_.notify_all();
+    for (std::thread& worker : pool_workers_) {
+        if (worker.joinable()) worker.join();
+    }
+}
+
+const char* AsyncIO::backend_name() const {
+    return backend() == Backend::kIoUring ? "io_uring" : "thread-pool";
+}
+
+void AsyncIO::finish(Pending& pending, std::int64_t result) {
+    BatchState& state = *pending.state;
+    state.batch[pending.index].result = result;
+    if (state.remaining.fetch_sub(1, std::memory_order_acq_rel) == 1 && state.done) {
+        state.done(state.batch);
+    }
+}
+
+void AsyncIO::submit(Batch batch, BatchCallback done) {
+    if (batch.empty()) {
+        if (done) done(batch);
+        return;
+    }
+    auto state = std::make_shared<BatchState>();
+    state->batch = std::move(batch);
+    state->done = std::move(done);
+    state->remaining.store(state->batch.size(), std::memory_order_relaxed);
+
+    std::vector<Pending> ops;
+    ops.reserve(state->batch.size());
+    for (std::size_t i = 0; i < state->batch.size(); ++i) {
+        ops.push_back(Pending{state, i});
+    }
+    if (backend() == Backend::kIoUring) {
+        if (uring_submit(ops)) return;
+        fall_back_to_pool();
+    }
+    {
+        std::lock_guard<std::mutex> lock(pool_mutex_);
+        for (Pending& op : ops) pool_queue_.push_back(std::move(op));
+    }
+    pool_cv_.notify_all();
+}
+
+std::future<AsyncIO::Batch> AsyncIO::submit(Batch batch) {
+    auto promise = std::make_shared<std::promise<Batch>>();
+    std::future<Batch> future = promise->get_future();
+    submit(std::move(batch), [promise](Batch& done) { promise->set_value(std::move(done)); });
+    return future;
+}
+
+bool AsyncIO::run(Batch& batch) {
+    batch = submit(std::move(batch)).get();
+    for (const Request& req : batch) {
+        if (!req.complete()) return false;
+    }
+    return true;
+}
+
+void AsyncIO::fall_back_to_pool() {
+    std::lock_guard<std::mutex> lock(pool_mutex_);
+    if (pool_workers_.empty()) start_pool(pool_threads_);
+    backend_.store(Backend::kThreadPool, std::memory_order_release);
+}
+
+void AsyncIO::start_pool(std::size_t threads) {
+    for (std::size_t i = 0; i < threads; ++i) {
+        pool_workers_.emplace_back([this]() { pool_main(); });
+    }
+}
+
+void AsyncIO::pool_main() {
+    for (;;) {
+        Pending pending;
+        {
+            std::unique_lock<std::mutex> lock(pool_mutex_);
+            pool_cv_.wait(lock, [&] { return pool_quit_ || !pool_queue_.empty(); });
+            if (pool_queue_.empty()) return;
+            pending = std::move(pool_queue_.front());
+            pool_queue_.pop_front();
+        }
+        finish(pending, transfer_blocking(pending.state->batch[pending.index]));
+    }
+}
+
+AsyncIO& AsyncIO::shared() {
+    static AsyncIO engine([] {
+        const char* env = std::getenv("WF_IO_BACKEND");
+        return (env && std::string(env) == "pool") ? Backend::kThreadPool : Backend::kIoUring;
+    }());
+    return engine;
+}
+
+} // namespace wf
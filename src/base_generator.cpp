@@ -0,0 +1,104 @@
+#include "base_generator.h"
+
+#include <array>
+#include <vector>
+
+#include "wf_math.h"
+#include "wf_noise.h"
+
+namespace wf {
+
+void generate_base_chunk(const PlanetConfig& cfg, const FaceChunkKey& key, const HeightTile& heights,
+                         Chunk64& chunk, uint64_t* open_sky) {
+    const int N = Chunk64::N;
+    const double voxel_m = cfg.voxel_size_m;
+    const double chunk_m = static_cast<double>(N) * voxel_m;
+    const double r_origin = static_cast<double>(key.k) * chunk_m;
+
+    chunk.fill_all_air();
+
+    std::array<double, Chunk64::N> radial_m{};
+    for (int z = 0; z < N; ++z) {
+        radial_m[z] = r_origin + (z + 0.5) * voxel_m;
+    }
+
+    if (open_sky) {
+        // The voxel above the chunk is air or water wherever the surface lies below its center.
+        const double r_above = r_origin + chunk_m + 0.5 * voxel_m;
+        for (int y = 0; y < N; ++y) {
+            uint64_t bits = 0;
+            for (int x = 0; x < N; ++x) {
+                if (cfg.radius_m + heights.at(x, y) < r_above) bits |= 1ull << x;
+            }
+            open_sky[y] = bits;
+        }
+    }
+    // Entirely above the highest column: nothing but air.
+    if (radial_m[0] > cfg.radius_m + heights.max_m) return;
+
+    Float3 right, up, forward;
+    face_basis(key.face, right, up, forward);
+    const uint32_t cave_seed = cfg.seed + 777u;
+
+    constexpr double kWaterBandDepthM = 5.0;
+    constexpr double kDirtDepthM = 2.0;
+    constexpr float kCaveScale = 0.05f;
+
+    // Cave noise runs batched per row of columns, over the voxels deep enough to carve;
+    // the row is written afterwards in the same order as voxel-by-voxel generation.
+    std::array<uint16_t, Chunk64::N * Chunk64::N> row{};
+    std::vector<float> cave_x, cave_y, cave_z, cave_values;
+    std::vector<uint32_t> cave_voxels;
+
+    for (int y = 0; y < N; ++y) {
+        cave_x.clear();
+        cave_y.clear();
+        cave_z.clear();
+        cave_voxels.clear();
+        for (int x = 0; x < N; ++x) {
+            const double surface_r = cfg.radius_m + heights.at(x, y);
+            const Float3 dir = column_direction(cfg, right, up, forward, key.i, key.j, x, y);
+            const float dir_x = dir.x;
+            const float dir_y = dir.y;
+            const float dir_z = dir.z;
+            for (int z = 0; z < N; ++z) {
+                double r0 = radial_m[z];
+                uint16_t mat = MAT_AIR;
+                if (r0 <= surface_r) {
+                    double depth = surface_r - r0;
+                    if (r0 > cfg.sea_level_m && depth < kWaterBandDepthM) {
+                        mat = MAT_WATER;
+                    } else {
+                        if (depth > kCaveMinDepthM) {
+                            float radius_f = static_cast<float>(r0);
+                            float px = dir_x * radius_f;
+                            float py = dir_y * radius_f;
+                            float pz = dir_z * radius_f;
+                            cave_x.push_back(px * kCaveScale);
+                            cave_y.push_back(py * kCaveScale);
+                            cave_z.push_back(pz * kCaveScale);
+                            cave_voxels.push_back(static_cast<uint32_t>(x * N + z));
+                        }
+                        mat = depth < kDirtDepthM ? MAT_DIRT : MAT_ROCK;
+                    }
+                }
+                row[static_cast<std::size_t>(x * N + z)] = mat;
+            }
+        }
+        if (!cave_voxels.empty()) {
+            cave_values.resize(cave_voxels.size());
+            fbm_batch<4>(cave_x.data(), cave_y.data(), cave_z.data(), cave_voxels.size(), 2.2f, 0.5f, cave_seed,
+                         cave_values.data());
+            for (std::size_t c = 0; c < cave_voxels.size(); ++c) {
+                if (cave_values[c] > kCaveNoiseThreshold) row[cave_voxels[c]] = MAT_AIR;
+            }
+        }
+        for (int x = 0; x < N; ++x) {
+            for (int z = 0; z < N; ++z) {
+                chunk.set_voxel(x, y, z, row[static_cast<std::size_t>(x * N + z)]);
+            }
+        }
+    }
+}
+
+} // namespace wf
@@ -29,8 +29,13 @@ inline Float3 normalize_or(const Float3& v, const Float3& fallback) {
     return (len > 1e-5f) ? (v / len) : fallback;
 }
 
-inline Float3 to_float3(const double pos[3]) {
-    return Float3{static_cast<float>(pos[0]), static_cast<float>(pos[1]), static_cast<float>(pos[2])};
+inline Double3 to_double3(const double pos[3]) {
+    return Double3{pos[0], pos[1], pos[2]};
+}
+
+// Radial direction computed in double: normalizing a float position quantizes it at planet scale.
+inline Float3 radial_dir(const double pos[3]) {
+    return to_float3(wf::normalize(to_double3(pos)));
 }
 
 inline float deg_to_rad(float deg) {
@@ -79,7 +84,7 @@ CameraControllerSettings CameraController::settings() const {
     return cfg;
 }
 
-void CameraController::sync_state(const Float3& position, float yaw_rad, float pitch_rad, bool walk_mode) {
+void CameraController::sync_state(const Double3& position, float yaw_rad, float pitch_rad, bool walk_mode) {
     cam_pos_[0] = position.x;
     cam_pos_[1] = position.y;
     cam_pos_[2] = position.z;
@@ -116,8 +121,7 @@ CameraUpdateResult CameraController::update(const CameraUpdateInput& input) {
             cam_pitch_ = std::clamp(cam_pitch_, -max_pitch, max_pitch);
         }
     } else {
-        Float3 pos = to_float3(cam_pos_);
-        Float3 updir = wf::normalize(pos);
+        Float3 updir = radial_dir(cam_pos_);
 
         auto rotate_axis = [](const Float3& v, const Float3& axis, float angle) {
             Float3 n = normalize_or(axis, Float3{0.0f, 1.0f, 0.0f});
@@ -164,13 +168,12 @@ CameraUpdateResult CameraController::update(const CameraUpdateInput& input) {
         cam_pitch_ = std::asin(std::clamp(forward.y, -1.0f, 1.0f));
     }
 
-    Float3 pos_f = to_float3(cam_pos_);
     float cy = std::cos(cam_yaw_);
     float sy = std::sin(cam_yaw_);
     float cp = std::cos(cam_pitch_);
     float sp = std::sin(cam_pitch_);
     Float3 forward = normalize_or(Float3{cp * cy, sp, cp * sy}, Float3{1.0f, 0.0f, 0.0f});
-    Float3 world_up = walk_mode_ ? wf::normalize(pos_f) : Float3{0.0f, 1.0f, 0.0f};
+    Float3 world_up = walk_mode_ ? radial_dir(cam_pos_) : Float3{0.0f, 1.0f, 0.0f};
     Float3 right = normalize_or(cross3(forward, world_up), Float3{0.0f, 0.0f, 1.0f});
 
     if (!walk_mode_) {
@@ -185,7 +188,7 @@ CameraUpdateResult CameraController::update(const CameraUpdateInput& input) {
             cam_pos_[2] += delta.z;
         }
     } else {
-        Float3 updir_norm = wf::normalize(to_float3(cam_pos_));
+        Float3 updir_norm = radial_dir(cam_pos_);
         Float3 tangent_forward = normalize_or(forward - updir_norm * dot3(forward, updir_norm), right);
         Float3 tangent_right = normalize_or(cross3(tangent_forward, updir_norm), Float3{0.0f, 1.0f, 0.0f});
         Float3 step = Float3{0.0f, 0.0f, 0.0f};
@@ -198,9 +201,11 @@ CameraUpdateResult CameraController::update(const CameraUpdateInput& input) {
         float step_len = wf::length(step);
         if (step_len > 0.0f) {
             step = wf::normalize(step);
-            double cam_radius = std::sqrt(cam_pos_[0] * cam_pos_[0] + cam_pos_[1] * cam_pos_[1] + cam_pos_[2] * cam_pos_[2]);
-            float angle = static_cast<float>((walk_speed_ * (input.sprint ? 2.0f : 1.0f) * dt) / std::max(cam_radius, 1e-6));
-            Float3 rotated = updir_norm * std::cos(angle) + step * std::sin(angle);
+            // Rotate along the great circle in double; per-frame angles are ~1e-7 rad at Earth radius.
+            Double3 pos_d = to_double3(cam_pos_);
+            double cam_radius = wf::length(pos_d);
+            double angle = (walk_speed_ * (input.sprint ? 2.0 : 1.0) * dt) / std::max(cam_radius, 1e-6);
+            Double3 rotated = wf::normalize(pos_d) * std::cos(angle) + to_double3(step) * std::sin(angle);
             rotated = wf::normalize(rotated);
             cam_pos_[0] = rotated.x * cam_radius;
             cam_pos_[1] = rotated.y * cam_radius;
@@ -239,8 +244,8 @@ void CameraController::toggle_invert_y() {
     invert_mouse_y_ = !invert_mouse_y_;
 }
 
-Float3 CameraController::position() const {
-    return to_float3(cam_pos_);
+Double3 CameraController::position() const {
+    return to_double3(cam_pos_);
 }
 
 Float3 CameraController::forward() const {
@@ -253,21 +258,20 @@ Float3 CameraController::forward() const {
 
 Float3 CameraController::up() const {
     if (walk_mode_) {
-        return wf::normalize(position());
+        return radial_dir(cam_pos_);
     }
     return Float3{0.0f, 1.0f, 0.0f};
 }
 
 CameraSnapshot CameraController::snapshot(float fov_deg, float near_plane, float far_plane) const {
     CameraSnapshot snap{};
-    Float3 pos = position();
     Float3 fwd = forward();
-    Float3 updir = walk_mode_ ? wf::normalize(pos) : Float3{0.0f, 1.0f, 0.0f};
-    Float3 center = pos + fwd;
-    snap.view = wf::look_at_rh({pos.x, pos.y, pos.z}, {center.x, center.y, center.z}, {updir.x, updir.y, updir.z});
+    Float3 updir = up();
+    // Camera-relative: the eye is the origin, world positions are offset by -position.
+    snap.view = wf::look_at_rh({0.0f, 0.0f, 0.0f}, {fwd.x, fwd.y, fwd.z}, {updir.x, updir.y, updir.z});
     float fovy = deg_to_rad(fov_deg);
     snap.projection = wf::perspective_vk(fovy, aspect_ratio_, near_plane, far_plane);
-    snap.position = pos;
+    snap.position = position();
     snap.forward = fwd;
     snap.up = updir;
     snap.fov_deg = fov_deg;
@@ -281,8 +285,8 @@ void CameraController::clamp_pitch(float max_pitch_rad) {
 }
 
 void CameraController::ground_follow() {
-    Float3 ndir = wf::normalize(position());
-    double h = terrain_height_m(planet_cfg_, ndir);
+    Double3 ndir = wf::normalize(position());
+    double h = terrain_height_m(planet_cfg_, to_float3(ndir));
     double surface_r = planet_cfg_.radius_m + h;
     if (surface_r < planet_cfg_.sea_level_m) {
         surface_r = planet_cfg_.sea_level_m;
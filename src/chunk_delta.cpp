@@ -143,4 +143,33 @@ void apply_chunk_delta(const ChunkDelta& delta, Chunk64& chunk) {
     }
 }
 
+uint32_t rebase_chunk_delta(ChunkDelta& delta, const Chunk64& new_base, const GeneratorStamp& stamp) {
+    const int N = Chunk64::N;
+    const int N2 = N * N;
+    auto base_material = [&](uint32_t i) {
+        return new_base.get_material((int)(i % N), (int)((i / N) % N), (int)(i / N2));
+    };
+
+    uint32_t removed = 0;
+    if (delta.mode == ChunkDelta::Mode::kDense) {
+        for (uint32_t i = 0; i < delta.dense_data.size(); ++i) {
+            uint16_t mat = delta.dense_data[i];
+            if (mat == ChunkDelta::kNoOverride || mat != base_material(i)) continue;
+            delta.dense_data[i] = ChunkDelta::kNoOverride;
+            ++removed;
+        }
+    } else {
+        auto keep = std::remove_if(delta.entries.begin(), delta.entries.end(), [&](const ChunkDeltaEntry& e) {
+            return e.material == base_material(e.index);
+        });
+        removed = static_cast<uint32_t>(delta.entries.end() - keep);
+        delta.entries.erase(keep, delta.entries.end());
+    }
+    delta.override_count -= std::min(delta.override_count, removed);
+    // Persist under the new stamp even when nothing was dropped
+    if (delta.base != stamp) delta.dirty = true;
+    delta.base = stamp;
+    return removed;
+}
+
 } // namespace wf
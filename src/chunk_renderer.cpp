@@ -1,13 +1,33 @@
 #include "chunk_renderer.h"
 #include "vk_utils.h"
+#include "material_table.h"
 #include "mesh.h"
 
 #include <string>
 #include <iostream>
 #include <algorithm>
+#include <cmath>
+#include <chrono>
+#include <cstring>
+#include <numeric>
 
 namespace wf {
 
+namespace {
+
+// One counting pass of an LSD radix sort over 8 bits of the depth key (stable).
+template <typename Key>
+void radix_pass(const std::vector<Key>& src, std::vector<Key>& dst, int shift) {
+    uint32_t offsets[256] = {};
+    for (const Key& k : src) offsets[(k.depth >> shift) & 0xFFu]++;
+    uint32_t sum = 0;
+    for (uint32_t& c : offsets) { uint32_t n = c; c = sum; sum += n; }
+    dst.resize(src.size());
+    for (const Key& k : src) dst[offsets[(k.depth >> shift) & 0xFFu]++] = k;
+}
+
+} // namespace
+
 void ChunkRenderer::init(VkPhysicalDevice phys, VkDevice device, VkRenderPass renderPass, VkExtent2D extent, const char* shaderDir) {
     phys_ = phys; device_ = device; render_pass_ = renderPass; extent_ = extent; shader_dir_ = shaderDir ? std::string(shaderDir) : std::string();
 
@@ -37,16 +57,22 @@ void ChunkRenderer::init(VkPhysicalDevice phys, VkDevice device, VkRenderPass re
     stages[0].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO; stages[0].stage = VK_SHADER_STAGE_VERTEX_BIT; stages[0].module = vs; stages[0].pName = "main";
     stages[1].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO; stages[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT; stages[1].module = fs; stages[1].pName = "main";
 
-    VkVertexInputBindingDescription bind{}; bind.binding = 0; bind.stride = sizeof(Vertex); bind.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
-    VkVertexInputAttributeDescription attrs[3]{};
+    // Binding 1 steps once per instance: firstInstance selects the draw record's origin offset.
+    VkVertexInputBindingDescription binds[2]{};
+    binds[0].binding = 0; binds[0].stride = sizeof(Vertex); binds[0].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+    binds[1].binding = 1; binds[1].stride = sizeof(float) * 4; binds[1].inputRate = VK_VERTEX_INPUT_RATE_INSTANCE;
+    VkVertexInputAttributeDescription attrs[6]{};
     attrs[0].location = 0; attrs[0].binding = 0; attrs[0].format = VK_FORMAT_R32G32B32_SFLOAT; attrs[0].offset = 0;
     attrs[1].location = 1; attrs[1].binding = 0; attrs[1].format = VK_FORMAT_R32G32B32_SFLOAT; attrs[1].offset = 12;
     attrs[2].location = 2; attrs[2].binding = 0; attrs[2].format = VK_FORMAT_R16_UINT;          attrs[2].offset = 24;
+    attrs[3].location = 3; attrs[3].binding = 1; attrs[3].format = VK_FORMAT_R32G32B32_SFLOAT; attrs[3].offset = 0;
+    attrs[4].location = 4; attrs[4].binding = 0; attrs[4].format = VK_FORMAT_R8_UINT;           attrs[4].offset = 26;
+    attrs[5].location = 5; attrs[5].binding = 0; attrs[5].format = VK_FORMAT_R8_UINT;           attrs[5].offset = 27;
     VkPipelineVertexInputStateCreateInfo vi{};
     vi.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-    vi.vertexBindingDescriptionCount = 1;
-    vi.pVertexBindingDescriptions = &bind;
-    vi.vertexAttributeDescriptionCount = 3;
+    vi.vertexBindingDescriptionCount = 2;
+    vi.pVertexBindingDescriptions = binds;
+    vi.vertexAttributeDescriptionCount = 6;
     vi.pVertexAttributeDescriptions = attrs;
 
     VkPipelineInputAssemblyStateCreateInfo ia{};
@@ -81,9 +107,18 @@ void ChunkRenderer::init(VkPhysicalDevice phys, VkDevice device, VkRenderPass re
     ds.depthWriteEnable = VK_TRUE;
     ds.depthCompareOp = VK_COMPARE_OP_LESS;
 
+    if (!palette_set_ && !create_palette()) {
+        vkDestroyShaderModule(device_, vs, nullptr);
+        vkDestroyShaderModule(device_, fs, nullptr);
+        std::cerr << "Failed to create the material palette. Chunk rendering disabled.\n";
+        return;
+    }
+
     VkPushConstantRange pcr{}; pcr.stageFlags = VK_SHADER_STAGE_VERTEX_BIT; pcr.offset = 0; pcr.size = sizeof(float) * 16;
     VkPipelineLayoutCreateInfo plci{};
     plci.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    plci.setLayoutCount = 1;
+    plci.pSetLayouts = &palette_set_layout_;
     plci.pushConstantRangeCount = 1;
     plci.pPushConstantRanges = &pcr;
     if (vkCreatePipelineLayout(device_, &plci, nullptr, &layout_) != VK_SUCCESS) {
@@ -108,19 +143,48 @@ void ChunkRenderer::init(VkPhysicalDevice phys, VkDevice device, VkRenderPass re
     if (vkCreateGraphicsPipelines(device_, VK_NULL_HANDLE, 1, &gpi, nullptr, &pipeline_) != VK_SUCCESS) {
         std::cerr << "Failed to create chunk graphics pipeline.\n";
         vkDestroyPipelineLayout(device_, layout_, nullptr); layout_ = VK_NULL_HANDLE;
+    } else {
+        // Translucent variant: straight alpha blending over the opaque result, depth tested but
+        // not written, both sides drawn so water surfaces stay visible from below.
+        cba.blendEnable = VK_TRUE;
+        cba.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+        cba.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+        cba.colorBlendOp = VK_BLEND_OP_ADD;
+        cba.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+        cba.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+        cba.alphaBlendOp = VK_BLEND_OP_ADD;
+        ds.depthWriteEnable = VK_FALSE;
+        rs.cullMode = VK_CULL_MODE_NONE;
+        if (vkCreateGraphicsPipelines(device_, VK_NULL_HANDLE, 1, &gpi, nullptr, &translucent_pipeline_) != VK_SUCCESS) {
+            std::cerr << "Failed to create translucent chunk pipeline; water is not drawn.\n";
+            translucent_pipeline_ = VK_NULL_HANDLE;
+        }
     }
     vkDestroyShaderModule(device_, vs, nullptr);
     vkDestroyShaderModule(device_, fs, nullptr);
+
+    if (!cull_pipeline_) create_cull_pipeline();
 }
 
 void ChunkRenderer::recreate(VkRenderPass renderPass, VkExtent2D extent, const char* shaderDir) {
     if (pipeline_) { vkDestroyPipeline(device_, pipeline_, nullptr); pipeline_ = VK_NULL_HANDLE; }
+    if (translucent_pipeline_) { vkDestroyPipeline(device_, translucent_pipeline_, nullptr); translucent_pipeline_ = VK_NULL_HANDLE; }
     if (layout_) { vkDestroyPipelineLayout(device_, layout_, nullptr); layout_ = VK_NULL_HANDLE; }
     init(phys_, device_, renderPass, extent, shaderDir ? shaderDir : shader_dir_.c_str());
 }
 
 void ChunkRenderer::cleanup(VkDevice device) {
+    record_workers_.stop();
+    destroy_record_lanes();
+    record_threads_ = 0;
+    destroy_gpu_cull(device);
+    destroy_offset_slots(device);
+    destroy_palette(device);
+    draw_records_.clear();
+    draw_origins_.clear();
+    free_draw_records_.clear();
     if (pipeline_) { vkDestroyPipeline(device, pipeline_, nullptr); pipeline_ = VK_NULL_HANDLE; }
+    if (translucent_pipeline_) { vkDestroyPipeline(device, translucent_pipeline_, nullptr); translucent_pipeline_ = VK_NULL_HANDLE; }
     if (layout_) { vkDestroyPipelineLayout(device, layout_, nullptr); layout_ = VK_NULL_HANDLE; }
     if (vtx_pool_) { vkDestroyBuffer(device, vtx_pool_, nullptr); vtx_pool_ = VK_NULL_HANDLE; }
     if (vtx_mem_) { vkFreeMemory(device, vtx_mem_, nullptr); vtx_mem_ = VK_NULL_HANDLE; vtx_capacity_ = 0; vtx_used_ = 0; }
@@ -142,9 +206,13 @@ void ChunkRenderer::record(VkCommandBuffer cmd, const float mvp[16], const std::
         return;
     }
     vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline_);
+    bind_palette(cmd);
     vkCmdPushConstants(cmd, layout_, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(float) * 16, mvp);
+    if (!bind_draw_offsets(cmd)) return;
+    sort_draw_order(items, sort_scratch_);
+    const std::vector<uint32_t>& order = sort_scratch_.order;
     // If items reference the shared pools (no per-chunk buffers), build and issue indirect multi-draw
-    bool pooled = true;
+    bool pooled = indirect_first_instance_;
     for (const auto& it : items) {
         if (it.vbuf != VK_NULL_HANDLE || it.ibuf != VK_NULL_HANDLE) { pooled = false; break; }
     }
@@ -153,8 +221,9 @@ void ChunkRenderer::record(VkCommandBuffer cmd, const float mvp[16], const std::
         // Build commands
         using Cmd = VkDrawIndexedIndirectCommand;
         std::vector<Cmd> cmds; cmds.reserve(items.size());
-        for (const auto& it : items) {
-            Cmd c{ it.index_count, 1u, it.first_index, it.base_vertex, 0u };
+        for (uint32_t i : order) {
+            const auto& it = items[i];
+            Cmd c{ it.index_count, 1u, it.first_index, it.base_vertex, it.draw_record };
             cmds.push_back(c);
             if (log_) {
                 std::cout << "[pool] draw first_index=" << it.first_index
@@ -173,24 +242,786 @@ void ChunkRenderer::record(VkCommandBuffer cmd, const float mvp[16], const std::
         }
         VkDeviceSize offs = 0;
         vkCmdBindVertexBuffers(cmd, 0, 1, &vtx_pool_, &offs);
-        vkCmdBindIndexBuffer(cmd, idx_pool_, 0, VK_INDEX_TYPE_UINT32);
+        vkCmdBindIndexBuffer(cmd, idx_pool_, 0, kIndexType);
         vkCmdDrawIndexedIndirect(cmd, indirect_buf_, 0, (uint32_t)cmds.size(), sizeof(Cmd));
     } else {
         // Fallback to direct per-chunk draws
-        for (const auto& it : items) {
-            if (log_) {
+        if (log_) {
+            for (uint32_t i : order) {
+                const auto& it = items[i];
                 std::cout << "[chunk] draw direct idx=" << it.index_count
                           << " first_index=" << it.first_index
                           << " base_vertex=" << it.base_vertex
                           << " vbuf=" << (void*)it.vbuf
                           << " ibuf=" << (void*)it.ibuf << "\n";
             }
+        }
+        record_direct_draws(cmd, items, order);
+    }
+}
+
+void ChunkRenderer::record_translucent(VkCommandBuffer cmd, const float mvp[16], const std::vector<ChunkDrawItem>& items) {
+    if (!translucent_pipeline_ || items.empty()) return;
+    // Blending is order dependent: farthest chunk first. Centers are camera-relative.
+    translucent_keys_.clear();
+    for (uint32_t i = 0; i < items.size(); ++i) {
+        const float* c = items[i].center;
+        translucent_keys_.emplace_back(c[0] * c[0] + c[1] * c[1] + c[2] * c[2], i);
+    }
+    std::sort(translucent_keys_.begin(), translucent_keys_.end(),
+              [](const auto& a, const auto& b) { return a.first > b.first; });
+    translucent_order_.clear();
+    for (const auto& k : translucent_keys_) translucent_order_.push_back(k.second);
+    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, translucent_pipeline_);
+    bind_palette(cmd);
+    vkCmdPushConstants(cmd, layout_, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(float) * 16, mvp);
+    if (!bind_draw_offsets(cmd)) return;
+    record_direct_draws(cmd, items, translucent_order_);
+}
+
+void ChunkRenderer::record_direct_draws(VkCommandBuffer cmd, const std::vector<ChunkDrawItem>& items,
+                                        const std::vector<uint32_t>& order) const {
+    VkBuffer bound_vbuf = VK_NULL_HANDLE;
+    VkBuffer bound_ibuf = VK_NULL_HANDLE;
+    for (uint32_t i : order) {
+        const auto& it = items[i];
+        VkBuffer vbuf = it.vbuf ? it.vbuf : vtx_pool_;
+        VkBuffer ibuf = it.ibuf ? it.ibuf : idx_pool_;
+        if (!vbuf || !ibuf || it.draw_record == kNoDrawRecord) continue;
+        if (vbuf != bound_vbuf) {
             VkDeviceSize offs = 0;
-            vkCmdBindVertexBuffers(cmd, 0, 1, &it.vbuf, &offs);
-            vkCmdBindIndexBuffer(cmd, it.ibuf, 0, VK_INDEX_TYPE_UINT32);
-            vkCmdDrawIndexed(cmd, it.index_count, 1, it.first_index, it.base_vertex, 0);
+            vkCmdBindVertexBuffers(cmd, 0, 1, &vbuf, &offs);
+            bound_vbuf = vbuf;
+        }
+        if (ibuf != bound_ibuf) {
+            vkCmdBindIndexBuffer(cmd, ibuf, 0, kIndexType);
+            bound_ibuf = ibuf;
+        }
+        vkCmdDrawIndexed(cmd, it.index_count, 1, it.first_index, it.base_vertex, it.draw_record);
+    }
+}
+
+bool ChunkRenderer::bind_draw_offsets(VkCommandBuffer cmd) const {
+    const OffsetSlot& slot = offset_slots_[active_offset_slot_];
+    if (!slot.buffer) return false;
+    VkDeviceSize offs = 0;
+    vkCmdBindVertexBuffers(cmd, 1, 1, &slot.buffer, &offs);
+    return true;
+}
+
+void ChunkRenderer::update_draw_offsets(size_t frame_slot, const double camera[3]) {
+    // The slot's fence has been waited, so its offsets are no longer read by the GPU.
+    active_offset_slot_ = frame_slot % 2;
+    OffsetSlot& slot = offset_slots_[active_offset_slot_];
+    const size_t count = draw_origins_.size();
+    if (slot.capacity < std::max<size_t>(count, 1)) {
+        if (slot.map) { vkUnmapMemory(device_, slot.memory); slot.map = nullptr; }
+        if (slot.buffer) { vkDestroyBuffer(device_, slot.buffer, nullptr); slot.buffer = VK_NULL_HANDLE; }
+        if (slot.memory) { vkFreeMemory(device_, slot.memory, nullptr); slot.memory = VK_NULL_HANDLE; }
+        slot.capacity = 0;
+        size_t cap = std::max<size_t>(count + count / 2, 4096);
+        VkDeviceSize bytes = (VkDeviceSize)(cap * sizeof(float) * 4);
+        wf::vk::create_buffer(phys_, device_, bytes, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                              VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                              slot.buffer, slot.memory);
+        if (!slot.buffer || vkMapMemory(device_, slot.memory, 0, bytes, 0, &slot.map) != VK_SUCCESS) {
+            slot.map = nullptr;
+            return;
+        }
+        slot.capacity = cap;
+    }
+    // Subtract in double, then narrow: the offsets stay small near the camera at any planet radius.
+    auto* dst = static_cast<float*>(slot.map);
+    const Double3 cam{camera[0], camera[1], camera[2]};
+    for (size_t i = 0; i < count; ++i) {
+        Float3 rel = to_float3(draw_origins_[i] - cam);
+        dst[i * 4 + 0] = rel.x;
+        dst[i * 4 + 1] = rel.y;
+        dst[i * 4 + 2] = rel.z;
+        dst[i * 4 + 3] = 0.0f;
+    }
+}
+
+void ChunkRenderer::destroy_offset_slots(VkDevice device) {
+    for (auto& slot : offset_slots_) {
+        if (slot.map) vkUnmapMemory(device, slot.memory);
+        if (slot.buffer) vkDestroyBuffer(device, slot.buffer, nullptr);
+        if (slot.memory) vkFreeMemory(device, slot.memory, nullptr);
+        slot = OffsetSlot{};
+    }
+    active_offset_slot_ = 0;
+}
+
+float ChunkRenderer::sort_draw_order(const std::vector<ChunkDrawItem>& items, DrawSortScratch& scratch) const {
+    scratch.order.resize(items.size());
+    if (!sort_view_.enabled || items.size() < 2) {
+        std::iota(scratch.order.begin(), scratch.order.end(), 0u);
+        return 0.0f;
+    }
+    const DrawSortView& v = sort_view_;
+    const float range = std::max(v.far_m - v.near_m, 1e-3f);
+    const float scale = 65535.0f / range;
+    const float split = std::clamp(v.near_split_m, v.near_m, v.far_m);
+    float nearest = v.far_m;
+    scratch.near_keys.clear();
+    scratch.far_keys.clear();
+    for (size_t i = 0; i < items.size(); ++i) {
+        const auto& it = items[i];
+        float depth = (it.center[0] - v.eye[0]) * v.forward[0] +
+                      (it.center[1] - v.eye[1]) * v.forward[1] +
+                      (it.center[2] - v.eye[2]) * v.forward[2] - it.radius;
+        depth = std::clamp(depth, v.near_m, v.far_m);
+        nearest = std::min(nearest, depth);
+        DrawSortKey key{static_cast<uint16_t>((depth - v.near_m) * scale), static_cast<uint32_t>(i)};
+        (depth < split ? scratch.near_keys : scratch.far_keys).push_back(key);
+    }
+    // Near chunks cover most of the screen: sort them fully. Far ones only need coarse order.
+    radix_pass(scratch.near_keys, scratch.tmp, 0);
+    radix_pass(scratch.tmp, scratch.near_keys, 8);
+    radix_pass(scratch.far_keys, scratch.tmp, 8);
+    size_t n = 0;
+    for (const DrawSortKey& k : scratch.near_keys) scratch.order[n++] = k.index;
+    for (const DrawSortKey& k : scratch.tmp) scratch.order[n++] = k.index;
+    return nearest;
+}
+
+bool ChunkRenderer::create_palette() {
+    const std::vector<GpuMaterial> palette = material_table().gpu_palette();
+    const VkDeviceSize bytes = static_cast<VkDeviceSize>(palette.size() * sizeof(GpuMaterial));
+
+    VkDescriptorSetLayoutBinding binding{};
+    binding.binding = 0;
+    binding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    binding.descriptorCount = 1;
+    binding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+    VkDescriptorSetLayoutCreateInfo dslci{};
+    dslci.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    dslci.bindingCount = 1;
+    dslci.pBindings = &binding;
+    VkDescriptorPoolSize pool_size{VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1};
+    VkDescriptorPoolCreateInfo dpci{};
+    dpci.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    dpci.maxSets = 1;
+    dpci.poolSizeCount = 1;
+    dpci.pPoolSizes = &pool_size;
+    if (vkCreateDescriptorSetLayout(device_, &dslci, nullptr, &palette_set_layout_) != VK_SUCCESS ||
+        vkCreateDescriptorPool(device_, &dpci, nullptr, &palette_descriptor_pool_) != VK_SUCCESS) {
+        destroy_palette(device_);
+        return false;
+    }
+    VkDescriptorSetAllocateInfo dsai{};
+    dsai.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    dsai.descriptorPool = palette_descriptor_pool_;
+    dsai.descriptorSetCount = 1;
+    dsai.pSetLayouts = &palette_set_layout_;
+    if (vkAllocateDescriptorSets(device_, &dsai, &palette_set_) != VK_SUCCESS) {
+        palette_set_ = VK_NULL_HANDLE;
+        destroy_palette(device_);
+        return false;
+    }
+
+    wf::vk::create_buffer(phys_, device_, bytes, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                          VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                          palette_buffer_, palette_mem_);
+    if (!palette_buffer_) {
+        destroy_palette(device_);
+        return false;
+    }
+    wf::vk::upload_host_visible(device_, palette_mem_, bytes, palette.data());
+
+    VkDescriptorBufferInfo info{palette_buffer_, 0, bytes};
+    VkWriteDescriptorSet write{};
+    write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    write.dstSet = palette_set_;
+    write.dstBinding = 0;
+    write.descriptorCount = 1;
+    write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    write.pBufferInfo = &info;
+    vkUpdateDescriptorSets(device_, 1, &write, 0, nullptr);
+    return true;
+}
+
+void ChunkRenderer::destroy_palette(VkDevice device) {
+    if (palette_buffer_) { vkDestroyBuffer(device, palette_buffer_, nullptr); palette_buffer_ = VK_NULL_HANDLE; }
+    if (palette_mem_) { vkFreeMemory(device, palette_mem_, nullptr); palette_mem_ = VK_NULL_HANDLE; }
+    // Destroying the pool frees the set.
+    if (palette_descriptor_pool_) { vkDestroyDescriptorPool(device, palette_descriptor_pool_, nullptr); palette_descriptor_pool_ = VK_NULL_HANDLE; }
+    palette_set_ = VK_NULL_HANDLE;
+    if (palette_set_layout_) { vkDestroyDescriptorSetLayout(device, palette_set_layout_, nullptr); palette_set_layout_ = VK_NULL_HANDLE; }
+}
+
+void ChunkRenderer::bind_palette(VkCommandBuffer cmd) const {
+    vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, layout_, 0, 1, &palette_set_, 0, nullptr);
+}
+
+void ChunkRenderer::create_cull_pipeline() {
+    std::string csPath = shader_dir_ + "/chunk_cull.comp.spv";
+    std::vector<std::string> csFallbacks = {
+        std::string("build/shaders/") + "chunk_cull.comp.spv",
+        std::string("shaders/") + "chunk_cull.comp.spv",
+        std::string("shaders_build/") + "chunk_cull.comp.spv"
+    };
+    VkShaderModule cs = wf::vk::load_shader_module(device_, csPath, csFallbacks);
+    if (!cs) {
+        std::cout << "[info] Chunk cull shader not found. GPU culling disabled." << std::endl;
+        return;
+    }
+
+    VkDescriptorSetLayoutBinding bindings[4]{};
+    for (uint32_t i = 0; i < 4; ++i) {
+        bindings[i].binding = i;
+        bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        bindings[i].descriptorCount = 1;
+        bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+    }
+    VkDescriptorSetLayoutCreateInfo dslci{};
+    dslci.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    dslci.bindingCount = 4;
+    dslci.pBindings = bindings;
+    VkDescriptorPoolSize pool_size{VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 4 * 2};
+    VkDescriptorPoolCreateInfo dpci{};
+    dpci.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    dpci.maxSets = 2;
+    dpci.poolSizeCount = 1;
+    dpci.pPoolSizes = &pool_size;
+    // planes[6] + eye/occluder + control = 128 bytes, the guaranteed push constant minimum
+    VkPushConstantRange pcr{}; pcr.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT; pcr.offset = 0; pcr.size = sizeof(float) * 32;
+    VkPipelineLayoutCreateInfo plci{};
+    plci.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    plci.setLayoutCount = 1;
+    plci.pSetLayouts = &cull_set_layout_;
+    plci.pushConstantRangeCount = 1;
+    plci.pPushConstantRanges = &pcr;
+    if (vkCreateDescriptorSetLayout(device_, &dslci, nullptr, &cull_set_layout_) != VK_SUCCESS ||
+        vkCreateDescriptorPool(device_, &dpci, nullptr, &cull_descriptor_pool_) != VK_SUCCESS ||
+        vkCreatePipelineLayout(device_, &plci, nullptr, &cull_layout_) != VK_SUCCESS) {
+        vkDestroyShaderModule(device_, cs, nullptr);
+        destroy_gpu_cull(device_);
+        return;
+    }
+
+    VkComputePipelineCreateInfo cpci{};
+    cpci.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+    cpci.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    cpci.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+    cpci.stage.module = cs;
+    cpci.stage.pName = "main";
+    cpci.layout = cull_layout_;
+    if (vkCreateComputePipelines(device_, VK_NULL_HANDLE, 1, &cpci, nullptr, &cull_pipeline_) != VK_SUCCESS) {
+        std::cerr << "Failed to create chunk cull compute pipeline.\n";
+        cull_pipeline_ = VK_NULL_HANDLE;
+    }
+    vkDestroyShaderModule(device_, cs, nullptr);
+
+    VkDescriptorSetLayout layouts[2] = {cull_set_layout_, cull_set_layout_};
+    VkDescriptorSetAllocateInfo dsai{};
+    dsai.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    dsai.descriptorPool = cull_descriptor_pool_;
+    dsai.descriptorSetCount = 2;
+    dsai.pSetLayouts = layouts;
+    VkDescriptorSet sets[2] = {VK_NULL_HANDLE, VK_NULL_HANDLE};
+    if (cull_pipeline_ && vkAllocateDescriptorSets(device_, &dsai, sets) == VK_SUCCESS) {
+        gpu_slots_[0].set = sets[0];
+        gpu_slots_[1].set = sets[1];
+    } else {
+        destroy_gpu_cull(device_);
+    }
+}
+
+void ChunkRenderer::destroy_gpu_cull(VkDevice device) {
+    for (auto& slot : gpu_slots_) {
+        if (slot.records_map) vkUnmapMemory(device, slot.records_mem);
+        if (slot.counter_map) vkUnmapMemory(device, slot.counter_mem);
+        if (slot.records) vkDestroyBuffer(device, slot.records, nullptr);
+        if (slot.records_mem) vkFreeMemory(device, slot.records_mem, nullptr);
+        if (slot.commands) vkDestroyBuffer(device, slot.commands, nullptr);
+        if (slot.commands_mem) vkFreeMemory(device, slot.commands_mem, nullptr);
+        if (slot.counter) vkDestroyBuffer(device, slot.counter, nullptr);
+        if (slot.counter_mem) vkFreeMemory(device, slot.counter_mem, nullptr);
+        slot = GpuCullSlot{};
+    }
+    if (cull_pipeline_) { vkDestroyPipeline(device, cull_pipeline_, nullptr); cull_pipeline_ = VK_NULL_HANDLE; }
+    if (cull_layout_) { vkDestroyPipelineLayout(device, cull_layout_, nullptr); cull_layout_ = VK_NULL_HANDLE; }
+    if (cull_descriptor_pool_) { vkDestroyDescriptorPool(device, cull_descriptor_pool_, nullptr); cull_descriptor_pool_ = VK_NULL_HANDLE; }
+    if (cull_set_layout_) { vkDestroyDescriptorSetLayout(device, cull_set_layout_, nullptr); cull_set_layout_ = VK_NULL_HANDLE; }
+}
+
+void ChunkRenderer::set_gpu_cull(bool enabled, bool draw_indirect_count, bool multi_draw_indirect) {
+    if (enabled && !gpu_cull_enabled_) {
+        for (auto& slot : gpu_slots_) { slot.full_sync = true; slot.dirty.clear(); }
+    }
+    gpu_cull_enabled_ = enabled;
+    draw_indirect_count_ = draw_indirect_count;
+    multi_draw_indirect_ = multi_draw_indirect;
+    draw_indexed_indirect_count_ = nullptr;
+    if (draw_indirect_count_ && device_) {
+        draw_indexed_indirect_count_ = reinterpret_cast<PFN_vkCmdDrawIndexedIndirectCountKHR>(
+            vkGetDeviceProcAddr(device_, "vkCmdDrawIndexedIndirectCountKHR"));
+    }
+    // Without indirect count the fallback issues one multi-draw over every record.
+    if (!draw_indexed_indirect_count_ && !multi_draw_indirect_) gpu_cull_enabled_ = false;
+    // Compacted commands carry the record index as firstInstance to find its origin offset.
+    if (!indirect_first_instance_) gpu_cull_enabled_ = false;
+}
+
+void ChunkRenderer::mark_draw_record_dirty(uint32_t record) {
+    for (auto& slot : gpu_slots_) {
+        if (slot.full_sync) continue;
+        // Past one entry per record a full copy is cheaper than replaying the list.
+        if (!gpu_cull_enabled_ || slot.dirty.size() >= draw_records_.size()) {
+            slot.full_sync = true;
+            slot.dirty.clear();
+            continue;
+        }
+        slot.dirty.push_back(record);
+    }
+}
+
+uint32_t ChunkRenderer::register_draw(const ChunkDrawItem& item, const Double3& origin, bool gpu_cull) {
+    uint32_t record = 0;
+    if (!free_draw_records_.empty()) {
+        record = free_draw_records_.back();
+        free_draw_records_.pop_back();
+    } else {
+        record = static_cast<uint32_t>(draw_records_.size());
+        draw_records_.push_back(GpuDrawRecord{});
+        draw_origins_.push_back(Double3{});
+    }
+    GpuDrawRecord& r = draw_records_[record];
+    r.radius = item.radius;
+    r.index_count = gpu_cull ? item.index_count : 0; // the cull pass skips empty records
+    r.first_index = item.first_index;
+    r.base_vertex = item.base_vertex;
+    draw_origins_[record] = origin;
+    mark_draw_record_dirty(record);
+    return record;
+}
+
+void ChunkRenderer::unregister_draw(uint32_t record) {
+    if (record >= draw_records_.size()) return;
+    draw_records_[record] = GpuDrawRecord{};
+    draw_origins_[record] = Double3{};
+    free_draw_records_.push_back(record);
+    mark_draw_record_dirty(record);
+}
+
+bool ChunkRenderer::ensure_gpu_slot_capacity(GpuCullSlot& slot, size_t records) {
+    if (slot.capacity >= records && slot.records) return true;
+    // The slot's previous frame has retired, so its buffers and descriptor set can be replaced.
+    if (slot.records_map) { vkUnmapMemory(device_, slot.records_mem); slot.records_map = nullptr; }
+    if (slot.counter_map) { vkUnmapMemory(device_, slot.counter_mem); slot.counter_map = nullptr; }
+    if (slot.records) { vkDestroyBuffer(device_, slot.records, nullptr); slot.records = VK_NULL_HANDLE; }
+    if (slot.records_mem) { vkFreeMemory(device_, slot.records_mem, nullptr); slot.records_mem = VK_NULL_HANDLE; }
+    if (slot.commands) { vkDestroyBuffer(device_, slot.commands, nullptr); slot.commands = VK_NULL_HANDLE; }
+    if (slot.commands_mem) { vkFreeMemory(device_, slot.commands_mem, nullptr); slot.commands_mem = VK_NULL_HANDLE; }
+    if (!slot.counter) {
+        wf::vk::create_buffer(phys_, device_, sizeof(uint32_t) * 4,
+                              VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                              VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                              slot.counter, slot.counter_mem);
+    }
+    size_t cap = std::max<size_t>(records + records / 2, 4096);
+    VkDeviceSize record_bytes = (VkDeviceSize)(cap * sizeof(GpuDrawRecord));
+    // Near and far ranges each need room for every record.
+    VkDeviceSize command_bytes = (VkDeviceSize)(2 * cap * sizeof(VkDrawIndexedIndirectCommand));
+    wf::vk::create_buffer(phys_, device_, record_bytes, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                          VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                          slot.records, slot.records_mem);
+    wf::vk::create_buffer(phys_, device_, command_bytes, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+                          VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, slot.commands, slot.commands_mem);
+    if (!slot.records || !slot.commands || !slot.counter ||
+        vkMapMemory(device_, slot.records_mem, 0, record_bytes, 0, &slot.records_map) != VK_SUCCESS ||
+        vkMapMemory(device_, slot.counter_mem, 0, sizeof(uint32_t) * 4, 0, &slot.counter_map) != VK_SUCCESS) {
+        slot.capacity = 0;
+        return false;
+    }
+    std::memset(slot.counter_map, 0, sizeof(uint32_t) * 4);
+    slot.capacity = cap;
+    slot.full_sync = true;
+    slot.dirty.clear();
+    slot.bound_offsets = VK_NULL_HANDLE; // forces a descriptor rewrite
+    return true;
+}
+
+void ChunkRenderer::write_cull_descriptors(GpuCullSlot& slot, VkBuffer offsets) {
+    VkDescriptorBufferInfo infos[4] = {
+        {slot.records, 0, VK_WHOLE_SIZE},
+        {slot.commands, 0, VK_WHOLE_SIZE},
+        {slot.counter, 0, VK_WHOLE_SIZE},
+        {offsets, 0, VK_WHOLE_SIZE},
+    };
+    VkWriteDescriptorSet writes[4]{};
+    for (uint32_t i = 0; i < 4; ++i) {
+        writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        writes[i].dstSet = slot.set;
+        writes[i].dstBinding = i;
+        writes[i].descriptorCount = 1;
+        writes[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        writes[i].pBufferInfo = &infos[i];
+    }
+    vkUpdateDescriptorSets(device_, 4, writes, 0, nullptr);
+    slot.bound_offsets = offsets;
+}
+
+void ChunkRenderer::record_gpu_cull(VkCommandBuffer cmd, size_t frame_slot, const GpuCullParams& params) {
+    GpuCullSlot& slot = gpu_slots_[frame_slot % 2];
+    // The slot's fence has been waited: its counter holds the result of the previous cull.
+    if (slot.counter_map && slot.dispatched > 0) {
+        const uint32_t* counter = static_cast<const uint32_t*>(slot.counter_map);
+        gpu_visible_ = static_cast<int>(counter[0] + counter[1]);
+        gpu_visible_indices_ = counter[2];
+        if (slot.cpu_visible >= 0) {
+            GpuCullParity& parity = gpu_cull_parity_;
+            const int diff = std::abs(gpu_visible_ - slot.cpu_visible);
+            parity.checked++;
+            parity.last_gpu = gpu_visible_;
+            parity.last_cpu = slot.cpu_visible;
+            parity.max_draw_diff = std::max(parity.max_draw_diff, diff);
+            if (diff != 0 || gpu_visible_indices_ != slot.cpu_indices) {
+                // Log the first few and then sparsely; float rounding at a plane may flip a draw.
+                if (parity.mismatched++ < 8 || parity.mismatched % 600 == 0) {
+                    std::cout << "[chunk] gpu cull parity mismatch: gpu=" << gpu_visible_ << " draws/"
+                              << gpu_visible_indices_ << " indices cpu=" << slot.cpu_visible << " draws/"
+                              << slot.cpu_indices << " indices (" << parity.mismatched << " of " << parity.checked
+                              << ")\n";
+                }
+            }
+        }
+    }
+    slot.dispatched = 0;
+    slot.cpu_visible = -1;
+    const size_t count = draw_records_.size();
+    const OffsetSlot& offsets = offset_slots_[frame_slot % 2];
+    if (count == 0 || offsets.capacity < count || !ensure_gpu_slot_capacity(slot, count)) return;
+    if (slot.bound_offsets != offsets.buffer) write_cull_descriptors(slot, offsets.buffer);
+
+    auto* dst = static_cast<GpuDrawRecord*>(slot.records_map);
+    if (slot.full_sync) {
+        std::memcpy(dst, draw_records_.data(), count * sizeof(GpuDrawRecord));
+        slot.full_sync = false;
+    } else {
+        for (uint32_t record : slot.dirty) {
+            if (record < count) dst[record] = draw_records_[record];
+        }
+    }
+    slot.dirty.clear();
+
+    vkCmdFillBuffer(cmd, slot.counter, 0, sizeof(uint32_t) * 4, 0);
+    VkBufferMemoryBarrier reset{};
+    reset.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    reset.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    reset.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+    reset.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    reset.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    reset.buffer = slot.counter;
+    reset.offset = 0;
+    reset.size = VK_WHOLE_SIZE;
+    vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0,
+                         0, nullptr, 1, &reset, 0, nullptr);
+
+    struct {
+        float planes[6][4];
+        float eye_occluder[4];
+        uint32_t control[4];
+    } pc{};
+    std::memcpy(pc.planes, params.planes, sizeof(pc.planes));
+    pc.eye_occluder[0] = params.eye[0]; pc.eye_occluder[1] = params.eye[1]; pc.eye_occluder[2] = params.eye[2];
+    pc.eye_occluder[3] = params.occluder_radius;
+    pc.control[0] = static_cast<uint32_t>(count);
+    pc.control[1] = draw_indexed_indirect_count_ ? 1u : 0u;
+    pc.control[2] = params.frustum ? 1u : 0u;
+    std::memcpy(&pc.control[3], &params.near_split, sizeof(float));
+    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, cull_pipeline_);
+    vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, cull_layout_, 0, 1, &slot.set, 0, nullptr);
+    vkCmdPushConstants(cmd, cull_layout_, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(pc), &pc);
+    vkCmdDispatch(cmd, static_cast<uint32_t>((count + 63) / 64), 1, 1);
+
+    VkBufferMemoryBarrier produced[2]{};
+    for (int i = 0; i < 2; ++i) {
+        produced[i].sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        produced[i].srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        produced[i].dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+        produced[i].srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        produced[i].dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        produced[i].offset = 0;
+        produced[i].size = VK_WHOLE_SIZE;
+    }
+    produced[0].buffer = slot.commands;
+    produced[1].buffer = slot.counter;
+    vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, 0,
+                         0, nullptr, 2, produced, 0, nullptr);
+    slot.dispatched = static_cast<uint32_t>(count);
+    if (gpu_cull_check_) replay_gpu_cull(params, frame_slot, slot.cpu_visible, slot.cpu_indices);
+}
+
+void ChunkRenderer::replay_gpu_cull(const GpuCullParams& params, size_t frame_slot, int& visible,
+                                    uint64_t& indices) const {
+    visible = 0;
+    indices = 0;
+    // The same float offsets the dispatch reads from the slot's offset buffer.
+    const float* offsets = static_cast<const float*>(offset_slots_[frame_slot % 2].map);
+    if (!offsets) return;
+    const float ex = params.eye[0], ey = params.eye[1], ez = params.eye[2];
+    const float el = std::sqrt(ex * ex + ey * ey + ez * ez);
+    for (size_t id = 0; id < draw_records_.size(); ++id) {
+        const GpuDrawRecord& r = draw_records_[id];
+        if (r.index_count == 0) continue;
+        const float dx = offsets[id * 4 + 0], dy = offsets[id * 4 + 1], dz = offsets[id * 4 + 2];
+        bool in = true;
+        if (params.frustum) {
+            for (int p = 0; p < 6 && in; ++p) {
+                const float* pl = params.planes[p];
+                if (dx * pl[0] + dy * pl[1] + dz * pl[2] + pl[3] < -r.radius) in = false;
+            }
+        }
+        const float ro = params.occluder_radius - r.radius;
+        if (in && params.occluder_radius > 0.0f && ro > 0.0f && el > ro) {
+            const float vh2 = (el - ro) * (el + ro);
+            const float vt_dot_vc = -(dx * ex + dy * ey + dz * ez);
+            if (vt_dot_vc > vh2 && vt_dot_vc * vt_dot_vc > vh2 * (dx * dx + dy * dy + dz * dz)) in = false;
+        }
+        if (!in) continue;
+        visible++;
+        indices += r.index_count;
+    }
+}
+
+void ChunkRenderer::record_gpu_draws(VkCommandBuffer cmd, size_t frame_slot, const float mvp[16]) {
+    const GpuCullSlot& slot = gpu_slots_[frame_slot % 2];
+    if (slot.dispatched == 0) return;
+    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline_);
+    bind_palette(cmd);
+    vkCmdPushConstants(cmd, layout_, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(float) * 16, mvp);
+    VkDeviceSize offs = 0;
+    vkCmdBindVertexBuffers(cmd, 0, 1, &vtx_pool_, &offs);
+    vkCmdBindVertexBuffers(cmd, 1, 1, &offset_slots_[frame_slot % 2].buffer, &offs);
+    vkCmdBindIndexBuffer(cmd, idx_pool_, 0, kIndexType);
+    if (draw_indexed_indirect_count_) {
+        // Near range first (count at offset 0), then the far range placed after `dispatched` commands.
+        const VkDeviceSize stride = sizeof(VkDrawIndexedIndirectCommand);
+        draw_indexed_indirect_count_(cmd, slot.commands, 0, slot.counter, 0, slot.dispatched, stride);
+        draw_indexed_indirect_count_(cmd, slot.commands, stride * slot.dispatched, slot.counter, sizeof(uint32_t),
+                                     slot.dispatched, stride);
+    } else {
+        // Culled records carry instanceCount = 0 and cost only a command fetch.
+        vkCmdDrawIndexedIndirect(cmd, slot.commands, 0, slot.dispatched, sizeof(VkDrawIndexedIndirectCommand));
+    }
+}
+
+void ChunkRenderer::finish_gpu_cull(VkCommandBuffer cmd, size_t frame_slot) {
+    const GpuCullSlot& slot = gpu_slots_[frame_slot % 2];
+    if (slot.dispatched == 0) return;
+    VkBufferMemoryBarrier readback{};
+    readback.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+    readback.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    readback.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+    readback.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    readback.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    readback.buffer = slot.counter;
+    readback.offset = 0;
+    readback.size = VK_WHOLE_SIZE;
+    vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0,
+                         0, nullptr, 1, &readback, 0, nullptr);
+}
+
+uint32_t ChunkRenderer::record_bucket(int face, int64_t ci, int64_t cj) {
+    // Floor division keeps tiles contiguous across negative chunk coordinates.
+    auto tile = [](int64_t c) {
+        int64_t t = (c >= 0) ? c / kBucketTileChunks : -((-c + kBucketTileChunks - 1) / kBucketTileChunks);
+        return static_cast<uint32_t>(t & 1);
+    };
+    uint32_t f = (face >= 0 && face < 6) ? static_cast<uint32_t>(face) : 0u;
+    return f * 4u + tile(ci) + 2u * tile(cj);
+}
+
+void ChunkRenderer::set_record_threads(size_t count, uint32_t graphics_queue_family) {
+    if (count == record_threads_ && graphics_queue_family == graphics_queue_family_) return;
+    record_workers_.stop();
+    destroy_record_lanes();
+    record_threads_ = count;
+    graphics_queue_family_ = graphics_queue_family;
+    if (record_threads_ > 0) {
+        lanes_.resize(kRecordSlots * kLanesPerSlot);
+        record_workers_.start(record_threads_);
+    }
+}
+
+ChunkRenderer::RecordLane* ChunkRenderer::lane(size_t frame_slot, size_t index) {
+    if (lanes_.empty() || index >= kLanesPerSlot) return nullptr;
+    return &lanes_[(frame_slot % kRecordSlots) * kLanesPerSlot + index];
+}
+
+bool ChunkRenderer::ensure_lane_command_buffer(RecordLane& lane) {
+    if (!lane.pool) {
+        VkCommandPoolCreateInfo pci{};
+        pci.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+        pci.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+        pci.queueFamilyIndex = graphics_queue_family_;
+        if (vkCreateCommandPool(device_, &pci, nullptr, &lane.pool) != VK_SUCCESS) return false;
+    }
+    if (!lane.cmd) {
+        VkCommandBufferAllocateInfo cai{};
+        cai.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        cai.commandPool = lane.pool;
+        cai.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+        cai.commandBufferCount = 1;
+        if (vkAllocateCommandBuffers(device_, &cai, &lane.cmd) != VK_SUCCESS) return false;
+    }
+    // The slot's previous submission has retired (its fence was waited before recording).
+    vkResetCommandPool(device_, lane.pool, 0);
+    return true;
+}
+
+bool ChunkRenderer::ensure_lane_indirect(RecordLane& lane, size_t draw_count) {
+    if (lane.indirect_capacity_cmds >= draw_count) return true;
+    if (lane.indirect_map) { vkUnmapMemory(device_, lane.indirect_mem); lane.indirect_map = nullptr; }
+    if (lane.indirect) { vkDestroyBuffer(device_, lane.indirect, nullptr); lane.indirect = VK_NULL_HANDLE; }
+    if (lane.indirect_mem) { vkFreeMemory(device_, lane.indirect_mem, nullptr); lane.indirect_mem = VK_NULL_HANDLE; }
+    size_t new_cap = std::max<size_t>(draw_count + draw_count / 2, 256);
+    VkDeviceSize bytes = (VkDeviceSize)(new_cap * sizeof(VkDrawIndexedIndirectCommand));
+    wf::vk::create_buffer(phys_, device_, bytes, VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+                          VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                          lane.indirect, lane.indirect_mem);
+    if (!lane.indirect || vkMapMemory(device_, lane.indirect_mem, 0, bytes, 0, &lane.indirect_map) != VK_SUCCESS) {
+        lane.indirect_capacity_cmds = 0;
+        return false;
+    }
+    lane.indirect_capacity_cmds = new_cap;
+    return true;
+}
+
+void ChunkRenderer::record_lane(RecordLane& lane, uint32_t bucket, const VkCommandBufferInheritanceInfo& inheritance,
+                                const float mvp[16], const BucketCullFn& cull) {
+    lane.items.clear();
+    lane.indices = 0;
+    lane.recorded = false;
+    cull(bucket, lane.items);
+    if (lane.items.empty()) return;
+    for (const auto& it : lane.items) lane.indices += it.index_count;
+    lane.nearest = sort_draw_order(lane.items, lane.sort);
+    if (!offset_slots_[active_offset_slot_].buffer || !ensure_lane_command_buffer(lane)) return;
+
+    VkCommandBufferBeginInfo bi{};
+    bi.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    bi.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+    bi.pInheritanceInfo = &inheritance;
+    if (vkBeginCommandBuffer(lane.cmd, &bi) != VK_SUCCESS) return;
+    vkCmdBindPipeline(lane.cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline_);
+    bind_palette(lane.cmd);
+    vkCmdPushConstants(lane.cmd, layout_, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(float) * 16, mvp);
+    bind_draw_offsets(lane.cmd);
+
+    bool pooled = vtx_pool_ && idx_pool_ && indirect_first_instance_;
+    for (const auto& it : lane.items) {
+        if (it.vbuf != VK_NULL_HANDLE || it.ibuf != VK_NULL_HANDLE) { pooled = false; break; }
+    }
+    if (pooled && ensure_lane_indirect(lane, lane.items.size())) {
+        auto* cmds = static_cast<VkDrawIndexedIndirectCommand*>(lane.indirect_map);
+        for (size_t i = 0; i < lane.items.size(); ++i) {
+            const auto& it = lane.items[lane.sort.order[i]];
+            cmds[i] = VkDrawIndexedIndirectCommand{ it.index_count, 1u, it.first_index, it.base_vertex, it.draw_record };
         }
+        VkDeviceSize offs = 0;
+        vkCmdBindVertexBuffers(lane.cmd, 0, 1, &vtx_pool_, &offs);
+        vkCmdBindIndexBuffer(lane.cmd, idx_pool_, 0, kIndexType);
+        vkCmdDrawIndexedIndirect(lane.cmd, lane.indirect, 0, (uint32_t)lane.items.size(), sizeof(VkDrawIndexedIndirectCommand));
+    } else {
+        record_direct_draws(lane.cmd, lane.items, lane.sort.order);
+    }
+    lane.recorded = vkEndCommandBuffer(lane.cmd) == VK_SUCCESS;
+}
+
+void ChunkRenderer::record_buckets(size_t frame_slot, VkRenderPass render_pass, VkFramebuffer framebuffer,
+                                   const float mvp[16], const BucketCullFn& cull,
+                                   std::vector<VkCommandBuffer>& out_secondaries, ChunkRecordStats& stats) {
+    stats = ChunkRecordStats{};
+    if (!parallel_record_enabled() || !cull) return;
+    const auto t0 = std::chrono::steady_clock::now();
+
+    VkCommandBufferInheritanceInfo inheritance{};
+    inheritance.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+    inheritance.renderPass = render_pass;
+    inheritance.subpass = 0;
+    inheritance.framebuffer = framebuffer;
+    inheritance.pipelineStatistics = inherited_statistics_;
+
+    float mvp_copy[16];
+    std::copy(mvp, mvp + 16, mvp_copy);
+    {
+        std::lock_guard<std::mutex> lock(record_mutex_);
+        record_pending_ = kRecordBuckets;
+    }
+    for (uint32_t b = 0; b < kRecordBuckets; ++b) {
+        RecordLane* l = lane(frame_slot, b);
+        record_workers_.submit([this, l, b, &inheritance, &mvp_copy, &cull]() {
+            const auto lane_t0 = std::chrono::steady_clock::now();
+            record_lane(*l, b, inheritance, mvp_copy, cull);
+            l->record_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - lane_t0).count();
+            std::lock_guard<std::mutex> lock(record_mutex_);
+            if (--record_pending_ == 0) record_cv_.notify_one();
+        });
+    }
+    {
+        std::unique_lock<std::mutex> lock(record_mutex_);
+        record_cv_.wait(lock, [&] { return record_pending_ == 0; });
+    }
+
+    // Execute in bucket order so the frame is deterministic regardless of worker scheduling;
+    // with sorting on, buckets are reordered by their nearest chunk (stable, so ties keep bucket order).
+    const RecordLane* order[kRecordBuckets];
+    size_t recorded = 0;
+    for (uint32_t b = 0; b < kRecordBuckets; ++b) {
+        const RecordLane* l = lane(frame_slot, b);
+        stats.lane_sum_ms += l->record_ms;
+        stats.lane_max_ms = std::max(stats.lane_max_ms, l->record_ms);
+        if (l->recorded) order[recorded++] = l;
+    }
+    if (sort_view_.enabled) {
+        std::stable_sort(order, order + recorded, [](const RecordLane* a, const RecordLane* b) {
+            return a->nearest < b->nearest;
+        });
+    }
+    for (size_t i = 0; i < recorded; ++i) {
+        const RecordLane* l = order[i];
+        out_secondaries.push_back(l->cmd);
+        stats.visible += static_cast<int>(l->items.size());
+        stats.indices += l->indices;
+        stats.secondaries++;
+    }
+    stats.wall_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    if (log_ && (++log_frame_cnt_ % log_every_n_ == 0)) {
+        std::cout << "[chunk] parallel record: secondaries=" << stats.secondaries
+                  << " draws=" << stats.visible << " threads=" << record_threads_
+                  << " wall=" << stats.wall_ms << "ms lanes=" << stats.lane_sum_ms << "ms max=" << stats.lane_max_ms
+                  << "ms\n";
+    }
+}
+
+VkCommandBuffer ChunkRenderer::begin_main_secondary(size_t frame_slot, VkRenderPass render_pass, VkFramebuffer framebuffer) {
+    RecordLane* l = lane(frame_slot, kRecordBuckets);
+    if (!l || !ensure_lane_command_buffer(*l)) return VK_NULL_HANDLE;
+    VkCommandBufferInheritanceInfo inheritance{};
+    inheritance.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+    inheritance.renderPass = render_pass;
+    inheritance.subpass = 0;
+    inheritance.framebuffer = framebuffer;
+    inheritance.pipelineStatistics = inherited_statistics_;
+    VkCommandBufferBeginInfo bi{};
+    bi.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    bi.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+    bi.pInheritanceInfo = &inheritance;
+    if (vkBeginCommandBuffer(l->cmd, &bi) != VK_SUCCESS) return VK_NULL_HANDLE;
+    return l->cmd;
+}
+
+void ChunkRenderer::destroy_record_lanes() {
+    for (auto& l : lanes_) {
+        if (l.indirect_map) { vkUnmapMemory(device_, l.indirect_mem); l.indirect_map = nullptr; }
+        if (l.indirect) vkDestroyBuffer(device_, l.indirect, nullptr);
+        if (l.indirect_mem) vkFreeMemory(device_, l.indirect_mem, nullptr);
+        if (l.pool) vkDestroyCommandPool(device_, l.pool, nullptr); // frees l.cmd
     }
+    lanes_.clear();
 }
 
 bool ChunkRenderer::ensure_pool_capacity(VkDeviceSize add_vtx_bytes, VkDeviceSize add_idx_bytes) {
@@ -198,7 +1029,7 @@ bool ChunkRenderer::ensure_pool_capacity(VkDeviceSize add_vtx_bytes, VkDeviceSiz
     if (vtx_capacity_ == 0) {
         VkDeviceSize base_cap = (vtx_initial_cap_ > 0) ? vtx_initial_cap_ : (VkDeviceSize)(64 * 1024 * 1024);
         VkDeviceSize new_cap = std::max<VkDeviceSize>(add_vtx_bytes, base_cap);
-        VkBufferUsageFlags usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+        VkBufferUsageFlags usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
         VkMemoryPropertyFlags props = use_device_local_ ? VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
                                                         : (VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
         wf::vk::create_buffer(phys_, device_, new_cap, usage, props, vtx_pool_, vtx_mem_);
@@ -207,7 +1038,7 @@ bool ChunkRenderer::ensure_pool_capacity(VkDeviceSize add_vtx_bytes, VkDeviceSiz
     if (idx_capacity_ == 0) {
         VkDeviceSize base_cap = (idx_initial_cap_ > 0) ? idx_initial_cap_ : (VkDeviceSize)(64 * 1024 * 1024);
         VkDeviceSize new_cap = std::max<VkDeviceSize>(add_idx_bytes, base_cap);
-        VkBufferUsageFlags usage = VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+        VkBufferUsageFlags usage = VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
         VkMemoryPropertyFlags props = use_device_local_ ? VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
                                                         : (VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
         wf::vk::create_buffer(phys_, device_, new_cap, usage, props, idx_pool_, idx_mem_);
@@ -216,6 +1047,66 @@ bool ChunkRenderer::ensure_pool_capacity(VkDeviceSize add_vtx_bytes, VkDeviceSiz
     return true;
 }
 
+void ChunkRenderer::resize_pools(VkDeviceSize vtx_bytes, VkDeviceSize idx_bytes, bool device_local) {
+    vtx_initial_cap_ = vtx_bytes;
+    idx_initial_cap_ = idx_bytes;
+    bool memory_changed = device_local != use_device_local_;
+    use_device_local_ = device_local;
+    // Pools not created yet: the new caps apply on first upload
+    if (!device_ || vtx_capacity_ == 0 || idx_capacity_ == 0) return;
+    VkDeviceSize v_cap = std::max(vtx_bytes, vtx_tail_);
+    VkDeviceSize i_cap = std::max(idx_bytes, idx_tail_);
+    if (memory_changed || v_cap != vtx_capacity_) migrate_pool(true, v_cap, device_local);
+    if (memory_changed || i_cap != idx_capacity_) migrate_pool(false, i_cap, device_local);
+}
+
+void ChunkRenderer::migrate_pool(bool isVertex, VkDeviceSize new_cap, bool device_local) {
+    VkBuffer& buf = isVertex ? vtx_pool_ : idx_pool_;
+    VkDeviceMemory& mem = isVertex ? vtx_mem_ : idx_mem_;
+    VkDeviceSize& cap = isVertex ? vtx_capacity_ : idx_capacity_;
+    VkDeviceSize tail = isVertex ? vtx_tail_ : idx_tail_;
+
+    VkBufferUsageFlags usage = (isVertex ? VK_BUFFER_USAGE_VERTEX_BUFFER_BIT : VK_BUFFER_USAGE_INDEX_BUFFER_BIT)
+                             | VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+    VkMemoryPropertyFlags props = device_local ? VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
+                                               : (VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    VkBuffer nb = VK_NULL_HANDLE; VkDeviceMemory nm = VK_NULL_HANDLE;
+    wf::vk::create_buffer(phys_, device_, new_cap, usage, props, nb, nm);
+
+    // Offsets stay valid: copy everything up to the tail in one blocking transfer
+    if (tail > 0) {
+        ensure_transfer_objects();
+        VkCommandBufferAllocateInfo cai{};
+        cai.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        cai.commandPool = transfer_pool_;
+        cai.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        cai.commandBufferCount = 1;
+        VkCommandBuffer cmd = VK_NULL_HANDLE;
+        vkAllocateCommandBuffers(device_, &cai, &cmd);
+        VkCommandBufferBeginInfo bi{};
+        bi.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        bi.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        vkBeginCommandBuffer(cmd, &bi);
+        VkBufferCopy copy{0, 0, tail};
+        vkCmdCopyBuffer(cmd, buf, nb, 1, &copy);
+        vkEndCommandBuffer(cmd);
+        vkResetFences(device_, 1, &transfer_fence_);
+        VkSubmitInfo si{};
+        si.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        si.commandBufferCount = 1;
+        si.pCommandBuffers = &cmd;
+        vkQueueSubmit(transfer_queue_, 1, &si, transfer_fence_);
+        vkWaitForFences(device_, 1, &transfer_fence_, VK_TRUE, UINT64_MAX);
+        vkFreeCommandBuffers(device_, transfer_pool_, 1, &cmd);
+    }
+
+    vkDestroyBuffer(device_, buf, nullptr);
+    vkFreeMemory(device_, mem, nullptr);
+    std::cout << "[pool] resize: " << (isVertex ? "vtx" : "idx") << " cap " << (unsigned long long)cap
+              << " -> " << (unsigned long long)new_cap << " (" << (device_local ? "device-local" : "host-visible") << ")\n";
+    buf = nb; mem = nm; cap = new_cap;
+}
+
 void ChunkRenderer::ensure_indirect_capacity(size_t drawCount) {
     if (indirect_capacity_cmds_ >= drawCount) return;
     size_t new_cap = std::max<size_t>(drawCount, indirect_capacity_cmds_ ? indirect_capacity_cmds_ * 2 : 1024);
@@ -307,8 +1198,8 @@ void ChunkRenderer::free_to_pool(VkDeviceSize offset, VkDeviceSize bytes, bool i
 void ChunkRenderer::free_mesh(uint32_t first_index, uint32_t index_count,
                               int32_t base_vertex, uint32_t vertex_count) {
     if (index_count > 0) {
-        VkDeviceSize off = (VkDeviceSize)first_index * sizeof(uint32_t);
-        VkDeviceSize sz = (VkDeviceSize)index_count * sizeof(uint32_t);
+        VkDeviceSize off = (VkDeviceSize)first_index * sizeof(uint16_t);
+        VkDeviceSize sz = (VkDeviceSize)index_count * sizeof(uint16_t);
         free_to_pool(off, sz, false);
     }
     if (vertex_count > 0) {
@@ -319,19 +1210,19 @@ void ChunkRenderer::free_mesh(uint32_t first_index, uint32_t index_count,
 }
 
 bool ChunkRenderer::upload_mesh(const struct Vertex* vertices, size_t vcount,
-                                const uint32_t* indices, size_t icount,
+                                const uint16_t* indices, size_t icount,
                                 uint32_t& out_first_index,
                                 int32_t& out_base_vertex) {
     VkDeviceSize vbytes = (VkDeviceSize)(vcount * sizeof(Vertex));
-    VkDeviceSize ibytes = (VkDeviceSize)(icount * sizeof(uint32_t));
+    VkDeviceSize ibytes = (VkDeviceSize)(icount * sizeof(uint16_t));
     if (!ensure_pool_capacity(vbytes, ibytes)) {
         out_base_vertex = 0; out_first_index = 0; return false;
     }
     VkDeviceSize voff = 0, ioff = 0;
     if (!alloc_from_pool(vbytes, sizeof(Vertex), true, voff)) return false;
-    if (!alloc_from_pool(ibytes, sizeof(uint32_t), false, ioff)) { free_to_pool(voff, vbytes, true); return false; }
+    if (!alloc_from_pool(ibytes, sizeof(uint16_t), false, ioff)) { free_to_pool(voff, vbytes, true); return false; }
     out_base_vertex = (int32_t)(voff / sizeof(Vertex));
-    out_first_index = (uint32_t)(ioff / sizeof(uint32_t));
+    out_first_index = (uint32_t)(ioff / sizeof(uint16_t));
     if (!use_device_local_) {
         wf::vk::upload_host_visible(device_, vtx_mem_, vbytes, vertices, voff);
         vtx_used_ = std::max(vtx_used_, voff + vbytes);
@@ -0,0 +1,192 @@
+#include "chunk_residency.h"
+
+#include <iostream>
+
+namespace wf {
+
+const char* chunk_residency_state_name(ChunkResidencyState state) {
+    switch (state) {
+        case ChunkResidencyState::kRequested: return "requested";
+        case ChunkResidencyState::kGenerating: return "generating";
+        case ChunkResidencyState::kGenerated: return "generated";
+        case ChunkResidencyState::kMeshing: return "meshing";
+        case ChunkResidencyState::kMeshReady: return "mesh-ready";
+        case ChunkResidencyState::kUploading: return "uploading";
+        case ChunkResidencyState::kResident: return "resident";
+        case ChunkResidencyState::kEvicting: return "evicting";
+    }
+    return "?";
+}
+
+void ChunkResidencyTable::log_transition(const FaceChunkKey& key,
+                                         ChunkResidencyState from,
+                                         ChunkResidencyState to,
+                                         uint64_t gen,
+                                         bool accepted) const {
+#ifndef NDEBUG
+    if (!accepted || trace_.load(std::memory_order_relaxed)) {
+        std::cout << "[residency] " << (accepted ? "" : "rejected ")
+                  << "face=" << key.face << " i=" << key.i << " j=" << key.j << " k=" << key.k
+                  << " " << chunk_residency_state_name(from) << " -> " << chunk_residency_state_name(to)
+                  << " gen=" << gen << "\n";
+    }
+#else
+    (void)key;
+    (void)from;
+    (void)to;
+    (void)gen;
+    (void)accepted;
+#endif
+}
+
+bool ChunkResidencyTable::reject(const FaceChunkKey& key, const Entry* entry, ChunkResidencyState to, uint64_t gen) {
+    ++rejected_;
+    // A missing entry is logged as evicting: the key was forgotten after its release.
+    log_transition(key, entry ? entry->state : ChunkResidencyState::kEvicting, to, gen, false);
+    return false;
+}
+
+void ChunkResidencyTable::set_state(const FaceChunkKey& key, Entry& entry, ChunkResidencyState to) {
+    log_transition(key, entry.state, to, entry.gen, true);
+    entry.state = to;
+}
+
+bool ChunkResidencyTable::request(const FaceChunkKey& key, uint64_t gen) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto [it, inserted] = entries_.try_emplace(key);
+    Entry& entry = it->second;
+    if (inserted) {
+        entry.gen = gen;
+        log_transition(key, ChunkResidencyState::kEvicting, ChunkResidencyState::kRequested, gen, true);
+        return true;
+    }
+    if (gen < entry.gen || entry.state == ChunkResidencyState::kUploading) {
+        return reject(key, &entry, ChunkResidencyState::kRequested, gen);
+    }
+    entry.gen = gen;
+    entry.ticket = 0;
+    set_state(key, entry, ChunkResidencyState::kRequested);
+    return true;
+}
+
+bool ChunkResidencyTable::advance(const FaceChunkKey& key, ChunkResidencyState to, uint64_t gen) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(key);
+    if (it == entries_.end()) return reject(key, nullptr, to, gen);
+    Entry& entry = it->second;
+    bool valid = false;
+    if (to == ChunkResidencyState::kGenerating) {
+        valid = entry.state == ChunkResidencyState::kRequested;
+    } else if (to == ChunkResidencyState::kGenerated) {
+        valid = entry.state == ChunkResidencyState::kRequested || entry.state == ChunkResidencyState::kGenerating;
+    }
+    if (!valid || gen != entry.gen) return reject(key, &entry, to, gen);
+    set_state(key, entry, to);
+    return true;
+}
+
+uint64_t ChunkResidencyTable::begin_mesh(const FaceChunkKey& key, uint64_t gen) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(key);
+    if (it == entries_.end()) {
+        reject(key, nullptr, ChunkResidencyState::kMeshing, gen);
+        return 0;
+    }
+    Entry& entry = it->second;
+    bool valid = entry.state == ChunkResidencyState::kGenerated ||
+                 entry.state == ChunkResidencyState::kMeshing ||
+                 entry.state == ChunkResidencyState::kMeshReady ||
+                 entry.state == ChunkResidencyState::kResident;
+    if (!valid || (gen != 0 && gen != entry.gen)) {
+        reject(key, &entry, ChunkResidencyState::kMeshing, gen);
+        return 0;
+    }
+    entry.ticket = next_ticket_++;
+    set_state(key, entry, ChunkResidencyState::kMeshing);
+    return entry.ticket;
+}
+
+bool ChunkResidencyTable::finish_mesh(const FaceChunkKey& key, uint64_t ticket, bool has_mesh) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ChunkResidencyState to = has_mesh ? ChunkResidencyState::kMeshReady : ChunkResidencyState::kGenerated;
+    auto it = entries_.find(key);
+    if (it == entries_.end()) return reject(key, nullptr, to, 0);
+    Entry& entry = it->second;
+    if (entry.state != ChunkResidencyState::kMeshing || entry.ticket != ticket) {
+        return reject(key, &entry, to, entry.gen);
+    }
+    set_state(key, entry, to);
+    return true;
+}
+
+bool ChunkResidencyTable::begin_upload(const FaceChunkKey& key, uint64_t ticket) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(key);
+    if (it == entries_.end()) return reject(key, nullptr, ChunkResidencyState::kUploading, 0);
+    Entry& entry = it->second;
+    if (entry.state != ChunkResidencyState::kMeshReady || entry.ticket != ticket) {
+        return reject(key, &entry, ChunkResidencyState::kUploading, entry.gen);
+    }
+    set_state(key, entry, ChunkResidencyState::kUploading);
+    return true;
+}
+
+bool ChunkResidencyTable::accepts_upload(const FaceChunkKey& key, uint64_t ticket) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(key);
+    return it != entries_.end() && it->second.state == ChunkResidencyState::kUploading && it->second.ticket == ticket;
+}
+
+bool ChunkResidencyTable::finish_upload(const FaceChunkKey& key, uint64_t ticket, bool uploaded) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ChunkResidencyState to = uploaded ? ChunkResidencyState::kResident : ChunkResidencyState::kGenerated;
+    auto it = entries_.find(key);
+    if (it == entries_.end()) return reject(key, nullptr, to, 0);
+    Entry& entry = it->second;
+    if (entry.state != ChunkResidencyState::kUploading || entry.ticket != ticket) {
+        return reject(key, &entry, to, entry.gen);
+    }
+    set_state(key, entry, to);
+    return true;
+}
+
+void ChunkResidencyTable::begin_evict(const FaceChunkKey& key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(key);
+    if (it == entries_.end() || it->second.state == ChunkResidencyState::kEvicting) return;
+    set_state(key, it->second, ChunkResidencyState::kEvicting);
+}
+
+bool ChunkResidencyTable::finish_evict(const FaceChunkKey& key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(key);
+    if (it == entries_.end()) return true;
+    if (it->second.state != ChunkResidencyState::kEvicting) return false;
+    entries_.erase(it);
+    return true;
+}
+
+bool ChunkResidencyTable::state(const FaceChunkKey& key, ChunkResidencyState& out) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(key);
+    if (it == entries_.end()) return false;
+    out = it->second.state;
+    return true;
+}
+
+ChunkResidencyStats ChunkResidencyTable::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ChunkResidencyStats out{};
+    for (const auto& kv : entries_) {
+        ++out.counts[static_cast<std::size_t>(kv.second.state)];
+    }
+    out.rejected = rejected_;
+    return out;
+}
+
+void ChunkResidencyTable::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_.clear();
+}
+
+} // namespace wf
@@ -2,6 +2,8 @@
 
 #include <algorithm>
 #include <chrono>
+#include <filesystem>
+#include <iostream>
 #include <memory>
 #include <thread>
 #include <utility>
@@ -19,6 +21,75 @@ void ChunkStreamingManager::set_worker_count(std::size_t count) {
     worker_count_hint_ = count;
 }
 
+void ChunkStreamingManager::set_class_threads(std::size_t edit_threads, std::size_t far_threads) {
+    edit_threads_ = edit_threads;
+    far_threads_ = far_threads;
+}
+
+void ChunkStreamingManager::set_io_threads(std::size_t threads, int nice) {
+    io_threads_ = std::max<std::size_t>(1, threads);
+    io_nice_ = nice;
+}
+
+void ChunkStreamingManager::start_worker_pool() {
+    std::size_t near = worker_count_hint_;
+    if (near == 0) {
+        unsigned int hw = std::thread::hardware_concurrency();
+        near = hw == 0 ? 1u : static_cast<std::size_t>(hw);
+    }
+    std::size_t threads[kLoaderClassCount] = {};
+    threads[static_cast<std::size_t>(StreamingClass::kEdit)] = edit_threads_;
+    threads[static_cast<std::size_t>(StreamingClass::kNear)] = near;
+    threads[static_cast<std::size_t>(StreamingClass::kFar)] = far_threads_ > 0 ? far_threads_ : std::max<std::size_t>(1, near / 2);
+    worker_pool_.start(std::span<const std::size_t>(threads, kLoaderClassCount));
+}
+
+void ChunkStreamingManager::start_io_pool() {
+    // Region files have no write locking: flushes never overlap and each schedules one
+    // task per region, so writers never share a file.
+    io_pool_.start(io_threads_, io_nice_);
+    io_threads_running_ = io_threads_;
+    io_nice_running_ = io_nice_;
+    io_pool_started_.store(true, std::memory_order_relaxed);
+}
+
+void ChunkStreamingManager::restart_workers() {
+    // Bumping the generation makes the running ring job bail out at its next check,
+    // so the join inside start() is bounded by one chunk per thread.
+    request_gen_.fetch_add(1, std::memory_order_relaxed);
+    if (io_pool_started_.load(std::memory_order_relaxed) &&
+        (io_threads_ != io_threads_running_ || io_nice_ != io_nice_running_)) {
+        // With the loader joined no ring job waits on a prefetch, so only saves need to finish.
+        worker_pool_.stop();
+        wait_for_pending_saves();
+        start_io_pool();
+    }
+    start_worker_pool();
+}
+
+void ChunkStreamingManager::stop_workers() {
+    request_gen_.fetch_add(1, std::memory_order_relaxed);
+    worker_pool_.stop();
+}
+
+void ChunkStreamingManager::invalidate_generated() {
+    // Joining the aborted job first guarantees nothing stale lands in the caches below.
+    restart_workers();
+    {
+        std::lock_guard<std::mutex> lock(chunk_cache_mutex_);
+        chunk_cache_.clear();
+    }
+    {
+        std::lock_guard<std::mutex> lock(results_mutex_);
+        results_queue_.clear();
+    }
+    {
+        std::lock_guard<std::mutex> lock(remesh_mutex_);
+        remesh_queue_.clear();
+    }
+    residency_.clear();
+}
+
 void ChunkStreamingManager::set_load_job(LoadJob job) {
     std::lock_guard<std::mutex> lock(job_mutex_);
     load_job_ = std::move(job);
@@ -26,22 +97,16 @@ void ChunkStreamingManager::set_load_job(LoadJob job) {
 
 void ChunkStreamingManager::start() {
     stop_flag_.store(false, std::memory_order_relaxed);
-    std::size_t resolved = worker_count_hint_;
-    if (resolved == 0) {
-        unsigned int hw = std::thread::hardware_concurrency();
-        resolved = hw == 0 ? 1u : static_cast<std::size_t>(hw);
-    }
-    worker_pool_.start(resolved);
-    save_pool_.start(1);
-    save_pool_started_.store(true, std::memory_order_relaxed);
+    start_worker_pool();
+    start_io_pool();
 }
 
 void ChunkStreamingManager::stop() {
     stop_flag_.store(true, std::memory_order_relaxed);
     worker_pool_.stop();
     wait_for_pending_saves();
-    save_pool_.stop();
-    save_pool_started_.store(false, std::memory_order_relaxed);
+    io_pool_.stop();
+    io_pool_started_.store(false, std::memory_order_relaxed);
 }
 
 uint64_t ChunkStreamingManager::enqueue_request(LoadRequest req) {
@@ -55,7 +120,8 @@ uint64_t ChunkStreamingManager::enqueue_request(LoadRequest req) {
     }
 
     if (job_copy) {
-        worker_pool_.submit([job_copy, req]() { job_copy(req); });
+        // Ring jobs coordinate their own parallel_for phases; they must not tie up edit workers.
+        worker_pool_.submit(static_cast<std::size_t>(StreamingClass::kNear), [job_copy, req]() { job_copy(req); }, false);
     }
 
     return gen;
@@ -127,10 +193,16 @@ double ChunkStreamingManager::last_total_ms() const {
 }
 
 void ChunkStreamingManager::set_planet_config(const PlanetConfig& cfg) {
+    // The stamp hashes every field, so an unchanged config is never written under running
+    // ring jobs; a changed one needs stop_workers() first.
+    const GeneratorStamp stamp = generator_stamp(cfg);
+    if (stamp == stamp_) return;
     planet_cfg_ = cfg;
+    stamp_ = stamp;
 }
 
 void ChunkStreamingManager::set_region_root(std::string root) {
+    if (root == region_root_) return;
     region_root_ = std::move(root);
 }
 
@@ -206,6 +278,7 @@ void ChunkStreamingManager::overlay_chunk_delta(const FaceChunkKey& key, Chunk64
         std::scoped_lock lock(chunk_delta_mutex_);
         auto it = chunk_deltas_.find(key);
         if (it != chunk_deltas_.end()) {
+            if (it->second.base != stamp_) resolve_stale_delta(key, it->second, chunk);
             normalize_chunk_delta_representation(it->second);
             if (!it->second.empty()) apply_chunk_delta(it->second, chunk);
             return;
@@ -214,11 +287,14 @@ void ChunkStreamingManager::overlay_chunk_delta(const FaceChunkKey& key, Chunk64
 
     ChunkDelta delta;
     if (!RegionIO::load_chunk_delta(key, delta, 32, region_root_)) {
+        ChunkDelta fresh;
+        fresh.base = stamp_;
         std::scoped_lock lock(chunk_delta_mutex_);
-        chunk_deltas_.emplace(key, ChunkDelta{});
+        chunk_deltas_.emplace(key, std::move(fresh));
         return;
     }
 
+    if (delta.base != stamp_) resolve_stale_delta(key, delta, chunk);
     normalize_chunk_delta_representation(delta);
     if (!delta.empty()) apply_chunk_delta(delta, chunk);
     {
@@ -227,16 +303,106 @@ void ChunkStreamingManager::overlay_chunk_delta(const FaceChunkKey& key, Chunk64
     }
 }
 
+void ChunkStreamingManager::prefetch_chunk_deltas(std::span<const FaceChunkKey> keys) {
+    std::vector<FaceChunkKey> missing;
+    {
+        std::scoped_lock lock(chunk_delta_mutex_);
+        for (const FaceChunkKey& key : keys) {
+            if (!chunk_deltas_.count(key)) missing.push_back(key);
+        }
+    }
+    if (missing.empty()) return;
+
+    std::vector<std::optional<ChunkDelta>> loaded;
+    RegionIO::load_chunk_deltas(missing, loaded, 32, region_root_);
+    // Stale deltas are resolved by the overlay, which has the base chunk to rebase against.
+    std::scoped_lock lock(chunk_delta_mutex_);
+    for (std::size_t i = 0; i < missing.size(); ++i) {
+        if (loaded[i]) {
+            chunk_deltas_.try_emplace(missing[i], std::move(*loaded[i]));
+        } else {
+            ChunkDelta fresh;
+            fresh.base = stamp_;
+            chunk_deltas_.try_emplace(missing[i], std::move(fresh));
+        }
+    }
+}
+
+std::future<void> ChunkStreamingManager::prefetch_chunk_deltas_async(std::vector<FaceChunkKey> keys) {
+    auto done = std::make_shared<std::promise<void>>();
+    std::future<void> future = done->get_future();
+    if (!io_pool_started_.load(std::memory_order_relaxed)) {
+        prefetch_chunk_deltas(keys);
+        done->set_value();
+        return future;
+    }
+    io_pool_.submit([this, done, keys = std::move(keys)]() {
+        prefetch_chunk_deltas(keys);
+        done->set_value();
+    });
+    return future;
+}
+
+void ChunkStreamingManager::may_have_chunk_deltas(std::span<const FaceChunkKey> keys, std::vector<uint8_t>& out) const {
+    out.assign(keys.size(), 0);
+    std::vector<std::size_t> unknown;
+    {
+        std::scoped_lock lock(chunk_delta_mutex_);
+        for (std::size_t i = 0; i < keys.size(); ++i) {
+            auto it = chunk_deltas_.find(keys[i]);
+            if (it == chunk_deltas_.end()) unknown.push_back(i);
+            else out[i] = it->second.empty() ? 0 : 1;
+        }
+    }
+    // Region files are per shell and 32x32 columns; look each one up once.
+    std::unordered_map<FaceChunkKey, uint8_t, FaceChunkKeyHash> regions;
+    for (std::size_t i : unknown) {
+        std::int64_t i0 = 0, j0 = 0;
+        int ti = 0, tj = 0;
+        RegionIO::region_coords(keys[i], 32, i0, j0, ti, tj);
+        auto [it, fresh] = regions.try_emplace(FaceChunkKey{keys[i].face, i0, j0, keys[i].k}, 0);
+        if (fresh) {
+            std::error_code ec;
+            it->second = std::filesystem::exists(RegionIO::region_path(keys[i], 32, region_root_), ec) ? 1 : 0;
+        }
+        out[i] = it->second;
+    }
+}
+
+void ChunkStreamingManager::resolve_stale_delta(const FaceChunkKey& key, ChunkDelta& delta, const Chunk64& base) {
+    if (delta.empty()) {
+        delta.base = stamp_;
+        return;
+    }
+    if (rebase_stale_deltas_.load(std::memory_order_relaxed)) {
+        uint32_t dropped = rebase_chunk_delta(delta, base, stamp_);
+        if (log_stream_.load(std::memory_order_relaxed)) {
+            std::cout << "[stream] rebased stale delta face=" << key.face << " i=" << key.i << " j=" << key.j << " k=" << key.k
+                      << " dropped=" << dropped << " kept=" << delta.override_count << "\n";
+        }
+        return;
+    }
+    // Refused: the stale overrides are not applied and stay on disk until this chunk is edited again
+    std::cout << "[stream] refusing stale delta face=" << key.face << " i=" << key.i << " j=" << key.j << " k=" << key.k
+              << " generator=" << delta.base.generator_version << " config=0x" << std::hex << delta.base.config_hash << std::dec << "\n";
+    delta.clear();
+    delta.base = stamp_;
+}
+
 void ChunkStreamingManager::flush_dirty_chunk_deltas() {
     if (!save_chunks_enabled_) return;
+    wait_for_pending_saves();
 
-    std::vector<std::pair<FaceChunkKey, ChunkDelta>> pending;
+    // Only the copy happens under the lock; edits resume while the regions are written.
+    std::unordered_map<std::string, RegionSaveBatch> regions;
     {
         std::scoped_lock lock(chunk_delta_mutex_);
         for (auto& kv : chunk_deltas_) {
             ChunkDelta& delta = kv.second;
             if (!delta.dirty) continue;
-            pending.emplace_back(kv.first, delta);
+            // Created by an edit before any overlay: recorded against the current base
+            if (!delta.base.known()) delta.base = stamp_;
+            regions[RegionIO::region_path(kv.first, 32, region_root_)].emplace_back(kv.first, delta);
             delta.dirty = false;
             if (!delta.dirty_mask.empty()) {
                 std::fill(delta.dirty_mask.begin(), delta.dirty_mask.end(), 0ull);
@@ -244,32 +410,55 @@ void ChunkStreamingManager::flush_dirty_chunk_deltas() {
         }
     }
 
-    if (pending.empty()) return;
+    if (regions.empty()) return;
+    if (log_stream_.load(std::memory_order_relaxed)) {
+        std::size_t count = 0;
+        for (const auto& kv : regions) count += kv.second.size();
+        std::cout << "[stream] saving " << count << " deltas in " << regions.size() << " regions\n";
+    }
 
-    if (!save_pool_started_.load(std::memory_order_relaxed)) {
-        for (auto& pair : pending) {
-            FaceChunkKey key = pair.first;
-            ChunkDelta& delta = pair.second;
-            normalize_chunk_delta_representation(delta);
-            RegionIO::save_chunk_delta(key, delta, 32, region_root_);
-        }
+    if (!io_pool_started_.load(std::memory_order_relaxed)) {
+        for (auto& kv : regions) save_region_batch(kv.second);
         return;
     }
 
-    auto batch = std::make_shared<std::vector<std::pair<FaceChunkKey, ChunkDelta>>>(std::move(pending));
-    save_pool_.submit([this, batch]() {
-        for (auto& pair : *batch) {
-            FaceChunkKey key = pair.first;
-            ChunkDelta& delta = pair.second;
-            normalize_chunk_delta_representation(delta);
-            RegionIO::save_chunk_delta(key, delta, 32, region_root_);
-        }
-    });
+    for (auto& kv : regions) {
+        auto batch = std::make_shared<RegionSaveBatch>(std::move(kv.second));
+        saves_in_flight_.fetch_add(1, std::memory_order_relaxed);
+        io_pool_.submit([this, batch]() {
+            save_region_batch(*batch);
+            saves_in_flight_.fetch_sub(1, std::memory_order_release);
+        });
+    }
+}
+
+void ChunkStreamingManager::save_region_batch(const RegionSaveBatch& batch) {
+    RegionSaveBatch normalized = batch;
+    for (auto& pair : normalized) normalize_chunk_delta_representation(pair.second);
+    if (RegionIO::save_region_deltas(normalized, 32, region_root_)) return;
+
+    // The old region is intact; mark the keys dirty again so the next flush retries.
+    std::cout << "[stream] region save failed: " << RegionIO::region_path(batch.front().first, 32, region_root_) << "\n";
+    std::scoped_lock lock(chunk_delta_mutex_);
+    for (const auto& pair : batch) {
+        auto it = chunk_deltas_.find(pair.first);
+        if (it != chunk_deltas_.end()) it->second.dirty = true;
+    }
+}
+
+void ChunkStreamingManager::tick_autosave() {
+    if (!save_chunks_enabled_ || autosave_interval_s_ <= 0.0) return;
+    auto now = std::chrono::steady_clock::now();
+    if (std::chrono::duration<double>(now - last_autosave_).count() < autosave_interval_s_) return;
+    // A flush still writing is left alone; the next tick tries again.
+    if (saves_in_flight_.load(std::memory_order_acquire) > 0) return;
+    last_autosave_ = now;
+    flush_dirty_chunk_deltas();
 }
 
 void ChunkStreamingManager::wait_for_pending_saves() {
     using namespace std::chrono_literals;
-    while (save_pool_started_.load(std::memory_order_relaxed) && !save_pool_.idle()) {
+    while (saves_in_flight_.load(std::memory_order_acquire) > 0) {
         std::this_thread::sleep_for(1ms);
     }
 }
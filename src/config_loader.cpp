@@ -10,6 +10,7 @@
 #include <optional>
 #include <string>
 #include <tuple>
+#include <utility>
 
 namespace wf {
 namespace {
@@ -93,6 +94,8 @@ bool apply_file_overrides(const std::string& path, AppConfig& cfg) {
             else if (key == "terrain_octaves") { cfg.planet_cfg.terrain_octaves = std::max(1, std::stoi(val)); std::cout << "[config] terrain_octaves=" << cfg.planet_cfg.terrain_octaves << " (file)\n"; }
             else if (key == "terrain_lacunarity") { cfg.planet_cfg.terrain_lacunarity = std::stof(val); std::cout << "[config] terrain_lacunarity=" << cfg.planet_cfg.terrain_lacunarity << " (file)\n"; }
             else if (key == "terrain_gain") { cfg.planet_cfg.terrain_gain = std::stof(val); std::cout << "[config] terrain_gain=" << cfg.planet_cfg.terrain_gain << " (file)\n"; }
+            else if (key == "terrain_noise") { if (parse_noise_basis(lower(val), cfg.planet_cfg.terrain_noise)) std::cout << "[config] terrain_noise=" << noise_basis_name(cfg.planet_cfg.terrain_noise) << " (file)\n"; }
+            else if (key == "terrain_warp") { cfg.planet_cfg.terrain_warp = std::max(0.0f, std::stof(val)); std::cout << "[config] terrain_warp=" << cfg.planet_cfg.terrain_warp << " (file)\n"; }
             else if (key == "planet_seed") { cfg.planet_cfg.seed = static_cast<uint32_t>(std::stoul(val)); std::cout << "[config] planet_seed=" << cfg.planet_cfg.seed << " (file)\n"; }
             else if (key == "radius_m") { cfg.planet_cfg.radius_m = std::stod(val); std::cout << "[config] radius_m=" << cfg.planet_cfg.radius_m << " (file)\n"; }
             else if (key == "sea_level_m") { cfg.planet_cfg.sea_level_m = std::stod(val); std::cout << "[config] sea_level_m=" << cfg.planet_cfg.sea_level_m << " (file)\n"; }
@@ -101,6 +104,9 @@ bool apply_file_overrides(const std::string& path, AppConfig& cfg) {
             else if (key == "ring_radius") { cfg.ring_radius = std::max(0, std::stoi(val)); std::cout << "[config] ring_radius=" << cfg.ring_radius << " (file)\n"; }
             else if (key == "prune_margin") { cfg.prune_margin = std::max(0, std::stoi(val)); std::cout << "[config] prune_margin=" << cfg.prune_margin << " (file)\n"; }
             else if (key == "cull") { cfg.cull_enabled = parse_bool(val, cfg.cull_enabled); std::cout << "[config] cull=" << (cfg.cull_enabled ? "true" : "false") << " (file)\n"; }
+            else if (key == "gpu_cull") { cfg.gpu_cull = parse_bool(val, cfg.gpu_cull); std::cout << "[config] gpu_cull=" << (cfg.gpu_cull ? "true" : "false") << " (file)\n"; }
+            else if (key == "gpu_cull_check") { cfg.gpu_cull_check = parse_bool(val, cfg.gpu_cull_check); std::cout << "[config] gpu_cull_check=" << (cfg.gpu_cull_check ? "true" : "false") << " (file)\n"; }
+            else if (key == "draw_sort") { cfg.draw_sort = parse_bool(val, cfg.draw_sort); std::cout << "[config] draw_sort=" << (cfg.draw_sort ? "true" : "false") << " (file)\n"; }
             else if (key == "draw_stats") { cfg.draw_stats_enabled = parse_bool(val, cfg.draw_stats_enabled); std::cout << "[config] draw_stats=" << (cfg.draw_stats_enabled ? "true" : "false") << " (file)\n"; }
             else if (key == "hud_scale") { cfg.hud_scale = std::stof(val); std::cout << "[config] hud_scale=" << cfg.hud_scale << " (file)\n"; }
             else if (key == "hud_shadow") { cfg.hud_shadow = parse_bool(val, cfg.hud_shadow); std::cout << "[config] hud_shadow=" << (cfg.hud_shadow ? "true" : "false") << " (file)\n"; }
@@ -108,6 +114,8 @@ bool apply_file_overrides(const std::string& path, AppConfig& cfg) {
             else if (key == "log_stream") { cfg.log_stream = parse_bool(val, cfg.log_stream); std::cout << "[config] log_stream=" << (cfg.log_stream ? "true" : "false") << " (file)\n"; }
             else if (key == "log_pool") { cfg.log_pool = parse_bool(val, cfg.log_pool); std::cout << "[config] log_pool=" << (cfg.log_pool ? "true" : "false") << " (file)\n"; }
             else if (key == "save_chunks") { cfg.save_chunks_enabled = parse_bool(val, cfg.save_chunks_enabled); std::cout << "[config] save_chunks=" << (cfg.save_chunks_enabled ? "true" : "false") << " (file)\n"; }
+            else if (key == "rebase_stale_deltas") { cfg.rebase_stale_deltas = parse_bool(val, cfg.rebase_stale_deltas); std::cout << "[config] rebase_stale_deltas=" << (cfg.rebase_stale_deltas ? "true" : "false") << " (file)\n"; }
+            else if (key == "autosave_sec") { cfg.autosave_sec = std::max(0.0f, std::stof(val)); std::cout << "[config] autosave_sec=" << cfg.autosave_sec << " (file)\n"; }
             else if (key == "debug_chunk_keys") { cfg.debug_chunk_keys = parse_bool(val, cfg.debug_chunk_keys); std::cout << "[config] debug_chunk_keys=" << (cfg.debug_chunk_keys ? "true" : "false") << " (file)\n"; }
             else if (key == "profile_csv") { cfg.profile_csv_enabled = parse_bool(val, cfg.profile_csv_enabled); std::cout << "[config] profile_csv=" << (cfg.profile_csv_enabled ? "true" : "false") << " (file)\n"; }
             else if (key == "profile_csv_path") { cfg.profile_csv_path = val; std::cout << "[config] profile_csv_path=" << cfg.profile_csv_path << " (file)\n"; }
@@ -116,6 +124,11 @@ bool apply_file_overrides(const std::string& path, AppConfig& cfg) {
             else if (key == "pool_idx_mb") { cfg.pool_idx_mb = std::max(1, std::stoi(val)); std::cout << "[config] pool_idx_mb=" << cfg.pool_idx_mb << " (file)\n"; }
             else if (key == "uploads_per_frame") { cfg.uploads_per_frame_limit = std::max(1, std::stoi(val)); std::cout << "[config] uploads_per_frame=" << cfg.uploads_per_frame_limit << " (file)\n"; }
             else if (key == "loader_threads") { cfg.loader_threads = std::max(0, std::stoi(val)); std::cout << "[config] loader_threads=" << cfg.loader_threads << " (file)\n"; }
+            else if (key == "edit_threads") { cfg.edit_threads = std::max(0, std::stoi(val)); std::cout << "[config] edit_threads=" << cfg.edit_threads << " (file)\n"; }
+            else if (key == "far_threads") { cfg.far_threads = std::max(0, std::stoi(val)); std::cout << "[config] far_threads=" << cfg.far_threads << " (file)\n"; }
+            else if (key == "io_threads") { cfg.io_threads = std::max(1, std::stoi(val)); std::cout << "[config] io_threads=" << cfg.io_threads << " (file)\n"; }
+            else if (key == "io_nice") { cfg.io_nice = std::clamp(std::stoi(val), -20, 19); std::cout << "[config] io_nice=" << cfg.io_nice << " (file)\n"; }
+            else if (key == "record_threads") { cfg.record_threads = std::max(-1, std::stoi(val)); std::cout << "[config] record_threads=" << cfg.record_threads << " (file)\n"; }
             else if (key == "k_down") { cfg.k_down = std::max(0, std::stoi(val)); std::cout << "[config] k_down=" << cfg.k_down << " (file)\n"; }
             else if (key == "k_up") { cfg.k_up = std::max(0, std::stoi(val)); std::cout << "[config] k_up=" << cfg.k_up << " (file)\n"; }
             else if (key == "k_prune_margin") { cfg.k_prune_margin = std::max(0, std::stoi(val)); std::cout << "[config] k_prune_margin=" << cfg.k_prune_margin << " (file)\n"; }
@@ -143,6 +156,12 @@ void apply_env_overrides(AppConfig& cfg) {
     apply_env_value("WF_TERRAIN_OCTAVES", cfg.planet_cfg.terrain_octaves, [&](const char* s) { cfg.planet_cfg.terrain_octaves = std::max(1, std::stoi(s)); });
     apply_env_value("WF_TERRAIN_LACUNARITY", cfg.planet_cfg.terrain_lacunarity, [&](const char* s) { cfg.planet_cfg.terrain_lacunarity = std::stof(s); });
     apply_env_value("WF_TERRAIN_GAIN", cfg.planet_cfg.terrain_gain, [&](const char* s) { cfg.planet_cfg.terrain_gain = std::stof(s); });
+    if (const char* s = std::getenv("WF_TERRAIN_NOISE")) {
+        if (parse_noise_basis(lower(s), cfg.planet_cfg.terrain_noise)) {
+            std::cout << "[config] WF_TERRAIN_NOISE=" << noise_basis_name(cfg.planet_cfg.terrain_noise) << " (env)\n";
+        }
+    }
+    apply_env_value("WF_TERRAIN_WARP", cfg.planet_cfg.terrain_warp, [&](const char* s) { cfg.planet_cfg.terrain_warp = std::max(0.0f, std::stof(s)); });
     apply_env_value("WF_PLANET_SEED", cfg.planet_cfg.seed, [&](const char* s) { cfg.planet_cfg.seed = static_cast<uint32_t>(std::stoul(s)); });
     apply_env_value("WF_RADIUS_M", cfg.planet_cfg.radius_m, [&](const char* s) { cfg.planet_cfg.radius_m = std::stod(s); });
     apply_env_value("WF_SEA_LEVEL_M", cfg.planet_cfg.sea_level_m, [&](const char* s) { cfg.planet_cfg.sea_level_m = std::stod(s); });
@@ -161,10 +180,15 @@ void apply_env_overrides(AppConfig& cfg) {
     apply_env_value("WF_RING_RADIUS", cfg.ring_radius, [&](const char* s) { cfg.ring_radius = std::max(0, std::stoi(s)); });
     apply_env_value("WF_PRUNE_MARGIN", cfg.prune_margin, [&](const char* s) { cfg.prune_margin = std::max(0, std::stoi(s)); });
     apply_env_bool("WF_CULL", cfg.cull_enabled);
+    apply_env_bool("WF_GPU_CULL", cfg.gpu_cull);
+    apply_env_bool("WF_GPU_CULL_CHECK", cfg.gpu_cull_check);
+    apply_env_bool("WF_DRAW_SORT", cfg.draw_sort);
     apply_env_bool("WF_DRAW_STATS", cfg.draw_stats_enabled);
     apply_env_bool("WF_LOG_STREAM", cfg.log_stream);
     apply_env_bool("WF_LOG_POOL", cfg.log_pool);
     apply_env_bool("WF_SAVE_CHUNKS", cfg.save_chunks_enabled);
+    apply_env_bool("WF_REBASE_STALE_DELTAS", cfg.rebase_stale_deltas);
+    apply_env_value("WF_AUTOSAVE_SEC", cfg.autosave_sec, [&](const char* s) { cfg.autosave_sec = std::max(0.0f, std::stof(s)); });
     apply_env_bool("WF_DEBUG_CHUNK_KEYS", cfg.debug_chunk_keys);
     apply_env_value("WF_PROFILE_CSV", cfg.profile_csv_enabled, [&](const char* s) { cfg.profile_csv_enabled = parse_bool(s, cfg.profile_csv_enabled); });
     apply_env_value("WF_PROFILE_CSV_PATH", cfg.profile_csv_path, [&](const char* s) { cfg.profile_csv_path = s; });
@@ -175,6 +199,11 @@ void apply_env_overrides(AppConfig& cfg) {
 
     apply_env_value("WF_UPLOADS_PER_FRAME", cfg.uploads_per_frame_limit, [&](const char* s) { cfg.uploads_per_frame_limit = std::max(1, std::stoi(s)); });
     apply_env_value("WF_LOADER_THREADS", cfg.loader_threads, [&](const char* s) { cfg.loader_threads = std::max(0, std::stoi(s)); });
+    apply_env_value("WF_EDIT_THREADS", cfg.edit_threads, [&](const char* s) { cfg.edit_threads = std::max(0, std::stoi(s)); });
+    apply_env_value("WF_FAR_THREADS", cfg.far_threads, [&](const char* s) { cfg.far_threads = std::max(0, std::stoi(s)); });
+    apply_env_value("WF_IO_THREADS", cfg.io_threads, [&](const char* s) { cfg.io_threads = std::max(1, std::stoi(s)); });
+    apply_env_value("WF_IO_NICE", cfg.io_nice, [&](const char* s) { cfg.io_nice = std::clamp(std::stoi(s), -20, 19); });
+    apply_env_value("WF_RECORD_THREADS", cfg.record_threads, [&](const char* s) { cfg.record_threads = std::max(-1, std::stoi(s)); });
     apply_env_value("WF_K_DOWN", cfg.k_down, [&](const char* s) { cfg.k_down = std::max(0, std::stoi(s)); });
     apply_env_value("WF_K_UP", cfg.k_up, [&](const char* s) { cfg.k_up = std::max(0, std::stoi(s)); });
     apply_env_value("WF_K_PRUNE_MARGIN", cfg.k_prune_margin, [&](const char* s) { cfg.k_prune_margin = std::max(0, std::stoi(s)); });
@@ -210,6 +239,8 @@ void write_config_file(std::ostream& out, const AppConfig& cfg) {
     out << "terrain_octaves=" << cfg.planet_cfg.terrain_octaves << '\n';
     out << "terrain_lacunarity=" << cfg.planet_cfg.terrain_lacunarity << '\n';
     out << "terrain_gain=" << cfg.planet_cfg.terrain_gain << '\n';
+    out << "terrain_noise=" << noise_basis_name(cfg.planet_cfg.terrain_noise) << '\n';
+    out << "terrain_warp=" << cfg.planet_cfg.terrain_warp << '\n';
     out << "planet_seed=" << cfg.planet_cfg.seed << '\n';
     out << "radius_m=" << cfg.planet_cfg.radius_m << '\n';
     out << "sea_level_m=" << cfg.planet_cfg.sea_level_m << '\n';
@@ -219,6 +250,9 @@ void write_config_file(std::ostream& out, const AppConfig& cfg) {
     out << "ring_radius=" << cfg.ring_radius << '\n';
     out << "prune_margin=" << cfg.prune_margin << '\n';
     out << "cull=" << bool_string(cfg.cull_enabled) << '\n';
+    out << "gpu_cull=" << bool_string(cfg.gpu_cull) << '\n';
+    out << "gpu_cull_check=" << bool_string(cfg.gpu_cull_check) << '\n';
+    out << "draw_sort=" << bool_string(cfg.draw_sort) << '\n';
     out << "draw_stats=" << bool_string(cfg.draw_stats_enabled) << '\n';
 
     out << "hud_scale=" << cfg.hud_scale << '\n';
@@ -228,6 +262,8 @@ void write_config_file(std::ostream& out, const AppConfig& cfg) {
     out << "log_stream=" << bool_string(cfg.log_stream) << '\n';
     out << "log_pool=" << bool_string(cfg.log_pool) << '\n';
     out << "save_chunks=" << bool_string(cfg.save_chunks_enabled) << '\n';
+    out << "rebase_stale_deltas=" << bool_string(cfg.rebase_stale_deltas) << '\n';
+    out << "autosave_sec=" << cfg.autosave_sec << '\n';
     out << "debug_chunk_keys=" << bool_string(cfg.debug_chunk_keys) << '\n';
     out << "profile_csv=" << bool_string(cfg.profile_csv_enabled) << '\n';
     out << "profile_csv_path=" << cfg.profile_csv_path << '\n';
@@ -238,6 +274,11 @@ void write_config_file(std::ostream& out, const AppConfig& cfg) {
 
     out << "uploads_per_frame=" << cfg.uploads_per_frame_limit << '\n';
     out << "loader_threads=" << cfg.loader_threads << '\n';
+    out << "edit_threads=" << cfg.edit_threads << '\n';
+    out << "far_threads=" << cfg.far_threads << '\n';
+    out << "io_threads=" << cfg.io_threads << '\n';
+    out << "io_nice=" << cfg.io_nice << '\n';
+    out << "record_threads=" << cfg.record_threads << '\n';
     out << "k_down=" << cfg.k_down << '\n';
     out << "k_up=" << cfg.k_up << '\n';
     out << "k_prune_margin=" << cfg.k_prune_margin << '\n';
@@ -256,7 +297,9 @@ bool configs_equal(const AppConfig& a, const AppConfig& b) {
                         p.terrain_freq,
                         p.terrain_octaves,
                         p.terrain_lacunarity,
-                        p.terrain_gain);
+                        p.terrain_gain,
+                        p.terrain_noise,
+                        p.terrain_warp);
     };
 
     if (tie_planet(a.planet_cfg) != tie_planet(b.planet_cfg)) {
@@ -266,22 +309,22 @@ bool configs_equal(const AppConfig& a, const AppConfig& b) {
     return std::tie(a.invert_mouse_x, a.invert_mouse_y, a.cam_sensitivity, a.cam_speed,
                     a.fov_deg, a.near_m, a.far_m, a.walk_mode, a.eye_height_m, a.walk_speed,
                     a.walk_pitch_max_deg, a.walk_surface_bias_m, a.surface_push_m,
-                    a.use_chunk_renderer, a.ring_radius, a.prune_margin, a.cull_enabled,
+                    a.use_chunk_renderer, a.ring_radius, a.prune_margin, a.cull_enabled, a.gpu_cull, a.gpu_cull_check, a.draw_sort,
                     a.draw_stats_enabled, a.hud_scale, a.hud_shadow, a.hud_shadow_offset_px,
-                    a.log_stream, a.log_pool, a.save_chunks_enabled, a.debug_chunk_keys,
+                    a.log_stream, a.log_pool, a.save_chunks_enabled, a.rebase_stale_deltas, a.autosave_sec, a.debug_chunk_keys,
                     a.profile_csv_enabled, a.profile_csv_path, a.device_local_enabled,
-                    a.pool_vtx_mb, a.pool_idx_mb, a.uploads_per_frame_limit, a.loader_threads,
+                    a.pool_vtx_mb, a.pool_idx_mb, a.uploads_per_frame_limit, a.loader_threads, a.edit_threads, a.far_threads, a.io_threads, a.io_nice, a.record_threads,
                     a.k_down, a.k_up, a.k_prune_margin, a.face_keep_time_cfg_s,
                     a.region_root, a.config_path)
            ==
            std::tie(b.invert_mouse_x, b.invert_mouse_y, b.cam_sensitivity, b.cam_speed,
                     b.fov_deg, b.near_m, b.far_m, b.walk_mode, b.eye_height_m, b.walk_speed,
                     b.walk_pitch_max_deg, b.walk_surface_bias_m, b.surface_push_m,
-                    b.use_chunk_renderer, b.ring_radius, b.prune_margin, b.cull_enabled,
+                    b.use_chunk_renderer, b.ring_radius, b.prune_margin, b.cull_enabled, b.gpu_cull, b.gpu_cull_check, b.draw_sort,
                     b.draw_stats_enabled, b.hud_scale, b.hud_shadow, b.hud_shadow_offset_px,
-                    b.log_stream, b.log_pool, b.save_chunks_enabled, b.debug_chunk_keys,
+                    b.log_stream, b.log_pool, b.save_chunks_enabled, b.rebase_stale_deltas, b.autosave_sec, b.debug_chunk_keys,
                     b.profile_csv_enabled, b.profile_csv_path, b.device_local_enabled,
-                    b.pool_vtx_mb, b.pool_idx_mb, b.uploads_per_frame_limit, b.loader_threads,
+                    b.pool_vtx_mb, b.pool_idx_mb, b.uploads_per_frame_limit, b.loader_threads, b.edit_threads, b.far_threads, b.io_threads, b.io_nice, b.record_threads,
                     b.k_down, b.k_up, b.k_prune_margin, b.face_keep_time_cfg_s,
                     b.region_root, b.config_path);
 }
@@ -292,6 +335,136 @@ bool operator==(const AppConfig& a, const AppConfig& b) {
     return configs_equal(a, b);
 }
 
+AppConfigDiff diff_configs(const AppConfig& a, const AppConfig& b) {
+    AppConfigDiff diff;
+    auto check = [&](const char* key, bool changed, bool& group) {
+        if (!changed) return;
+        diff.fields.push_back(key);
+        group = true;
+    };
+
+    check("invert_mouse_x", a.invert_mouse_x != b.invert_mouse_x, diff.camera);
+    check("invert_mouse_y", a.invert_mouse_y != b.invert_mouse_y, diff.camera);
+    check("mouse_sensitivity", a.cam_sensitivity != b.cam_sensitivity, diff.camera);
+    check("move_speed", a.cam_speed != b.cam_speed, diff.camera);
+    check("fov_deg", a.fov_deg != b.fov_deg, diff.camera);
+    check("near_m", a.near_m != b.near_m, diff.camera);
+    check("far_m", a.far_m != b.far_m, diff.camera);
+    check("walk_mode", a.walk_mode != b.walk_mode, diff.camera);
+    check("eye_height", a.eye_height_m != b.eye_height_m, diff.camera);
+    check("walk_speed", a.walk_speed != b.walk_speed, diff.camera);
+    check("walk_pitch_max_deg", a.walk_pitch_max_deg != b.walk_pitch_max_deg, diff.camera);
+    check("walk_surface_bias_m", a.walk_surface_bias_m != b.walk_surface_bias_m, diff.camera);
+    check("surface_push_m", a.surface_push_m != b.surface_push_m, diff.remesh);
+
+    const PlanetConfig& pa = a.planet_cfg;
+    const PlanetConfig& pb = b.planet_cfg;
+    check("terrain_amp_m", pa.terrain_amp_m != pb.terrain_amp_m, diff.terrain);
+    check("terrain_freq", pa.terrain_freq != pb.terrain_freq, diff.terrain);
+    check("terrain_octaves", pa.terrain_octaves != pb.terrain_octaves, diff.terrain);
+    check("terrain_lacunarity", pa.terrain_lacunarity != pb.terrain_lacunarity, diff.terrain);
+    check("terrain_gain", pa.terrain_gain != pb.terrain_gain, diff.terrain);
+    check("terrain_noise", pa.terrain_noise != pb.terrain_noise, diff.terrain);
+    check("terrain_warp", pa.terrain_warp != pb.terrain_warp, diff.terrain);
+    check("planet_seed", pa.seed != pb.seed, diff.terrain);
+    check("radius_m", pa.radius_m != pb.radius_m, diff.terrain);
+    check("sea_level_m", pa.sea_level_m != pb.sea_level_m, diff.terrain);
+    check("voxel_size_m", pa.voxel_size_m != pb.voxel_size_m, diff.terrain);
+
+    check("use_chunk_renderer", a.use_chunk_renderer != b.use_chunk_renderer, diff.render);
+    check("ring_radius", a.ring_radius != b.ring_radius, diff.ring);
+    check("prune_margin", a.prune_margin != b.prune_margin, diff.ring);
+    check("cull", a.cull_enabled != b.cull_enabled, diff.render);
+    check("gpu_cull", a.gpu_cull != b.gpu_cull, diff.render);
+    check("gpu_cull_check", a.gpu_cull_check != b.gpu_cull_check, diff.render);
+    check("draw_sort", a.draw_sort != b.draw_sort, diff.render);
+    check("draw_stats", a.draw_stats_enabled != b.draw_stats_enabled, diff.render);
+
+    check("hud_scale", a.hud_scale != b.hud_scale, diff.render);
+    check("hud_shadow", a.hud_shadow != b.hud_shadow, diff.render);
+    check("hud_shadow_offset", a.hud_shadow_offset_px != b.hud_shadow_offset_px, diff.render);
+
+    check("log_stream", a.log_stream != b.log_stream, diff.render);
+    check("log_pool", a.log_pool != b.log_pool, diff.render);
+    check("save_chunks", a.save_chunks_enabled != b.save_chunks_enabled, diff.storage);
+    check("rebase_stale_deltas", a.rebase_stale_deltas != b.rebase_stale_deltas, diff.storage);
+    check("autosave_sec", a.autosave_sec != b.autosave_sec, diff.storage);
+    check("debug_chunk_keys", a.debug_chunk_keys != b.debug_chunk_keys, diff.render);
+    check("profile_csv", a.profile_csv_enabled != b.profile_csv_enabled, diff.render);
+    check("profile_csv_path", a.profile_csv_path != b.profile_csv_path, diff.render);
+
+    check("device_local", a.device_local_enabled != b.device_local_enabled, diff.pools);
+    check("pool_vtx_mb", a.pool_vtx_mb != b.pool_vtx_mb, diff.pools);
+    check("pool_idx_mb", a.pool_idx_mb != b.pool_idx_mb, diff.pools);
+
+    check("uploads_per_frame", a.uploads_per_frame_limit != b.uploads_per_frame_limit, diff.render);
+    check("loader_threads", a.loader_threads != b.loader_threads, diff.loader_threads);
+    check("edit_threads", a.edit_threads != b.edit_threads, diff.loader_threads);
+    check("far_threads", a.far_threads != b.far_threads, diff.loader_threads);
+    check("io_threads", a.io_threads != b.io_threads, diff.loader_threads);
+    check("io_nice", a.io_nice != b.io_nice, diff.loader_threads);
+    check("record_threads", a.record_threads != b.record_threads, diff.render);
+    check("k_down", a.k_down != b.k_down, diff.ring);
+    check("k_up", a.k_up != b.k_up, diff.ring);
+    check("k_prune_margin", a.k_prune_margin != b.k_prune_margin, diff.ring);
+    check("face_keep_sec", a.face_keep_time_cfg_s != b.face_keep_time_cfg_s, diff.ring);
+
+    check("region_root", a.region_root != b.region_root, diff.storage);
+    check("config_path", a.config_path != b.config_path, diff.storage);
+
+    // Growing the ring around the same center only needs the new outer tiles.
+    diff.ring_grew_only = b.ring_radius > a.ring_radius && a.k_down == b.k_down && a.k_up == b.k_up;
+    return diff;
+}
+
+StreamingDiffPlan plan_streaming_diff(const AppConfigDiff& diff, const AppConfig& before, const AppConfig& after,
+                                      bool loader_busy) {
+    StreamingDiffPlan plan;
+    if (diff.terrain) {
+        // Invalidation restarts the loader and restreams everything; nothing else applies.
+        plan.stop_loader = true;
+        plan.invalidate = true;
+        return plan;
+    }
+    auto request_delta = [&](int keep) {
+        plan.ring_delta_keep = plan.ring_delta_keep ? std::min(*plan.ring_delta_keep, keep) : keep;
+    };
+    if (diff.loader_threads) {
+        plan.restart_loader = true;
+        // The restart aborts the running ring job; its tiles must be requested again.
+        if (loader_busy) request_delta(-1);
+    }
+    if (diff.ring) {
+        const bool k_changed = before.k_down != after.k_down || before.k_up != after.k_up;
+        if (diff.ring_grew_only) {
+            request_delta(before.ring_radius);
+        } else if (k_changed) {
+            request_delta(-1);
+        }
+        // A smaller radius or prune margin only needs the allow regions, rebuilt every update.
+    }
+    if (diff.remesh) request_delta(-1);
+    return plan;
+}
+
+std::string describe_config_diff(const AppConfigDiff& diff) {
+    std::string out;
+    for (const char* key : diff.fields) {
+        if (!out.empty()) out += ',';
+        out += key;
+    }
+    out += " ->";
+    const std::pair<bool, const char*> groups[] = {
+        {diff.camera, " camera"}, {diff.render, " render"}, {diff.ring, " ring"},
+        {diff.remesh, " remesh"}, {diff.pools, " pools"}, {diff.loader_threads, " loader"},
+        {diff.terrain, " terrain"}, {diff.storage, " storage"},
+    };
+    for (const auto& [set, name] : groups) {
+        if (set) out += name;
+    }
+    return out;
+}
+
 bool operator!=(const AppConfig& a, const AppConfig& b) {
     return !configs_equal(a, b);
 }
@@ -0,0 +1,101 @@
+#include "height_tile_cache.h"
+
+#include <algorithm>
+
+#include "chunk.h"
+
+namespace wf {
+
+static_assert(HeightTile::kSize == Chunk64::N, "height tiles cover one chunk column");
+
+Float3 column_direction(const PlanetConfig& cfg, const Float3& right, const Float3& up, const Float3& forward,
+                        std::int64_t i, std::int64_t j, int x, int y) {
+    const double chunk_m = static_cast<double>(Chunk64::N) * cfg.voxel_size_m;
+    const double s = static_cast<double>(i) * chunk_m + (x + 0.5) * cfg.voxel_size_m;
+    const double t = static_cast<double>(j) * chunk_m + (y + 0.5) * cfg.voxel_size_m;
+    const double r = cfg.radius_m;
+    return normalize(Float3{static_cast<float>(right.x * s + up.x * t + forward.x * r),
+                            static_cast<float>(right.y * s + up.y * t + forward.y * r),
+                            static_cast<float>(right.z * s + up.z * t + forward.z * r)});
+}
+
+void build_height_tile(const PlanetConfig& cfg, int face, std::int64_t i, std::int64_t j, HeightTile& out) {
+    const int N = HeightTile::kSize;
+    Float3 right, up, forward;
+    face_basis(face, right, up, forward);
+    float lo = 0.0f, hi = 0.0f;
+    for (int y = 0; y < N; ++y) {
+        for (int x = 0; x < N; ++x) {
+            const float h = static_cast<float>(terrain_height_m(cfg, column_direction(cfg, right, up, forward, i, j, x, y)));
+            out.height_m[static_cast<std::size_t>(y * N + x)] = h;
+            if (x == 0 && y == 0) lo = hi = h;
+            lo = std::min(lo, h);
+            hi = std::max(hi, h);
+        }
+    }
+    out.min_m = lo;
+    out.max_m = hi;
+}
+
+HeightTileCache::HeightTileCache(std::size_t capacity_tiles) : capacity_(std::max<std::size_t>(capacity_tiles, 1)) {}
+
+std::shared_ptr<const HeightTile> HeightTileCache::get(const PlanetConfig& cfg, int face, std::int64_t i, std::int64_t j) {
+    const FaceChunkKey key{face, i, j, 0};
+    const std::uint64_t config_hash = planet_config_hash(cfg);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (config_hash != config_hash_) {
+            entries_.clear();
+            lru_.clear();
+            config_hash_ = config_hash;
+        }
+        auto it = entries_.find(key);
+        if (it != entries_.end()) {
+            lru_.splice(lru_.begin(), lru_, it->second.lru);
+            ++hits_;
+            return it->second.tile;
+        }
+    }
+
+    auto tile = std::make_shared<HeightTile>();
+    build_height_tile(cfg, face, i, j, *tile);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++misses_;
+    if (config_hash != config_hash_) return tile; // the config changed while building
+    // Two workers may build the same column at once; the first insert wins.
+    auto [it, inserted] = entries_.try_emplace(key, Entry{std::move(tile), {}});
+    if (!inserted) {
+        lru_.splice(lru_.begin(), lru_, it->second.lru);
+        return it->second.tile;
+    }
+    lru_.push_front(key);
+    it->second.lru = lru_.begin();
+    std::shared_ptr<const HeightTile> result = it->second.tile;
+    evict_over_capacity();
+    return result;
+}
+
+void HeightTileCache::evict_over_capacity() {
+    while (entries_.size() > capacity_) {
+        entries_.erase(lru_.back());
+        lru_.pop_back();
+    }
+}
+
+HeightTileCache::Stats HeightTileCache::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats out;
+    out.hits = hits_;
+    out.misses = misses_;
+    out.entries = entries_.size();
+    return out;
+}
+
+void HeightTileCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_.clear();
+    lru_.clear();
+}
+
+} // namespace wf
@@ -0,0 +1,321 @@
+#include "light_engine.h"
+
+#include <algorithm>
+#include <bit>
+#include <vector>
+
+#include "material_table.h"
+
+namespace wf {
+
+namespace {
+
+constexpr int N = Chunk64::N;
+
+struct LightNode {
+    int16_t x, y, z;
+    uint8_t level; // removal passes: the level the node had before it was cleared
+};
+
+enum class Channel : uint8_t { kSky, kBlock };
+
+constexpr int kDirs[6][3] = {{-1, 0, 0}, {1, 0, 0}, {0, -1, 0}, {0, 1, 0}, {0, 0, -1}, {0, 0, 1}};
+
+inline uint8_t channel_get(uint8_t l, Channel ch) { return ch == Channel::kSky ? light_sky(l) : light_block(l); }
+inline uint8_t channel_set(uint8_t l, Channel ch, uint8_t v) {
+    return ch == Channel::kSky ? pack_light(v, light_block(l)) : pack_light(light_sky(l), v);
+}
+
+// Level one step away along dz: full sunlight keeps its strength straight down.
+inline uint8_t spread_level(Channel ch, uint8_t level, int dz) {
+    if (ch == Channel::kSky && dz < 0 && level == kMaxLight) return kMaxLight;
+    return level > 0 ? static_cast<uint8_t>(level - 1) : 0;
+}
+
+inline uint32_t voxel_index(int x, int y, int z) { return Chunk64::lindex(x, y, z); }
+
+// Air and non-opaque materials (water) pass light; only occupied voxels need the table.
+inline bool passes_light(const Chunk64& c, int x, int y, int z) {
+    return !c.is_solid(x, y, z) || !material_table().opaque(c.get_material(x, y, z));
+}
+
+// True when no voxel can hold light: every voxel is occupied by an opaque material.
+bool blocks_all_light(const Chunk64& c) {
+    return c.is_all_solid() && !has_clear_materials(c);
+}
+
+// One chunk; light outside it is neither read nor written.
+struct ChunkView {
+    const Chunk64& c;
+    ChunkLight& light;
+
+    bool inside(int x, int y, int z) const { return x >= 0 && y >= 0 && z >= 0 && x < N && y < N && z < N; }
+    bool transparent(int x, int y, int z) const { return passes_light(c, x, y, z); }
+    uint8_t emission(int x, int y, int z) const { return material_light_emission(c.get_material(x, y, z)); }
+    uint8_t get(int x, int y, int z) const { return light.get(voxel_index(x, y, z)); }
+    void set(int x, int y, int z, uint8_t v) { light.set(voxel_index(x, y, z), v); }
+};
+
+// Coordinates relative to the center chunk, spanning [-N, 2N) on each axis.
+struct NeighborhoodView {
+    LightNeighborhood& nbh;
+    uint32_t changed = 0;
+
+    Chunk64* locate(int x, int y, int z, int& slot, int& lx, int& ly, int& lz) const {
+        if (x < -N || y < -N || z < -N || x >= 2 * N || y >= 2 * N || z >= 2 * N) return nullptr;
+        const int dx = (x < 0) ? -1 : (x >= N ? 1 : 0);
+        const int dy = (y < 0) ? -1 : (y >= N ? 1 : 0);
+        const int dz = (z < 0) ? -1 : (z >= N ? 1 : 0);
+        slot = LightNeighborhood::slot(dx, dy, dz);
+        lx = x - dx * N;
+        ly = y - dy * N;
+        lz = z - dz * N;
+        return nbh.chunks[slot];
+    }
+    bool inside(int x, int y, int z) const {
+        int s = 0, lx = 0, ly = 0, lz = 0;
+        return locate(x, y, z, s, lx, ly, lz) != nullptr;
+    }
+    bool transparent(int x, int y, int z) const {
+        int s = 0, lx = 0, ly = 0, lz = 0;
+        const Chunk64* c = locate(x, y, z, s, lx, ly, lz);
+        return c && passes_light(*c, lx, ly, lz);
+    }
+    uint8_t emission(int x, int y, int z) const {
+        int s = 0, lx = 0, ly = 0, lz = 0;
+        const Chunk64* c = locate(x, y, z, s, lx, ly, lz);
+        return c ? material_light_emission(c->get_material(lx, ly, lz)) : 0;
+    }
+    uint8_t get(int x, int y, int z) const {
+        int s = 0, lx = 0, ly = 0, lz = 0;
+        const Chunk64* c = locate(x, y, z, s, lx, ly, lz);
+        return c ? c->light.get(voxel_index(lx, ly, lz)) : 0;
+    }
+    void set(int x, int y, int z, uint8_t v) {
+        int s = 0, lx = 0, ly = 0, lz = 0;
+        Chunk64* c = locate(x, y, z, s, lx, ly, lz);
+        if (!c) return;
+        c->light.set(voxel_index(lx, ly, lz), v);
+        changed |= 1u << s;
+        // The face neighbor's mesh samples this cell when it lies on the shared boundary.
+        const int d[3] = {s % 3 - 1, (s / 3) % 3 - 1, s / 9 - 1};
+        const int l[3] = {lx, ly, lz};
+        for (int a = 0; a < 3; ++a) {
+            int step = (l[a] == 0) ? -1 : (l[a] == N - 1 ? 1 : 0);
+            if (step == 0 || d[a] + step < -1 || d[a] + step > 1) continue;
+            int nd[3] = {d[0], d[1], d[2]};
+            nd[a] += step;
+            changed |= 1u << LightNeighborhood::slot(nd[0], nd[1], nd[2]);
+        }
+    }
+};
+
+template <typename View>
+void propagate_add(View& view, std::vector<LightNode>& queue, Channel ch) {
+    for (std::size_t head = 0; head < queue.size(); ++head) {
+        const LightNode n = queue[head];
+        const uint8_t level = channel_get(view.get(n.x, n.y, n.z), ch);
+        if (level <= 1) continue;
+        for (const auto& d : kDirs) {
+            const int x = n.x + d[0], y = n.y + d[1], z = n.z + d[2];
+            if (!view.inside(x, y, z) || !view.transparent(x, y, z)) continue;
+            const uint8_t next = spread_level(ch, level, d[2]);
+            const uint8_t cur = view.get(x, y, z);
+            if (channel_get(cur, ch) >= next) continue;
+            view.set(x, y, z, channel_set(cur, ch, next));
+            queue.push_back(LightNode{(int16_t)x, (int16_t)y, (int16_t)z, 0});
+        }
+    }
+    queue.clear();
+}
+
+// Clears everything the removed nodes fed; brighter cells met on the way (other sources)
+// go to `add` so the add pass can refill the cleared region from them.
+template <typename View>
+void propagate_remove(View& view, std::vector<LightNode>& removal, std::vector<LightNode>& add, Channel ch) {
+    for (std::size_t head = 0; head < removal.size(); ++head) {
+        const LightNode n = removal[head];
+        for (const auto& d : kDirs) {
+            const int x = n.x + d[0], y = n.y + d[1], z = n.z + d[2];
+            if (!view.inside(x, y, z)) continue;
+            const uint8_t cur = view.get(x, y, z);
+            const uint8_t level = channel_get(cur, ch);
+            if (level == 0) continue;
+            const bool fed = level < n.level ||
+                             (ch == Channel::kSky && d[2] < 0 && n.level == kMaxLight && level == kMaxLight);
+            if (!fed) {
+                add.push_back(LightNode{(int16_t)x, (int16_t)y, (int16_t)z, 0});
+                continue;
+            }
+            const uint8_t keep = (ch == Channel::kBlock) ? view.emission(x, y, z) : 0;
+            view.set(x, y, z, channel_set(cur, ch, keep));
+            removal.push_back(LightNode{(int16_t)x, (int16_t)y, (int16_t)z, level});
+            if (keep > 0) add.push_back(LightNode{(int16_t)x, (int16_t)y, (int16_t)z, 0});
+        }
+    }
+    removal.clear();
+}
+
+bool has_emitters(const Chunk64& c) {
+    for (uint16_t mat : c.palette) {
+        if (material_light_emission(mat) > 0) return true;
+    }
+    return false;
+}
+
+void seed_emitters(ChunkView& view, const Chunk64& c, std::vector<LightNode>& queue) {
+    for (std::size_t w = 0; w < c.occ.size(); ++w) {
+        for (uint64_t bits = c.occ[w]; bits; bits &= bits - 1) {
+            const uint32_t i = static_cast<uint32_t>(w * 64 + static_cast<std::size_t>(std::countr_zero(bits)));
+            const int x = static_cast<int>(i % N), y = static_cast<int>((i / N) % N), z = static_cast<int>(i / (N * N));
+            const uint8_t e = material_light_emission(c.get_material(x, y, z));
+            if (e == 0) continue;
+            view.set(x, y, z, channel_set(view.get(x, y, z), Channel::kBlock, e));
+            queue.push_back(LightNode{(int16_t)x, (int16_t)y, (int16_t)z, 0});
+        }
+    }
+}
+
+} // namespace
+
+uint8_t material_light_emission(uint16_t mat) {
+    return std::min(material_table().emissive(mat), kMaxLight);
+}
+
+void light_chunk(Chunk64& c, const Chunk64* above, const uint64_t* open_sky) {
+    uint8_t sky_in[N * N];
+    bool all_open = true, all_dark = true;
+    for (int y = 0; y < N; ++y) {
+        for (int x = 0; x < N; ++x) {
+            uint8_t s = 0;
+            if (above) s = light_sky(above->light.get(voxel_index(x, y, 0)));
+            else if (open_sky) s = ((open_sky[y] >> x) & 1ull) ? kMaxLight : 0;
+            sky_in[x + y * N] = s;
+            all_open = all_open && s == kMaxLight;
+            all_dark = all_dark && s == 0;
+        }
+    }
+    const bool emitters = has_emitters(c);
+    if (!emitters && c.is_all_air() && (all_open || all_dark)) {
+        c.light.reset(all_open ? ChunkLight::kFullSky : 0);
+        return;
+    }
+    c.light.reset(0);
+    if (!emitters && blocks_all_light(c)) return;
+
+    ChunkView view{c, c.light};
+    std::vector<LightNode> queue;
+    // Direct sunlight runs down each open column to the first solid voxel.
+    int sun_floor[N * N];
+    for (int y = 0; y < N; ++y) {
+        for (int x = 0; x < N; ++x) {
+            const uint8_t s = sky_in[x + y * N];
+            int z = N - 1;
+            if (s == kMaxLight) {
+                for (; z >= 0 && passes_light(c, x, y, z); --z) view.set(x, y, z, pack_light(kMaxLight, 0));
+            } else if (s > 1 && passes_light(c, x, y, N - 1)) {
+                view.set(x, y, N - 1, pack_light(static_cast<uint8_t>(s - 1), 0));
+                queue.push_back(LightNode{(int16_t)x, (int16_t)y, (int16_t)(N - 1), 0});
+            }
+            sun_floor[x + y * N] = z + 1;
+        }
+    }
+    // Only sunlit cells beside a shorter neighboring sun column can spread any further.
+    for (int y = 0; y < N; ++y) {
+        for (int x = 0; x < N; ++x) {
+            const int floor = sun_floor[x + y * N];
+            int reach = floor;
+            if (x > 0) reach = std::max(reach, sun_floor[x - 1 + y * N]);
+            if (x + 1 < N) reach = std::max(reach, sun_floor[x + 1 + y * N]);
+            if (y > 0) reach = std::max(reach, sun_floor[x + (y - 1) * N]);
+            if (y + 1 < N) reach = std::max(reach, sun_floor[x + (y + 1) * N]);
+            for (int z = floor; z < reach; ++z) queue.push_back(LightNode{(int16_t)x, (int16_t)y, (int16_t)z, 0});
+        }
+    }
+    propagate_add(view, queue, Channel::kSky);
+    if (emitters) {
+        seed_emitters(view, c, queue);
+        propagate_add(view, queue, Channel::kBlock);
+    }
+    c.light.compact();
+}
+
+bool light_gather(const Chunk64& c, const Chunk64* const nb[6], ChunkLight& out) {
+    if (blocks_all_light(c)) return false;
+    bool copied = false;
+    std::vector<LightNode> sky, block;
+    for (int f = 0; f < 6; ++f) {
+        const Chunk64* n = nb[f];
+        if (!n) continue;
+        const int axis = f / 2;
+        const bool positive = (f & 1) != 0;
+        const int layer = positive ? N - 1 : 0;
+        const int n_layer = positive ? 0 : N - 1;
+        for (int v = 0; v < N; ++v) {
+            for (int u = 0; u < N; ++u) {
+                int p[3], q[3];
+                p[axis] = layer;
+                q[axis] = n_layer;
+                p[(axis + 1) % 3] = q[(axis + 1) % 3] = u;
+                p[(axis + 2) % 3] = q[(axis + 2) % 3] = v;
+                if (!passes_light(c, p[0], p[1], p[2])) continue;
+                const uint8_t nl = n->light.get(voxel_index(q[0], q[1], q[2]));
+                // Light coming from the chunk above travels down (dz = -1).
+                const uint8_t s = spread_level(Channel::kSky, light_sky(nl), (axis == 2 && positive) ? -1 : 0);
+                const uint8_t b = spread_level(Channel::kBlock, light_block(nl), 0);
+                const uint32_t i = voxel_index(p[0], p[1], p[2]);
+                const uint8_t cur = copied ? out.get(i) : c.light.get(i);
+                if (s <= light_sky(cur) && b <= light_block(cur)) continue;
+                if (!copied) {
+                    out = c.light;
+                    copied = true;
+                }
+                out.set(i, pack_light(std::max(s, light_sky(cur)), std::max(b, light_block(cur))));
+                const LightNode node{(int16_t)p[0], (int16_t)p[1], (int16_t)p[2], 0};
+                if (s > light_sky(cur)) sky.push_back(node);
+                if (b > light_block(cur)) block.push_back(node);
+            }
+        }
+    }
+    if (!copied) return false;
+    ChunkView view{c, out};
+    propagate_add(view, sky, Channel::kSky);
+    propagate_add(view, block, Channel::kBlock);
+    out.compact();
+    return true;
+}
+
+uint32_t relight_edit(LightNeighborhood& nbh, std::span<const uint32_t> changed) {
+    if (!nbh.chunks[LightNeighborhood::kCenter] || changed.empty()) return 0;
+    NeighborhoodView view{nbh};
+    std::vector<LightNode> sky_remove, block_remove, sky_add, block_add;
+    for (uint32_t i : changed) {
+        const int x = static_cast<int>(i % N), y = static_cast<int>((i / N) % N), z = static_cast<int>(i / (N * N));
+        const uint8_t old = view.get(x, y, z);
+        const uint8_t e = view.emission(x, y, z);
+        view.set(x, y, z, pack_light(0, e));
+        const LightNode node{(int16_t)x, (int16_t)y, (int16_t)z, 0};
+        if (light_sky(old) > 0) sky_remove.push_back(LightNode{node.x, node.y, node.z, light_sky(old)});
+        if (light_block(old) > e) block_remove.push_back(LightNode{node.x, node.y, node.z, light_block(old)});
+        if (e > 0) block_add.push_back(node);
+        if (!view.transparent(x, y, z)) continue;
+        // An opened voxel fills from whatever lights its neighbors.
+        for (const auto& d : kDirs) {
+            const int nx = x + d[0], ny = y + d[1], nz = z + d[2];
+            if (!view.inside(nx, ny, nz)) continue;
+            const LightNode neighbor{(int16_t)nx, (int16_t)ny, (int16_t)nz, 0};
+            sky_add.push_back(neighbor);
+            block_add.push_back(neighbor);
+        }
+    }
+    propagate_remove(view, sky_remove, sky_add, Channel::kSky);
+    propagate_remove(view, block_remove, block_add, Channel::kBlock);
+    propagate_add(view, sky_add, Channel::kSky);
+    propagate_add(view, block_add, Channel::kBlock);
+    for (int s = 0; s < 27; ++s) {
+        if (((view.changed >> s) & 1u) && nbh.chunks[s]) nbh.chunks[s]->light.compact();
+    }
+    return view.changed;
+}
+
+} // namespace wf
@@ -0,0 +1,229 @@
+#include "material_table.h"
+#include "chunk.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <utility>
+
+namespace wf {
+namespace {
+
+std::string trim(const std::string& s) {
+    size_t a = 0, b = s.size();
+    while (a < b && std::isspace(static_cast<unsigned char>(s[a]))) ++a;
+    while (b > a && std::isspace(static_cast<unsigned char>(s[b - 1]))) --b;
+    return s.substr(a, b - a);
+}
+
+std::string lower(std::string s) {
+    for (auto& c : s) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    return s;
+}
+
+bool parse_bool(const std::string& v, bool& out) {
+    const std::string s = lower(v);
+    if (s == "1" || s == "true" || s == "yes" || s == "on") { out = true; return true; }
+    if (s == "0" || s == "false" || s == "no" || s == "off") { out = false; return true; }
+    return false;
+}
+
+bool parse_sim(const std::string& v, SimClass& out) {
+    const std::string s = lower(v);
+    if (s == "solid") out = SimClass::Solid;
+    else if (s == "granular") out = SimClass::Granular;
+    else if (s == "fluid") out = SimClass::Fluid;
+    else if (s == "gas") out = SimClass::Gas;
+    else return false;
+    return true;
+}
+
+bool parse_color(const std::string& v, float out[3]) {
+    if (!v.empty() && v[0] == '#') {
+        unsigned r = 0, g = 0, b = 0;
+        if (v.size() != 7 || std::sscanf(v.c_str() + 1, "%2x%2x%2x", &r, &g, &b) != 3) return false;
+        out[0] = r / 255.0f; out[1] = g / 255.0f; out[2] = b / 255.0f;
+        return true;
+    }
+    std::istringstream in(v);
+    float c[3];
+    if (!(in >> c[0] >> c[1] >> c[2])) return false;
+    for (int i = 0; i < 3; ++i) out[i] = std::clamp(c[i], 0.0f, 1.0f);
+    return true;
+}
+
+MaterialInfo builtin(const char* name, float r, float g, float b, float alpha, bool opaque, uint8_t emissive,
+                     SimClass sim, float density, float hardness) {
+    MaterialInfo m;
+    m.name = name;
+    m.color[0] = r; m.color[1] = g; m.color[2] = b;
+    m.alpha = alpha;
+    m.opaque = opaque;
+    m.emissive = emissive;
+    m.sim = sim;
+    m.density = density;
+    m.hardness = hardness;
+    m.defined = true;
+    return m;
+}
+
+MaterialTable& active_table() {
+    static MaterialTable table;
+    return table;
+}
+
+} // namespace
+
+MaterialTable::MaterialTable() {
+    define(MAT_AIR, builtin("air", 0.82f, 0.75f, 0.66f, 0.0f, false, 0, SimClass::Gas, 1.2f, 0.0f));
+    define(MAT_ROCK, builtin("rock", 0.6f, 0.6f, 0.6f, 1.0f, true, 0, SimClass::Solid, 2600.0f, 3.0f));
+    define(MAT_DIRT, builtin("dirt", 0.47f, 0.28f, 0.09f, 1.0f, true, 0, SimClass::Granular, 1500.0f, 1.0f));
+    define(MAT_WATER, builtin("water", 0.1f, 0.4f, 0.9f, 0.6f, false, 0, SimClass::Fluid, 1000.0f, 0.0f));
+    define(MAT_LAVA, builtin("lava", 0.9f, 0.3f, 0.1f, 1.0f, true, 15, SimClass::Fluid, 3100.0f, 0.0f));
+}
+
+void MaterialTable::define(uint16_t id, MaterialInfo m) {
+    if (id >= entries_.size()) entries_.resize(static_cast<std::size_t>(id) + 1);
+    m.defined = true;
+    entries_[id] = std::move(m);
+}
+
+std::optional<uint16_t> MaterialTable::find(std::string_view name) const {
+    for (std::size_t i = 0; i < entries_.size(); ++i) {
+        if (entries_[i].defined && entries_[i].name == name) return static_cast<uint16_t>(i);
+    }
+    return std::nullopt;
+}
+
+bool MaterialTable::load_file(const std::string& path, std::string* error) {
+    std::ifstream in(path);
+    if (!in.good()) {
+        if (error) *error = "cannot open " + path;
+        return false;
+    }
+    if (parse(in, error)) return true;
+    if (error) *error = path + ": " + *error;
+    return false;
+}
+
+bool MaterialTable::parse(std::istream& in, std::string* error) {
+    MaterialTable next = *this;
+    auto fail = [&](int line_no, const std::string& what) {
+        if (error) *error = "line " + std::to_string(line_no) + ": " + what;
+        return false;
+    };
+
+    // The section being read; committed when the next one starts and at the end.
+    MaterialInfo cur;
+    std::optional<uint16_t> cur_id;
+    int cur_line = 0;
+    bool in_section = false;
+    auto commit = [&]() -> bool {
+        if (!in_section) return true;
+        std::optional<uint16_t> named = next.find(cur.name);
+        uint16_t id = cur_id ? *cur_id : (named ? *named : static_cast<uint16_t>(next.size()));
+        if (named && *named != id) {
+            return fail(cur_line, "'" + cur.name + "' already has id " + std::to_string(*named));
+        }
+        if (id == MAT_AIR && cur.opaque) return fail(cur_line, "air (id 0) cannot be opaque");
+        next.define(id, cur);
+        return true;
+    };
+
+    std::string line;
+    int line_no = 0;
+    while (std::getline(in, line)) {
+        ++line_no;
+        line = trim(line);
+        if (line.empty() || line[0] == '#' || line[0] == ';') continue;
+        if (line.front() == '[') {
+            if (line.back() != ']') return fail(line_no, "unterminated section");
+            if (!commit()) return false;
+            cur = MaterialInfo{};
+            cur.name = lower(trim(line.substr(1, line.size() - 2)));
+            if (cur.name.empty()) return fail(line_no, "empty material name");
+            // Restyling an existing material starts from its current properties.
+            if (auto existing = next.find(cur.name)) cur = next.info(*existing);
+            cur_id.reset();
+            cur_line = line_no;
+            in_section = true;
+            continue;
+        }
+        auto eq = line.find('=');
+        if (eq == std::string::npos) return fail(line_no, "expected key = value");
+        if (!in_section) return fail(line_no, "property outside a [material] section");
+        const std::string key = lower(trim(line.substr(0, eq)));
+        const std::string val = trim(line.substr(eq + 1));
+        bool ok = true;
+        try {
+            if (key == "id") {
+                const int id = std::stoi(val);
+                ok = id >= 0 && id <= 0xFFFF;
+                if (ok) cur_id = static_cast<uint16_t>(id);
+            } else if (key == "color") {
+                ok = parse_color(val, cur.color);
+            } else if (key == "alpha") {
+                const float a = std::stof(val);
+                ok = a >= 0.0f && a <= 1.0f;
+                if (ok) cur.alpha = a;
+            } else if (key == "opaque") {
+                ok = parse_bool(val, cur.opaque);
+            } else if (key == "emissive") {
+                const int e = std::stoi(val);
+                ok = e >= 0 && e <= 15;
+                if (ok) cur.emissive = static_cast<uint8_t>(e);
+            } else if (key == "sim") {
+                ok = parse_sim(val, cur.sim);
+            } else if (key == "density") {
+                cur.density = std::stof(val);
+            } else if (key == "hardness") {
+                cur.hardness = std::stof(val);
+            } else {
+                return fail(line_no, "unknown key '" + key + "'");
+            }
+        } catch (...) {
+            ok = false;
+        }
+        if (!ok) return fail(line_no, "bad value for " + key + ": " + val);
+    }
+    if (!commit()) return false;
+    *this = std::move(next);
+    return true;
+}
+
+std::vector<GpuMaterial> MaterialTable::gpu_palette() const {
+    std::vector<GpuMaterial> out(std::max<std::size_t>(entries_.size(), 1));
+    for (std::size_t i = 0; i < out.size(); ++i) {
+        const MaterialInfo& m = info(static_cast<uint16_t>(i));
+        GpuMaterial& g = out[i];
+        g.color[0] = m.color[0];
+        g.color[1] = m.color[1];
+        g.color[2] = m.color[2];
+        g.color[3] = m.opaque ? 1.0f : m.alpha;
+        g.emissive = m.emissive / 15.0f;
+        g.flags = (m.opaque ? kGpuOpaque : 0u) | (m.emissive > 0 ? kGpuEmissive : 0u);
+        g.pad[0] = g.pad[1] = 0;
+    }
+    return out;
+}
+
+const MaterialTable& material_table() {
+    return active_table();
+}
+
+void set_material_table(MaterialTable table) {
+    active_table() = std::move(table);
+}
+
+bool has_clear_materials(const Chunk64& c) {
+    if (c.is_all_air()) return false;
+    const MaterialTable& t = material_table();
+    for (uint16_t id : c.palette) {
+        if (id != MAT_AIR && !t.opaque(id)) return true;
+    }
+    return false;
+}
+
+} // namespace wf
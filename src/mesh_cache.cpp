@@ -0,0 +1,226 @@
+#include "mesh_cache.h"
+#include "material_table.h"
+
+#include <chrono>
+#include <cstring>
+
+namespace wf {
+
+namespace {
+
+inline uint64_t rotl(uint64_t v, int r) { return (v << r) | (v >> (64 - r)); }
+
+// Two independent multiply-rotate streams; a 128-bit key makes accidental reuse of
+// another chunk's mesh practically impossible.
+struct ContentHasher {
+    uint64_t h0 = 0x9E3779B97F4A7C15ull;
+    uint64_t h1 = 0xC2B2AE3D27D4EB4Full;
+
+    void word(uint64_t w) {
+        h0 = rotl(h0 ^ w, 27) * 0x87C37B91114253D5ull;
+        h1 = rotl(h1 + w, 31) * 0x4CF5AD432745937Full;
+    }
+    void words(const uint64_t* p, std::size_t n) {
+        for (std::size_t i = 0; i < n; ++i) word(p[i]);
+    }
+    MeshCacheKey finish() {
+        auto fmix = [](uint64_t k) {
+            k ^= k >> 33;
+            k *= 0xFF51AFD7ED558CCDull;
+            k ^= k >> 33;
+            k *= 0xC4CEB9FE1A85EC53ull;
+            k ^= k >> 33;
+            return k;
+        };
+        return MeshCacheKey{fmix(h0 ^ h1), fmix(h1 + h0)};
+    }
+};
+
+void hash_light(ContentHasher& h, const ChunkLight& light) {
+    h.word(light.fill);
+    h.word(light.levels.size());
+    const std::size_t full = light.levels.size() / 8;
+    for (std::size_t i = 0; i < full; ++i) {
+        uint64_t w = 0;
+        std::memcpy(&w, light.levels.data() + i * 8, sizeof(w));
+        h.word(w);
+    }
+}
+
+// Light of one neighbor layer, eight cells per word.
+void hash_layer_light(ContentHasher& h, const Chunk64& n, int axis, int layer) {
+    const int N = Chunk64::N;
+    if (n.light.levels.empty()) {
+        h.word(n.light.fill);
+        return;
+    }
+    for (int b = 0; b < N; ++b) {
+        for (int a = 0; a < N; a += 8) {
+            uint64_t w = 0;
+            for (int k = 0; k < 8; ++k) {
+                int p[3];
+                p[axis] = layer;
+                p[(axis + 1) % 3] = a + k;
+                p[(axis + 2) % 3] = b;
+                w |= static_cast<uint64_t>(n.light.get(Chunk64::lindex(p[0], p[1], p[2]))) << (k * 8);
+            }
+            h.word(w);
+        }
+    }
+}
+
+// The mesher only reads the neighbor layer facing the chunk: its occupancy, which of its
+// voxels are see-through, and its light.
+void hash_boundary(ContentHasher& h, const Chunk64* n, int axis, int layer) {
+    const int N = Chunk64::N;
+    if (!n) {
+        h.word(0xA11AB5E17ull + static_cast<uint64_t>(axis * 2 + (layer == 0)));
+        return;
+    }
+    h.word(0xB0DAull + static_cast<uint64_t>(axis * 2 + (layer == 0)));
+    if (axis == 2) {
+        // One z layer is N*N contiguous bits.
+        h.words(n->occ.data() + static_cast<std::size_t>(layer) * N * N / 64, static_cast<std::size_t>(N) * N / 64);
+    } else if (axis == 1) {
+        // One row of x per z; N == 64, so each row is exactly one word.
+        for (int z = 0; z < N; ++z) h.word(n->occ[static_cast<std::size_t>(z * N + layer)]);
+    } else {
+        for (int z = 0; z < N; ++z) {
+            uint64_t column = 0;
+            for (int y = 0; y < N; ++y) {
+                if (n->is_solid(layer, y, z)) column |= 1ull << y;
+            }
+            h.word(column);
+        }
+    }
+    if (has_clear_materials(*n)) {
+        // Which boundary voxels are see-through decides between opaque and water faces.
+        const MaterialTable& t = material_table();
+        h.word(0xC1EA5ull);
+        for (int r = 0; r < N; ++r) {
+            uint64_t row = 0;
+            for (int i = 0; i < N; ++i) {
+                const int x = axis == 0 ? layer : i;
+                const int y = axis == 1 ? layer : (axis == 0 ? i : r);
+                const int z = axis == 2 ? layer : r;
+                if (n->is_solid(x, y, z) && !t.opaque(n->get_material(x, y, z))) row |= 1ull << i;
+            }
+            h.word(row);
+        }
+    }
+    hash_layer_light(h, *n, axis, layer);
+}
+
+} // namespace
+
+MeshCache::MeshCache(std::size_t budget_bytes) : budget_bytes_(budget_bytes) {}
+
+MeshCacheKey MeshCache::key_for(const Chunk64& c,
+                                const Chunk64* nx, const Chunk64* px,
+                                const Chunk64* ny, const Chunk64* py,
+                                const Chunk64* nz, const Chunk64* pz,
+                                float voxel_size_m, const uint64_t* owned,
+                                const ChunkEdgeCells* edges) {
+    static_assert(Chunk64::N == 64, "boundary hashing packs one chunk row per word");
+    const int N = Chunk64::N;
+    ContentHasher h;
+    uint32_t scale_bits = 0;
+    static_assert(sizeof(scale_bits) == sizeof(voxel_size_m));
+    std::memcpy(&scale_bits, &voxel_size_m, sizeof(scale_bits));
+    h.word(scale_bits);
+    h.words(c.occ.data(), c.occ.size());
+    h.word(c.palette.size());
+    for (uint16_t mat : c.palette) h.word(mat);
+    h.word(c.indices.bpp());
+    h.words(c.indices.words().data(), c.indices.words().size());
+    hash_light(h, c.light);
+    hash_boundary(h, nx, 0, N - 1);
+    hash_boundary(h, px, 0, 0);
+    hash_boundary(h, ny, 1, N - 1);
+    hash_boundary(h, py, 1, 0);
+    hash_boundary(h, nz, 2, N - 1);
+    hash_boundary(h, pz, 2, 0);
+    // Missing edge cells read as air, so they share the key of an all-air set.
+    const ChunkEdgeCells no_edges{};
+    const ChunkEdgeCells& e = edges ? *edges : no_edges;
+    h.words(e.solid, 12);
+    h.words(e.clear, 12);
+    h.word(static_cast<uint64_t>(e.corner_solid) | (static_cast<uint64_t>(e.corner_clear) << 8));
+    if (owned) {
+        h.word(0x0B1EDull);
+        h.words(owned, static_cast<std::size_t>(N) * N);
+    }
+    return h.finish();
+}
+
+std::shared_ptr<const Mesh> MeshCache::mesh_greedy(const Chunk64& c,
+                                                   const Chunk64* nx, const Chunk64* px,
+                                                   const Chunk64* ny, const Chunk64* py,
+                                                   const Chunk64* nz, const Chunk64* pz,
+                                                   float voxel_size_m, const uint64_t* owned,
+                                                   const ChunkEdgeCells* edges) {
+    auto t0 = std::chrono::steady_clock::now();
+    const MeshCacheKey key = key_for(c, nx, px, ny, py, nz, pz, voxel_size_m, owned, edges);
+    auto t1 = std::chrono::steady_clock::now();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = entries_.find(key);
+        if (it != entries_.end()) {
+            const double hash_ms = std::chrono::duration<double, std::milli>(t1 - t0).count();
+            lru_.splice(lru_.begin(), lru_, it->second.lru);
+            ++hits_;
+            saved_ms_ += it->second.mesh_ms - hash_ms;
+            return it->second.mesh;
+        }
+    }
+
+    auto mesh = std::make_shared<Mesh>();
+    mesh_chunk_greedy_neighbors(c, nx, px, ny, py, nz, pz, *mesh, voxel_size_m, owned, edges);
+    const double mesh_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t1).count();
+
+    std::shared_ptr<const Mesh> result = std::move(mesh);
+    Entry entry;
+    entry.bytes = result->vertices.size() * sizeof(Vertex) + result->indices.size() * sizeof(uint16_t) +
+                  result->segments.size() * sizeof(MeshSegment);
+    entry.mesh = result;
+    entry.mesh_ms = mesh_ms;
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++misses_;
+    // Two workers may mesh the same content at once; the first insert wins.
+    auto [it, inserted] = entries_.try_emplace(key, std::move(entry));
+    if (!inserted) return it->second.mesh;
+    lru_.push_front(key);
+    it->second.lru = lru_.begin();
+    bytes_ += it->second.bytes;
+    evict_over_budget();
+    return result;
+}
+
+void MeshCache::evict_over_budget() {
+    while (bytes_ > budget_bytes_ && entries_.size() > 1) {
+        auto oldest = entries_.find(lru_.back());
+        bytes_ -= oldest->second.bytes;
+        entries_.erase(oldest);
+        lru_.pop_back();
+    }
+}
+
+MeshCache::Stats MeshCache::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats out;
+    out.hits = hits_;
+    out.misses = misses_;
+    out.saved_ms = saved_ms_;
+    out.entries = entries_.size();
+    out.bytes = bytes_;
+    return out;
+}
+
+void MeshCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_.clear();
+    lru_.clear();
+    bytes_ = 0;
+}
+
+} // namespace wf
@@ -1,6 +1,9 @@
 #include "mesh.h"
 #include "chunk.h"
+#include "material_table.h"
 #include "wf_math.h"
+#include <algorithm>
+#include <bit>
 #include <vector>
 
 namespace wf {
@@ -8,181 +11,401 @@ namespace wf {
 struct MaskCell {
     uint16_t mat;
     int8_t sign; // +1 or -1
+    uint8_t ao;  // 2 bits per corner: (u-,v-), (u+,v-), (u+,v+), (u-,v+)
+    uint8_t light;
 };
 
 static inline bool cell_equal(const MaskCell& a, const MaskCell& b) {
-    return a.mat == b.mat && a.sign == b.sign;
+    return a.mat == b.mat && a.sign == b.sign && a.ao == b.ao && a.light == b.light;
 }
 
-static void add_quad(Mesh& m, Float3 origin, Float3 udir, Float3 vdir, Float3 n, float w, float h, uint16_t mat, bool flip) {
-    const uint32_t base = (uint32_t)m.vertices.size();
+static inline uint8_t corner_ao(int ao, int corner) { return (uint8_t)((ao >> (corner * 2)) & 3); }
+
+static void add_quad(Mesh& m, Float3 origin, Float3 udir, Float3 vdir, Float3 n, float w, float h, uint16_t mat, uint8_t ao, uint8_t light, bool flip) {
+    const uint32_t base = m.begin_vertices(4);
     Float3 p0 = origin;
     Float3 p1 = { origin.x + udir.x * w, origin.y + udir.y * w, origin.z + udir.z * w };
     Float3 p2 = { p1.x + vdir.x * h, p1.y + vdir.y * h, p1.z + vdir.z * h };
     Float3 p3 = { origin.x + vdir.x * h, origin.y + vdir.y * h, origin.z + vdir.z * h };
-    Vertex v0{p0.x, p0.y, p0.z, n.x, n.y, n.z, mat};
-    Vertex v1{p1.x, p1.y, p1.z, n.x, n.y, n.z, mat};
-    Vertex v2{p2.x, p2.y, p2.z, n.x, n.y, n.z, mat};
-    Vertex v3{p3.x, p3.y, p3.z, n.x, n.y, n.z, mat};
+    const uint8_t a0 = corner_ao(ao, 0), a1 = corner_ao(ao, 1), a2 = corner_ao(ao, 2), a3 = corner_ao(ao, 3);
+    Vertex v0{p0.x, p0.y, p0.z, n.x, n.y, n.z, mat, a0, light};
+    Vertex v1{p1.x, p1.y, p1.z, n.x, n.y, n.z, mat, a1, light};
+    Vertex v2{p2.x, p2.y, p2.z, n.x, n.y, n.z, mat, a2, light};
+    Vertex v3{p3.x, p3.y, p3.z, n.x, n.y, n.z, mat, a3, light};
     m.vertices.push_back(v0);
     m.vertices.push_back(v1);
     m.vertices.push_back(v2);
     m.vertices.push_back(v3);
+    // Split along the darker diagonal so occlusion interpolates symmetrically (no anisotropy)
+    const uint32_t r = (a0 + a2 > a1 + a3) ? 1u : 0u;
+    const uint32_t q0 = base + r, q1 = base + ((1 + r) & 3), q2 = base + ((2 + r) & 3), q3 = base + ((3 + r) & 3);
     if (!flip) {
-        m.indices.push_back(base + 0);
-        m.indices.push_back(base + 1);
-        m.indices.push_back(base + 2);
-        m.indices.push_back(base + 0);
-        m.indices.push_back(base + 2);
-        m.indices.push_back(base + 3);
+        m.push_index(q0);
+        m.push_index(q1);
+        m.push_index(q2);
+        m.push_index(q0);
+        m.push_index(q2);
+        m.push_index(q3);
     } else {
-        m.indices.push_back(base + 0);
-        m.indices.push_back(base + 2);
-        m.indices.push_back(base + 1);
-        m.indices.push_back(base + 0);
-        m.indices.push_back(base + 3);
-        m.indices.push_back(base + 2);
+        m.push_index(q0);
+        m.push_index(q2);
+        m.push_index(q1);
+        m.push_index(q0);
+        m.push_index(q3);
+        m.push_index(q2);
+    }
+}
+
+// What occupies a cell as far as face culling is concerned.
+enum CellKind : uint8_t { kAirCell = 0, kClearCell = 1, kOpaqueCell = 2 };
+
+// `clear` says whether the chunk holds non-opaque materials at all; without them every
+// occupied voxel is opaque and the material lookup is skipped.
+static inline uint8_t cell_kind(const Chunk64& n, bool clear, int x, int y, int z) {
+    if (!n.is_solid(x, y, z)) return kAirCell;
+    return (clear && !material_table().opaque(n.get_material(x, y, z))) ? kClearCell : kOpaqueCell;
+}
+
+// Kind of a cell one voxel outside the chunk comes from the face neighbor on that side
+// (nb = -X,+X,-Y,+Y,-Z,+Z), or from `edges` when it is outside on two or three axes;
+// missing neighbors read as air (no outer walls).
+static inline uint8_t kind_around(const Chunk64& c, bool c_clear, const Chunk64* const nb[6],
+                                  const bool nb_clear[6], const ChunkEdgeCells* edges, int x, int y, int z) {
+    const int N = Chunk64::N;
+    int p[3] = { x, y, z };
+    int outside = 0, side = 0, inside_axis = 0;
+    int sides[3] = { 0, 0, 0 };  // 0 below the chunk, 1 above
+    for (int a = 0; a < 3; ++a) {
+        if (p[a] < 0)       { ++outside; side = a * 2;     p[a] += N; }
+        else if (p[a] >= N) { ++outside; side = a * 2 + 1; p[a] -= N; sides[a] = 1; }
+        else inside_axis = a;
+    }
+    if (outside == 0) return cell_kind(c, c_clear, x, y, z);
+    if (outside == 1) return nb[side] ? cell_kind(*nb[side], nb_clear[side], p[0], p[1], p[2]) : kAirCell;
+    if (!edges) return kAirCell;
+    bool solid = false, clear = false;
+    if (outside == 2) {
+        const int a = inside_axis, b = (a == 0) ? 1 : 0, d = (a == 2) ? 1 : 2;
+        const int e = ChunkEdgeCells::edge(a, sides[b], sides[d]);
+        solid = ((edges->solid[e] >> p[a]) & 1ull) != 0;
+        clear = ((edges->clear[e] >> p[a]) & 1ull) != 0;
+    } else {
+        const int k = ChunkEdgeCells::corner(sides[0], sides[1], sides[2]);
+        solid = ((edges->corner_solid >> k) & 1u) != 0;
+        clear = ((edges->corner_clear >> k) & 1u) != 0;
+    }
+    return !solid ? kAirCell : (clear ? kClearCell : kOpaqueCell);
+}
+
+// Light of the cell in front of a face; it lies in the chunk or, at a seam, in the face neighbor.
+static inline uint8_t light_around(const Chunk64& c, const Chunk64* const nb[6], int x, int y, int z) {
+    const int N = Chunk64::N;
+    int p[3] = { x, y, z };
+    const Chunk64* src = &c;
+    for (int a = 0; a < 3; ++a) {
+        if (p[a] < 0)       { src = nb[a * 2];     p[a] += N; }
+        else if (p[a] >= N) { src = nb[a * 2 + 1]; p[a] -= N; }
+    }
+    return src ? src->light.get(Chunk64::lindex(p[0], p[1], p[2])) : ChunkLight::kFullSky;
+}
+
+// Classic 3-neighbor vertex AO: two edge voxels and the diagonal voxel in the air layer in
+// front of the face; two solid edges fully occlude regardless of the diagonal.
+static inline int vertex_ao(bool side1, bool side2, bool diag) {
+    if (side1 && side2) return 0;
+    return 3 - (int)side1 - (int)side2 - (int)diag;
+}
+
+// One layer of cells perpendicular to the sweep axis with a one-voxel border. emit[v + 1]
+// holds bit u for u in [0, N) of cells whose faces the pass draws, block[v + 1] of cells
+// that hide a neighbor's face; lo/hi hold the border cells u = -1 and u = N as
+// bit 0 emit, bit 1 block.
+struct LayerSlab {
+    uint64_t emit[Chunk64::N + 2];
+    uint64_t block[Chunk64::N + 2];
+    uint8_t lo[Chunk64::N + 2];
+    uint8_t hi[Chunk64::N + 2];
+
+    bool solid(int u, int v) const {
+        if (u < 0) return (lo[v + 1] & 2) != 0;
+        if (u >= Chunk64::N) return (hi[v + 1] & 2) != 0;
+        return ((block[v + 1] >> u) & 1ull) != 0;
+    }
+};
+
+// Packed corner AO for the face of cell (u, v); `air` is the layer in front of the face.
+static inline uint8_t face_ao(const LayerSlab& air, int u, int v) {
+    const bool um = air.solid(u - 1, v), up = air.solid(u + 1, v);
+    const bool vm = air.solid(u, v - 1), vp = air.solid(u, v + 1);
+    const int a0 = vertex_ao(um, vm, air.solid(u - 1, v - 1));
+    const int a1 = vertex_ao(up, vm, air.solid(u + 1, v - 1));
+    const int a2 = vertex_ao(up, vp, air.solid(u + 1, v + 1));
+    const int a3 = vertex_ao(um, vp, air.solid(u - 1, v + 1));
+    return (uint8_t)(a0 | (a1 << 2) | (a2 << 4) | (a3 << 6));
+}
+
+// Transposes z-major occupancy words (bit x of word z * N + y) into x-major ones
+// (bit z of word x * N + y) for the X sweep.
+static void transpose_x(const uint64_t* in, std::vector<uint64_t>& out) {
+    const int N = Chunk64::N;
+    out.assign((size_t)N * N, 0ull);
+    for (int z = 0; z < N; ++z) {
+        for (int y = 0; y < N; ++y) {
+            for (uint64_t w = in[z * N + y]; w; w &= w - 1) out[std::countr_zero(w) * N + y] |= 1ull << z;
+        }
+    }
+}
+
+// Occupancy-layout bits of the chunk's non-opaque occupied voxels.
+static void clear_bits(const Chunk64& c, std::vector<uint64_t>& out) {
+    const int N = Chunk64::N;
+    const MaterialTable& t = material_table();
+    out.assign((size_t)N * N, 0ull);
+    for (int z = 0; z < N; ++z) {
+        for (int y = 0; y < N; ++y) {
+            for (uint64_t w = c.occ[z * N + y]; w; w &= w - 1) {
+                const int x = std::countr_zero(w);
+                if (!t.opaque(c.get_material(x, y, z))) out[z * N + y] |= 1ull << x;
+            }
+        }
     }
 }
 
-static inline bool get_neighbor_solid(const Chunk64* n, int x, int y, int z) {
-    if (!n) return false; // treat as air when no neighbor provided (no outer walls)
-    if (x < 0 || y < 0 || z < 0 || x >= Chunk64::N || y >= Chunk64::N || z >= Chunk64::N) return false;
-    return n->is_solid(x, y, z);
+// Cells of `emit_kind` draw faces toward cells whose kind is not in `block_mask`.
+struct SweepPass {
+    const uint64_t* emit;     // occupancy layout
+    const uint64_t* block;
+    const uint64_t* emit_x;   // transposed for the X sweep
+    const uint64_t* block_x;
+    uint8_t emit_kind;
+    uint8_t block_mask;       // bit per CellKind
+    bool translucent;         // no AO; drawn into translucent segments
+};
+
+void gather_edge_cells(const Chunk64* const nbh[27], ChunkEdgeCells& out) {
+    static_assert(Chunk64::N == 64, "an edge strip is one word");
+    const int N = Chunk64::N;
+    const MaterialTable& t = material_table();
+    out = ChunkEdgeCells{};
+    auto slot = [](const int d[3]) { return (d[0] + 1) + (d[1] + 1) * 3 + (d[2] + 1) * 9; };
+    // Cell at -1 lies in the chunk below at N - 1, cell at N in the chunk above at 0.
+    auto sample = [&](const Chunk64& n, const int p[3], uint64_t& solid, uint64_t& clear, uint64_t bit) {
+        if (!n.is_solid(p[0], p[1], p[2])) return;
+        solid |= bit;
+        if (!t.opaque(n.get_material(p[0], p[1], p[2]))) clear |= bit;
+    };
+    for (int a = 0; a < 3; ++a) {
+        const int b = (a == 0) ? 1 : 0, d = (a == 2) ? 1 : 2;
+        for (int sb = 0; sb < 2; ++sb) {
+            for (int sd = 0; sd < 2; ++sd) {
+                int off[3] = { 0, 0, 0 };
+                off[b] = sb ? 1 : -1;
+                off[d] = sd ? 1 : -1;
+                const Chunk64* n = nbh[slot(off)];
+                if (!n || n->is_all_air()) continue;
+                const int e = ChunkEdgeCells::edge(a, sb, sd);
+                int p[3];
+                p[b] = sb ? 0 : N - 1;
+                p[d] = sd ? 0 : N - 1;
+                for (int i = 0; i < N; ++i) {
+                    p[a] = i;
+                    sample(*n, p, out.solid[e], out.clear[e], 1ull << i);
+                }
+            }
+        }
+    }
+    for (int k = 0; k < 8; ++k) {
+        const int off[3] = { (k & 1) ? 1 : -1, (k & 2) ? 1 : -1, (k & 4) ? 1 : -1 };
+        const Chunk64* n = nbh[slot(off)];
+        if (!n) continue;
+        const int p[3] = { (k & 1) ? 0 : N - 1, (k & 2) ? 0 : N - 1, (k & 4) ? 0 : N - 1 };
+        uint64_t solid = 0, clear = 0;
+        sample(*n, p, solid, clear, 1ull);
+        out.corner_solid |= static_cast<uint8_t>(solid << k);
+        out.corner_clear |= static_cast<uint8_t>(clear << k);
+    }
 }
 
 void mesh_chunk_greedy_neighbors(const Chunk64& c,
                                  const Chunk64* negX, const Chunk64* posX,
                                  const Chunk64* negY, const Chunk64* posY,
                                  const Chunk64* negZ, const Chunk64* posZ,
-                                 Mesh& out, float s) {
-    out.vertices.clear(); out.indices.clear();
-    // Early outs for empty or fully solid volumes where no seam faces are possible
+                                 Mesh& out, float s,
+                                 const uint64_t* owned,
+                                 const ChunkEdgeCells* edges,
+                                 bool ambient_occlusion) {
+    out.clear();
     if (c.is_all_air()) return;
-    if (c.is_all_solid()) {
-        bool posX_s = posX ? posX->is_all_solid() : true;
-        bool negX_s = negX ? negX->is_all_solid() : true;
-        bool posY_s = posY ? posY->is_all_solid() : true;
-        bool negY_s = negY ? negY->is_all_solid() : true;
-        bool posZ_s = posZ ? posZ->is_all_solid() : true;
-        bool negZ_s = negZ ? negZ->is_all_solid() : true;
-        if (posX_s && negX_s && posY_s && negY_s && posZ_s && negZ_s) return;
+    const Chunk64* const nb[6] = { negX, posX, negY, posY, negZ, posZ };
+    const bool c_clear = has_clear_materials(c);
+    bool nb_clear[6];
+    bool any_clear = c_clear;
+    for (int i = 0; i < 6; ++i) {
+        nb_clear[i] = nb[i] && has_clear_materials(*nb[i]);
+        any_clear = any_clear || nb_clear[i];
+    }
+    // Early out for fully opaque volumes where no seam faces are possible
+    if (c.is_all_solid() && !any_clear) {
+        bool all_s = true;
+        for (int i = 0; i < 6; ++i) all_s = all_s && (!nb[i] || nb[i]->is_all_solid());
+        if (all_s) return;
     }
     const int N = Chunk64::N;
-    // For each axis
-    for (int axis = 0; axis < 3; ++axis) {
-        int du = (axis == 0) ? 2 : 0; // u index maps: for X axis, u=z; Y axis, u=x; Z axis, u=x
-        int dv = (axis == 0) ? 1 : ((axis == 1) ? 2 : 1); // for X axis, v=y; Y axis, v=z; Z axis, v=y
-        int dims[3] = { N, N, N };
-        int U = dims[du], V = dims[dv];
-        std::vector<MaskCell> mask(U * V);
-        std::vector<uint8_t> taken(U * V);
-        // Sweep layers between cells (N+1 planes)
-        for (int d = 0; d <= N; ++d) {
-            // Build mask at this plane
-            for (int v = 0; v < V; ++v) {
-                for (int u = 0; u < U; ++u) {
-                    int acoord = d - 1;
-                    int bcoord = d;
-                    // Compose coords for a and b
-                    int ax = 0, ay = 0, az = 0, bx = 0, by = 0, bz = 0;
-                    if (axis == 0) { // X
-                        ax = acoord; bx = bcoord; ay = v; by = v; az = u; bz = u;
-                    } else if (axis == 1) { // Y
-                        ay = acoord; by = bcoord; ax = u; bx = u; az = v; bz = v;
-                    } else { // Z
-                        az = acoord; bz = bcoord; ax = u; bx = u; ay = v; by = v;
-                    }
-                    bool a_in = (acoord >= 0 && acoord < N);
-                    bool b_in = (bcoord >= 0 && bcoord < N);
-                    MaskCell cell{0, 0};
-                    if (a_in && b_in) {
-                        bool a_sol = c.is_solid(ax, ay, az);
-                        bool b_sol = c.is_solid(bx, by, bz);
-                        if (a_sol != b_sol) {
-                            if (a_sol) { cell.mat = c.get_material(ax, ay, az); cell.sign = +1; }
-                            else       { cell.mat = c.get_material(bx, by, bz); cell.sign = -1; }
-                        }
-                    } else if (a_in && !b_in) {
-                        // Positive chunk boundary (d == N): consult neighbor to decide seam face; if no neighbor, do not emit (avoid outer walls)
-                        bool a_sol = c.is_solid(ax, ay, az);
-                        bool has_nb = (axis == 0) ? (posX != nullptr)
-                                      : (axis == 1) ? (posY != nullptr)
-                                                    : (posZ != nullptr);
-                        if (has_nb) {
-                            bool b_sol = false;
-                            if (axis == 0)      b_sol = get_neighbor_solid(posX, 0, by, bz);
-                            else if (axis == 1) b_sol = get_neighbor_solid(posY, bx, 0, bz);
-                            else                b_sol = get_neighbor_solid(posZ, bx, by, 0);
-                            if (a_sol != b_sol && a_sol) { cell.mat = c.get_material(ax, ay, az); cell.sign = +1; }
-                        } else {
-                            cell = {0, 0};
-                        }
-                    } else if (!a_in && b_in) {
-                        // Negative chunk boundary (d == 0): consult neighbor to decide seam face; if no neighbor, do not emit (avoid outer walls)
-                        bool has_nb = (axis == 0) ? (negX != nullptr)
-                                      : (axis == 1) ? (negY != nullptr)
-                                                    : (negZ != nullptr);
-                        if (has_nb) {
-                            bool b_sol = c.is_solid(bx, by, bz);
-                            bool a_sol = false;
-                            if (axis == 0)      a_sol = get_neighbor_solid(negX, Chunk64::N - 1, by, bz);
-                            else if (axis == 1) a_sol = get_neighbor_solid(negY, bx, Chunk64::N - 1, bz);
-                            else                a_sol = get_neighbor_solid(negZ, bx, by, Chunk64::N - 1);
-                            if (b_sol != a_sol && b_sol) { cell.mat = c.get_material(bx, by, bz); cell.sign = -1; }
-                        } else {
-                            cell = {0, 0};
+    static_assert(Chunk64::N == 64, "layer rows are one occupancy word wide");
+    // Occupancy words run along x; the X sweep wants rows along z, so transpose once:
+    // bit z of occ_x[x * N + y] is solid(x, y, z).
+    std::vector<uint64_t> occ_x;
+    transpose_x(c.occ.data(), occ_x);
+    // Opaque voxels face anything see-through; clear voxels (water) face air only.
+    std::vector<uint64_t> clear, clear_x, opaque, opaque_x;
+    std::vector<SweepPass> passes;
+    if (c_clear) {
+        clear_bits(c, clear);
+        opaque.resize(clear.size());
+        for (size_t i = 0; i < clear.size(); ++i) opaque[i] = c.occ[i] & ~clear[i];
+        transpose_x(clear.data(), clear_x);
+        transpose_x(opaque.data(), opaque_x);
+        passes.push_back(SweepPass{opaque.data(), opaque.data(), opaque_x.data(), opaque_x.data(),
+                                   kOpaqueCell, 1u << kOpaqueCell, false});
+        passes.push_back(SweepPass{clear.data(), c.occ.data(), clear_x.data(), occ_x.data(),
+                                   kClearCell, (1u << kClearCell) | (1u << kOpaqueCell), true});
+    } else {
+        passes.push_back(SweepPass{c.occ.data(), c.occ.data(), occ_x.data(), occ_x.data(),
+                                   kOpaqueCell, 1u << kOpaqueCell, false});
+    }
+    LayerSlab slabs[2];
+    for (const SweepPass& pass : passes) {
+        if (pass.translucent) out.begin_translucent();
+        // For each axis
+        for (int axis = 0; axis < 3; ++axis) {
+            int du = (axis == 0) ? 2 : 0; // u index maps: for X axis, u=z; Y axis, u=x; Z axis, u=x
+            int dv = (axis == 0) ? 1 : ((axis == 1) ? 2 : 1); // for X axis, v=y; Y axis, v=z; Z axis, v=y
+            int dims[3] = { N, N, N };
+            int U = dims[du], V = dims[dv];
+            std::vector<MaskCell> mask(U * V);
+            std::vector<uint8_t> taken(U * V);
+            auto to_xyz = [&](int layer, int u, int v, int& x, int& y, int& z) {
+                if (axis == 0)      { x = layer; y = v; z = u; }
+                else if (axis == 1) { x = u; y = layer; z = v; }
+                else                { x = u; y = v; z = layer; }
+            };
+            // Border cell as bit 0 emit, bit 1 block
+            auto bits_at = [&](int layer, int u, int v) -> uint8_t {
+                int x, y, z;
+                to_xyz(layer, u, v, x, y, z);
+                const uint8_t k = kind_around(c, c_clear, nb, nb_clear, edges, x, y, z);
+                return (uint8_t)((k == pass.emit_kind ? 1u : 0u) | (((pass.block_mask >> k) & 1u) << 1));
+            };
+            auto fill_slab = [&](int layer, LayerSlab& slab) {
+                const bool layer_in = (layer >= 0 && layer < N);
+                for (int v = -1; v <= V; ++v) {
+                    uint64_t e = 0, b = 0;
+                    if (layer_in && v >= 0 && v < V) {
+                        const size_t w = (axis == 0) ? (size_t)(layer * N + v) : (size_t)((axis == 1) ? (v * N + layer) : (layer * N + v));
+                        e = (axis == 0) ? pass.emit_x[w] : pass.emit[w];
+                        b = (axis == 0) ? pass.block_x[w] : pass.block[w];
+                    } else {
+                        for (int u = 0; u < U; ++u) {
+                            const uint8_t k = bits_at(layer, u, v);
+                            e |= (uint64_t)(k & 1u) << u;
+                            b |= (uint64_t)(k >> 1) << u;
                         }
                     }
-                    mask[u + v * U] = cell;
+                    slab.emit[v + 1] = e;
+                    slab.block[v + 1] = b;
+                    slab.lo[v + 1] = bits_at(layer, -1, v);
+                    slab.hi[v + 1] = bits_at(layer, U, v);
                 }
-            }
-            std::fill(taken.begin(), taken.end(), 0);
-            // Greedy merge
-            for (int v = 0; v < V; ++v) {
-                for (int u = 0; u < U; ) {
-                    const MaskCell c0 = mask[u + v * U];
-                    if (taken[u + v * U] || c0.mat == 0) { ++u; continue; }
-                    // width
-                    int w = 1;
-                    while (u + w < U && !taken[u + w + v * U] && cell_equal(mask[u + w + v * U], c0)) ++w;
-                    // height
-                    int h = 1;
-                    bool done = false;
-                    while (v + h < V && !done) {
-                        for (int x = 0; x < w; ++x) {
-                            if (taken[u + x + (v + h) * U] || !cell_equal(mask[u + x + (v + h) * U], c0)) { done = true; break; }
+            };
+            const bool has_neg = nb[axis * 2] != nullptr;
+            const bool has_pos = nb[axis * 2 + 1] != nullptr;
+            fill_slab(-1, slabs[1]);
+            // Sweep layers between cells (N+1 planes)
+            for (int d = 0; d <= N; ++d) {
+                const LayerSlab& sa = slabs[(d + 1) & 1]; // layer d - 1
+                LayerSlab& sb = slabs[d & 1];             // layer d
+                fill_slab(d, sb);
+                int acoord = d - 1;
+                int bcoord = d;
+                bool a_in = (acoord >= 0 && acoord < N);
+                bool b_in = (bcoord >= 0 && bcoord < N);
+                // Build mask at this plane, visiting only cells where an emitting side meets an unblocking one
+                std::fill(mask.begin(), mask.end(), MaskCell{0, 0, 0, 0});
+                for (int v = 0; v < V; ++v) {
+                    const uint64_t pos = sa.emit[v + 1] & ~sb.block[v + 1];
+                    const uint64_t neg = sb.emit[v + 1] & ~sa.block[v + 1];
+                    // At a chunk boundary only the in-chunk side emits, and only toward a present neighbor (no outer walls)
+                    uint64_t faces = (a_in && b_in) ? (pos | neg)
+                                   : a_in ? (has_pos ? pos : 0ull)
+                                          : (has_neg ? neg : 0ull);
+                    while (faces) {
+                        const int u = std::countr_zero(faces);
+                        faces &= faces - 1;
+                        int ax = 0, ay = 0, az = 0, bx = 0, by = 0, bz = 0;
+                        to_xyz(acoord, u, v, ax, ay, az);
+                        to_xyz(bcoord, u, v, bx, by, bz);
+                        MaskCell cell{0, 0, 0, 0};
+                        if ((pos >> u) & 1ull) { cell.mat = c.get_material(ax, ay, az); cell.sign = +1; }
+                        else                   { cell.mat = c.get_material(bx, by, bz); cell.sign = -1; }
+                        if (owned) {
+                            // The emitting voxel is the occupied side of the face
+                            int ox = (cell.sign > 0) ? ax : bx;
+                            int oy = (cell.sign > 0) ? ay : by;
+                            int oz = (cell.sign > 0) ? az : bz;
+                            if (((owned[oy + oz * N] >> ox) & 1ull) == 0) continue;
                         }
-                        if (!done) ++h;
+                        cell.ao = (pass.translucent || !ambient_occlusion) ? 0xFF : face_ao((cell.sign > 0) ? sb : sa, u, v);
+                        cell.light = (cell.sign > 0) ? light_around(c, nb, bx, by, bz) : light_around(c, nb, ax, ay, az);
+                        mask[u + v * U] = cell;
                     }
-                    // mark
-                    for (int y = 0; y < h; ++y) {
-                        for (int x = 0; x < w; ++x) taken[u + x + (v + y) * U] = 1;
-                    }
-                    // emit quad
-                    Float3 n{0,0,0};
-                    if (axis == 0) n = (c0.sign > 0) ? Float3{1,0,0} : Float3{-1,0,0};
-                    if (axis == 1) n = (c0.sign > 0) ? Float3{0,1,0} : Float3{0,-1,0};
-                    if (axis == 2) n = (c0.sign > 0) ? Float3{0,0,1} : Float3{0,0,-1};
-                    Float3 origin{0,0,0}, udir{0,0,0}, vdir{0,0,0};
-                    float plane = d * s;
-                    if (axis == 0) {
-                        origin = Float3{plane, v * s, u * s};
-                        udir = Float3{0, 0, 1}; // Z (du)
-                        vdir = Float3{0, 1, 0}; // Y (dv)
-                    } else if (axis == 1) {
-                        origin = Float3{u * s, plane, v * s};
-                        udir = Float3{1, 0, 0}; // X (du)
-                        vdir = Float3{0, 0, 1}; // Z (dv)
-                    } else {
-                        origin = Float3{u * s, v * s, plane};
-                        udir = Float3{1, 0, 0}; // X (du)
-                        vdir = Float3{0, 1, 0}; // Y (dv)
+                }
+                std::fill(taken.begin(), taken.end(), 0);
+                // Greedy merge
+                for (int v = 0; v < V; ++v) {
+                    for (int u = 0; u < U; ) {
+                        const MaskCell c0 = mask[u + v * U];
+                        if (taken[u + v * U] || c0.mat == 0) { ++u; continue; }
+                        // width
+                        int w = 1;
+                        while (u + w < U && !taken[u + w + v * U] && cell_equal(mask[u + w + v * U], c0)) ++w;
+                        // height
+                        int h = 1;
+                        bool done = false;
+                        while (v + h < V && !done) {
+                            for (int x = 0; x < w; ++x) {
+                                if (taken[u + x + (v + h) * U] || !cell_equal(mask[u + x + (v + h) * U], c0)) { done = true; break; }
+                            }
+                            if (!done) ++h;
+                        }
+                        // mark
+                        for (int y = 0; y < h; ++y) {
+                            for (int x = 0; x < w; ++x) taken[u + x + (v + y) * U] = 1;
+                        }
+                        // emit quad
+                        Float3 n{0,0,0};
+                        if (axis == 0) n = (c0.sign > 0) ? Float3{1,0,0} : Float3{-1,0,0};
+                        if (axis == 1) n = (c0.sign > 0) ? Float3{0,1,0} : Float3{0,-1,0};
+                        if (axis == 2) n = (c0.sign > 0) ? Float3{0,0,1} : Float3{0,0,-1};
+                        Float3 origin{0,0,0}, udir{0,0,0}, vdir{0,0,0};
+                        float plane = d * s;
+                        if (axis == 0) {
+                            origin = Float3{plane, v * s, u * s};
+                            udir = Float3{0, 0, 1}; // Z (du)
+                            vdir = Float3{0, 1, 0}; // Y (dv)
+                        } else if (axis == 1) {
+                            origin = Float3{u * s, plane, v * s};
+                            udir = Float3{1, 0, 0}; // X (du)
+                            vdir = Float3{0, 0, 1}; // Z (dv)
+                        } else {
+                            origin = Float3{u * s, v * s, plane};
+                            udir = Float3{1, 0, 0}; // X (du)
+                            vdir = Float3{0, 1, 0}; // Y (dv)
+                        }
+                        // Flip indices depending on axis/sign to make outward faces front-facing under CLOCKWISE
+                        bool flip = (axis == 0 || axis == 1) ? (c0.sign > 0) : (c0.sign < 0);
+                        add_quad(out, origin, udir, vdir, n, w * s, h * s, c0.mat, c0.ao, c0.light, flip);
+                        u += w;
                     }
-                    // Flip indices depending on axis/sign to make outward faces front-facing under CLOCKWISE
-                    bool flip = (axis == 0 || axis == 1) ? (c0.sign > 0) : (c0.sign < 0);
-                    add_quad(out, origin, udir, vdir, n, w * s, h * s, c0.mat, flip);
-                    u += w;
                 }
             }
         }
@@ -6,7 +6,7 @@ namespace wf {
 
 static inline void add_quad(Mesh& m, float x, float y, float z, float w, float h,
                             Float3 u, Float3 v, Float3 n, uint16_t mat) {
-    const uint32_t base = (uint32_t)m.vertices.size();
+    const uint32_t base = m.begin_vertices(4);
     Float3 p0 = {x, y, z};
     Float3 p1 = {x + u.x * w, y + u.y * w, z + u.z * w};
     Float3 p2 = {p1.x + v.x * h, p1.y + v.y * h, p1.z + v.z * h};
@@ -21,17 +21,17 @@ static inline void add_quad(Mesh& m, float x, float y, float z, float w, float h
     m.vertices.push_back(v2);
     m.vertices.push_back(v3);
     // two triangles
-    m.indices.push_back(base + 0);
-    m.indices.push_back(base + 1);
-    m.indices.push_back(base + 2);
-    m.indices.push_back(base + 0);
-    m.indices.push_back(base + 2);
-    m.indices.push_back(base + 3);
+    m.push_index(base + 0);
+    m.push_index(base + 1);
+    m.push_index(base + 2);
+    m.push_index(base + 0);
+    m.push_index(base + 2);
+    m.push_index(base + 3);
 }
 
 // Naive mesher: emits a face for any solid voxel face that borders air or a different material
 void mesh_chunk_naive(const Chunk64& c, Mesh& out, float voxel_size_m) {
-    out.vertices.clear(); out.indices.clear();
+    out.clear();
     const int N = Chunk64::N;
     for (int z = 0; z < N; ++z) {
         for (int y = 0; y < N; ++y) {
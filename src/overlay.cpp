@@ -1,114 +1,21 @@
 #include "overlay.h"
 #include "vk_utils.h"
+#include "ui/ui_text.h"
 
+#include <cstddef>
 #include <cstring>
 #include <algorithm>
+#include <chrono>
 #include <iostream>
 
 namespace wf {
 
-// 6x8 bitmap font (ASCII 32..127). Each row uses 6 low bits, bit0 is leftmost pixel.
-static const uint8_t WF_FONT6x8[96][8] = {
-    /* 32 ' ' */ {0,0,0,0,0,0,0,0},
-    /* 33 '!' */ {0x04,0x04,0x04,0x04,0x04,0x00,0x04,0x00},
-    /* 34 '"'*/ {0x0a,0x0a,0x0a,0x00,0x00,0x00,0x00,0x00},
-    /* 35 '#' */ {0x0a,0x1f,0x0a,0x0a,0x1f,0x0a,0x00,0x00},
-    /* 36 '$' */ {0x04,0x1e,0x05,0x0e,0x14,0x0f,0x04,0x00},
-    /* 37 '%' */ {0x03,0x13,0x08,0x04,0x02,0x19,0x18,0x00},
-    /* 38 '&' */ {0x06,0x09,0x05,0x02,0x15,0x09,0x16,0x00},
-    /* 39 '\''*/ {0x06,0x02,0x04,0x00,0x00,0x00,0x00,0x00},
-    /* 40 '(' */ {0x08,0x04,0x02,0x02,0x02,0x04,0x08,0x00},
-    /* 41 ')' */ {0x02,0x04,0x08,0x08,0x08,0x04,0x02,0x00},
-    /* 42 '*' */ {0x04,0x15,0x0e,0x04,0x0e,0x15,0x04,0x00},
-    /* 43 '+' */ {0x00,0x04,0x04,0x1f,0x04,0x04,0x00,0x00},
-    /* 44 ',' */ {0x00,0x00,0x00,0x00,0x06,0x02,0x04,0x00},
-    /* 45 '-' */ {0x00,0x00,0x00,0x1f,0x00,0x00,0x00,0x00},
-    /* 46 '.' */ {0x00,0x00,0x00,0x00,0x00,0x06,0x06,0x00},
-    /* 47 '/' */ {0x10,0x10,0x08,0x04,0x02,0x01,0x01,0x00},
-    /* 48 '0' */ {0x0e,0x11,0x13,0x15,0x19,0x11,0x0e,0x00},
-    /* 49 '1' */ {0x04,0x06,0x04,0x04,0x04,0x04,0x1f,0x00},
-    /* 50 '2' */ {0x0e,0x11,0x10,0x0c,0x02,0x01,0x1f,0x00},
-    /* 51 '3' */ {0x1f,0x10,0x0c,0x10,0x10,0x11,0x0e,0x00},
-    /* 52 '4' */ {0x08,0x0c,0x0a,0x09,0x1f,0x08,0x08,0x00},
-    /* 53 '5' */ {0x1f,0x01,0x0f,0x10,0x10,0x11,0x0e,0x00},
-    /* 54 '6' */ {0x0c,0x02,0x01,0x0f,0x11,0x11,0x0e,0x00},
-    /* 55 '7' */ {0x1f,0x10,0x08,0x04,0x02,0x02,0x02,0x00},
-    /* 56 '8' */ {0x0e,0x11,0x11,0x0e,0x11,0x11,0x0e,0x00},
-    /* 57 '9' */ {0x0e,0x11,0x11,0x1e,0x10,0x08,0x06,0x00},
-    /* 58 ':' */ {0x00,0x06,0x06,0x00,0x06,0x06,0x00,0x00},
-    /* 59 ';' */ {0x00,0x06,0x06,0x00,0x06,0x02,0x04,0x00},
-    /* 60 '<' */ {0x08,0x04,0x02,0x01,0x02,0x04,0x08,0x00},
-    /* 61 '=' */ {0x00,0x00,0x1f,0x00,0x1f,0x00,0x00,0x00},
-    /* 62 '>' */ {0x02,0x04,0x08,0x10,0x08,0x04,0x02,0x00},
-    /* 63 '?' */ {0x0e,0x11,0x10,0x08,0x04,0x00,0x04,0x00},
-    /* 64 '@' */ {0x0e,0x11,0x1d,0x15,0x1d,0x01,0x0e,0x00},
-    /* 65 'A' */ {0x0e,0x11,0x11,0x1f,0x11,0x11,0x11,0x00},
-    /* 66 'B' */ {0x0f,0x11,0x11,0x0f,0x11,0x11,0x0f,0x00},
-    /* 67 'C' */ {0x0e,0x11,0x01,0x01,0x01,0x11,0x0e,0x00},
-    /* 68 'D' */ {0x0f,0x11,0x11,0x11,0x11,0x11,0x0f,0x00},
-    /* 69 'E' */ {0x1f,0x01,0x01,0x0f,0x01,0x01,0x1f,0x00},
-    /* 70 'F' */ {0x1f,0x01,0x01,0x0f,0x01,0x01,0x01,0x00},
-    /* 71 'G' */ {0x0e,0x11,0x01,0x1d,0x11,0x11,0x1e,0x00},
-    /* 72 'H' */ {0x11,0x11,0x11,0x1f,0x11,0x11,0x11,0x00},
-    /* 73 'I' */ {0x0e,0x04,0x04,0x04,0x04,0x04,0x0e,0x00},
-    /* 74 'J' */ {0x1c,0x08,0x08,0x08,0x08,0x09,0x06,0x00},
-    /* 75 'K' */ {0x11,0x09,0x05,0x03,0x05,0x09,0x11,0x00},
-    /* 76 'L' */ {0x01,0x01,0x01,0x01,0x01,0x01,0x1f,0x00},
-    /* 77 'M' */ {0x11,0x1b,0x15,0x11,0x11,0x11,0x11,0x00},
-    /* 78 'N' */ {0x11,0x11,0x13,0x15,0x19,0x11,0x11,0x00},
-    /* 79 'O' */ {0x0e,0x11,0x11,0x11,0x11,0x11,0x0e,0x00},
-    /* 80 'P' */ {0x0f,0x11,0x11,0x0f,0x01,0x01,0x01,0x00},
-    /* 81 'Q' */ {0x0e,0x11,0x11,0x11,0x15,0x09,0x16,0x00},
-    /* 82 'R' */ {0x0f,0x11,0x11,0x0f,0x05,0x09,0x11,0x00},
-    /* 83 'S' */ {0x1e,0x01,0x01,0x0e,0x10,0x10,0x0f,0x00},
-    /* 84 'T' */ {0x1f,0x04,0x04,0x04,0x04,0x04,0x04,0x00},
-    /* 85 'U' */ {0x11,0x11,0x11,0x11,0x11,0x11,0x0e,0x00},
-    /* 86 'V' */ {0x11,0x11,0x11,0x11,0x11,0x0a,0x04,0x00},
-    /* 87 'W' */ {0x11,0x11,0x11,0x11,0x15,0x1b,0x11,0x00},
-    /* 88 'X' */ {0x11,0x11,0x0a,0x04,0x0a,0x11,0x11,0x00},
-    /* 89 'Y' */ {0x11,0x11,0x0a,0x04,0x04,0x04,0x04,0x00},
-    /* 90 'Z' */ {0x1f,0x10,0x08,0x04,0x02,0x01,0x1f,0x00},
-    /* 91 '[' */ {0x0e,0x02,0x02,0x02,0x02,0x02,0x0e,0x00},
-    /* 92 '\\'*/ {0x01,0x01,0x02,0x04,0x08,0x10,0x10,0x00},
-    /* 93 ']' */ {0x0e,0x08,0x08,0x08,0x08,0x08,0x0e,0x00},
-    /* 94 '^' */ {0x04,0x0a,0x11,0x00,0x00,0x00,0x00,0x00},
-    /* 95 '_' */ {0x00,0x00,0x00,0x00,0x00,0x00,0x1f,0x00},
-    /* 96 '`' */ {0x06,0x04,0x08,0x00,0x00,0x00,0x00,0x00},
-    /* 97 'a' */ {0x00,0x00,0x0e,0x10,0x1e,0x11,0x1e,0x00},
-    /* 98 'b' */ {0x01,0x01,0x0f,0x11,0x11,0x11,0x0f,0x00},
-    /* 99 'c' */ {0x00,0x00,0x0e,0x01,0x01,0x01,0x0e,0x00},
-    /*100 'd' */ {0x10,0x10,0x1e,0x11,0x11,0x11,0x1e,0x00},
-    /*101 'e' */ {0x00,0x00,0x0e,0x11,0x1f,0x01,0x0e,0x00},
-    /*102 'f' */ {0x0c,0x02,0x0f,0x02,0x02,0x02,0x02,0x00},
-    /*103 'g' */ {0x00,0x00,0x1e,0x11,0x11,0x1e,0x10,0x0e},
-    /*104 'h' */ {0x01,0x01,0x0f,0x11,0x11,0x11,0x11,0x00},
-    /*105 'i' */ {0x00,0x04,0x00,0x06,0x04,0x04,0x0e,0x00},
-    /*106 'j' */ {0x00,0x08,0x00,0x0c,0x08,0x08,0x06,0x00},
-    /*107 'k' */ {0x01,0x09,0x05,0x03,0x05,0x09,0x11,0x00},
-    /*108 'l' */ {0x06,0x04,0x04,0x04,0x04,0x04,0x0e,0x00},
-    /*109 'm' */ {0x00,0x00,0x1b,0x15,0x15,0x11,0x11,0x00},
-    /*110 'n' */ {0x00,0x00,0x0f,0x11,0x11,0x11,0x11,0x00},
-    /*111 'o' */ {0x00,0x00,0x0e,0x11,0x11,0x11,0x0e,0x00},
-    /*112 'p' */ {0x00,0x00,0x0f,0x11,0x11,0x0f,0x01,0x01},
-    /*113 'q' */ {0x00,0x00,0x1e,0x11,0x11,0x1e,0x10,0x10},
-    /*114 'r' */ {0x00,0x00,0x0d,0x13,0x01,0x01,0x01,0x00},
-    /*115 's' */ {0x00,0x00,0x1e,0x01,0x0e,0x10,0x0f,0x00},
-    /*116 't' */ {0x02,0x02,0x0f,0x02,0x02,0x02,0x0c,0x00},
-    /*117 'u' */ {0x00,0x00,0x11,0x11,0x11,0x11,0x1e,0x00},
-    /*118 'v' */ {0x00,0x00,0x11,0x11,0x11,0x0a,0x04,0x00},
-    /*119 'w' */ {0x00,0x00,0x11,0x11,0x15,0x1b,0x11,0x00},
-    /*120 'x' */ {0x00,0x00,0x11,0x0a,0x04,0x0a,0x11,0x00},
-    /*121 'y' */ {0x00,0x00,0x11,0x11,0x1e,0x10,0x0e,0x00},
-    /*122 'z' */ {0x00,0x00,0x1f,0x08,0x04,0x02,0x1f,0x00},
-    /*123 '{' */ {0x0c,0x04,0x04,0x03,0x04,0x04,0x0c,0x00},
-    /*124 '|' */ {0x04,0x04,0x04,0x00,0x04,0x04,0x04,0x00},
-    /*125 '}' */ {0x03,0x04,0x04,0x18,0x04,0x04,0x03,0x00},
-    /*126 '~' */ {0x08,0x15,0x02,0x00,0x00,0x00,0x00,0x00},
-    /*127     */ {0,0,0,0,0,0,0,0}
-};
-
 void OverlayRenderer::init(VkPhysicalDevice phys, VkDevice dev, VkRenderPass renderPass, VkExtent2D extent, const char* shaderDir) {
     phys_ = phys; device_ = dev; extent_ = extent;
+    if (!atlas_image_ && !create_atlas()) {
+        std::cout << "[info] Overlay glyph atlas unavailable. HUD disabled." << std::endl;
+        return;
+    }
     // Load shaders
     auto read_all = [](const std::string& p, std::vector<char>& out)->bool{ FILE* f = fopen(p.c_str(), "rb"); if(!f) return false; fseek(f,0,SEEK_END); long len=ftell(f); fseek(f,0,SEEK_SET); out.resize(len); size_t rd=fread(out.data(),1,out.size(),f); fclose(f); return rd==out.size(); };
     auto load_shader = [&](const std::string& path)->VkShaderModule{
@@ -135,15 +42,17 @@ void OverlayRenderer::init(VkPhysicalDevice phys, VkDevice dev, VkRenderPass ren
     stages[0].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO; stages[0].stage = VK_SHADER_STAGE_VERTEX_BIT; stages[0].module = vs; stages[0].pName = "main";
     stages[1].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO; stages[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT; stages[1].module = fs; stages[1].pName = "main";
 
-    VkVertexInputBindingDescription bind{}; bind.binding = 0; bind.stride = sizeof(float) * 6; bind.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
-    VkVertexInputAttributeDescription attrs[2]{};
-    attrs[0].location = 0; attrs[0].binding = 0; attrs[0].format = VK_FORMAT_R32G32_SFLOAT; attrs[0].offset = 0;
-    attrs[1].location = 1; attrs[1].binding = 0; attrs[1].format = VK_FORMAT_R32G32B32A32_SFLOAT; attrs[1].offset = sizeof(float) * 2;
+    VkVertexInputBindingDescription bind{}; bind.binding = 0; bind.stride = sizeof(ui::UIDrawVertex); bind.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+    VkVertexInputAttributeDescription attrs[4]{};
+    attrs[0].location = 0; attrs[0].binding = 0; attrs[0].format = VK_FORMAT_R32G32_SFLOAT; attrs[0].offset = offsetof(ui::UIDrawVertex, x);
+    attrs[1].location = 1; attrs[1].binding = 0; attrs[1].format = VK_FORMAT_R32G32_SFLOAT; attrs[1].offset = offsetof(ui::UIDrawVertex, u);
+    attrs[2].location = 2; attrs[2].binding = 0; attrs[2].format = VK_FORMAT_R32G32B32A32_SFLOAT; attrs[2].offset = offsetof(ui::UIDrawVertex, r);
+    attrs[3].location = 3; attrs[3].binding = 0; attrs[3].format = VK_FORMAT_R32_SFLOAT; attrs[3].offset = offsetof(ui::UIDrawVertex, shadow);
     VkPipelineVertexInputStateCreateInfo vi{};
     vi.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
     vi.vertexBindingDescriptionCount = 1;
     vi.pVertexBindingDescriptions = &bind;
-    vi.vertexAttributeDescriptionCount = 2;
+    vi.vertexAttributeDescriptionCount = 4;
     vi.pVertexAttributeDescriptions = attrs;
 
     VkPipelineInputAssemblyStateCreateInfo ia{};
@@ -175,8 +84,13 @@ void OverlayRenderer::init(VkPhysicalDevice phys, VkDevice dev, VkRenderPass ren
     ds.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
     ds.depthTestEnable = VK_FALSE;
     ds.depthWriteEnable = VK_FALSE;
+    VkPushConstantRange pcr{}; pcr.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT; pcr.offset = 0; pcr.size = sizeof(float) * 4; // shadow color
     VkPipelineLayoutCreateInfo plci{};
     plci.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    plci.setLayoutCount = 1;
+    plci.pSetLayouts = &set_layout_;
+    plci.pushConstantRangeCount = 1;
+    plci.pPushConstantRanges = &pcr;
     if (vkCreatePipelineLayout(device_, &plci, nullptr, &pipeline_layout_) != VK_SUCCESS) {
         vkDestroyShaderModule(device_, vs, nullptr); vkDestroyShaderModule(device_, fs, nullptr); return;
     }
@@ -214,10 +128,139 @@ void OverlayRenderer::cleanup(VkDevice dev) {
     if (pipeline_) { vkDestroyPipeline(dev, pipeline_, nullptr); pipeline_ = VK_NULL_HANDLE; }
     if (pipeline_layout_) { vkDestroyPipelineLayout(dev, pipeline_layout_, nullptr); pipeline_layout_ = VK_NULL_HANDLE; }
     for (size_t i=0;i<kFrames;++i) {
+        if (mapped_[i]) vkUnmapMemory(dev, vmem_[i]);
         if (vbuf_[i]) vkDestroyBuffer(dev, vbuf_[i], nullptr);
         if (vmem_[i]) vkFreeMemory(dev, vmem_[i], nullptr);
-        vbuf_[i]=VK_NULL_HANDLE; vmem_[i]=VK_NULL_HANDLE; capacity_bytes_[i]=0; vertex_count_[i]=0;
+        vbuf_[i]=VK_NULL_HANDLE; vmem_[i]=VK_NULL_HANDLE; mapped_[i]=nullptr; capacity_bytes_[i]=0; index_offset_[i]=0; index_count_[i]=0; slot_valid_[i]=false;
     }
+    destroy_atlas(dev);
+}
+
+bool OverlayRenderer::create_atlas() {
+    if (!transfer_queue_) return false;
+    const ui::GlyphAtlas& atlas = ui::glyph_atlas();
+    const VkDeviceSize bytes = static_cast<VkDeviceSize>(atlas.pixels.size());
+
+    VkImageCreateInfo ici{};
+    ici.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    ici.imageType = VK_IMAGE_TYPE_2D;
+    ici.format = VK_FORMAT_R8_UNORM;
+    ici.extent = {static_cast<uint32_t>(atlas.width), static_cast<uint32_t>(atlas.height), 1};
+    ici.mipLevels = 1;
+    ici.arrayLayers = 1;
+    ici.samples = VK_SAMPLE_COUNT_1_BIT;
+    ici.tiling = VK_IMAGE_TILING_OPTIMAL;
+    ici.usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+    ici.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    ici.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    if (vkCreateImage(device_, &ici, nullptr, &atlas_image_) != VK_SUCCESS) return false;
+    VkMemoryRequirements req{}; vkGetImageMemoryRequirements(device_, atlas_image_, &req);
+    VkMemoryAllocateInfo mai{};
+    mai.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    mai.allocationSize = req.size;
+    mai.memoryTypeIndex = find_memory_type(req.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    if (vkAllocateMemory(device_, &mai, nullptr, &atlas_mem_) != VK_SUCCESS) { destroy_atlas(device_); return false; }
+    vkBindImageMemory(device_, atlas_image_, atlas_mem_, 0);
+
+    // Staging copy through a throwaway pool on the graphics queue
+    VkBuffer staging = VK_NULL_HANDLE; VkDeviceMemory staging_mem = VK_NULL_HANDLE;
+    create_host_buffer(bytes, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, staging, staging_mem, atlas.pixels.data());
+    VkCommandPoolCreateInfo pci{};
+    pci.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    pci.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+    pci.queueFamilyIndex = transfer_queue_family_;
+    VkCommandPool pool = VK_NULL_HANDLE;
+    vkCreateCommandPool(device_, &pci, nullptr, &pool);
+    VkCommandBuffer cmd = wf::vk::begin_one_time_commands(device_, pool);
+    VkImageMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = atlas_image_;
+    barrier.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1};
+    barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+    VkBufferImageCopy region{};
+    region.imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1};
+    region.imageExtent = ici.extent;
+    vkCmdCopyBufferToImage(cmd, staging, atlas_image_, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+    wf::vk::end_one_time_commands(device_, transfer_queue_, pool, cmd);
+    vkDestroyCommandPool(device_, pool, nullptr);
+    vkDestroyBuffer(device_, staging, nullptr);
+    vkFreeMemory(device_, staging_mem, nullptr);
+
+    VkImageViewCreateInfo vci{};
+    vci.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    vci.image = atlas_image_;
+    vci.viewType = VK_IMAGE_VIEW_TYPE_2D;
+    vci.format = VK_FORMAT_R8_UNORM;
+    vci.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1};
+    if (vkCreateImageView(device_, &vci, nullptr, &atlas_view_) != VK_SUCCESS) { destroy_atlas(device_); return false; }
+
+    // Nearest + clamp: glyph texels map 1:N onto screen pixels
+    VkSamplerCreateInfo sci{};
+    sci.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+    sci.magFilter = VK_FILTER_NEAREST;
+    sci.minFilter = VK_FILTER_NEAREST;
+    sci.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+    sci.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    sci.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    sci.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    if (vkCreateSampler(device_, &sci, nullptr, &atlas_sampler_) != VK_SUCCESS) { destroy_atlas(device_); return false; }
+
+    VkDescriptorSetLayoutBinding binding{};
+    binding.binding = 0;
+    binding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    binding.descriptorCount = 1;
+    binding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+    VkDescriptorSetLayoutCreateInfo dslci{};
+    dslci.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    dslci.bindingCount = 1;
+    dslci.pBindings = &binding;
+    if (vkCreateDescriptorSetLayout(device_, &dslci, nullptr, &set_layout_) != VK_SUCCESS) { destroy_atlas(device_); return false; }
+    VkDescriptorPoolSize psize{}; psize.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER; psize.descriptorCount = 1;
+    VkDescriptorPoolCreateInfo dpci{};
+    dpci.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    dpci.maxSets = 1;
+    dpci.poolSizeCount = 1;
+    dpci.pPoolSizes = &psize;
+    if (vkCreateDescriptorPool(device_, &dpci, nullptr, &descriptor_pool_) != VK_SUCCESS) { destroy_atlas(device_); return false; }
+    VkDescriptorSetAllocateInfo dsai{};
+    dsai.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    dsai.descriptorPool = descriptor_pool_;
+    dsai.descriptorSetCount = 1;
+    dsai.pSetLayouts = &set_layout_;
+    if (vkAllocateDescriptorSets(device_, &dsai, &descriptor_set_) != VK_SUCCESS) { destroy_atlas(device_); return false; }
+    VkDescriptorImageInfo dii{};
+    dii.sampler = atlas_sampler_;
+    dii.imageView = atlas_view_;
+    dii.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    VkWriteDescriptorSet wds{};
+    wds.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    wds.dstSet = descriptor_set_;
+    wds.dstBinding = 0;
+    wds.descriptorCount = 1;
+    wds.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    wds.pImageInfo = &dii;
+    vkUpdateDescriptorSets(device_, 1, &wds, 0, nullptr);
+    return true;
+}
+
+void OverlayRenderer::destroy_atlas(VkDevice dev) {
+    if (descriptor_pool_) { vkDestroyDescriptorPool(dev, descriptor_pool_, nullptr); descriptor_pool_ = VK_NULL_HANDLE; }
+    descriptor_set_ = VK_NULL_HANDLE;
+    if (set_layout_) { vkDestroyDescriptorSetLayout(dev, set_layout_, nullptr); set_layout_ = VK_NULL_HANDLE; }
+    if (atlas_sampler_) { vkDestroySampler(dev, atlas_sampler_, nullptr); atlas_sampler_ = VK_NULL_HANDLE; }
+    if (atlas_view_) { vkDestroyImageView(dev, atlas_view_, nullptr); atlas_view_ = VK_NULL_HANDLE; }
+    if (atlas_image_) { vkDestroyImage(dev, atlas_image_, nullptr); atlas_image_ = VK_NULL_HANDLE; }
+    if (atlas_mem_) { vkFreeMemory(dev, atlas_mem_, nullptr); atlas_mem_ = VK_NULL_HANDLE; }
 }
 
 uint32_t OverlayRenderer::find_memory_type(uint32_t typeBits, VkMemoryPropertyFlags properties) {
@@ -233,30 +276,73 @@ void OverlayRenderer::create_host_buffer(VkDeviceSize size, VkBufferUsageFlags u
 
 void OverlayRenderer::upload_draw_data(size_t frameSlot, const ui::UIDrawData& drawData) {
     if (frameSlot >= kFrames) return;
-    VkDeviceSize bytes = static_cast<VkDeviceSize>(drawData.vertex_count * sizeof(ui::UIDrawVertex));
-    if (bytes == 0 || !drawData.vertices) {
-        vertex_count_[frameSlot] = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    last_upload_bytes_ = 0;
+    VkDeviceSize vbytes = static_cast<VkDeviceSize>(drawData.vertex_count * sizeof(ui::UIDrawVertex));
+    VkDeviceSize ibytes = static_cast<VkDeviceSize>(drawData.index_count * sizeof(uint32_t));
+    if (vbytes == 0 || ibytes == 0 || !drawData.vertices || !drawData.indices) {
+        index_count_[frameSlot] = 0;
+        slot_valid_[frameSlot] = false;
+        last_upload_ms_ = 0.0;
         return;
     }
+    VkDeviceSize ioffset = (vbytes + 3) & ~VkDeviceSize(3);
+    VkDeviceSize bytes = ioffset + ibytes;
     if (capacity_bytes_[frameSlot] < bytes) {
+        // The slot's previous frame has retired (its fence was waited), so it is safe to replace.
+        if (mapped_[frameSlot]) { vkUnmapMemory(device_, vmem_[frameSlot]); mapped_[frameSlot] = nullptr; }
         if (vbuf_[frameSlot]) { vkDestroyBuffer(device_, vbuf_[frameSlot], nullptr); vbuf_[frameSlot] = VK_NULL_HANDLE; }
         if (vmem_[frameSlot]) { vkFreeMemory(device_, vmem_[frameSlot], nullptr); vmem_[frameSlot] = VK_NULL_HANDLE; }
-        capacity_bytes_[frameSlot] = std::max<VkDeviceSize>(bytes, 64 * 1024);
-        create_host_buffer(capacity_bytes_[frameSlot], VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, vbuf_[frameSlot], vmem_[frameSlot], nullptr);
+        capacity_bytes_[frameSlot] = std::max<VkDeviceSize>(bytes + bytes / 2, 64 * 1024);
+        create_host_buffer(capacity_bytes_[frameSlot], VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
+                           vbuf_[frameSlot], vmem_[frameSlot], nullptr);
+        vkMapMemory(device_, vmem_[frameSlot], 0, capacity_bytes_[frameSlot], 0, &mapped_[frameSlot]);
+        slot_valid_[frameSlot] = false;
+    }
+    if (!mapped_[frameSlot]) { index_count_[frameSlot] = 0; slot_valid_[frameSlot] = false; return; }
+    char* dst = static_cast<char*>(mapped_[frameSlot]);
+
+    // Each slot keeps the revision it last received. A slot that is still on the
+    // current layout only needs the vertex ranges patched since then; the index
+    // region is untouched until the next repack.
+    const uint64_t slot_rev = slot_revision_[frameSlot];
+    const bool patchable = slot_valid_[frameSlot] && index_offset_[frameSlot] == ioffset &&
+                           slot_rev >= drawData.layout_revision && slot_rev >= drawData.patch_base_revision;
+    if (patchable) {
+        if (slot_rev != drawData.revision) {
+            for (size_t i = 0; i < drawData.dirty_range_count; ++i) {
+                const ui::UIDirtyRange& r = drawData.dirty_ranges[i];
+                if (r.revision <= slot_rev) continue;
+                size_t off = static_cast<size_t>(r.first_vertex) * sizeof(ui::UIDrawVertex);
+                size_t len = static_cast<size_t>(r.vertex_count) * sizeof(ui::UIDrawVertex);
+                std::memcpy(dst + off, drawData.vertices + r.first_vertex, len);
+                last_upload_bytes_ += len;
+            }
+        }
+    } else {
+        std::memcpy(dst, drawData.vertices, static_cast<std::size_t>(vbytes));
+        std::memcpy(dst + ioffset, drawData.indices, static_cast<std::size_t>(ibytes));
+        last_upload_bytes_ = static_cast<size_t>(vbytes + ibytes);
     }
-    void* mapped = nullptr;
-    vkMapMemory(device_, vmem_[frameSlot], 0, capacity_bytes_[frameSlot], 0, &mapped);
-    std::memcpy(mapped, drawData.vertices, static_cast<std::size_t>(bytes));
-    vkUnmapMemory(device_, vmem_[frameSlot]);
-    vertex_count_[frameSlot] = static_cast<uint32_t>(drawData.vertex_count);
+    slot_revision_[frameSlot] = drawData.revision;
+    slot_valid_[frameSlot] = true;
+    index_offset_[frameSlot] = ioffset;
+    index_count_[frameSlot] = static_cast<uint32_t>(drawData.index_count);
+    shadow_color_[frameSlot] = drawData.shadow_color;
+    last_upload_ms_ = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
 }
 
 void OverlayRenderer::record_draw(VkCommandBuffer cmd, size_t frameSlot) {
-    if (!pipeline_ || vertex_count_[frameSlot] == 0) return;
+    if (!pipeline_ || frameSlot >= kFrames || index_count_[frameSlot] == 0) return;
     vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline_);
+    vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline_layout_, 0, 1, &descriptor_set_, 0, nullptr);
+    const ui::Color& sc = shadow_color_[frameSlot];
+    float shadow[4] = {sc.r, sc.g, sc.b, sc.a};
+    vkCmdPushConstants(cmd, pipeline_layout_, VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(shadow), shadow);
     VkDeviceSize offs = 0; VkBuffer vb = vbuf_[frameSlot];
     vkCmdBindVertexBuffers(cmd, 0, 1, &vb, &offs);
-    vkCmdDraw(cmd, vertex_count_[frameSlot], 1, 0, 0);
+    vkCmdBindIndexBuffer(cmd, vb, index_offset_[frameSlot], VK_INDEX_TYPE_UINT32);
+    vkCmdDrawIndexed(cmd, index_count_[frameSlot], 1, 0, 0, 0);
 }
 
 } // namespace wf
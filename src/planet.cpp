@@ -1,7 +1,13 @@
 #include "planet.h"
+#include "chunk.h"
+#include "height_tile_cache.h"
 #include "wf_noise.h"
 
 #include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <vector>
 
 namespace wf {
 
@@ -16,6 +22,37 @@ static const Float3 FACE_FORWARD[6] = {
     {1,0,0},  {-1,0,0}, {0,1,0}, {0,-1,0}, {0,0,1}, {0,0,-1}
 };
 
+std::uint64_t planet_config_hash(const PlanetConfig& cfg) {
+    // FNV-1a 64 over fixed-width little-endian field encodings
+    std::uint64_t h = 14695981039346656037ull;
+    auto mix = [&h](std::uint64_t v, int bytes) {
+        for (int b = 0; b < bytes; ++b) {
+            h ^= (v >> (b * 8)) & 0xFFu;
+            h *= 1099511628211ull;
+        }
+    };
+    mix(std::bit_cast<std::uint64_t>(cfg.radius_m), 8);
+    mix(std::bit_cast<std::uint64_t>(cfg.voxel_size_m), 8);
+    mix(std::bit_cast<std::uint64_t>(cfg.sea_level_m), 8);
+    mix(cfg.seed, 4);
+    mix(std::bit_cast<std::uint64_t>(cfg.terrain_amp_m), 8);
+    mix(std::bit_cast<std::uint32_t>(cfg.terrain_freq), 4);
+    mix(static_cast<std::uint32_t>(cfg.terrain_octaves), 4);
+    mix(std::bit_cast<std::uint32_t>(cfg.terrain_lacunarity), 4);
+    mix(std::bit_cast<std::uint32_t>(cfg.terrain_gain), 4);
+    // Mixed only when set, so worlds stamped before these fields existed stay valid.
+    if (cfg.terrain_noise != NoiseBasis::Value) mix(static_cast<std::uint32_t>(cfg.terrain_noise), 1);
+    if (cfg.terrain_warp != 0.0f) mix(std::bit_cast<std::uint32_t>(cfg.terrain_warp), 4);
+    return h;
+}
+
+GeneratorStamp generator_stamp(const PlanetConfig& cfg) {
+    GeneratorStamp stamp{};
+    stamp.generator_version = kGeneratorVersion;
+    stamp.config_hash = planet_config_hash(cfg);
+    return stamp;
+}
+
 int face_from_direction(Float3 d) {
     Float3 a = { std::fabs(d.x), std::fabs(d.y), std::fabs(d.z) };
     if (a.x >= a.y && a.x >= a.z) return d.x >= 0 ? 0 : 1;   // ±X
@@ -23,6 +60,16 @@ int face_from_direction(Float3 d) {
     return d.z >= 0 ? 4 : 5;                                 // ±Z
 }
 
+int face_from_direction(const Double3& d) {
+    // Components within a relative 1e-12 of the largest count as tied, so the same point
+    // reached through two faces' grids (equal up to rounding) picks the same face.
+    const double ax = std::fabs(d.x), ay = std::fabs(d.y), az = std::fabs(d.z);
+    const double tied = std::max({ax, ay, az}) * (1.0 - 1e-12);
+    if (ax >= tied) return d.x >= 0 ? 0 : 1;
+    if (ay >= tied) return d.y >= 0 ? 2 : 3;
+    return d.z >= 0 ? 4 : 5;
+}
+
 Float3 direction_from_face_uv(int face, float u, float v) {
     // Map face-local square [-1,1]^2 to cube then project to sphere
     Float3 right = FACE_RIGHT[face];
@@ -60,6 +107,122 @@ void face_basis(int face, Float3& right, Float3& up, Float3& forward) {
     forward = FACE_FORWARD[face];
 }
 
+FaceEdge face_edge_neighbor(int face, int edge) {
+    static const std::array<std::array<FaceEdge, 4>, 6> table = [] {
+        auto same = [](const Float3& a, const Float3& b) { return a.x == b.x && a.y == b.y && a.z == b.z; };
+        auto neg = [](const Float3& a) { return Float3{-a.x, -a.y, -a.z}; };
+        auto edge_dir = [&](int f, int e) {
+            Float3 d = (e < 2) ? FACE_RIGHT[f] : FACE_UP[f];
+            return (e & 1) ? neg(d) : d;
+        };
+        std::array<std::array<FaceEdge, 4>, 6> t{};
+        for (int f = 0; f < 6; ++f) {
+            for (int e = 0; e < 4; ++e) {
+                // The neighbor faces along the edge direction; our forward is one of its edges
+                Float3 d = edge_dir(f, e);
+                int g = 0;
+                while (g < 6 && !same(FACE_FORWARD[g], d)) ++g;
+                int back = 0;
+                while (back < 4 && !same(edge_dir(g, back), FACE_FORWARD[f])) ++back;
+                t[f][e] = FaceEdge{g, back};
+            }
+        }
+        return t;
+    }();
+    return table[face][edge];
+}
+
+Double3 face_grid_direction(int face, double S, double T, double R) {
+    double uc = (R != 0.0) ? (S / R) : 0.0;
+    double vc = (R != 0.0) ? (T / R) : 0.0;
+    double wc = std::sqrt(std::max(0.0, 1.0 - (uc * uc + vc * vc)));
+    return normalize(to_double3(FACE_RIGHT[face]) * uc + to_double3(FACE_UP[face]) * vc + to_double3(FACE_FORWARD[face]) * wc);
+}
+
+bool face_grid_coords(int face, const Double3& dir, double R, double& S, double& T) {
+    if (dot(dir, to_double3(FACE_FORWARD[face])) <= 0.0) return false;
+    S = dot(dir, to_double3(FACE_RIGHT[face])) * R;
+    T = dot(dir, to_double3(FACE_UP[face])) * R;
+    return true;
+}
+
+bool face_owns_direction(int face, const Double3& dir) { return face_from_direction(dir) == face; }
+
+bool face_owns_grid_point(int face, double S, double T, double R) {
+    if (R <= 0.0) return false;
+    double uc = S / R;
+    double vc = T / R;
+    double q = uc * uc + vc * vc;
+    if (q >= 1.0) return false;
+    // The face axes are signed unit axes, so the unnormalized direction keeps exact components
+    // and face_from_direction breaks ties the same way for every face.
+    double wc = std::sqrt(1.0 - q);
+    Double3 dir = to_double3(FACE_RIGHT[face]) * uc + to_double3(FACE_UP[face]) * vc + to_double3(FACE_FORWARD[face]) * wc;
+    return face_owns_direction(face, dir);
+}
+
+FaceOwnership chunk_face_ownership(const PlanetConfig& cfg, const FaceChunkKey& key) {
+    // Owned regions are quadrant-like in (S/R, T/R), so the corners and center decide
+    const double chunk_m = cfg.voxel_size_m * Chunk64::N;
+    const double S0 = key.i * chunk_m, T0 = key.j * chunk_m;
+    const double R0 = std::max(key.k * chunk_m, 0.5 * chunk_m);
+    int owned = 0;
+    for (int c = 0; c < 8; ++c) {
+        owned += face_owns_grid_point(key.face, S0 + ((c & 1) ? chunk_m : 0.0), T0 + ((c & 2) ? chunk_m : 0.0),
+                                      R0 + ((c & 4) ? chunk_m : 0.0)) ? 1 : 0;
+    }
+    if (owned == 8) return FaceOwnership::kFull;
+    if (owned > 0) return FaceOwnership::kPartial;
+    double h = 0.5 * chunk_m;
+    return face_owns_grid_point(key.face, S0 + h, T0 + h, R0 + h) ? FaceOwnership::kPartial : FaceOwnership::kNone;
+}
+
+void chunk_ownership_mask(const PlanetConfig& cfg, const FaceChunkKey& key, std::vector<std::uint64_t>& out) {
+    static_assert(Chunk64::N == 64, "ownership mask packs one chunk row per 64-bit word");
+    const int N = Chunk64::N;
+    const double voxel_m = cfg.voxel_size_m;
+    const double chunk_m = voxel_m * N;
+    out.assign(static_cast<size_t>(N) * N, 0ull);
+    for (int z = 0; z < N; ++z) {
+        double R = key.k * chunk_m + (z + 0.5) * voxel_m;
+        for (int y = 0; y < N; ++y) {
+            double T = key.j * chunk_m + (y + 0.5) * voxel_m;
+            uint64_t bits = 0;
+            for (int x = 0; x < N; ++x) {
+                double S = key.i * chunk_m + (x + 0.5) * voxel_m;
+                if (face_owns_grid_point(key.face, S, T, R)) bits |= 1ull << x;
+            }
+            out[y + z * N] = bits;
+        }
+    }
+}
+
+bool owned_voxel_at(const PlanetConfig& cfg, const Double3& p, FaceChunkKey& key, int& lx, int& ly, int& lz) {
+    const double r = length(p);
+    if (r <= 0.0) return false;
+    const Double3 dir = p / r;
+    const std::int64_t N = Chunk64::N;
+    const double voxel_m = cfg.voxel_size_m;
+    const int dominant = face_from_direction(dir);
+    for (int n = 0; n < 6; ++n) {
+        // Near an edge the dominant face's voxel around p can have its center on the neighbor.
+        const int face = (n == 0) ? dominant : (n <= dominant ? n - 1 : n);
+        double S = 0.0, T = 0.0;
+        if (!face_grid_coords(face, dir, r, S, T)) continue;
+        const std::int64_t vs = static_cast<std::int64_t>(std::floor(S / voxel_m));
+        const std::int64_t vt = static_cast<std::int64_t>(std::floor(T / voxel_m));
+        const std::int64_t vr = static_cast<std::int64_t>(std::floor(r / voxel_m));
+        if (!face_owns_grid_point(face, (vs + 0.5) * voxel_m, (vt + 0.5) * voxel_m, (vr + 0.5) * voxel_m)) continue;
+        auto floor_div = [N](std::int64_t v) { return (v >= 0) ? v / N : -((-v + N - 1) / N); };
+        key = FaceChunkKey{face, floor_div(vs), floor_div(vt), floor_div(vr)};
+        lx = static_cast<int>(vs - key.i * N);
+        ly = static_cast<int>(vt - key.j * N);
+        lz = static_cast<int>(vr - key.k * N);
+        return true;
+    }
+    return false;
+}
+
 Int3 voxel_from_lat_lon_h(const PlanetConfig& cfg, double lat_rad, double lon_rad, double height_m) {
     Float3 dir = direction_from_lat_lon(lat_rad, lon_rad);
     double r = cfg.radius_m + height_m;
@@ -92,58 +255,188 @@ FaceChunkKey face_chunk_from_voxel(const PlanetConfig& cfg, Int3 voxel, int chun
     return FaceChunkKey{face, i, j, k};
 }
 
+namespace {
+
+constexpr float kCaveScale = 0.05f;
+constexpr uint32_t kCaveSeedOffset = 777u;
+
+// Material at radius r under the surface at surface_r, before caves. Returns true when
+// the point lies deep enough for a cave to carve it, which the caller decides from noise.
+template <typename R>
+bool base_before_caves(const PlanetConfig& cfg, R r, double surface_r, BaseSample& out) {
+    if (r > surface_r) {
+        out = BaseSample{MAT_AIR, -1.0f};
+        return false;
+    }
+    // Water layer around sea level where below surface but near sea level
+    if (r > cfg.sea_level_m && (surface_r - r) < 5.0) {
+        out = BaseSample{MAT_WATER, 1.0f};
+        return false;
+    }
+    // Dirt near surface, rock deeper
+    out = (surface_r - r < 2.0) ? BaseSample{MAT_DIRT, 1.0f} : BaseSample{MAT_ROCK, 1.0f};
+    // Underground: rock with caves below the top few meters
+    return r < surface_r - kCaveMinDepthM;
+}
+
+// Generator column of a direction: the voxel column of its dominant face's grid (gnomonic
+// at radius_m, as column_direction) it falls in, as {face, s, t, 0} in voxels.
+FaceChunkKey generator_column(const PlanetConfig& cfg, Float3 dir) {
+    const int face = face_from_direction(dir);
+    const Double3 d = to_double3(dir);
+    const double fwd = dot(d, to_double3(FACE_FORWARD[face]));
+    const double s = cfg.radius_m * dot(d, to_double3(FACE_RIGHT[face])) / fwd;
+    const double t = cfg.radius_m * dot(d, to_double3(FACE_UP[face])) / fwd;
+    return FaceChunkKey{face, static_cast<std::int64_t>(std::floor(s / cfg.voxel_size_m)),
+                        static_cast<std::int64_t>(std::floor(t / cfg.voxel_size_m)), 0};
+}
+
+// Surface radius of a generator column, the same value its height tile entry gives.
+double column_surface_r(const PlanetConfig& cfg, const FaceChunkKey& column) {
+    const std::int64_t N = Chunk64::N;
+    const std::int64_t i = static_cast<std::int64_t>(std::floor(static_cast<double>(column.i) / N));
+    const std::int64_t j = static_cast<std::int64_t>(std::floor(static_cast<double>(column.j) / N));
+    Float3 right, up, forward;
+    face_basis(column.face, right, up, forward);
+    const Float3 dir = column_direction(cfg, right, up, forward, i, j, static_cast<int>(column.i - i * N),
+                                        static_cast<int>(column.j - j * N));
+    return cfg.radius_m + static_cast<float>(terrain_height_m(cfg, dir));
+}
+
+// Cave candidates of a batch, as coordinate arrays for fbm_batch.
+struct CaveBatch {
+    std::vector<float> x, y, z;
+    std::vector<std::size_t> slot;
+
+    void add(Float3 pos_m, std::size_t i) {
+        x.push_back(pos_m.x*kCaveScale);
+        y.push_back(pos_m.y*kCaveScale);
+        z.push_back(pos_m.z*kCaveScale);
+        slot.push_back(i);
+    }
+
+    void carve(const PlanetConfig& cfg, std::span<BaseSample> out) const {
+        if (slot.empty()) return;
+        std::vector<float> cave(slot.size());
+        fbm_batch<4>(x.data(), y.data(), z.data(), slot.size(), 2.2f, 0.5f, cfg.seed + kCaveSeedOffset, cave.data());
+        for (std::size_t c = 0; c < slot.size(); ++c) {
+            if (cave[c] > kCaveNoiseThreshold) out[slot[c]] = BaseSample{MAT_AIR, -0.5f};
+        }
+    }
+};
+
+} // namespace
+
 BaseSample sample_base(const PlanetConfig& cfg, Int3 voxel) {
     // Convert voxel (integer grid at 10cm) to meters and spherical radius
     Float3 pos_m = to_float3(voxel, float(cfg.voxel_size_m));
     float r = length(pos_m);
 
-    // Elevation via FBM on the angular direction; cave noise via 3D fbm
+    // Elevation via FBM on the column's direction; cave noise via 3D fbm
     Float3 dir = (r > 0) ? pos_m / r : Float3{0,1,0};
-    double height_m = terrain_height_m(cfg, dir);
-
-    // Base radial surface at radius + height
-    double surface_r = cfg.radius_m + height_m;
-
-    // Cave noise (3D)
-    float cave = fbm({pos_m.x*0.05f, pos_m.y*0.05f, pos_m.z*0.05f}, 4, 2.2f, 0.5f, cfg.seed + 777u);
-    bool cave_air = (cave > 0.35f); // sparse
+    double surface_r = column_surface_r(cfg, generator_column(cfg, dir));
 
     BaseSample out{};
-    if (r > surface_r) {
-        out.material = MAT_AIR; out.density = -1.0f; return out;
+    if (base_before_caves(cfg, r, surface_r, out)) {
+        float cave = fbm<4>({pos_m.x*kCaveScale, pos_m.y*kCaveScale, pos_m.z*kCaveScale}, 2.2f, 0.5f,
+                            cfg.seed + kCaveSeedOffset);
+        if (cave > kCaveNoiseThreshold) out = BaseSample{MAT_AIR, -0.5f};
     }
+    return out;
+}
 
-    // Water layer around sea level where below surface but near sea level
-    if (r > cfg.sea_level_m && (surface_r - r) < 5.0) {
-        out.material = MAT_WATER; out.density = 1.0f; return out;
+void sample_base_batch(const PlanetConfig& cfg, std::span<const Int3> voxels, std::span<BaseSample> out) {
+    // A brush or a radial run of voxels shares few columns: sort the voxels by column and
+    // evaluate each column's height once.
+    struct ColumnVoxel {
+        FaceChunkKey column;
+        std::size_t index;
+    };
+    std::vector<ColumnVoxel> cols(voxels.size());
+    std::vector<Float3> pos_m(voxels.size());
+    std::vector<float> r(voxels.size());
+    for (std::size_t i = 0; i < voxels.size(); ++i) {
+        pos_m[i] = to_float3(voxels[i], float(cfg.voxel_size_m));
+        r[i] = length(pos_m[i]);
+        cols[i] = ColumnVoxel{generator_column(cfg, (r[i] > 0) ? pos_m[i] / r[i] : Float3{0,1,0}), i};
     }
+    std::sort(cols.begin(), cols.end(), [](const ColumnVoxel& a, const ColumnVoxel& b) {
+        if (a.column.face != b.column.face) return a.column.face < b.column.face;
+        if (a.column.j != b.column.j) return a.column.j < b.column.j;
+        return a.column.i < b.column.i;
+    });
 
-    // Underground: rock with caves, top few meters dirt
-    if (cave_air && r < surface_r - 3.0) {
-        out.material = MAT_AIR; out.density = -0.5f; return out;
+    CaveBatch caves;
+    double surface_r = 0.0;
+    for (std::size_t n = 0; n < cols.size(); ++n) {
+        const std::size_t i = cols[n].index;
+        if (n == 0 || cols[n].column != cols[n - 1].column) surface_r = column_surface_r(cfg, cols[n].column);
+        if (base_before_caves(cfg, r[i], surface_r, out[i])) caves.add(pos_m[i], i);
     }
+    caves.carve(cfg, out);
+}
 
-    // Dirt near surface, rock deeper
-    if (surface_r - r < 2.0) {
-        out.material = MAT_DIRT; out.density = 1.0f; return out;
-    } else {
-        out.material = MAT_ROCK; out.density = 1.0f; return out;
+void sample_base_radial(const PlanetConfig& cfg, Float3 dir, std::span<const double> radii_m,
+                        std::span<BaseSample> out) {
+    dir = normalize(dir);
+    const double surface_r = cfg.radius_m + terrain_height_m(cfg, dir);
+    CaveBatch caves;
+    for (std::size_t i = 0; i < radii_m.size(); ++i) {
+        if (base_before_caves(cfg, radii_m[i], surface_r, out[i])) {
+            const float r = static_cast<float>(radii_m[i]);
+            caves.add(Float3{dir.x*r, dir.y*r, dir.z*r}, i);
+        }
     }
+    caves.carve(cfg, out);
+}
+
+void cave_noise_batch(const PlanetConfig& cfg, const float* xs_m, const float* ys_m, const float* zs_m, std::size_t n,
+                      float* out) {
+    std::vector<float> x(n), y(n), z(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        x[i] = xs_m[i]*kCaveScale;
+        y[i] = ys_m[i]*kCaveScale;
+        z[i] = zs_m[i]*kCaveScale;
+    }
+    fbm_batch<4>(x.data(), y.data(), z.data(), n, 2.2f, 0.5f, cfg.seed + kCaveSeedOffset, out);
 }
 
 double terrain_height_m(const PlanetConfig& cfg, Float3 direction) {
     // Map to face-UV and compute FBM elevation using configurable parameters
     int face = 0; float u = 0.0f, v = 0.0f;
     (void)face_uv_from_direction(direction, face, u, v);
+    return terrain_height_uv(cfg, u, v);
+}
+
+double terrain_height_uv(const PlanetConfig& cfg, float u, float v) {
     const float freq = cfg.terrain_freq;
     const int   octs = cfg.terrain_octaves;
     const float lac  = cfg.terrain_lacunarity;
     const float gain = cfg.terrain_gain;
-    float elev = fbm({u*freq, v*freq, 0.0f}, octs, lac, gain, cfg.seed); // [-1,1]
+    float x = u*freq, y = v*freq;
+    if (cfg.terrain_warp != 0.0f) domain_warp2(x, y, cfg.terrain_warp, cfg.seed);
+    const Fbm2Fn elev_fbm = select_fbm2(cfg.terrain_noise, octs);
+    float elev = std::clamp(elev_fbm(x, y, octs, lac, gain, cfg.seed), -1.0f, 1.0f); // [-1,1]
     elev = (elev + 1.0f) * 0.5f; // [0,1]
     const double amp_m = cfg.terrain_amp_m;
     double height_m = amp_m * elev; // [0, amp_m]
     return height_m;
 }
 
+double terrain_height_slope_bound(const PlanetConfig& cfg) {
+    // The basis changes by at most noise2_slope_bound per lattice unit; octave i scales that
+    // by its amplitude and frequency, the warp stretches distances, and
+    // height = amp * (elev + 1) / 2.
+    const double basis_slope = noise2_slope_bound(cfg.terrain_noise) * domain_warp2_stretch(cfg.terrain_warp);
+    double amp = 0.5, freq = 1.0, slope = 0.0, norm = 0.0;
+    for (int i = 0; i < cfg.terrain_octaves; ++i) {
+        slope += amp * freq * basis_slope;
+        norm += amp;
+        freq *= cfg.terrain_lacunarity;
+        amp *= cfg.terrain_gain;
+    }
+    if (norm <= 0.0) return 0.0;
+    return 0.5 * cfg.terrain_amp_m * std::fabs(static_cast<double>(cfg.terrain_freq)) * slope / norm;
+}
+
 } // namespace wf
@@ -1,10 +1,17 @@
 #include "region_io.h"
 
+#include "async_io.h"
+
+#include <cerrno>
 #include <cstdio>
 #include <cstring>
+#include <unordered_map>
 #include <vector>
 #include <filesystem>
 
+#include <fcntl.h>
+#include <unistd.h>
+
 namespace fs = std::filesystem;
 
 namespace wf {
@@ -50,24 +57,49 @@ static bool write_all(FILE* f, const void* src, size_t n) {
     return std::fwrite(src, 1, n, f) == n;
 }
 
-static bool load_region_header(FILE* f, RegionHeaderV1& hdr) {
+// 1 or 2 for a valid header, 0 otherwise.
+static int region_header_version(const RegionHeaderV1& hdr) {
+    bool v1 = std::strncmp(hdr.magic, "WFREGN1", 7) == 0 && hdr.version == 1;
+    bool v2 = std::strncmp(hdr.magic, "WFREGN2", 7) == 0 && hdr.version == 2;
+    if (!v1 && !v2) return 0;
+    if (hdr.toc_entries != (uint32_t)(hdr.tile * hdr.tile)) return 0;
+    return v2 ? 2 : 1;
+}
+
+static bool load_region_header(FILE* f, RegionHeaderV1& hdr, GeneratorStamp* stamp = nullptr) {
     if (!read_all(f, &hdr, sizeof(hdr))) return false;
-    if (std::strncmp(hdr.magic, "WFREGN1", 7) != 0 || hdr.version != 1) return false;
-    if (hdr.toc_entries != (uint32_t)(hdr.tile * hdr.tile)) return false;
+    int version = region_header_version(hdr);
+    if (version == 0) return false;
+    GeneratorStamp s{};
+    if (version == 2) {
+        RegionHeaderStampV2 tail{};
+        if (!read_all(f, &tail, sizeof(tail))) return false;
+        s.generator_version = tail.generator_version;
+        s.config_hash = tail.config_hash;
+    }
+    if (stamp) *stamp = s;
     return true;
 }
 
+static bool write_region_stamp(FILE* f, const GeneratorStamp& stamp) {
+    RegionHeaderStampV2 tail{};
+    tail.generator_version = stamp.generator_version;
+    tail.config_hash = stamp.config_hash;
+    std::fseek(f, (long)sizeof(RegionHeaderV1), SEEK_SET);
+    return write_all(f, &tail, sizeof(tail));
+}
+
 static void init_region_header(RegionHeaderV1& hdr, const FaceChunkKey& key, int tile) {
     std::memset(&hdr, 0, sizeof(hdr));
-    std::memcpy(hdr.magic, "WFREGN1", 7);
-    hdr.version = 1;
+    std::memcpy(hdr.magic, "WFREGN2", 7);
+    hdr.version = 2;
     hdr.face = key.face;
     std::int64_t i0, j0; int ti, tj; RegionIO::region_coords(key, tile, i0, j0, ti, tj);
     hdr.i0 = i0; hdr.j0 = j0; hdr.k = key.k;
     hdr.tile = tile; hdr.chunk_vox = wf::Chunk64::N;
     hdr.flags = 0;
     hdr.toc_entries = (uint32_t)(tile * tile);
-    hdr.toc_offset = sizeof(RegionHeaderV1);
+    hdr.toc_offset = sizeof(RegionHeaderV1) + sizeof(RegionHeaderStampV2);
     hdr.data_offset = hdr.toc_offset + sizeof(RegionTocEntryV1) * hdr.toc_entries;
 }
 
@@ -87,50 +119,55 @@ static bool ensure_dirs_for(const std::string& path) {
     return !ec;
 }
 
-bool RegionIO::save_chunk(const FaceChunkKey& key, const Chunk64& c, int tile, const std::string& root) {
+// Read the existing header or write a fresh one with an empty TOC. A known stamp
+// replaces the last-writer stamp of V2 files; V1 files keep their layout.
+static bool prepare_region(FILE* f, const FaceChunkKey& key, int tile, const GeneratorStamp& stamp, RegionHeaderV1& hdr) {
+    std::fseek(f, 0, SEEK_END);
+    long sz = std::ftell(f);
+    if (sz >= (long)sizeof(RegionHeaderV1)) {
+        std::fseek(f, 0, SEEK_SET);
+        GeneratorStamp existing{};
+        if (load_region_header(f, hdr, &existing)) {
+            if (hdr.version == 2 && stamp.known() && existing != stamp) {
+                return write_region_stamp(f, stamp);
+            }
+            return true;
+        }
+    }
+    init_region_header(hdr, key, tile);
+    std::vector<RegionTocEntryV1> toc(hdr.toc_entries, RegionTocEntryV1{});
+    std::fseek(f, 0, SEEK_SET);
+    if (!write_all(f, &hdr, sizeof(hdr))) return false;
+    if (!write_region_stamp(f, stamp)) return false;
+    return write_all(f, toc.data(), sizeof(RegionTocEntryV1) * toc.size());
+}
+
+bool RegionIO::save_chunk(const FaceChunkKey& key, const Chunk64& c, int tile, const std::string& root,
+                          const GeneratorStamp& stamp) {
     std::string path = region_path(key, tile, root);
     if (!ensure_dirs_for(path)) return false;
     FILE* f = open_region_rw(path);
     if (!f) return false;
 
-    RegionHeaderV1 hdr{}; bool exists = false;
-    std::vector<RegionTocEntryV1> toc;
-    {
-        // Read existing header if present, else initialize new
-        std::fseek(f, 0, SEEK_END);
-        long sz = std::ftell(f);
-        if (sz >= (long)sizeof(RegionHeaderV1)) {
-            std::fseek(f, 0, SEEK_SET);
-            if (load_region_header(f, hdr)) {
-                exists = true;
-                toc.resize(hdr.toc_entries);
-                std::fseek(f, (long)hdr.toc_offset, SEEK_SET);
-                if (!read_all(f, toc.data(), sizeof(RegionTocEntryV1) * toc.size())) { std::fclose(f); return false; }
-            }
-        }
-        if (!exists) {
-            init_region_header(hdr, key, tile);
-            toc.assign(hdr.toc_entries, RegionTocEntryV1{});
-            std::fseek(f, 0, SEEK_SET);
-            if (!write_all(f, &hdr, sizeof(hdr))) { std::fclose(f); return false; }
-            if (!write_all(f, toc.data(), sizeof(RegionTocEntryV1) * toc.size())) { std::fclose(f); return false; }
-        }
-    }
+    RegionHeaderV1 hdr{};
+    if (!prepare_region(f, key, tile, stamp, hdr)) { std::fclose(f); return false; }
 
     // Prepare chunk blob (raw)
     const int N = Chunk64::N;
     const size_t N3 = size_t(N) * N * N;
-    ChunkBlobHeaderV1 ch{};
+    ChunkBlobHeaderV2 ch{};
     std::memset(&ch, 0, sizeof(ch));
-    std::memcpy(ch.magic, "WFCHK1", 6);
-    ch.version = 1;
+    std::memcpy(ch.magic, "WFCHK2", 6);
+    ch.version = 2;
     ch.palette_count = (uint16_t)c.palette.size();
     ch.bpp = 8;
     ch.indices_bytes = (uint32_t)N3; // 8-bit per index
     ch.occ_words = (uint32_t)((N3 + 63) / 64);
+    ch.generator_version = stamp.generator_version;
+    ch.config_hash = stamp.config_hash;
 
     std::vector<uint8_t> blob;
-    blob.reserve(sizeof(ChunkBlobHeaderV1) + ch.palette_count * 2 + ch.indices_bytes + ch.occ_words * 8);
+    blob.reserve(sizeof(ChunkBlobHeaderV2) + ch.palette_count * 2 + ch.indices_bytes + ch.occ_words * 8);
     // Header
     blob.insert(blob.end(), reinterpret_cast<uint8_t*>(&ch), reinterpret_cast<uint8_t*>(&ch) + sizeof(ch));
     // Palette
@@ -159,7 +196,6 @@ bool RegionIO::save_chunk(const FaceChunkKey& key, const Chunk64& c, int tile, c
 
     RegionTocEntryV1 ent{};
     ent.offset = off; ent.size = (uint32_t)blob.size(); ent.usize = ent.size; ent.flags = 0; ent.checksum = checksum;
-    toc[idx] = ent;
 
     // Write TOC entry back
     std::fseek(f, (long)(hdr.toc_offset + idx * sizeof(RegionTocEntryV1)), SEEK_SET);
@@ -169,7 +205,8 @@ bool RegionIO::save_chunk(const FaceChunkKey& key, const Chunk64& c, int tile, c
     return true;
 }
 
-bool RegionIO::load_chunk(const FaceChunkKey& key, Chunk64& out, int tile, const std::string& root) {
+bool RegionIO::load_chunk(const FaceChunkKey& key, Chunk64& out, int tile, const std::string& root,
+                          const GeneratorStamp* expect) {
     std::string path = region_path(key, tile, root);
     FILE* f = std::fopen(path.c_str(), "rb");
     if (!f) return false;
@@ -191,9 +228,22 @@ bool RegionIO::load_chunk(const FaceChunkKey& key, Chunk64& out, int tile, const
     if (fnv1a32(blob.data(), blob.size()) != ent.checksum) return false;
 
     if (blob.size() < sizeof(ChunkBlobHeaderV1)) return false;
+    // V2 only appends fields, so the V1 view is valid for both
     const ChunkBlobHeaderV1* ch = reinterpret_cast<const ChunkBlobHeaderV1*>(blob.data());
-    if (std::strncmp(ch->magic, "WFCHK1", 6) != 0 || ch->version != 1) return false;
-    const uint8_t* p = blob.data() + sizeof(ChunkBlobHeaderV1);
+    size_t header_bytes = sizeof(ChunkBlobHeaderV1);
+    GeneratorStamp blob_stamp{};
+    if (std::strncmp(ch->magic, "WFCHK2", 6) == 0 && ch->version == 2) {
+        if (blob.size() < sizeof(ChunkBlobHeaderV2)) return false;
+        const ChunkBlobHeaderV2* ch2 = reinterpret_cast<const ChunkBlobHeaderV2*>(blob.data());
+        blob_stamp.generator_version = ch2->generator_version;
+        blob_stamp.config_hash = ch2->config_hash;
+        header_bytes = sizeof(ChunkBlobHeaderV2);
+    } else if (std::strncmp(ch->magic, "WFCHK1", 6) != 0 || ch->version != 1) {
+        return false;
+    }
+    // Generated data from another generator/config is never trusted
+    if (expect && blob_stamp != *expect) return false;
+    const uint8_t* p = blob.data() + header_bytes;
     const uint8_t* end = blob.data() + blob.size();
 
     // Load palette
@@ -225,58 +275,18 @@ bool RegionIO::load_chunk(const FaceChunkKey& key, Chunk64& out, int tile, const
     return true;
 }
 
-bool RegionIO::save_chunk_delta(const FaceChunkKey& key, const ChunkDelta& delta, int tile, const std::string& root) {
-    std::string path = region_path(key, tile, root);
-    if (!ensure_dirs_for(path)) return false;
-    FILE* f = open_region_rw(path);
-    if (!f) return false;
-
-    RegionHeaderV1 hdr{}; bool exists = false;
-    std::vector<RegionTocEntryV1> toc;
-    {
-        std::fseek(f, 0, SEEK_END);
-        long sz = std::ftell(f);
-        if (sz >= (long)sizeof(RegionHeaderV1)) {
-            std::fseek(f, 0, SEEK_SET);
-            if (load_region_header(f, hdr)) {
-                exists = true;
-                toc.resize(hdr.toc_entries);
-                std::fseek(f, (long)hdr.toc_offset, SEEK_SET);
-                if (!read_all(f, toc.data(), sizeof(RegionTocEntryV1) * toc.size())) {
-                    std::fclose(f);
-                    return false;
-                }
-            }
-        }
-        if (!exists) {
-            init_region_header(hdr, key, tile);
-            toc.assign(hdr.toc_entries, RegionTocEntryV1{});
-            std::fseek(f, 0, SEEK_SET);
-            if (!write_all(f, &hdr, sizeof(hdr))) { std::fclose(f); return false; }
-            if (!write_all(f, toc.data(), sizeof(RegionTocEntryV1) * toc.size())) { std::fclose(f); return false; }
-        }
-    }
-
-    std::int64_t i0, j0; int ti, tj; region_coords(key, tile, i0, j0, ti, tj);
-    const size_t idx = (size_t)(tj * tile + ti);
-
-    if (delta.empty()) {
-        RegionTocEntryV1 ent{};
-        toc[idx] = ent;
-        std::fseek(f, (long)(hdr.toc_offset + idx * sizeof(RegionTocEntryV1)), SEEK_SET);
-        bool ok = write_all(f, &ent, sizeof(ent));
-        std::fclose(f);
-        return ok;
-    }
-
-    ChunkDeltaHeaderV1 dh{};
+static void build_delta_blob(const ChunkDelta& delta, std::vector<uint8_t>& blob) {
+    const GeneratorStamp& stamp = delta.base;
+    ChunkDeltaHeaderV2 dh{};
     std::memset(&dh, 0, sizeof(dh));
-    std::memcpy(dh.magic, "WFDEL1", 6);
-    dh.version = 1;
+    std::memcpy(dh.magic, "WFDEL2", 6);
+    dh.version = 2;
     dh.entry_count = (delta.mode == ChunkDelta::Mode::kDense)
         ? (uint32_t)delta.dense_data.size()
         : (uint32_t)delta.entries.size();
     dh.reserved = static_cast<uint32_t>(delta.mode);
+    dh.generator_version = stamp.generator_version;
+    dh.config_hash = stamp.config_hash;
 
     struct PackedDeltaEntry {
         uint32_t index;
@@ -284,7 +294,7 @@ bool RegionIO::save_chunk_delta(const FaceChunkKey& key, const ChunkDelta& delta
         uint16_t pad;
     };
 
-    std::vector<uint8_t> blob;
+    blob.clear();
     if (delta.mode == ChunkDelta::Mode::kDense) {
         const size_t payload_bytes = (size_t)dh.entry_count * sizeof(uint16_t);
         blob.reserve(sizeof(dh) + payload_bytes);
@@ -300,7 +310,30 @@ bool RegionIO::save_chunk_delta(const FaceChunkKey& key, const ChunkDelta& delta
             blob.insert(blob.end(), ptr, ptr + sizeof(rec));
         }
     }
+}
+
+bool RegionIO::save_chunk_delta(const FaceChunkKey& key, const ChunkDelta& delta, int tile, const std::string& root) {
+    std::string path = region_path(key, tile, root);
+    if (!ensure_dirs_for(path)) return false;
+    FILE* f = open_region_rw(path);
+    if (!f) return false;
+
+    RegionHeaderV1 hdr{};
+    if (!prepare_region(f, key, tile, delta.base, hdr)) { std::fclose(f); return false; }
+
+    std::int64_t i0, j0; int ti, tj; region_coords(key, tile, i0, j0, ti, tj);
+    const size_t idx = (size_t)(tj * tile + ti);
+
+    if (delta.empty()) {
+        RegionTocEntryV1 ent{};
+        std::fseek(f, (long)(hdr.toc_offset + idx * sizeof(RegionTocEntryV1)), SEEK_SET);
+        bool ok = write_all(f, &ent, sizeof(ent));
+        std::fclose(f);
+        return ok;
+    }
 
+    std::vector<uint8_t> blob;
+    build_delta_blob(delta, blob);
     uint32_t checksum = fnv1a32(blob.data(), blob.size());
 
     std::fseek(f, 0, SEEK_END);
@@ -313,7 +346,6 @@ bool RegionIO::save_chunk_delta(const FaceChunkKey& key, const ChunkDelta& delta
     ent.usize = ent.size;
     ent.flags = kRegionFlag_Delta;
     ent.checksum = checksum;
-    toc[idx] = ent;
 
     std::fseek(f, (long)(hdr.toc_offset + idx * sizeof(RegionTocEntryV1)), SEEK_SET);
     bool ok = write_all(f, &ent, sizeof(ent));
@@ -321,34 +353,164 @@ bool RegionIO::save_chunk_delta(const FaceChunkKey& key, const ChunkDelta& delta
     return ok;
 }
 
-bool RegionIO::load_chunk_delta(const FaceChunkKey& key, ChunkDelta& out, int tile, const std::string& root) {
-    std::string path = region_path(key, tile, root);
-    FILE* f = std::fopen(path.c_str(), "rb");
-    if (!f) { out.clear(); return false; }
+// Makes the written bytes durable before a rename publishes them.
+// Caps the blob bytes a save holds in memory before issuing its reads and writes.
+static constexpr size_t kSaveBatchBytes = 8u << 20;
+
+bool RegionIO::save_region_deltas(std::span<const std::pair<FaceChunkKey, ChunkDelta>> deltas, int tile,
+                                  const std::string& root, AsyncIO* io) {
+    if (deltas.empty()) return true;
+    if (!io) io = &AsyncIO::shared();
+    const FaceChunkKey& first = deltas.front().first;
+    const std::string path = region_path(first, tile, root);
+    std::vector<const ChunkDelta*> replaced((size_t)tile * tile, nullptr);
+    GeneratorStamp stamp{};
+    for (const auto& [key, delta] : deltas) {
+        if (region_path(key, tile, root) != path) return false;
+        std::int64_t i0, j0; int ti, tj; region_coords(key, tile, i0, j0, ti, tj);
+        replaced[(size_t)(tj * tile + ti)] = &delta;
+        if (delta.base.known()) stamp = delta.base;
+    }
+    if (!ensure_dirs_for(path)) return false;
 
-    RegionHeaderV1 hdr{};
-    if (!load_region_header(f, hdr)) { std::fclose(f); out.clear(); return false; }
-    std::int64_t i0, j0; int ti, tj; region_coords(key, tile, i0, j0, ti, tj);
-    if (hdr.face != key.face || hdr.k != key.k || hdr.i0 != i0 || hdr.j0 != j0) { std::fclose(f); out.clear(); return false; }
+    // Entries not being replaced are carried over from the current file. A file that exists
+    // but cannot be read back fails the save: rewriting it would drop every chunk it holds.
+    FILE* old = std::fopen(path.c_str(), "rb");
+    if (!old && errno != ENOENT) return false;
+    RegionHeaderV1 old_hdr{};
+    std::vector<RegionTocEntryV1> old_toc;
+    if (old) {
+        GeneratorStamp old_stamp{};
+        std::int64_t i0, j0; int ti, tj; region_coords(first, tile, i0, j0, ti, tj);
+        bool readable = load_region_header(old, old_hdr, &old_stamp) && old_hdr.tile == tile &&
+                        old_hdr.face == first.face && old_hdr.k == first.k && old_hdr.i0 == i0 && old_hdr.j0 == j0;
+        if (readable) {
+            old_toc.resize(old_hdr.toc_entries);
+            readable = std::fseek(old, (long)old_hdr.toc_offset, SEEK_SET) == 0 &&
+                       read_all(old, old_toc.data(), old_toc.size() * sizeof(RegionTocEntryV1));
+        }
+        if (!readable) {
+            std::fclose(old);
+            return false;
+        }
+        if (!stamp.known()) stamp = old_stamp;
+    }
+    const int old_fd = old ? ::fileno(old) : -1;
+
+    // The temp file is written with positional writes through the async engine: blobs are
+    // packed back to back (dropping the dead blobs left by in-place saves), then the header
+    // and TOC, then one sync. Carried blobs are read from the old file in the same batches.
+    const std::string tmp_path = path + ".tmp";
+    const int fd = ::open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        if (old) std::fclose(old);
+        return false;
+    }
+    auto fail = [&]() {
+        ::close(fd);
+        if (old) std::fclose(old);
+        std::remove(tmp_path.c_str());
+        return false;
+    };
 
-    const size_t idx = (size_t)(tj * tile + ti);
-    std::fseek(f, (long)(hdr.toc_offset + idx * sizeof(RegionTocEntryV1)), SEEK_SET);
-    RegionTocEntryV1 ent{};
-    if (!read_all(f, &ent, sizeof(ent))) { std::fclose(f); out.clear(); return false; }
-    if (ent.offset == 0 || ent.size == 0 || (ent.flags & kRegionFlag_Delta) == 0) { std::fclose(f); out.clear(); return false; }
+    RegionHeaderV1 hdr{};
+    init_region_header(hdr, first, tile);
+    std::vector<RegionTocEntryV1> toc(hdr.toc_entries, RegionTocEntryV1{});
+
+    std::vector<std::vector<uint8_t>> blobs;
+    AsyncIO::Batch reads, writes;
+    size_t pending_bytes = 0;
+    // Reads land before the writes that copy them; run() fails on any short transfer.
+    auto flush = [&]() {
+        if (!io->run(reads) || !io->run(writes)) return false;
+        blobs.clear();
+        reads.clear();
+        writes.clear();
+        pending_bytes = 0;
+        return true;
+    };
+    std::uint64_t off = hdr.data_offset;
+    for (size_t idx = 0; idx < toc.size(); ++idx) {
+        RegionTocEntryV1 ent{};
+        std::vector<uint8_t> blob;
+        bool carried = false;
+        if (const ChunkDelta* delta = replaced[idx]) {
+            if (delta->empty()) continue;
+            build_delta_blob(*delta, blob);
+            ent.size = (uint32_t)blob.size();
+            ent.usize = ent.size;
+            ent.flags = kRegionFlag_Delta;
+            ent.checksum = fnv1a32(blob.data(), blob.size());
+        } else if (idx < old_toc.size() && old_toc[idx].offset != 0 && old_toc[idx].size != 0) {
+            ent = old_toc[idx];
+            blob.resize(ent.size);
+            carried = true;
+        } else {
+            continue;
+        }
+        // Requests point into the blob's heap buffer, which stays put as `blobs` grows.
+        blobs.push_back(std::move(blob));
+        std::vector<uint8_t>& data = blobs.back();
+        if (carried) reads.push_back(AsyncIO::Request{AsyncIO::Request::Op::kRead, old_fd, ent.offset, data.data(), data.size()});
+        ent.offset = off;
+        writes.push_back(AsyncIO::Request{AsyncIO::Request::Op::kWrite, fd, off, data.data(), data.size()});
+        off += data.size();
+        toc[idx] = ent;
+        pending_bytes += data.size();
+        if (pending_bytes >= kSaveBatchBytes && !flush()) return fail();
+    }
+    if (!flush()) return fail();
+    if (old) {
+        std::fclose(old);
+        old = nullptr;
+    }
 
-    std::vector<uint8_t> blob(ent.size);
-    std::fseek(f, (long)ent.offset, SEEK_SET);
-    if (!read_all(f, blob.data(), blob.size())) { std::fclose(f); out.clear(); return false; }
-    std::fclose(f);
+    RegionHeaderStampV2 tail{};
+    tail.generator_version = stamp.generator_version;
+    tail.config_hash = stamp.config_hash;
+    writes.push_back(AsyncIO::Request{AsyncIO::Request::Op::kWrite, fd, 0, &hdr, sizeof(hdr)});
+    writes.push_back(AsyncIO::Request{AsyncIO::Request::Op::kWrite, fd, sizeof(hdr), &tail, sizeof(tail)});
+    writes.push_back(AsyncIO::Request{AsyncIO::Request::Op::kWrite, fd, hdr.toc_offset, toc.data(),
+                                      toc.size() * sizeof(RegionTocEntryV1)});
+    if (!flush()) return fail();
+    AsyncIO::Batch sync{AsyncIO::Request{AsyncIO::Request::Op::kSync, fd, 0, nullptr, 0}};
+    if (!io->run(sync)) return fail();
+    ::close(fd);
+
+    // The rename is the commit point: readers see either the old file or the new one.
+    std::error_code ec;
+    fs::rename(tmp_path, path, ec);
+    if (ec) {
+        std::remove(tmp_path.c_str());
+        return false;
+    }
+    int dir = ::open(fs::path(path).parent_path().c_str(), O_RDONLY);
+    if (dir >= 0) {
+        ::fsync(dir);
+        ::close(dir);
+    }
+    return true;
+}
 
-    if (fnv1a32(blob.data(), blob.size()) != ent.checksum) { out.clear(); return false; }
-    if (blob.size() < sizeof(ChunkDeltaHeaderV1)) { out.clear(); return false; }
+// Verifies and decodes one delta blob read through its TOC entry.
+static bool parse_delta_blob(const std::vector<uint8_t>& blob, const RegionTocEntryV1& ent, ChunkDelta& out) {
+    if (fnv1a32(blob.data(), blob.size()) != ent.checksum) return false;
+    if (blob.size() < sizeof(ChunkDeltaHeaderV1)) return false;
 
     const ChunkDeltaHeaderV1* dh = reinterpret_cast<const ChunkDeltaHeaderV1*>(blob.data());
-    if (std::strncmp(dh->magic, "WFDEL1", 6) != 0 || dh->version != 1) { out.clear(); return false; }
+    size_t header_bytes = sizeof(ChunkDeltaHeaderV1);
+    GeneratorStamp delta_stamp{};
+    if (std::strncmp(dh->magic, "WFDEL2", 6) == 0 && dh->version == 2) {
+        if (blob.size() < sizeof(ChunkDeltaHeaderV2)) return false;
+        const ChunkDeltaHeaderV2* dh2 = reinterpret_cast<const ChunkDeltaHeaderV2*>(blob.data());
+        delta_stamp.generator_version = dh2->generator_version;
+        delta_stamp.config_hash = dh2->config_hash;
+        header_bytes = sizeof(ChunkDeltaHeaderV2);
+    } else if (std::strncmp(dh->magic, "WFDEL1", 6) != 0 || dh->version != 1) {
+        return false;
+    }
     size_t count = dh->entry_count;
-    const uint8_t* p = blob.data() + sizeof(ChunkDeltaHeaderV1);
+    const uint8_t* p = blob.data() + header_bytes;
     const uint8_t* end = blob.data() + blob.size();
 
     ChunkDelta::Mode mode = (dh->reserved == static_cast<uint32_t>(ChunkDelta::Mode::kDense))
@@ -356,10 +518,11 @@ bool RegionIO::load_chunk_delta(const FaceChunkKey& key, ChunkDelta& out, int ti
         : ChunkDelta::Mode::kSparse;
 
     out.clear(mode);
+    out.base = delta_stamp;
 
     if (mode == ChunkDelta::Mode::kDense) {
         size_t bytes = count * sizeof(uint16_t);
-        if (p + bytes > end) { out.clear(); return false; }
+        if (p + bytes > end) return false;
         out.dense_data.resize(count);
         std::memcpy(out.dense_data.data(), p, bytes);
         out.override_count = 0;
@@ -369,7 +532,7 @@ bool RegionIO::load_chunk_delta(const FaceChunkKey& key, ChunkDelta& out, int ti
     } else {
         struct PackedDeltaEntry { uint32_t index; uint16_t material; uint16_t pad; };
         size_t bytes = count * sizeof(PackedDeltaEntry);
-        if (p + bytes > end) { out.clear(); return false; }
+        if (p + bytes > end) return false;
         const PackedDeltaEntry* recs = reinterpret_cast<const PackedDeltaEntry*>(p);
         out.entries.reserve(count);
         for (size_t i = 0; i < count; ++i) {
@@ -383,4 +546,132 @@ bool RegionIO::load_chunk_delta(const FaceChunkKey& key, ChunkDelta& out, int ti
     return true;
 }
 
+bool RegionIO::load_chunk_delta(const FaceChunkKey& key, ChunkDelta& out, int tile, const std::string& root) {
+    std::string path = region_path(key, tile, root);
+    FILE* f = std::fopen(path.c_str(), "rb");
+    if (!f) { out.clear(); return false; }
+
+    RegionHeaderV1 hdr{};
+    if (!load_region_header(f, hdr)) { std::fclose(f); out.clear(); return false; }
+    std::int64_t i0, j0; int ti, tj; region_coords(key, tile, i0, j0, ti, tj);
+    if (hdr.face != key.face || hdr.k != key.k || hdr.i0 != i0 || hdr.j0 != j0) { std::fclose(f); out.clear(); return false; }
+
+    const size_t idx = (size_t)(tj * tile + ti);
+    std::fseek(f, (long)(hdr.toc_offset + idx * sizeof(RegionTocEntryV1)), SEEK_SET);
+    RegionTocEntryV1 ent{};
+    if (!read_all(f, &ent, sizeof(ent))) { std::fclose(f); out.clear(); return false; }
+    if (ent.offset == 0 || ent.size == 0 || (ent.flags & kRegionFlag_Delta) == 0) { std::fclose(f); out.clear(); return false; }
+
+    std::vector<uint8_t> blob(ent.size);
+    std::fseek(f, (long)ent.offset, SEEK_SET);
+    if (!read_all(f, blob.data(), blob.size())) { std::fclose(f); out.clear(); return false; }
+    std::fclose(f);
+
+    if (!parse_delta_blob(blob, ent, out)) { out.clear(); return false; }
+    return true;
+}
+
+std::size_t RegionIO::load_chunk_deltas(std::span<const FaceChunkKey> keys, std::vector<std::optional<ChunkDelta>>& out,
+                                        int tile, const std::string& root, AsyncIO* io) {
+    out.assign(keys.size(), std::nullopt);
+    if (keys.empty()) return 0;
+    if (!io) io = &AsyncIO::shared();
+
+    struct RegionRead {
+        std::string path;
+        int fd = -1;
+        std::vector<size_t> members;   // indices into keys
+        uint8_t header[sizeof(RegionHeaderV1) + sizeof(RegionHeaderStampV2)];
+        RegionHeaderV1 hdr{};
+        std::vector<RegionTocEntryV1> toc;
+    };
+    std::vector<RegionRead> regions;
+    std::unordered_map<std::string, size_t> region_index;
+    for (size_t i = 0; i < keys.size(); ++i) {
+        std::string path = region_path(keys[i], tile, root);
+        auto [it, inserted] = region_index.try_emplace(path, regions.size());
+        if (inserted) {
+            regions.emplace_back();
+            regions.back().path = std::move(path);
+        }
+        regions[it->second].members.push_back(i);
+    }
+
+    // Pass 1: headers. A V1 header is followed by its TOC, so the stamp-sized tail is always readable.
+    AsyncIO::Batch batch;
+    for (RegionRead& r : regions) {
+        r.fd = ::open(r.path.c_str(), O_RDONLY);
+        if (r.fd < 0) continue;
+        batch.push_back(AsyncIO::Request{AsyncIO::Request::Op::kRead, r.fd, 0, r.header, sizeof(r.header)});
+    }
+    io->run(batch);
+
+    // Pass 2: whole TOCs; a ring touches few regions, so one read each beats per-entry seeks.
+    size_t next = 0;
+    std::vector<size_t> toc_owner;
+    AsyncIO::Batch toc_batch;
+    for (size_t r = 0; r < regions.size(); ++r) {
+        RegionRead& region = regions[r];
+        if (region.fd < 0) continue;
+        const AsyncIO::Request& req = batch[next++];
+        if (req.result < (std::int64_t)sizeof(RegionHeaderV1)) continue;
+        std::memcpy(&region.hdr, region.header, sizeof(region.hdr));
+        if (region_header_version(region.hdr) == 0) continue;
+        const FaceChunkKey& first = keys[region.members.front()];
+        std::int64_t i0, j0; int ti, tj; region_coords(first, tile, i0, j0, ti, tj);
+        if (region.hdr.face != first.face || region.hdr.k != first.k || region.hdr.i0 != i0 || region.hdr.j0 != j0 ||
+            region.hdr.tile != tile) {
+            continue;
+        }
+        region.toc.resize(region.hdr.toc_entries);
+        toc_batch.push_back(AsyncIO::Request{AsyncIO::Request::Op::kRead, region.fd, region.hdr.toc_offset,
+                                             region.toc.data(), region.toc.size() * sizeof(RegionTocEntryV1)});
+        toc_owner.push_back(r);
+    }
+    io->run(toc_batch);
+
+    // Pass 3: every delta blob of every region in one batch.
+    std::vector<std::vector<uint8_t>> blobs(keys.size());
+    std::vector<const RegionTocEntryV1*> entries(keys.size(), nullptr);
+    AsyncIO::Batch blob_batch;
+    std::vector<size_t> blob_owner;
+    for (size_t t = 0; t < toc_batch.size(); ++t) {
+        if (!toc_batch[t].complete()) continue;
+        RegionRead& region = regions[toc_owner[t]];
+        for (size_t i : region.members) {
+            std::int64_t i0, j0; int ti, tj; region_coords(keys[i], tile, i0, j0, ti, tj);
+            const RegionTocEntryV1& ent = region.toc[(size_t)(tj * tile + ti)];
+            if (ent.offset == 0 || ent.size == 0 || (ent.flags & kRegionFlag_Delta) == 0) continue;
+            entries[i] = &ent;
+            blobs[i].resize(ent.size);
+            blob_batch.push_back(AsyncIO::Request{AsyncIO::Request::Op::kRead, region.fd, ent.offset, blobs[i].data(), ent.size});
+            blob_owner.push_back(i);
+        }
+    }
+    io->run(blob_batch);
+
+    size_t found = 0;
+    for (size_t b = 0; b < blob_batch.size(); ++b) {
+        if (!blob_batch[b].complete()) continue;
+        const size_t i = blob_owner[b];
+        ChunkDelta delta;
+        if (!parse_delta_blob(blobs[i], *entries[i], delta)) continue;
+        out[i] = std::move(delta);
+        ++found;
+    }
+    for (RegionRead& region : regions) {
+        if (region.fd >= 0) ::close(region.fd);
+    }
+    return found;
+}
+
+bool RegionIO::read_region_stamp(const std::string& path, GeneratorStamp& out) {
+    FILE* f = std::fopen(path.c_str(), "rb");
+    if (!f) return false;
+    RegionHeaderV1 hdr{};
+    bool ok = load_region_header(f, hdr, &out);
+    std::fclose(f);
+    return ok;
+}
+
 } // namespace wf
@@ -86,6 +86,7 @@ void RenderSystem::rebuild_swapchain_dependents(const char* shader_dir,
     VkExtent2D extent = renderer_.swapchain_extent();
 
     if (!overlay_initialized_) {
+        overlay_.set_transfer_context(renderer_.graphics_queue_family(), renderer_.graphics_queue());
         overlay_.init(physical, device, render_pass, extent, shader_dir);
         overlay_initialized_ = true;
     } else {
@@ -105,6 +106,13 @@ void RenderSystem::rebuild_swapchain_dependents(const char* shader_dir,
     chunk_renderer_.set_logging(log_pool);
 }
 
+void RenderSystem::resize_chunk_pools(bool device_local_enabled,
+                                      VkDeviceSize pool_vtx_bytes,
+                                      VkDeviceSize pool_idx_bytes) {
+    wait_idle();
+    chunk_renderer_.resize_pools(pool_vtx_bytes, pool_idx_bytes, device_local_enabled);
+}
+
 void RenderSystem::cleanup_swapchain_dependents() {
     for (auto& bucket : trash_) {
         bucket.clear();
@@ -130,7 +138,7 @@ void RenderSystem::cleanup_swapchain_dependents() {
 }
 
 bool RenderSystem::upload_chunk_mesh(const ChunkMeshData& data, bool log_stream) {
-    if (data.vertex_count == 0 || data.index_count == 0) {
+    if (data.vertex_count == 0 || data.index_count == 0 || data.segment_count == 0) {
         return false;
     }
 
@@ -158,6 +166,19 @@ bool RenderSystem::upload_chunk_mesh(const ChunkMeshData& data, bool log_stream)
     chunk.center[2] = data.center[2];
     chunk.radius = data.radius;
     chunk.key = data.key;
+    chunk.segments.assign(data.segments, data.segments + data.segment_count);
+
+    chunk.draw_records.reserve(chunk.segments.size());
+    for (const MeshSegment& seg : chunk.segments) {
+        ChunkDrawItem record{};
+        record.index_count = seg.index_count;
+        record.first_index = chunk.first_index + seg.first_index;
+        record.base_vertex = chunk.base_vertex + static_cast<int32_t>(seg.base_vertex);
+        record.vertex_count = seg.vertex_count;
+        record.radius = chunk.radius;
+        chunk.draw_records.push_back(chunk_renderer_.register_draw(
+            record, Double3{chunk.center[0], chunk.center[1], chunk.center[2]}, !seg.translucent));
+    }
 
     bool replaced = false;
     for (std::size_t i = 0; i < chunks_.size(); ++i) {
@@ -377,6 +398,13 @@ void RenderSystem::schedule_delete_chunk(ChunkInstance&& chunk) {
         return;
     }
 
+    // Drop the GPU draw record now so no later frame culls it in; the mesh itself is
+    // freed once the frames that may still reference it have retired.
+    for (uint32_t record : chunk.draw_records) {
+        chunk_renderer_.unregister_draw(record);
+    }
+    chunk.draw_records.clear();
+
     ensure_trash_capacity(frame_count);
     std::size_t slot = (renderer_.current_frame() + 1) % frame_count;
     trash_[slot].push_back(std::move(chunk));
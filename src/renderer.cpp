@@ -364,9 +364,29 @@ void Renderer::create_logical_device() {
         enabled_device_exts_.push_back("VK_KHR_portability_subset");
     }
 #endif
+    // GPU-driven chunk culling compacts draws and lets the device read the draw count.
+    draw_indirect_count_supported_ = has_device_extension(physical_device_, "VK_KHR_draw_indirect_count");
+    if (draw_indirect_count_supported_) {
+        enabled_device_exts_.push_back("VK_KHR_draw_indirect_count");
+    }
+
+    VkPhysicalDeviceFeatures supported{};
+    vkGetPhysicalDeviceFeatures(physical_device_, &supported);
+    VkPhysicalDeviceFeatures features{};
+    features.multiDrawIndirect = supported.multiDrawIndirect;
+    multi_draw_indirect_supported_ = supported.multiDrawIndirect == VK_TRUE;
+    // Indirect chunk draws pick their camera-relative origin through firstInstance.
+    features.drawIndirectFirstInstance = supported.drawIndirectFirstInstance;
+    draw_indirect_first_instance_supported_ = supported.drawIndirectFirstInstance == VK_TRUE;
+    // Fragment-shader invocation counts measure overdraw; inherited queries let them span secondaries.
+    features.pipelineStatisticsQuery = supported.pipelineStatisticsQuery;
+    features.inheritedQueries = supported.inheritedQueries;
+    pipeline_statistics_supported_ = supported.pipelineStatisticsQuery == VK_TRUE;
+    inherited_queries_supported_ = supported.inheritedQueries == VK_TRUE;
 
     VkDeviceCreateInfo dci{};
     dci.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+    dci.pEnabledFeatures = &features;
     dci.queueCreateInfoCount = static_cast<uint32_t>(queue_infos.size());
     dci.pQueueCreateInfos = queue_infos.data();
     dci.enabledExtensionCount = static_cast<uint32_t>(enabled_device_exts_.size());
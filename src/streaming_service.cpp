@@ -1,10 +1,20 @@
 #include "streaming_service.h"
 
 #include <algorithm>
+#include <cerrno>
+
+#if defined(__linux__)
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
 
 namespace wf {
 
 namespace {
+constexpr double kWaitSmoothing = 0.1;
+constexpr double kWaitPeakDecay = 0.98;
+
 std::size_t resolve_thread_count(std::size_t count_hint) {
     if (count_hint == 0) {
         unsigned int hw = std::thread::hardware_concurrency();
@@ -12,16 +22,43 @@ std::size_t resolve_thread_count(std::size_t count_hint) {
     }
     return count_hint;
 }
+
+// Lowers (or, with the privilege, raises) the calling thread's scheduling priority.
+void apply_thread_nice(int nice) {
+#if defined(__linux__)
+    if (nice == 0) return;
+    const id_t tid = static_cast<id_t>(::syscall(SYS_gettid));
+    errno = 0;
+    const int base = ::getpriority(PRIO_PROCESS, tid);
+    if (errno == 0) ::setpriority(PRIO_PROCESS, tid, std::clamp(base + nice, -20, 19));
+#else
+    (void)nice;
+#endif
+}
 } // namespace
 
-void StreamingService::start(std::size_t thread_count) {
+void StreamingService::start(std::size_t thread_count, int nice) {
+    const std::size_t resolved = resolve_thread_count(thread_count);
+    start(std::span<const std::size_t>(&resolved, 1), std::span<const int>(&nice, 1));
+}
+
+void StreamingService::start(std::span<const std::size_t> threads_per_class, std::span<const int> nice_per_class) {
     stop();
     quit_.store(false, std::memory_order_relaxed);
     workers_.clear();
-    std::size_t resolved = resolve_thread_count(thread_count);
-    workers_.reserve(resolved);
-    for (std::size_t i = 0; i < resolved; ++i) {
-        workers_.emplace_back([this, i]() { worker_main(i); });
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        classes_.clear();
+        classes_.resize(std::max<std::size_t>(threads_per_class.size(), 1));
+        for (std::size_t c = 0; c < threads_per_class.size(); ++c) {
+            classes_[c].threads = threads_per_class[c];
+        }
+    }
+    for (std::size_t c = 0; c < threads_per_class.size(); ++c) {
+        const int nice = c < nice_per_class.size() ? nice_per_class[c] : 0;
+        for (std::size_t i = 0; i < threads_per_class[c]; ++i) {
+            workers_.emplace_back([this, c, nice]() { worker_main(c, nice); });
+        }
     }
 }
 
@@ -36,18 +73,28 @@ void StreamingService::stop() {
     workers_.clear();
     {
         std::lock_guard<std::mutex> lock(mutex_);
-        tasks_.clear();
+        for (ClassState& state : classes_) {
+            state.tasks.clear();
+            state.active = 0;
+        }
     }
     active_workers_.store(0, std::memory_order_relaxed);
 }
 
 void StreamingService::submit(Task task) {
+    submit(0, std::move(task));
+}
+
+void StreamingService::submit(std::size_t cls, Task task, bool stealable) {
     if (!task) return;
     {
         std::lock_guard<std::mutex> lock(mutex_);
-        tasks_.push_back(std::move(task));
+        if (classes_.empty()) classes_.resize(1);
+        cls = std::min(cls, classes_.size() - 1);
+        classes_[cls].tasks.push_back(Queued{std::move(task), std::chrono::steady_clock::now(), stealable});
     }
-    cv_.notify_one();
+    // Workers of several classes may be eligible; a spurious wakeup is cheaper than a stall.
+    cv_.notify_all();
 }
 
 bool StreamingService::busy() const {
@@ -56,34 +103,97 @@ bool StreamingService::busy() const {
 
 bool StreamingService::idle() const {
     std::lock_guard<std::mutex> lock(mutex_);
-    return tasks_.empty() && active_workers_.load(std::memory_order_relaxed) == 0;
+    for (const ClassState& state : classes_) {
+        if (!state.tasks.empty()) return false;
+    }
+    return active_workers_.load(std::memory_order_relaxed) == 0;
+}
+
+bool StreamingService::idle(std::size_t cls) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (cls >= classes_.size()) return true;
+    return classes_[cls].tasks.empty() && classes_[cls].active == 0;
 }
 
 std::size_t StreamingService::pending_tasks() const {
     std::lock_guard<std::mutex> lock(mutex_);
-    return tasks_.size();
+    std::size_t total = 0;
+    for (const ClassState& state : classes_) total += state.tasks.size();
+    return total;
+}
+
+std::size_t StreamingService::class_count() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return classes_.size();
+}
+
+StreamingService::ClassStats StreamingService::class_stats(std::size_t cls) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ClassStats out{};
+    if (cls >= classes_.size()) return out;
+    const ClassState& state = classes_[cls];
+    out.threads = state.threads;
+    out.pending = state.tasks.size();
+    out.active = state.active;
+    out.completed = state.completed;
+    out.wait_ms_avg = state.wait_ms_avg;
+    out.wait_ms_peak = state.wait_ms_peak;
+    return out;
 }
 
-void StreamingService::worker_main(std::size_t /*index*/) {
+bool StreamingService::take_task(std::size_t own_cls, Queued& out, std::size_t& out_cls) {
+    if (own_cls < classes_.size() && !classes_[own_cls].tasks.empty()) {
+        out_cls = own_cls;
+    } else {
+        out_cls = classes_.size();
+        for (std::size_t c = 0; c < classes_.size(); ++c) {
+            if (!classes_[c].tasks.empty() && classes_[c].tasks.front().stealable) {
+                out_cls = c;
+                break;
+            }
+        }
+        if (out_cls == classes_.size()) return false;
+    }
+    ClassState& state = classes_[out_cls];
+    out = std::move(state.tasks.front());
+    state.tasks.pop_front();
+    ++state.active;
+    double wait_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - out.enqueued).count();
+    state.wait_ms_avg = state.completed + state.active > 1
+                            ? state.wait_ms_avg + (wait_ms - state.wait_ms_avg) * kWaitSmoothing
+                            : wait_ms;
+    state.wait_ms_peak = std::max(wait_ms, state.wait_ms_peak * kWaitPeakDecay);
+    return true;
+}
+
+void StreamingService::worker_main(std::size_t cls, int nice) {
+    apply_thread_nice(nice);
     for (;;) {
-        Task task;
+        Queued item;
+        std::size_t task_cls = cls;
         {
             std::unique_lock<std::mutex> lock(mutex_);
+            bool taken = false;
             cv_.wait(lock, [&] {
-                return quit_.load(std::memory_order_relaxed) || !tasks_.empty();
+                taken = take_task(cls, item, task_cls);
+                return taken || quit_.load(std::memory_order_relaxed);
             });
-            if (quit_.load(std::memory_order_relaxed) && tasks_.empty()) {
+            if (!taken) {
                 break;
             }
-            task = std::move(tasks_.front());
-            tasks_.pop_front();
             active_workers_.fetch_add(1, std::memory_order_relaxed);
         }
 
-        if (task) {
-            task();
+        if (item.task) {
+            item.task();
         }
 
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            ClassState& state = classes_[task_cls];
+            if (state.active > 0) --state.active;
+            ++state.completed;
+        }
         active_workers_.fetch_sub(1, std::memory_order_relaxed);
     }
 }
@@ -0,0 +1,384 @@
+#include "terrain_pyramid.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+
+#include "chunk.h"
+
+namespace wf {
+
+namespace {
+
+constexpr char kPyramidMagic[8] = {'W', 'F', 'H', 'P', 'Y', 'R', '1', '\0'};
+constexpr uint32_t kPyramidVersion = 1;
+
+struct PyramidFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t generator_version;
+    std::uint64_t config_hash;
+    int32_t tiles_per_face;
+    int32_t tile_cells;
+    uint32_t tile_count;
+    uint32_t reserved;
+};
+
+struct PyramidTileHeader {
+    int32_t face;
+    uint32_t index; // ty * tiles_per_face + tx
+};
+
+HeightBounds merge(const HeightBounds& a, const HeightBounds& b) {
+    return HeightBounds{std::min(a.min_m, b.min_m), std::max(a.max_m, b.max_m), 0.5f * (a.avg_m + b.avg_m)};
+}
+
+HeightBounds merge4(const HeightBounds& a, const HeightBounds& b, const HeightBounds& c, const HeightBounds& d) {
+    HeightBounds out{std::min(std::min(a.min_m, b.min_m), std::min(c.min_m, d.min_m)),
+                     std::max(std::max(a.max_m, b.max_m), std::max(c.max_m, d.max_m)),
+                     0.25f * (a.avg_m + b.avg_m + c.avg_m + d.avg_m)};
+    return out;
+}
+
+} // namespace
+
+TerrainHeightPyramid::TerrainHeightPyramid(int tiles_per_face)
+    : tiles_per_face_(static_cast<int>(std::bit_ceil(static_cast<unsigned>(std::max(tiles_per_face, 1))))) {
+    upper_levels_ = std::countr_zero(static_cast<unsigned>(tiles_per_face_)) + 1;
+    finest_cells_ = tiles_per_face_ * kTileCells;
+    set_config(PlanetConfig{});
+}
+
+void TerrainHeightPyramid::set_config(const PlanetConfig& cfg) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const GeneratorStamp stamp = generator_stamp(cfg);
+    if (stamp == stamp_ && stamp_.known()) return;
+    cfg_ = cfg;
+    stamp_ = stamp;
+    // A point of a finest cell is within half a cell in u and in v of some corner sample;
+    // the small constant absorbs float rounding of the sampled noise.
+    const double cell_uv = 2.0 / static_cast<double>(finest_cells_);
+    margin_m_ = static_cast<float>(terrain_height_slope_bound(cfg) * cell_uv + 0.01);
+    reset_faces();
+}
+
+PlanetConfig TerrainHeightPyramid::config() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return cfg_;
+}
+
+void TerrainHeightPyramid::reset_faces() {
+    for (Face& f : faces_) {
+        f.tiles.assign(static_cast<std::size_t>(tiles_per_face_) * tiles_per_face_, nullptr);
+        f.upper.assign(static_cast<std::size_t>(upper_levels_), {});
+        for (int l = 0; l < upper_levels_; ++l) {
+            const std::size_t side = static_cast<std::size_t>(tiles_per_face_ >> l);
+            f.upper[l].assign(side * side, Node{});
+        }
+    }
+    tile_count_ = 0;
+}
+
+HeightBounds TerrainHeightPyramid::full_range() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return HeightBounds{0.0f, static_cast<float>(cfg_.terrain_amp_m), static_cast<float>(0.5 * cfg_.terrain_amp_m)};
+}
+
+// terrain_height_uv is the same function of (u, v) on every face, so tiles ignore the face.
+std::shared_ptr<TerrainHeightPyramid::Tile> TerrainHeightPyramid::build_tile(const PlanetConfig& cfg, float margin_m,
+                                                                           int tx, int ty) const {
+    const int S = kTileCells + 1;
+    const double cell_uv = 2.0 / static_cast<double>(finest_cells_);
+    auto t = std::make_shared<Tile>();
+    t->samples.resize(static_cast<std::size_t>(S) * S);
+    for (int y = 0; y < S; ++y) {
+        const float v = static_cast<float>(-1.0 + (ty * kTileCells + y) * cell_uv);
+        for (int x = 0; x < S; ++x) {
+            const float u = static_cast<float>(-1.0 + (tx * kTileCells + x) * cell_uv);
+            t->samples[static_cast<std::size_t>(y * S + x)] = static_cast<float>(terrain_height_uv(cfg, u, v));
+        }
+    }
+    finish_tile(*t, static_cast<float>(cfg.terrain_amp_m), margin_m);
+    return t;
+}
+
+void TerrainHeightPyramid::finish_tile(Tile& t, float amp_m, float margin_m) {
+    const int S = kTileCells + 1;
+    const float lo = 0.0f;
+    const float hi = amp_m;
+    auto& l0 = t.levels[0];
+    l0.resize(static_cast<std::size_t>(kTileCells) * kTileCells);
+    for (int y = 0; y < kTileCells; ++y) {
+        for (int x = 0; x < kTileCells; ++x) {
+            const float a = t.samples[static_cast<std::size_t>(y * S + x)];
+            const float b = t.samples[static_cast<std::size_t>(y * S + x + 1)];
+            const float c = t.samples[static_cast<std::size_t>((y + 1) * S + x)];
+            const float d = t.samples[static_cast<std::size_t>((y + 1) * S + x + 1)];
+            HeightBounds& cell = l0[static_cast<std::size_t>(y * kTileCells + x)];
+            cell.min_m = std::clamp(std::min(std::min(a, b), std::min(c, d)) - margin_m, lo, hi);
+            cell.max_m = std::clamp(std::max(std::max(a, b), std::max(c, d)) + margin_m, lo, hi);
+            cell.avg_m = 0.25f * (a + b + c + d);
+        }
+    }
+    for (int l = 1; l < kTileLevels; ++l) {
+        const int side = kTileCells >> l;
+        const auto& src = t.levels[l - 1];
+        auto& dst = t.levels[l];
+        dst.resize(static_cast<std::size_t>(side) * side);
+        for (int y = 0; y < side; ++y) {
+            for (int x = 0; x < side; ++x) {
+                const std::size_t s0 = static_cast<std::size_t>((2 * y) * (2 * side) + 2 * x);
+                const std::size_t s1 = s0 + static_cast<std::size_t>(2 * side);
+                dst[static_cast<std::size_t>(y * side + x)] = merge4(src[s0], src[s0 + 1], src[s1], src[s1 + 1]);
+            }
+        }
+    }
+}
+
+std::shared_ptr<const TerrainHeightPyramid::Tile> TerrainHeightPyramid::tile(int face, int tx, int ty) {
+    const std::size_t idx = static_cast<std::size_t>(ty) * tiles_per_face_ + tx;
+    GeneratorStamp stamp;
+    PlanetConfig cfg;
+    float margin_m = 0.0f;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (faces_[face].tiles[idx]) return faces_[face].tiles[idx];
+        stamp = stamp_;
+        cfg = cfg_;
+        margin_m = margin_m_;
+    }
+    std::shared_ptr<const Tile> built = build_tile(cfg, margin_m, tx, ty);
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (stamp != stamp_) return built; // the config changed while building
+    // Two callers may build the same tile at once; the first insert wins.
+    std::shared_ptr<const Tile>& slot = faces_[face].tiles[idx];
+    if (!slot) {
+        slot = std::move(built);
+        Node& root = faces_[face].upper[0][idx];
+        root.b = slot->levels[kTileLevels - 1][0];
+        root.built = true;
+        ++tiles_built_;
+        ++tile_count_;
+    }
+    return slot;
+}
+
+HeightBounds TerrainHeightPyramid::node_bounds(int face, int level, int nx, int ny) {
+    const int side = tiles_per_face_ >> level;
+    const std::size_t idx = static_cast<std::size_t>(ny) * side + nx;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const Node& n = faces_[face].upper[level][idx];
+        if (n.built) return n.b;
+    }
+    if (level == 0) return tile(face, nx, ny)->levels[kTileLevels - 1][0];
+    // Merge the children when they are all there; otherwise sample the node coarsely
+    // instead of building every tile under it.
+    bool children = true;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const std::vector<Node>& below = faces_[face].upper[level - 1];
+        const std::size_t side_below = static_cast<std::size_t>(side) * 2;
+        for (int c = 0; c < 4 && children; ++c) {
+            const std::size_t cx = static_cast<std::size_t>(2 * nx + (c & 1));
+            const std::size_t cy = static_cast<std::size_t>(2 * ny + (c >> 1));
+            children = below[cy * side_below + cx].built;
+        }
+    }
+    const HeightBounds b = children
+        ? merge4(node_bounds(face, level - 1, 2 * nx, 2 * ny), node_bounds(face, level - 1, 2 * nx + 1, 2 * ny),
+                 node_bounds(face, level - 1, 2 * nx, 2 * ny + 1), node_bounds(face, level - 1, 2 * nx + 1, 2 * ny + 1))
+        : sample_node(level, nx, ny);
+    std::lock_guard<std::mutex> lock(mutex_);
+    Node& n = faces_[face].upper[level][idx];
+    n.b = b;
+    n.built = true;
+    return b;
+}
+
+HeightBounds TerrainHeightPyramid::sample_node(int level, int nx, int ny) const {
+    PlanetConfig cfg;
+    float margin = 0.0f;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        cfg = cfg_;
+        margin = margin_m_;
+    }
+    // Same padding rule as a tile cell, scaled to the coarser sample spacing.
+    constexpr int kSteps = 8;
+    const int node_cells = kTileCells << level;
+    const double step_uv = 2.0 * node_cells / (static_cast<double>(finest_cells_) * kSteps);
+    margin *= static_cast<float>(node_cells / kSteps);
+    float lo = 1e30f, hi = -1e30f, sum = 0.0f;
+    for (int y = 0; y <= kSteps; ++y) {
+        const float v = static_cast<float>(-1.0 + (ny * kSteps + y) * step_uv);
+        for (int x = 0; x <= kSteps; ++x) {
+            const float u = static_cast<float>(-1.0 + (nx * kSteps + x) * step_uv);
+            const float h = static_cast<float>(terrain_height_uv(cfg, u, v));
+            lo = std::min(lo, h);
+            hi = std::max(hi, h);
+            sum += h;
+        }
+    }
+    const float amp = static_cast<float>(cfg.terrain_amp_m);
+    return HeightBounds{std::clamp(lo - margin, 0.0f, amp), std::clamp(hi + margin, 0.0f, amp),
+                        sum / static_cast<float>((kSteps + 1) * (kSteps + 1))};
+}
+
+HeightBounds TerrainHeightPyramid::cell_bounds(int face, int level, int cx, int cy) {
+    if (level >= kTileLevels - 1) return node_bounds(face, level - (kTileLevels - 1), cx, cy);
+    const int per_tile = kTileCells >> level;
+    std::shared_ptr<const Tile> t = tile(face, cx / per_tile, cy / per_tile);
+    return t->levels[level][static_cast<std::size_t>((cy % per_tile) * per_tile + cx % per_tile)];
+}
+
+HeightBounds TerrainHeightPyramid::bounds_uv(int face, double u0, double v0, double u1, double v1) {
+    if (face < 0 || face >= 6) return full_range();
+    const double F = static_cast<double>(finest_cells_);
+    auto cell = [&](double uv) {
+        const double c = std::floor((std::clamp(uv, -1.0, 1.0) + 1.0) * 0.5 * F);
+        return std::clamp(static_cast<int>(c), 0, finest_cells_ - 1);
+    };
+    int cx0 = cell(std::min(u0, u1)), cx1 = cell(std::max(u0, u1));
+    int cy0 = cell(std::min(v0, v1)), cy1 = cell(std::max(v0, v1));
+    // Coarsest needed: the area spans at most two cells per axis.
+    int level = 0;
+    while ((cx1 >> level) - (cx0 >> level) > 1 || (cy1 >> level) - (cy0 >> level) > 1) ++level;
+    cx0 >>= level; cx1 >>= level; cy0 >>= level; cy1 >>= level;
+    HeightBounds out = cell_bounds(face, level, cx0, cy0);
+    if (cx1 != cx0) out = merge(out, cell_bounds(face, level, cx1, cy0));
+    if (cy1 != cy0) {
+        HeightBounds row = cell_bounds(face, level, cx0, cy1);
+        if (cx1 != cx0) row = merge(row, cell_bounds(face, level, cx1, cy1));
+        out = merge(out, row);
+    }
+    return out;
+}
+
+HeightBounds TerrainHeightPyramid::bounds_at(const Float3& direction) {
+    int face = 0;
+    float u = 0.0f, v = 0.0f;
+    if (!face_uv_from_direction(direction, face, u, v)) return full_range();
+    return bounds_uv(face, u, v, u, v);
+}
+
+HeightBounds TerrainHeightPyramid::column_bounds(const FaceChunkKey& key) {
+    double chunk_m = 0.0, radius_m = 0.0;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        chunk_m = cfg_.voxel_size_m * Chunk64::N;
+        radius_m = cfg_.radius_m;
+    }
+    // Generation samples column directions at the planet radius, where face-UV is S / R.
+    const double u0 = static_cast<double>(key.i) * chunk_m / radius_m;
+    const double v0 = static_cast<double>(key.j) * chunk_m / radius_m;
+    const double u1 = u0 + chunk_m / radius_m;
+    const double v1 = v0 + chunk_m / radius_m;
+    if (u0 < -1.0 || v0 < -1.0 || u1 > 1.0 || v1 > 1.0) return full_range();
+    return bounds_uv(key.face, u0, v0, u1, v1);
+}
+
+bool TerrainHeightPyramid::save(const std::string& path) const {
+    std::vector<std::pair<PyramidTileHeader, std::shared_ptr<const Tile>>> tiles;
+    PyramidFileHeader hdr{};
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (int f = 0; f < 6; ++f) {
+            for (std::size_t i = 0; i < faces_[f].tiles.size(); ++i) {
+                if (faces_[f].tiles[i]) tiles.push_back({PyramidTileHeader{f, static_cast<uint32_t>(i)}, faces_[f].tiles[i]});
+            }
+        }
+        std::memcpy(hdr.magic, kPyramidMagic, sizeof(hdr.magic));
+        hdr.version = kPyramidVersion;
+        hdr.generator_version = stamp_.generator_version;
+        hdr.config_hash = stamp_.config_hash;
+        hdr.tiles_per_face = tiles_per_face_;
+        hdr.tile_cells = kTileCells;
+        hdr.tile_count = static_cast<uint32_t>(tiles.size());
+    }
+    std::error_code ec;
+    const std::filesystem::path target(path);
+    if (target.has_parent_path()) std::filesystem::create_directories(target.parent_path(), ec);
+    // Written aside and renamed so a crash never leaves a torn file behind.
+    const std::string tmp = path + ".tmp";
+    FILE* f = std::fopen(tmp.c_str(), "wb");
+    if (!f) return false;
+    bool ok = std::fwrite(&hdr, sizeof(hdr), 1, f) == 1;
+    for (const auto& [th, t] : tiles) {
+        if (!ok) break;
+        ok = std::fwrite(&th, sizeof(th), 1, f) == 1 &&
+             std::fwrite(t->samples.data(), sizeof(float), t->samples.size(), f) == t->samples.size();
+    }
+    ok = (std::fclose(f) == 0) && ok;
+    if (ok) std::filesystem::rename(tmp, target, ec);
+    if (!ok || ec) {
+        std::filesystem::remove(tmp, ec);
+        return false;
+    }
+    return true;
+}
+
+bool TerrainHeightPyramid::load(const std::string& path) {
+    FILE* f = std::fopen(path.c_str(), "rb");
+    if (!f) return false;
+    PyramidFileHeader hdr{};
+    bool ok = std::fread(&hdr, sizeof(hdr), 1, f) == 1 && std::memcmp(hdr.magic, kPyramidMagic, sizeof(hdr.magic)) == 0 &&
+              hdr.version == kPyramidVersion && hdr.tile_cells == kTileCells;
+    GeneratorStamp stamp;
+    float amp_m = 0.0f, margin_m = 0.0f;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ok = ok && hdr.generator_version == stamp_.generator_version && hdr.config_hash == stamp_.config_hash &&
+             hdr.tiles_per_face == tiles_per_face_;
+        stamp = stamp_;
+        amp_m = static_cast<float>(cfg_.terrain_amp_m);
+        margin_m = margin_m_;
+    }
+    const std::size_t S = static_cast<std::size_t>(kTileCells + 1);
+    for (uint32_t n = 0; ok && n < hdr.tile_count; ++n) {
+        PyramidTileHeader th{};
+        auto t = std::make_shared<Tile>();
+        t->samples.resize(S * S);
+        ok = std::fread(&th, sizeof(th), 1, f) == 1 &&
+             std::fread(t->samples.data(), sizeof(float), t->samples.size(), f) == t->samples.size() &&
+             th.face >= 0 && th.face < 6 && th.index < static_cast<uint32_t>(tiles_per_face_ * tiles_per_face_);
+        if (!ok) break;
+        finish_tile(*t, amp_m, margin_m);
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stamp != stamp_) { // the config changed while loading; the file is stale now
+            ok = false;
+            break;
+        }
+        std::shared_ptr<const Tile>& slot = faces_[th.face].tiles[th.index];
+        if (slot) continue;
+        slot = std::move(t);
+        Node& root = faces_[th.face].upper[0][th.index];
+        root.b = slot->levels[kTileLevels - 1][0];
+        root.built = true;
+        ++tiles_loaded_;
+        ++tile_count_;
+    }
+    std::fclose(f);
+    return ok;
+}
+
+TerrainHeightPyramid::Stats TerrainHeightPyramid::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats out;
+    out.tiles_built = tiles_built_;
+    out.tiles_loaded = tiles_loaded_;
+    out.tiles = tile_count_;
+    return out;
+}
+
+void surface_shell_range(const PlanetConfig& cfg, const HeightBounds& b, double margin_m, std::int64_t& k_lo,
+                         std::int64_t& k_hi) {
+    const double chunk_m = cfg.voxel_size_m * Chunk64::N;
+    k_lo = static_cast<std::int64_t>(std::floor((cfg.radius_m + b.min_m - margin_m) / chunk_m));
+    k_hi = static_cast<std::int64_t>(std::floor((cfg.radius_m + b.max_m) / chunk_m));
+}
+
+} // namespace wf
@@ -1,14 +1,70 @@
 #include "ui/ui_context.h"
 
+#include <algorithm>
+
+#include "ui/ui_id.h"
+#include "ui/ui_text.h"
+
 namespace wf::ui {
 
+namespace {
+
+// Dirty ranges older than this many revisions are dropped; slower consumers re-upload in full.
+constexpr std::uint64_t kDirtyHistoryRevisions = 4;
+constexpr std::uint32_t kRangeGranularityQuads = 8;
+
+std::uint32_t range_capacity_for(std::uint32_t quads) {
+    // Leave ~25% headroom so small text length changes patch in place.
+    std::uint32_t want = quads + quads / 4;
+    return (want + kRangeGranularityQuads - 1) / kRangeGranularityQuads * kRangeGranularityQuads;
+}
+
+} // namespace
+
 void UIContext::begin(const ContextParams& params) {
     params_ = params;
-    vertices_.clear();
+    UIID h = hash_mix(hash_id("ui.params"), static_cast<std::uint64_t>(params.screen_width));
+    h = hash_mix(h, static_cast<std::uint64_t>(params.screen_height));
+    h = hash_mix(h, params.style.scale);
+    h = hash_mix(h, static_cast<std::uint64_t>(params.style.enable_shadow ? 1 : 0));
+    h = hash_mix(h, params.style.shadow_offset_px);
+    h = hash_mix(h, params.style.shadow_color);
+    params_hash_ = h;
+    frame_widgets_.clear();
+    scratch_.clear();
+    widget_open_ = false;
+    implicit_count_ = 0;
+    stats_ = UIRetainedStats{};
+}
+
+bool UIContext::begin_widget(UIID id, std::uint64_t content_hash) {
+    if (widget_open_) end_widget();
+    FrameWidget fw;
+    fw.id = id;
+    fw.hash = (content_hash == 0) ? 0 : hash_mix(content_hash, params_hash_);
+    fw.scratch_first = static_cast<std::uint32_t>(scratch_.size());
+    auto it = range_lookup_.find(id);
+    fw.rebuilt = (fw.hash == 0 || it == range_lookup_.end() || ranges_[it->second].hash != fw.hash);
+    frame_widgets_.push_back(fw);
+    widget_open_ = true;
+    return fw.rebuilt;
+}
+
+void UIContext::end_widget() {
+    if (!widget_open_) return;
+    FrameWidget& fw = frame_widgets_.back();
+    fw.scratch_count = static_cast<std::uint32_t>(scratch_.size()) - fw.scratch_first;
+    widget_open_ = false;
+}
+
+void UIContext::ensure_scope() {
+    if (widget_open_) return;
+    // Geometry emitted outside a widget scope is grouped and rebuilt every frame.
+    begin_widget(hash_mix(hash_id("ui.immediate"), static_cast<std::uint64_t>(implicit_count_++)), 0);
 }
 
 void UIContext::add_quad_pixels(const Rect& rect, const Color& color) {
-    push_quad_ndc(rect, color);
+    push_solid_quad_ndc(rect, color);
 }
 
 void UIContext::add_shadowed_quad_pixels(const Rect& rect, const Color& color) {
@@ -16,19 +72,154 @@ void UIContext::add_shadowed_quad_pixels(const Rect& rect, const Color& color) {
         Rect shadow_rect = rect;
         shadow_rect.x += params_.style.shadow_offset_px;
         shadow_rect.y += params_.style.shadow_offset_px;
-        push_quad_ndc(shadow_rect, params_.style.shadow_color);
+        push_solid_quad_ndc(shadow_rect, params_.style.shadow_color);
+    }
+    push_solid_quad_ndc(rect, color);
+}
+
+void UIContext::add_glyph_pixels(const Rect& rect, int glyph_index, const Color& color) {
+    Vec2 origin = glyph_atlas_origin(glyph_index);
+    Rect quad = rect;
+    Rect uv{origin.x, origin.y, static_cast<float>(kFont6x8Width), static_cast<float>(kFont6x8Height)};
+    float shadow_texels = 0.0f;
+    float texel_px = rect.w / static_cast<float>(kFont6x8Width);
+    if (params_.style.enable_shadow && texel_px > 0.0f) {
+        // Grow the quad right/down so the offset shadow is not clipped.
+        shadow_texels = std::min(params_.style.shadow_offset_px / texel_px, static_cast<float>(kGlyphAtlasPad));
+        quad.w += shadow_texels * texel_px;
+        quad.h += shadow_texels * texel_px;
+        uv.w += shadow_texels;
+        uv.h += shadow_texels;
     }
-    push_quad_ndc(rect, color);
+    push_quad_ndc(quad, color, uv, shadow_texels);
 }
 
 UIDrawData UIContext::end() {
+    if (widget_open_) end_widget();
+
+    bool same_layout = frame_widgets_.size() == ranges_.size();
+    for (std::size_t i = 0; same_layout && i < frame_widgets_.size(); ++i) {
+        const FrameWidget& fw = frame_widgets_[i];
+        same_layout = fw.id == ranges_[i].id && (!fw.rebuilt || fw.scratch_count / 4 <= ranges_[i].capacity_quads);
+    }
+
+    stats_.widgets = static_cast<std::uint32_t>(frame_widgets_.size());
+    for (const FrameWidget& fw : frame_widgets_) {
+        if (fw.rebuilt) ++stats_.widgets_rebuilt;
+    }
+
+    if (!same_layout) {
+        repack();
+        stats_.layout_changed = true;
+    } else if (stats_.widgets_rebuilt > 0) {
+        ++revision_;
+        for (std::size_t i = 0; i < frame_widgets_.size(); ++i) {
+            const FrameWidget& fw = frame_widgets_[i];
+            if (!fw.rebuilt) continue;
+            WidgetRange& range = ranges_[i];
+            range.hash = fw.hash;
+            write_range(range, scratch_.data() + fw.scratch_first, fw.scratch_count);
+            dirty_.push_back(UIDirtyRange{revision_, range.first_quad * 4, range.capacity_quads * 4});
+        }
+    }
+
+    if (revision_ > kDirtyHistoryRevisions) {
+        const std::uint64_t oldest_kept = revision_ - kDirtyHistoryRevisions;
+        if (oldest_kept > patch_base_revision_) {
+            dirty_.erase(std::remove_if(dirty_.begin(), dirty_.end(),
+                                        [&](const UIDirtyRange& r) { return r.revision <= oldest_kept; }),
+                         dirty_.end());
+            patch_base_revision_ = oldest_kept;
+        }
+    }
+
     draw_data_.vertices = vertices_.empty() ? nullptr : vertices_.data();
     draw_data_.vertex_count = vertices_.size();
+    draw_data_.indices = indices_.empty() ? nullptr : indices_.data();
+    draw_data_.index_count = indices_.size();
+    draw_data_.shadow_color = params_.style.shadow_color;
+    draw_data_.revision = revision_;
+    draw_data_.layout_revision = layout_revision_;
+    draw_data_.patch_base_revision = patch_base_revision_;
+    draw_data_.dirty_ranges = dirty_.empty() ? nullptr : dirty_.data();
+    draw_data_.dirty_range_count = dirty_.size();
     return draw_data_;
 }
 
-void UIContext::push_quad_ndc(const Rect& rect_px, const Color& color) noexcept {
+void UIContext::repack() {
+    std::vector<UIDrawVertex> old_vertices;
+    old_vertices.swap(vertices_);
+    std::vector<WidgetRange> old_ranges;
+    old_ranges.swap(ranges_);
+    std::unordered_map<UIID, std::size_t> old_lookup;
+    old_lookup.swap(range_lookup_);
+
+    ranges_.reserve(frame_widgets_.size());
+    std::uint32_t next_quad = 0;
+    for (const FrameWidget& fw : frame_widgets_) {
+        const WidgetRange* old = nullptr;
+        if (auto it = old_lookup.find(fw.id); it != old_lookup.end()) old = &old_ranges[it->second];
+        WidgetRange range;
+        range.id = fw.id;
+        range.hash = fw.hash;
+        range.first_quad = next_quad;
+        if (fw.rebuilt || !old) {
+            std::uint32_t quads = fw.scratch_count / 4;
+            range.capacity_quads = (old && quads <= old->capacity_quads) ? old->capacity_quads : range_capacity_for(quads);
+        } else {
+            range.capacity_quads = old->capacity_quads;
+        }
+        next_quad += range.capacity_quads;
+        range_lookup_[fw.id] = ranges_.size();
+        ranges_.push_back(range);
+    }
+
+    vertices_.assign(static_cast<std::size_t>(next_quad) * 4, UIDrawVertex{});
+    for (std::size_t i = 0; i < frame_widgets_.size(); ++i) {
+        const FrameWidget& fw = frame_widgets_[i];
+        const WidgetRange& range = ranges_[i];
+        if (fw.rebuilt) {
+            write_range(range, scratch_.data() + fw.scratch_first, fw.scratch_count);
+        } else {
+            const WidgetRange& old = old_ranges[old_lookup[fw.id]];
+            write_range(range, old_vertices.data() + static_cast<std::size_t>(old.first_quad) * 4, old.capacity_quads * 4);
+        }
+    }
+
+    indices_.resize(static_cast<std::size_t>(next_quad) * 6);
+    for (std::uint32_t q = 0; q < next_quad; ++q) {
+        const std::uint32_t base = q * 4;
+        std::uint32_t* dst = indices_.data() + static_cast<std::size_t>(q) * 6;
+        dst[0] = base + 0; dst[1] = base + 1; dst[2] = base + 2;
+        dst[3] = base + 0; dst[4] = base + 2; dst[5] = base + 3;
+    }
+
+    ++revision_;
+    layout_revision_ = revision_;
+    patch_base_revision_ = revision_;
+    dirty_.clear();
+}
+
+void UIContext::write_range(const WidgetRange& range, const UIDrawVertex* src, std::uint32_t vertex_count) {
+    const std::uint32_t capacity = range.capacity_quads * 4;
+    vertex_count = std::min(vertex_count, capacity);
+    UIDrawVertex* dst = vertices_.data() + static_cast<std::size_t>(range.first_quad) * 4;
+    std::copy(src, src + vertex_count, dst);
+    // Unused tail quads collapse to zero-area triangles.
+    std::fill(dst + vertex_count, dst + capacity, UIDrawVertex{0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f});
+}
+
+void UIContext::push_solid_quad_ndc(const Rect& rect_px, const Color& color) noexcept {
+    // Sample the middle of the solid atlas cell so nearest filtering always hits 255.
+    Vec2 origin = glyph_atlas_origin(kGlyphAtlasSolidIndex);
+    Rect uv{origin.x + 1.0f, origin.y + 1.0f, 1.0f, 1.0f};
+    push_quad_ndc(rect_px, color, uv, 0.0f);
+}
+
+void UIContext::push_quad_ndc(const Rect& rect_px, const Color& color, const Rect& uv, float shadow_texels) noexcept {
     if (params_.screen_width <= 0 || params_.screen_height <= 0) return;
+    ensure_scope();
+    if (!frame_widgets_.back().rebuilt) return; // cached widget: geometry already resident
     auto to_ndc = [&](float px, float py) {
         float xn = (px / static_cast<float>(params_.screen_width)) * 2.0f - 1.0f;
         float yn = (py / static_cast<float>(params_.screen_height)) * 2.0f - 1.0f;
@@ -47,17 +238,17 @@ void UIContext::push_quad_ndc(const Rect& rect_px, const Color& color) noexcept
     Vec2 p2 = to_ndc(scaled.x + scaled.w, scaled.y + scaled.h);
     Vec2 p3 = to_ndc(scaled.x, scaled.y + scaled.h);
 
-    UIDrawVertex v0{p0.x, p0.y, color.r, color.g, color.b, color.a};
-    UIDrawVertex v1{p1.x, p1.y, color.r, color.g, color.b, color.a};
-    UIDrawVertex v2{p2.x, p2.y, color.r, color.g, color.b, color.a};
-    UIDrawVertex v3{p3.x, p3.y, color.r, color.g, color.b, color.a};
-
-    vertices_.push_back(v0);
-    vertices_.push_back(v1);
-    vertices_.push_back(v2);
-    vertices_.push_back(v0);
-    vertices_.push_back(v2);
-    vertices_.push_back(v3);
+    const float inv_w = 1.0f / static_cast<float>(kGlyphAtlasWidth);
+    const float inv_h = 1.0f / static_cast<float>(kGlyphAtlasHeight);
+    const float u0 = uv.x * inv_w;
+    const float v0 = uv.y * inv_h;
+    const float u1 = (uv.x + uv.w) * inv_w;
+    const float v1 = (uv.y + uv.h) * inv_h;
+
+    scratch_.push_back(UIDrawVertex{p0.x, p0.y, u0, v0, color.r, color.g, color.b, color.a, shadow_texels});
+    scratch_.push_back(UIDrawVertex{p1.x, p1.y, u1, v0, color.r, color.g, color.b, color.a, shadow_texels});
+    scratch_.push_back(UIDrawVertex{p2.x, p2.y, u1, v1, color.r, color.g, color.b, color.a, shadow_texels});
+    scratch_.push_back(UIDrawVertex{p3.x, p3.y, u0, v1, color.r, color.g, color.b, color.a, shadow_texels});
 }
 
 } // namespace wf::ui
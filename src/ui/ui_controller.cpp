@@ -2,6 +2,7 @@
 
 #include <algorithm>
 #include <array>
+#include <chrono>
 #include <string>
 
 #include "ui/ui_id.h"
@@ -27,6 +28,7 @@ void UiController::end_backend_frame() {
 }
 
 UiController::FrameOutput UiController::build_frame(const FrameInput& input) {
+    auto t_begin = std::chrono::steady_clock::now();
     ContextParams params;
     params.screen_width = input.screen_width;
     params.screen_height = input.screen_height;
@@ -44,10 +46,15 @@ UiController::FrameOutput UiController::build_frame(const FrameInput& input) {
     text_params.scale = 1.0f;
     text_params.color = Color{1.0f, 1.0f, 1.0f, 1.0f};
     text_params.line_spacing_px = 4.0f;
-    float text_height = 0.0f;
-    if (!hud_text_.empty()) {
-        text_height = add_text_block(context_, hud_text_.c_str(), params.screen_width, text_params);
+    // The HUD text is only re-tessellated when its string changes.
+    if (context_.begin_widget(hash_id("hud.text"), hash_id(hud_text_))) {
+        hud_text_height_ = 0.0f;
+        if (!hud_text_.empty()) {
+            hud_text_height_ = add_text_block(context_, hud_text_.c_str(), params.screen_width, text_params);
+        }
     }
+    context_.end_widget();
+    float text_height = hud_text_height_;
 
     ButtonStyle button_style;
     button_style.text_scale = 1.0f;
@@ -142,6 +149,7 @@ UiController::FrameOutput UiController::build_frame(const FrameInput& input) {
     crosshair(context_, crosshair_center, crosshair_style);
 
     draw_data_ = context_.end();
+    last_build_ms_ = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t_begin).count();
     return output;
 }
 
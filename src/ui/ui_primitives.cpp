@@ -47,18 +47,23 @@ bool button(UIContext& ctx,
     if (state.active) fill = style.bg_active;
     else if (state.hovered) fill = style.bg_hover;
 
-    ctx.add_shadowed_quad_pixels(rect_px, fill);
-
-    TextDrawParams text_params;
-    text_params.origin_px = Vec2{rect_px.x + style.padding_px, rect_px.y + style.padding_px};
-    float margin_right = rect_px.w - style.padding_px;
-    text_params.margin_right_px = std::max(0.0f, margin_right);
-    text_params.line_spacing_px = 0.0f;
-    text_params.scale = style.text_scale;
-    text_params.color = style.text;
-    text_params.ellipsis = false;
-    std::string label_str(label);
-    add_text_block(ctx, label_str.c_str(), ctx.params().screen_width, text_params);
+    UIID content = hash_mix(hash_mix(hash_id(id, label), rect_px), fill);
+    content = hash_mix(hash_mix(hash_mix(content, style.text), style.text_scale), style.padding_px);
+    if (ctx.begin_widget(id, content)) {
+        ctx.add_shadowed_quad_pixels(rect_px, fill);
+
+        TextDrawParams text_params;
+        text_params.origin_px = Vec2{rect_px.x + style.padding_px, rect_px.y + style.padding_px};
+        float margin_right = rect_px.w - style.padding_px;
+        text_params.margin_right_px = std::max(0.0f, margin_right);
+        text_params.line_spacing_px = 0.0f;
+        text_params.scale = style.text_scale;
+        text_params.color = style.text;
+        text_params.ellipsis = false;
+        std::string label_str(label);
+        add_text_block(ctx, label_str.c_str(), ctx.params().screen_width, text_params);
+    }
+    ctx.end_widget();
 
     return state.pressed;
 }
@@ -89,18 +94,23 @@ bool selectable(UIContext& ctx,
         fill = selected ? style.bg_selected_hover : style.bg_hover;
     }
 
-    ctx.add_shadowed_quad_pixels(rect_px, fill);
-
-    TextDrawParams text_params;
-    text_params.origin_px = Vec2{rect_px.x + style.padding_px, rect_px.y + style.padding_px};
-    text_params.margin_right_px = std::max(0.0f, rect_px.w - style.padding_px * 2.0f);
-    text_params.line_spacing_px = 2.0f;
-    text_params.scale = style.text_scale;
-    text_params.color = style.text;
-    text_params.ellipsis = false;
-
-    std::string label_str(label);
-    add_text_block(ctx, label_str.c_str(), ctx.params().screen_width, text_params);
+    UIID content = hash_mix(hash_mix(hash_id(id, label), rect_px), fill);
+    content = hash_mix(hash_mix(hash_mix(content, style.text), style.text_scale), style.padding_px);
+    if (ctx.begin_widget(id, content)) {
+        ctx.add_shadowed_quad_pixels(rect_px, fill);
+
+        TextDrawParams text_params;
+        text_params.origin_px = Vec2{rect_px.x + style.padding_px, rect_px.y + style.padding_px};
+        text_params.margin_right_px = std::max(0.0f, rect_px.w - style.padding_px * 2.0f);
+        text_params.line_spacing_px = 2.0f;
+        text_params.scale = style.text_scale;
+        text_params.color = style.text;
+        text_params.ellipsis = false;
+
+        std::string label_str(label);
+        add_text_block(ctx, label_str.c_str(), ctx.params().screen_width, text_params);
+    }
+    ctx.end_widget();
 
     return state.pressed;
 }
@@ -144,10 +154,14 @@ void crosshair(UIContext& ctx,
                           thickness,
                           arm_length);
 
-    ctx.add_quad_pixels(left, style.color);
-    ctx.add_quad_pixels(right, style.color);
-    ctx.add_quad_pixels(top, style.color);
-    ctx.add_quad_pixels(bottom, style.color);
+    UIID content = hash_mix(hash_mix(hash_mix(hash_id("ui.crosshair"), left), top), style.color);
+    if (ctx.begin_widget(hash_id("ui.crosshair"), content)) {
+        ctx.add_quad_pixels(left, style.color);
+        ctx.add_quad_pixels(right, style.color);
+        ctx.add_quad_pixels(top, style.color);
+        ctx.add_quad_pixels(bottom, style.color);
+    }
+    ctx.end_widget();
 }
 
 DropdownResult dropdown(UIContext& ctx,
@@ -197,52 +211,72 @@ DropdownResult dropdown(UIContext& ctx,
     else if (inside_panel && input.mouse_down[0]) panel_color = style.panel_bg_active;
     else if (inside_panel) panel_color = style.panel_bg_hover;
 
-    ctx.add_shadowed_quad_pixels(rect_px, panel_color);
-
-    TextDrawParams text_params;
-    text_params.origin_px = Vec2{rect_px.x + style.padding_px, rect_px.y + style.padding_px};
-    text_params.margin_right_px = std::max(0.0f, rect_px.w - style.padding_px * 2.0f);
-    text_params.line_spacing_px = 0.0f;
-    text_params.scale = style.text_scale;
-    text_params.color = style.text;
-    text_params.ellipsis = true;
-
-    std::string current_label;
-    if (result.selected_index < labels.size()) {
-        current_label.assign(labels[result.selected_index]);
-    }
-    add_text_block(ctx, current_label.c_str(), ctx.params().screen_width, text_params);
-
+    // Resolve hover before emitting so the content hash covers every visual input.
     int hovered_index = -1;
-
-    if (open && !labels.empty()) {
-        ctx.add_shadowed_quad_pixels(popup_rect, style.popup_bg);
-
+    if (open && input.has_mouse) {
         for (std::size_t i = 0; i < labels.size(); ++i) {
             Rect row_rect = popup_rect;
             row_rect.y = popup_rect.y + style.item_height_px * static_cast<float>(i);
             row_rect.h = style.item_height_px;
-            Rect row_rect_scaled = scale_rect(row_rect, scale);
+            if (point_in_rect(input.mouse_x, input.mouse_y, scale_rect(row_rect, scale))) {
+                hovered_index = static_cast<int>(i);
+            }
+        }
+    }
 
-            bool row_hover = input.has_mouse && point_in_rect(input.mouse_x, input.mouse_y, row_rect_scaled);
-            if (row_hover) hovered_index = static_cast<int>(i);
+    UIID content = hash_mix(hash_mix(hash_id("ui.dropdown"), rect_px), panel_color);
+    content = hash_mix(content, static_cast<std::uint64_t>(open ? 1 : 0));
+    content = hash_mix(content, static_cast<std::uint64_t>(result.selected_index));
+    content = hash_mix(content, static_cast<std::uint64_t>(static_cast<std::int64_t>(hovered_index)));
+    for (std::string_view label : labels) {
+        content = hash_id(content, label);
+    }
 
-            Color row_color = style.option_bg;
-            if (result.selected_index == i) row_color = style.option_bg_selected;
-            if (row_hover) row_color = style.option_bg_hover;
-            if (row_color.a > 0.0f) {
-                ctx.add_quad_pixels(row_rect, row_color);
-            }
+    if (ctx.begin_widget(id, content)) {
+        ctx.add_shadowed_quad_pixels(rect_px, panel_color);
 
-            TextDrawParams row_text = text_params;
-            row_text.origin_px = Vec2{row_rect.x + style.padding_px, row_rect.y + style.padding_px};
-            row_text.margin_right_px = std::max(0.0f, row_rect.w - style.padding_px * 2.0f);
-            row_text.color = style.option_text;
-            row_text.scale = style.text_scale;
-            std::string label_str(labels[i]);
-            add_text_block(ctx, label_str.c_str(), ctx.params().screen_width, row_text);
+        TextDrawParams text_params;
+        text_params.origin_px = Vec2{rect_px.x + style.padding_px, rect_px.y + style.padding_px};
+        text_params.margin_right_px = std::max(0.0f, rect_px.w - style.padding_px * 2.0f);
+        text_params.line_spacing_px = 0.0f;
+        text_params.scale = style.text_scale;
+        text_params.color = style.text;
+        text_params.ellipsis = true;
+
+        std::string current_label;
+        if (result.selected_index < labels.size()) {
+            current_label.assign(labels[result.selected_index]);
+        }
+        add_text_block(ctx, current_label.c_str(), ctx.params().screen_width, text_params);
+
+        if (open && !labels.empty()) {
+            ctx.add_shadowed_quad_pixels(popup_rect, style.popup_bg);
+
+            for (std::size_t i = 0; i < labels.size(); ++i) {
+                Rect row_rect = popup_rect;
+                row_rect.y = popup_rect.y + style.item_height_px * static_cast<float>(i);
+                row_rect.h = style.item_height_px;
+
+                Color row_color = style.option_bg;
+                if (result.selected_index == i) row_color = style.option_bg_selected;
+                if (hovered_index == static_cast<int>(i)) row_color = style.option_bg_hover;
+                if (row_color.a > 0.0f) {
+                    ctx.add_quad_pixels(row_rect, row_color);
+                }
+
+                TextDrawParams row_text = text_params;
+                row_text.origin_px = Vec2{row_rect.x + style.padding_px, row_rect.y + style.padding_px};
+                row_text.margin_right_px = std::max(0.0f, row_rect.w - style.padding_px * 2.0f);
+                row_text.color = style.option_text;
+                row_text.scale = style.text_scale;
+                std::string label_str(labels[i]);
+                add_text_block(ctx, label_str.c_str(), ctx.params().screen_width, row_text);
+            }
         }
+    }
+    ctx.end_widget();
 
+    if (open && !labels.empty()) {
         if (!toggled && hovered_index >= 0 && input.mouse_pressed[0]) {
             if (result.selected_index != static_cast<std::size_t>(hovered_index)) {
                 result.selected_index = static_cast<std::size_t>(hovered_index);
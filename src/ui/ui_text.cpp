@@ -63,8 +63,44 @@ static std::vector<std::string> split_lines(const char* text) {
     return lines;
 }
 
+GlyphAtlas build_glyph_atlas() {
+    GlyphAtlas atlas;
+    atlas.pixels.assign(static_cast<std::size_t>(atlas.width * atlas.height), 0);
+    for (int g = 0; g < kGlyphAtlasGlyphs; ++g) {
+        const int cx = (g % kGlyphAtlasCols) * kGlyphAtlasCellW;
+        const int cy = (g / kGlyphAtlasCols) * kGlyphAtlasCellH;
+        for (int y = 0; y < kGlyphAtlasCellH; ++y) {
+            for (int x = 0; x < kGlyphAtlasCellW; ++x) {
+                bool lit = false;
+                if (g == kGlyphAtlasSolidIndex) {
+                    lit = true;
+                } else {
+                    int gx = x - kGlyphAtlasPad;
+                    int gy = y - kGlyphAtlasPad;
+                    if (gx >= 0 && gx < kFont6x8Width && gy >= 0 && gy < kFont6x8Height) {
+                        lit = (kFont6x8[g][gy] & (1u << gx)) != 0;
+                    }
+                }
+                atlas.pixels[static_cast<std::size_t>((cy + y) * atlas.width + cx + x)] = lit ? 255 : 0;
+            }
+        }
+    }
+    return atlas;
+}
+
 } // namespace
 
+const GlyphAtlas& glyph_atlas() {
+    static const GlyphAtlas atlas = build_glyph_atlas();
+    return atlas;
+}
+
+Vec2 glyph_atlas_origin(int glyph_index) {
+    glyph_index = std::clamp(glyph_index, 0, kGlyphAtlasGlyphs - 1);
+    return Vec2{static_cast<float>((glyph_index % kGlyphAtlasCols) * kGlyphAtlasCellW + kGlyphAtlasPad),
+                static_cast<float>((glyph_index / kGlyphAtlasCols) * kGlyphAtlasCellH + kGlyphAtlasPad)};
+}
+
 float add_text_block(UIContext& ctx, const char* text, int screen_width, const TextDrawParams& params) {
     if (!text) return 0.0f;
     std::vector<std::string> lines = split_lines(text);
@@ -103,21 +139,13 @@ float add_text_block(UIContext& ctx, const char* text, int screen_width, const T
             }
         }
 
+        const float py = origin_y + static_cast<float>(li) * line_height;
         for (int ci = 0; ci < static_cast<int>(line.size()); ++ci) {
             unsigned char ch = static_cast<unsigned char>(line[ci]);
-            if (ch < 32 || ch > 127) ch = 32;
-            const unsigned char* rows = kFont6x8[ch - 32];
-            for (int ry = 0; ry < kFont6x8Height; ++ry) {
-                unsigned char bits = rows[ry];
-                for (int rx = 0; rx < kFont6x8Width; ++rx) {
-                    if (bits & (1u << rx)) {
-                        float px = origin_x + (static_cast<float>(ci * kFont6x8Width + rx) * scale);
-                        float py = origin_y + static_cast<float>(li) * line_height + static_cast<float>(ry) * scale;
-                        Rect rect{px, py, scale, scale};
-                        ctx.add_shadowed_quad_pixels(rect, color);
-                    }
-                }
-            }
+            if (ch <= 32 || ch > 127) continue; // blank glyphs emit nothing
+            float px = origin_x + static_cast<float>(ci * kFont6x8Width) * scale;
+            Rect rect{px, py, kFont6x8Width * scale, kFont6x8Height * scale};
+            ctx.add_glyph_pixels(rect, static_cast<int>(ch) - 32, color);
         }
     }
 
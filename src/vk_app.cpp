@@ -7,8 +7,10 @@
 #include <cassert>
 #include <algorithm>
 #include <array>
+#include <cstdlib>
 #include <cstring>
 #include <functional>
+#include <limits>
 #include <iostream>
 #include <cstdio>
 #include <optional>
@@ -23,6 +25,7 @@
 #include <span>
 
 #include "chunk.h"
+#include "material_table.h"
 #include "mesh.h"
 #include "planet.h"
 #include "wf_noise.h"
@@ -63,7 +66,7 @@ VulkanApp::VulkanApp() {
                          region_root_,
                          save_chunks_enabled_,
                          log_stream_,
-                         /*remesh_per_frame_cap=*/4,
+                         /*remesh_per_frame_cap=*/8,
                          loader_threads_ > 0 ? static_cast<std::size_t>(loader_threads_) : 0);
 }
 
@@ -140,6 +143,7 @@ void VulkanApp::initialize() {
         throw std::runtime_error("RenderSystem not bound to VulkanApp before initialize");
     }
     init_window();
+    load_materials();
     load_config();
     init_vulkan();
     app_start_tp_ = std::chrono::steady_clock::now();
@@ -181,6 +185,7 @@ VulkanApp::~VulkanApp() {
     destroy_debug_axes_buffer();
     pipeline_compute_.reset();
     pipeline_layout_compute_.reset();
+    frag_query_pool_.reset();
     pipeline_triangle_.reset();
     pipeline_layout_.reset();
 
@@ -241,6 +246,7 @@ void VulkanApp::init_vulkan() {
     render_system_->initialize_renderer(renderer_info);
 
     create_compute_pipeline();
+    create_frag_stats_query();
 
 #ifdef WF_HAVE_VMA
     {
@@ -289,14 +295,15 @@ void VulkanApp::init_vulkan() {
             right.y * cr + up.y * cu + forward.y * cf,
             right.z * cr + up.z * cu + forward.z * cf
         });
-        Float3 chunk_center = dirc * (float)Rc;
-        float view_back = 12.0f;
-        Float3 eye = dirc * (float)(Rc + view_back) + up * 2.0f;
+        Double3 dirc_d = wf::normalize(to_double3(dirc));
+        Double3 chunk_center = dirc_d * Rc;
+        double view_back = 12.0;
+        Double3 eye = dirc_d * (Rc + view_back) + to_double3(up) * 2.0;
         cam_pos_[0] = eye.x; cam_pos_[1] = eye.y; cam_pos_[2] = eye.z;
-        Float3 look = wf::normalize(chunk_center - eye);
+        Float3 look = to_float3(wf::normalize(chunk_center - eye));
         cam_yaw_ = std::atan2(look.z, look.x);
         cam_pitch_ = std::asin(std::clamp(look.y, -1.0f, 1.0f));
-        bool chunk_outside = (Rc > (eye.x*dirc.x + eye.y*dirc.y + eye.z*dirc.z));
+        bool chunk_outside = (Rc > wf::dot(eye, dirc_d));
         if (chunk_outside) {
             cam_yaw_ += 3.14159265f;
             cam_pitch_ = -cam_pitch_;
@@ -325,6 +332,21 @@ void VulkanApp::record_command_buffer(const Renderer::FrameContext& ctx) {
         vkCmdDispatch(cmd, 1, 1, 1);
     }
 
+    // The slot's fence has been waited, so its query from the previous use is final.
+    const uint32_t frag_query = static_cast<uint32_t>(ctx.frame_index);
+    const bool frag_query_ok = frag_query_pool_ && frag_query < frag_query_issued_.size();
+    if (frag_query_ok) {
+        if (frag_query_issued_[frag_query]) {
+            uint64_t invocations = 0;
+            if (vkGetQueryPoolResults(renderer.device(), frag_query_pool_.get(), frag_query, 1, sizeof(invocations),
+                                      &invocations, sizeof(invocations), VK_QUERY_RESULT_64_BIT) == VK_SUCCESS) {
+                last_frag_invocations_ = invocations;
+            }
+            frag_query_issued_[frag_query] = 0;
+        }
+        vkCmdResetQueryPool(cmd, frag_query_pool_.get(), frag_query, 1);
+    }
+
     VkClearValue clear{ { {0.02f, 0.02f, 0.06f, 1.0f} } };
     VkRenderPassBeginInfo rbi{};
     rbi.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
@@ -336,7 +358,16 @@ void VulkanApp::record_command_buffer(const Renderer::FrameContext& ctx) {
     clears[0] = clear;
     clears[1].depthStencil = {1.0f, 0};
     rbi.clearValueCount = 2; rbi.pClearValues = clears;
-    vkCmdBeginRenderPass(cmd, &rbi, VK_SUBPASS_CONTENTS_INLINE);
+    auto record_start = std::chrono::steady_clock::now();
+    bool frag_query_active = false;
+    auto begin_render_pass = [&](VkSubpassContents contents) {
+        // Secondaries only count toward the query when they can inherit it.
+        if (frag_query_ok && (contents == VK_SUBPASS_CONTENTS_INLINE || frag_query_inherited_)) {
+            vkCmdBeginQuery(cmd, frag_query_pool_.get(), frag_query, 0);
+            frag_query_active = true;
+        }
+        vkCmdBeginRenderPass(cmd, &rbi, contents);
+    };
 
     float aspect = (swap_extent.height > 0)
         ? static_cast<float>(swap_extent.width) / static_cast<float>(swap_extent.height)
@@ -352,9 +383,13 @@ void VulkanApp::record_command_buffer(const Renderer::FrameContext& ctx) {
     Float3 up_vec{};
     Float3 right_vec{};
     wf::Mat4 V{};
+    // Same view with the eye at the origin: chunk geometry is drawn camera-relative.
+    wf::Mat4 V_rel{};
 
     if (!walk_mode_) {
+        const float origin[3] = {0.0f, 0.0f, 0.0f};
         V = wf::view_from_yaw_pitch(cam_yaw_, cam_pitch_, eye_arr);
+        V_rel = wf::view_from_yaw_pitch(cam_yaw_, cam_pitch_, origin);
         forward = Float3{cp * cyaw, sp, cp * syaw};
         Float3 world_up{0.0f, 1.0f, 0.0f};
         right_vec = Float3{
@@ -402,6 +437,7 @@ void VulkanApp::record_command_buffer(const Renderer::FrameContext& ctx) {
         wf::Vec3 center{eye_v.x + forward.x, eye_v.y + forward.y, eye_v.z + forward.z};
         wf::Vec3 up_v{up_vec.x, up_vec.y, up_vec.z};
         V = wf::look_at_rh(eye_v, center, up_v);
+        V_rel = wf::look_at_rh(wf::Vec3{0.0f, 0.0f, 0.0f}, wf::Vec3{forward.x, forward.y, forward.z}, up_v);
     }
 
     forward = wf::normalize(forward);
@@ -409,11 +445,17 @@ void VulkanApp::record_command_buffer(const Renderer::FrameContext& ctx) {
     up_vec = wf::normalize(up_vec);
 
     auto MVP = wf::mul(P, V);
+    auto MVP_rel = wf::mul(P, V_rel);
+    const double* eye_d = cam_pos_;
 
     bool debugTrianglePending = debug_show_test_triangle_ && pipeline_triangle_;
     ChunkRenderer& chunk_renderer = render_system_->chunk_renderer();
     auto chunks = render_system_->chunk_instances();
     bool chunk_ready = chunk_renderer.is_ready() && !chunks.empty();
+    // Draws after the chunks go to the primary, or to the main secondary when chunk buckets are recorded in parallel.
+    VkCommandBuffer secondary = VK_NULL_HANDLE;
+    VkCommandBuffer draw_cmd = cmd;
+    bool gpu_culled = false;
 
     if (chunk_ready) {
         if (debug_chunk_keys_) {
@@ -429,14 +471,16 @@ void VulkanApp::record_command_buffer(const Renderer::FrameContext& ctx) {
                 }
                 if (!chunks.empty()) {
                     const auto& rc0 = chunks[0];
-                    wf::Vec4 c0{rc0.center[0], rc0.center[1], rc0.center[2], 1.0f};
-                    wf::Vec4 view = wf::mul(V, c0);
+                    wf::Vec4 c0{static_cast<float>(rc0.center[0] - eye_d[0]),
+                                static_cast<float>(rc0.center[1] - eye_d[1]),
+                                static_cast<float>(rc0.center[2] - eye_d[2]), 1.0f};
+                    wf::Vec4 view = wf::mul(V_rel, c0);
                     auto clip = wf::mul(P, view);
                     std::cout << "eye:" << eye.x << "," << eye.y << "," << eye.z
                               << "  forward:" << forward.x << "," << forward.y << "," << forward.z << "\n";
                     std::cout << "chunk0 center:" << rc0.center[0] << "," << rc0.center[1] << "," << rc0.center[2]
                               << " radius:" << rc0.radius << "\n";
-                    std::cout << "delta:" << (rc0.center[0]-eye.x) << "," << (rc0.center[1]-eye.y) << "," << (rc0.center[2]-eye.z) << "\n";
+                    std::cout << "delta:" << c0.x << "," << c0.y << "," << c0.z << "\n";
                     std::cout << "view-space:" << view.x << "," << view.y << "," << view.z << "," << view.w << "\n";
                     std::cout << "clip test: "
                               << clip.x << ", "
@@ -448,112 +492,213 @@ void VulkanApp::record_command_buffer(const Renderer::FrameContext& ctx) {
             }
         }
 
-        // Prepare preallocated container and compute draw stats
-        chunk_items_tmp_.clear();
-        chunk_items_tmp_.reserve(chunks.size());
         last_draw_total_ = static_cast<int>(chunks.size());
         last_draw_visible_ = 0;
         last_draw_indices_ = 0;
-
-        if (cull_enabled_) {
-            const float deg_to_rad = 0.01745329252f;
-            Float3 fwd_n = forward;
-            Float3 up_n = up_vec;
-            Float3 right_n = right_vec;
-
-            float tan_y = std::tan(0.5f * fov_deg_ * deg_to_rad);
-            float tan_x = tan_y * aspect;
-
-            Float3 plane_right = Float3{fwd_n.x * tan_x - right_n.x,
-                                        fwd_n.y * tan_x - right_n.y,
-                                        fwd_n.z * tan_x - right_n.z};
-            Float3 plane_left  = Float3{fwd_n.x * tan_x + right_n.x,
-                                        fwd_n.y * tan_x + right_n.y,
-                                        fwd_n.z * tan_x + right_n.z};
-            Float3 plane_top   = Float3{fwd_n.x * tan_y - up_n.x,
-                                        fwd_n.y * tan_y - up_n.y,
-                                        fwd_n.z * tan_y - up_n.z};
-            Float3 plane_bottom= Float3{fwd_n.x * tan_y + up_n.x,
-                                        fwd_n.y * tan_y + up_n.y,
-                                        fwd_n.z * tan_y + up_n.z};
-
-            float plane_side_norm = wf::length(plane_right);
-            float plane_vert_norm = wf::length(plane_top);
-
-            for (const auto& rc : chunks) {
-                float dx = rc.center[0] - eye.x;
-                float dy = rc.center[1] - eye.y;
-                float dz = rc.center[2] - eye.z;
-                Float3 delta{dx, dy, dz};
-                float dist_f = dx*fwd_n.x + dy*fwd_n.y + dz*fwd_n.z;
-                // near/far
-                if (dist_f + rc.radius < near_m_) continue;
-                if (dist_f - rc.radius > far_m_) continue;
-
-                float dist_right = delta.x * plane_right.x + delta.y * plane_right.y + delta.z * plane_right.z;
-                if (dist_right < -rc.radius * plane_side_norm) continue;
-                float dist_left = delta.x * plane_left.x + delta.y * plane_left.y + delta.z * plane_left.z;
-                if (dist_left < -rc.radius * plane_side_norm) continue;
-                float dist_top = delta.x * plane_top.x + delta.y * plane_top.y + delta.z * plane_top.z;
-                if (dist_top < -rc.radius * plane_vert_norm) continue;
-                float dist_bottom = delta.x * plane_bottom.x + delta.y * plane_bottom.y + delta.z * plane_bottom.z;
-                if (dist_bottom < -rc.radius * plane_vert_norm) continue;
+        last_record_stats_ = ChunkRecordStats{};
+
+        const float deg_to_rad = 0.01745329252f;
+        Float3 fwd_n = forward;
+        Float3 up_n = up_vec;
+        Float3 right_n = right_vec;
+
+        float tan_y = std::tan(0.5f * fov_deg_ * deg_to_rad);
+        float tan_x = tan_y * aspect;
+
+        Float3 plane_right = Float3{fwd_n.x * tan_x - right_n.x,
+                                    fwd_n.y * tan_x - right_n.y,
+                                    fwd_n.z * tan_x - right_n.z};
+        Float3 plane_left  = Float3{fwd_n.x * tan_x + right_n.x,
+                                    fwd_n.y * tan_x + right_n.y,
+                                    fwd_n.z * tan_x + right_n.z};
+        Float3 plane_top   = Float3{fwd_n.x * tan_y - up_n.x,
+                                    fwd_n.y * tan_y - up_n.y,
+                                    fwd_n.z * tan_y - up_n.z};
+        Float3 plane_bottom= Float3{fwd_n.x * tan_y + up_n.x,
+                                    fwd_n.y * tan_y + up_n.y,
+                                    fwd_n.z * tan_y + up_n.z};
+
+        float plane_side_norm = wf::length(plane_right);
+        float plane_vert_norm = wf::length(plane_top);
+        const bool cull = cull_enabled_;
+        const float near_m = near_m_;
+        const float far_m = far_m_;
+
+        // Read-only over the chunk span; safe to call from record workers.
+        auto visible = [&](const RenderSystem::ChunkInstance& rc) {
+            if (!cull) return true;
+            // Difference in double: both terms can be planet-radius sized.
+            float dx = static_cast<float>(rc.center[0] - eye_d[0]);
+            float dy = static_cast<float>(rc.center[1] - eye_d[1]);
+            float dz = static_cast<float>(rc.center[2] - eye_d[2]);
+            Float3 delta{dx, dy, dz};
+            float dist_f = dx*fwd_n.x + dy*fwd_n.y + dz*fwd_n.z;
+            // near/far
+            if (dist_f + rc.radius < near_m) return false;
+            if (dist_f - rc.radius > far_m) return false;
+
+            float dist_right = delta.x * plane_right.x + delta.y * plane_right.y + delta.z * plane_right.z;
+            if (dist_right < -rc.radius * plane_side_norm) return false;
+            float dist_left = delta.x * plane_left.x + delta.y * plane_left.y + delta.z * plane_left.z;
+            if (dist_left < -rc.radius * plane_side_norm) return false;
+            float dist_top = delta.x * plane_top.x + delta.y * plane_top.y + delta.z * plane_top.z;
+            if (dist_top < -rc.radius * plane_vert_norm) return false;
+            float dist_bottom = delta.x * plane_bottom.x + delta.y * plane_bottom.y + delta.z * plane_bottom.z;
+            if (dist_bottom < -rc.radius * plane_vert_norm) return false;
+            return true;
+        };
+        // One draw per mesh segment of the requested pass; segments share the chunk's bounds.
+        auto append_items = [&](const RenderSystem::ChunkInstance& rc, std::vector<ChunkDrawItem>& out, bool translucent) {
+            const float rel[3] = {static_cast<float>(rc.center[0] - eye_d[0]),
+                                  static_cast<float>(rc.center[1] - eye_d[1]),
+                                  static_cast<float>(rc.center[2] - eye_d[2])};
+            for (std::size_t s = 0; s < rc.segments.size() && s < rc.draw_records.size(); ++s) {
+                const MeshSegment& seg = rc.segments[s];
+                if (seg.translucent != translucent) continue;
                 ChunkDrawItem item{};
                 item.vbuf = rc.vbuf.get();
                 item.ibuf = rc.ibuf.get();
-                item.index_count = rc.index_count;
-                item.first_index = rc.first_index;
-                item.base_vertex = rc.base_vertex;
-                item.vertex_count = rc.vertex_count;
-                item.center[0] = rc.center[0];
-                item.center[1] = rc.center[1];
-                item.center[2] = rc.center[2];
+                item.index_count = seg.index_count;
+                item.first_index = rc.first_index + seg.first_index;
+                item.base_vertex = rc.base_vertex + static_cast<int32_t>(seg.base_vertex);
+                item.vertex_count = seg.vertex_count;
+                item.draw_record = rc.draw_records[s];
+                item.center[0] = rel[0]; item.center[1] = rel[1]; item.center[2] = rel[2];
                 item.radius = rc.radius;
-                chunk_items_tmp_.push_back(item);
-                last_draw_visible_++;
-                last_draw_indices_ += rc.index_count;
+                out.push_back(item);
+            }
+        };
+
+        // Front-to-back order: the first quarter of the depth range is sorted fully and drawn first.
+        const float near_split = near_m + 0.25f * (far_m - near_m);
+        DrawSortView sort_view{};
+        sort_view.enabled = draw_sort_enabled_;
+        // Item centers are already camera-relative, so the sort eye stays at the origin.
+        sort_view.forward[0] = fwd_n.x; sort_view.forward[1] = fwd_n.y; sort_view.forward[2] = fwd_n.z;
+        sort_view.near_m = near_m;
+        sort_view.far_m = far_m;
+        sort_view.near_split_m = near_split;
+        chunk_renderer.set_sort_view(sort_view);
+        chunk_renderer.update_draw_offsets(ctx.frame_index, eye_d);
+
+        if (chunk_renderer.gpu_cull_active()) {
+            // Visibility runs on the GPU against persistent draw records: no per-chunk CPU work.
+            GpuCullParams gp{};
+            auto set_plane = [&](int idx, const Float3& n, float d) {
+                float len = wf::length(n);
+                float inv = (len > 0.0f) ? 1.0f / len : 0.0f;
+                gp.planes[idx][0] = n.x * inv; gp.planes[idx][1] = n.y * inv; gp.planes[idx][2] = n.z * inv;
+                gp.planes[idx][3] = d * inv;
+            };
+            set_plane(0, plane_right, 0.0f);
+            set_plane(1, plane_left, 0.0f);
+            set_plane(2, plane_top, 0.0f);
+            set_plane(3, plane_bottom, 0.0f);
+            set_plane(4, fwd_n, -near_m);
+            set_plane(5, Float3{-fwd_n.x, -fwd_n.y, -fwd_n.z}, far_m);
+            gp.eye[0] = eye.x; gp.eye[1] = eye.y; gp.eye[2] = eye.z;
+            gp.occluder_radius = static_cast<float>(std::max(0.0, planet_cfg_.radius_m - planet_cfg_.terrain_amp_m));
+            gp.near_split = draw_sort_enabled_ ? near_split : std::numeric_limits<float>::max();
+            gp.frustum = cull;
+            chunk_renderer.record_gpu_cull(cmd, ctx.frame_index, gp);
+            gpu_culled = true;
+            begin_render_pass(VK_SUBPASS_CONTENTS_INLINE);
+            chunk_renderer.record_gpu_draws(cmd, ctx.frame_index, MVP_rel.data());
+            last_draw_visible_ = chunk_renderer.gpu_visible();
+            last_draw_indices_ = chunk_renderer.gpu_visible_indices();
+        } else if (chunk_renderer.parallel_record_enabled()) {
+            // Only bucketing stays on this thread; culling and recording run per bucket on the workers.
+            for (auto& bucket : record_bucket_chunks_) bucket.clear();
+            for (std::size_t i = 0; i < chunks.size(); ++i) {
+                const FaceChunkKey& key = chunks[i].key;
+                record_bucket_chunks_[ChunkRenderer::record_bucket(key.face, key.i, key.j)].push_back(static_cast<uint32_t>(i));
             }
+            ChunkRenderer::BucketCullFn cull_bucket = [&](uint32_t bucket, std::vector<ChunkDrawItem>& out) {
+                for (uint32_t idx : record_bucket_chunks_[bucket]) {
+                    const auto& rc = chunks[idx];
+                    if (visible(rc)) append_items(rc, out, false);
+                }
+            };
+            record_secondaries_.clear();
+            ChunkRecordStats record_stats{};
+            chunk_renderer.record_buckets(ctx.frame_index, rbi.renderPass, rbi.framebuffer, MVP_rel.data(),
+                                          cull_bucket, record_secondaries_, record_stats);
+            last_draw_visible_ = record_stats.visible;
+            last_draw_indices_ = record_stats.indices;
+            last_record_stats_ = record_stats;
+            secondary = chunk_renderer.begin_main_secondary(ctx.frame_index, rbi.renderPass, rbi.framebuffer);
+        }
+
+        if (gpu_culled) {
+            // Render pass already begun around the indirect-count draw.
+        } else if (secondary != VK_NULL_HANDLE) {
+            begin_render_pass(VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+            draw_cmd = secondary;
         } else {
+            begin_render_pass(VK_SUBPASS_CONTENTS_INLINE);
+            // Prepare preallocated container and compute draw stats
+            chunk_items_tmp_.clear();
+            chunk_items_tmp_.reserve(chunks.size());
+            last_draw_visible_ = 0;
+            last_draw_indices_ = 0;
             for (const auto& rc : chunks) {
-                ChunkDrawItem item{};
-                item.vbuf = rc.vbuf.get();
-                item.ibuf = rc.ibuf.get();
-                item.index_count = rc.index_count;
-                item.first_index = rc.first_index;
-                item.base_vertex = rc.base_vertex;
-                item.vertex_count = rc.vertex_count;
-                item.center[0] = rc.center[0]; item.center[1] = rc.center[1]; item.center[2] = rc.center[2];
-                item.radius = rc.radius;
-                chunk_items_tmp_.push_back(item);
+                if (!visible(rc)) continue;
+                append_items(rc, chunk_items_tmp_, false);
                 last_draw_visible_++;
                 last_draw_indices_ += rc.index_count;
             }
+            chunk_renderer.record(cmd, MVP_rel.data(), chunk_items_tmp_);
+        }
+
+        // Translucent segments (water) blend over the finished opaque pass, so they go last,
+        // on the CPU-culled path whichever way the opaque chunks were culled.
+        translucent_items_tmp_.clear();
+        for (const auto& rc : chunks) {
+            // Translucent segments trail the opaque ones.
+            if (rc.segments.empty() || !rc.segments.back().translucent || !visible(rc)) continue;
+            append_items(rc, translucent_items_tmp_, true);
+        }
+        chunk_renderer.record_translucent(draw_cmd, MVP_rel.data(), translucent_items_tmp_);
+    } else {
+        begin_render_pass(VK_SUBPASS_CONTENTS_INLINE);
+        if (pipeline_triangle_) {
+            vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline_triangle_.get());
+            vkCmdDraw(cmd, 3, 1, 0, 0);
+            debugTrianglePending = false;
         }
-        chunk_renderer.record(cmd, MVP.data(), chunk_items_tmp_);
-    } else if (pipeline_triangle_) {
-        vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline_triangle_.get());
-        vkCmdDraw(cmd, 3, 1, 0, 0);
-        debugTrianglePending = false;
     }
 
     if (debug_show_axes_ && debug_axes_pipeline_ && debug_axes_vertex_count_ > 0) {
-        vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, debug_axes_pipeline_.get());
-        vkCmdPushConstants(cmd, debug_axes_layout_.get(), VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(float) * 16, MVP.data());
+        vkCmdBindPipeline(draw_cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, debug_axes_pipeline_.get());
+        vkCmdPushConstants(draw_cmd, debug_axes_layout_.get(), VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(float) * 16, MVP.data());
         VkDeviceSize offs = 0;
         VkBuffer axes_buf = debug_axes_vbo_.get();
-        vkCmdBindVertexBuffers(cmd, 0, 1, &axes_buf, &offs);
-        vkCmdDraw(cmd, debug_axes_vertex_count_, 1, 0, 0);
+        vkCmdBindVertexBuffers(draw_cmd, 0, 1, &axes_buf, &offs);
+        vkCmdDraw(draw_cmd, debug_axes_vertex_count_, 1, 0, 0);
     }
 
     if (debugTrianglePending) {
-        vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline_triangle_.get());
-        vkCmdDraw(cmd, 3, 1, 0, 0);
+        vkCmdBindPipeline(draw_cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline_triangle_.get());
+        vkCmdDraw(draw_cmd, 3, 1, 0, 0);
     }
 
-    render_system_->overlay().record_draw(cmd, overlay_draw_slot_);
+    render_system_->overlay().record_draw(draw_cmd, overlay_draw_slot_);
+    if (secondary != VK_NULL_HANDLE) {
+        throw_if_failed(vkEndCommandBuffer(secondary), "vkEndCommandBuffer (secondary) failed");
+        record_secondaries_.push_back(secondary);
+        vkCmdExecuteCommands(cmd, static_cast<uint32_t>(record_secondaries_.size()), record_secondaries_.data());
+    }
     vkCmdEndRenderPass(cmd);
+    if (frag_query_active) {
+        vkCmdEndQuery(cmd, frag_query_pool_.get(), frag_query);
+        frag_query_issued_[frag_query] = 1;
+    }
+    if (gpu_culled) {
+        chunk_renderer.finish_gpu_cull(cmd, ctx.frame_index);
+    }
 
     throw_if_failed(vkEndCommandBuffer(cmd), "vkEndCommandBuffer failed");
+    last_record_ms_ = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - record_start).count();
 }
 
 void VulkanApp::update_input(const ControllerFrameInput& frame) {
@@ -702,7 +847,7 @@ void VulkanApp::update_hud(float dt) {
         glfwSetWindowTitle(window, title);
     }
 
-    char hud[768];
+    char hud[2048];
     if (draw_stats_enabled_) {
         ChunkRenderer& chunk_renderer = render_system_->chunk_renderer();
         float tris_m = (float)last_draw_indices_ / 3.0f / 1.0e6f;
@@ -712,6 +857,7 @@ void VulkanApp::update_hud(float dt) {
         float v_cap_mb  = (float)(v_cap ? v_cap : (VkDeviceSize)1) / (1024.0f*1024.0f);
         float i_used_mb = (float)i_used / (1024.0f*1024.0f);
         float i_cap_mb  = (float)(i_cap ? i_cap : (VkDeviceSize)1) / (1024.0f*1024.0f);
+        // 16-bit indices: the same meshes would need twice i_used with 32-bit indices.
         size_t qdepth = streaming_.result_queue_depth();
         double gen_ms = streaming_.last_generation_ms();
         int gen_chunks = streaming_.last_generated_chunks();
@@ -730,17 +876,17 @@ void VulkanApp::update_hud(float dt) {
         double target_r = ground_r + (double)eye_height_m_ + (double)walk_surface_bias_m_;
         double dr = cam_rd_hud - target_r;
         std::snprintf(hud, sizeof(hud),
-                      "FPS: %.1f\nPos:(%.1f,%.1f,%.1f)  Yaw/Pitch:(%.1f,%.1f)  InvX:%d InvY:%d  Speed:%.1f\nDraw:%d/%d  Tris:%.2fM  Cull:%s  Ring:%d  Face:%d ci:%lld cj:%lld ck:%lld  k:%d/%d  Hold:%.2fs\nQueue:%zu  Gen:%.0fms (%d ch, %.2f ms/ch)  Mesh:%.0fms (%d ch, %.2f ms/ch)  Upload:%d in %.1fms (avg %.1fms)\nRad: cam=%.1f  tgt=%.1f  d=%.2f  (eye=%.2f bias=%.2f)\nPoolV: %.1f/%.1f MB  PoolI: %.1f/%.1f MB  Loader:%s",
+                      "FPS: %.1f\nPos:(%.1f,%.1f,%.1f)  Yaw/Pitch:(%.1f,%.1f)  InvX:%d InvY:%d  Speed:%.1f\nDraw:%d/%d  Tris:%.2fM  Rec:%.2fms/%zut  Cull:%s  Ring:%d  Face:%d ci:%lld cj:%lld ck:%lld  k:%d/%d  Hold:%.2fs\nQueue:%zu  Gen:%.0fms (%d ch, %.2f ms/ch)  Mesh:%.0fms (%d ch, %.2f ms/ch)  Upload:%d in %.1fms (avg %.1fms)\nRad: cam=%.1f  tgt=%.1f  d=%.2f  (eye=%.2f bias=%.2f)\nPoolV: %.1f/%.1f MB  PoolI: %.1f/%.1f MB (u16, saves %.1f MB)  Loader:%s",
                        fps_smooth_,
                        cam_pos_[0], cam_pos_[1], cam_pos_[2], yaw_deg, pitch_deg,
                        invert_mouse_x_?1:0, invert_mouse_y_?1:0, cam_speed_,
-                      last_draw_visible_, last_draw_total_, tris_m, cull_enabled_?"on":"off", ring_radius_,
+                      last_draw_visible_, last_draw_total_, tris_m, last_record_ms_, chunk_renderer.record_threads(), cull_enabled_?(chunk_renderer.gpu_cull_active()?"gpu":"cpu"):"off", ring_radius_,
                       streaming_.stream_face(), (long long)streaming_.ring_center_i(), (long long)streaming_.ring_center_j(), (long long)streaming_.ring_center_k(), k_down_, k_up_, (double)streaming_.face_keep_timer_s(),
                       qdepth, gen_ms, gen_chunks, ms_per,
                       mesh_ms, meshed, mesh_ms_per,
                       up_count, up_ms, upload_ms_avg_,
                       (float)cam_rd_hud, (float)target_r, (float)dr, eye_height_m_, walk_surface_bias_m_,
-                      v_used_mb, v_cap_mb, i_used_mb, i_cap_mb, streaming_.loader_busy()?"busy":"idle");
+                      v_used_mb, v_cap_mb, i_used_mb, i_cap_mb, i_used_mb, streaming_.loader_busy()?"busy":"idle");
     } else {
         std::snprintf(hud, sizeof(hud),
                       "FPS: %.1f\nPos:(%.1f,%.1f,%.1f)  Yaw/Pitch:(%.1f,%.1f)  InvX:%d InvY:%d  Speed:%.1f",
@@ -754,6 +900,125 @@ std::snprintf(hud + hud_len, sizeof(hud) - hud_len,
               debug_show_axes_ ? "on" : "off",
               debug_show_test_triangle_ ? "on" : "off");
 
+if (draw_stats_enabled_) {
+    const ui::UIRetainedStats& ui_stats = ui_controller_.retained_stats();
+    const OverlayRenderer& overlay = render_system_->overlay();
+    hud_len = std::strlen(hud);
+    std::snprintf(hud + hud_len, sizeof(hud) - hud_len,
+                  "\nUI: build %.3fms  upload %.3fms (%zu B)  widgets %u/%u%s",
+                  ui_controller_.last_build_ms(), overlay.last_upload_ms(), overlay.last_upload_bytes(),
+                  ui_stats.widgets_rebuilt, ui_stats.widgets,
+                  ui_stats.layout_changed ? "  repack" : "");
+    if (frag_query_pool_) {
+        // Shaded fragments per pixel: 1.0x means no overdraw past the depth test.
+        double pixels = std::max(1.0, (double)framebuffer_width_ * (double)framebuffer_height_);
+        hud_len = std::strlen(hud);
+        std::snprintf(hud + hud_len, sizeof(hud) - hud_len,
+                      "\nFrag: %.2fM  overdraw %.2fx  sort:%s",
+                      (double)last_frag_invocations_ / 1.0e6, (double)last_frag_invocations_ / pixels,
+                      draw_sort_enabled_ ? "on" : "off");
+    }
+    const ChunkRenderer& chunk_renderer = render_system_->chunk_renderer();
+    if (chunk_renderer.gpu_cull_check() && chunk_renderer.gpu_cull_parity().checked > 0) {
+        // GPU cull counters read back against the CPU replay of the same dispatch.
+        const ChunkRenderer::GpuCullParity& parity = chunk_renderer.gpu_cull_parity();
+        hud_len = std::strlen(hud);
+        std::snprintf(hud + hud_len, sizeof(hud) - hud_len,
+                      "\nCull check: gpu %d cpu %d  mismatched %llu/%llu  max diff %d",
+                      parity.last_gpu, parity.last_cpu, (unsigned long long)parity.mismatched,
+                      (unsigned long long)parity.checked, parity.max_draw_diff);
+    }
+    if (last_record_stats_.secondaries > 0) {
+        // Bucket recording on the record workers: lane CPU time against the caller's wait.
+        const ChunkRecordStats& rs = last_record_stats_;
+        hud_len = std::strlen(hud);
+        std::snprintf(hud + hud_len, sizeof(hud) - hud_len,
+                      "\nRecord: %u lanes  wall %.3fms  lanes %.3fms (max %.3fms)  %.2fx",
+                      rs.secondaries, rs.wall_ms, rs.lane_sum_ms, rs.lane_max_ms,
+                      rs.wall_ms > 0.0 ? rs.lane_sum_ms / rs.wall_ms : 0.0);
+    }
+    ChunkResidencyStats res = streaming_.residency().stats();
+    auto res_count = [&](ChunkResidencyState st) { return res.counts[static_cast<size_t>(st)]; };
+    hud_len = std::strlen(hud);
+    std::snprintf(hud + hud_len, sizeof(hud) - hud_len,
+                  "\nResidency: req %zu gen %zu/%zu mesh %zu/%zu up %zu res %zu evict %zu  rejected %llu",
+                  res_count(ChunkResidencyState::kRequested), res_count(ChunkResidencyState::kGenerating),
+                  res_count(ChunkResidencyState::kGenerated), res_count(ChunkResidencyState::kMeshing),
+                  res_count(ChunkResidencyState::kMeshReady), res_count(ChunkResidencyState::kUploading),
+                  res_count(ChunkResidencyState::kResident), res_count(ChunkResidencyState::kEvicting),
+                  (unsigned long long)res.rejected);
+
+    MeshCache::Stats mc = streaming_.mesh_cache_stats();
+    const uint64_t mc_lookups = mc.hits + mc.misses;
+    hud_len = std::strlen(hud);
+    std::snprintf(hud + hud_len, sizeof(hud) - hud_len,
+                  "\nMeshCache: hit %.1f%% (%llu/%llu)  saved %.0fms  %zu meshes %.1f MB",
+                  mc_lookups ? 100.0 * (double)mc.hits / (double)mc_lookups : 0.0,
+                  (unsigned long long)mc.hits, (unsigned long long)mc_lookups, mc.saved_ms,
+                  mc.entries, (double)mc.bytes / (1024.0 * 1024.0));
+
+    // Each hit is a chunk that skipped 64x64 terrain height evaluations.
+    HeightTileCache::Stats ht = streaming_.height_tile_stats();
+    const uint64_t ht_lookups = ht.hits + ht.misses;
+    hud_len = std::strlen(hud);
+    std::snprintf(hud + hud_len, sizeof(hud) - hud_len,
+                  "\nHeightTiles: hit %.1f%% (%llu/%llu)  %zu columns",
+                  ht_lookups ? 100.0 * (double)ht.hits / (double)ht_lookups : 0.0,
+                  (unsigned long long)ht.hits, (unsigned long long)ht_lookups, ht.entries);
+    // Air chunks decided from the height pyramid never fetch a height tile.
+    TerrainHeightPyramid::Stats tb = streaming_.terrain_bounds_stats();
+    hud_len = std::strlen(hud);
+    std::snprintf(hud + hud_len, sizeof(hud) - hud_len,
+                  "  bounds %zu tiles (%llu loaded)  %llu air chunks  %llu band-skipped",
+                  tb.tiles, (unsigned long long)tb.tiles_loaded, (unsigned long long)streaming_.bounds_air_chunks(),
+                  (unsigned long long)streaming_.band_skipped_chunks());
+
+    // Per scheduling class: queue depth and smoothed submit-to-start wait.
+    const std::pair<const char*, StreamingService::ClassStats> qos[] = {
+        {"edit", streaming_.class_stats(StreamingClass::kEdit)},
+        {"near", streaming_.class_stats(StreamingClass::kNear)},
+        {"far", streaming_.class_stats(StreamingClass::kFar)},
+        {"io", streaming_.class_stats(StreamingClass::kIo)},
+    };
+    hud_len = std::strlen(hud);
+    std::snprintf(hud + hud_len, sizeof(hud) - hud_len, "\nQoS:");
+    for (const auto& [name, st] : qos) {
+        hud_len = std::strlen(hud);
+        std::snprintf(hud + hud_len, sizeof(hud) - hud_len, "  %s q%zu %.1f/%.1fms", name, st.pending, st.wait_ms_avg, st.wait_ms_peak);
+    }
+    // Edit to visible: the target is under one frame at full ring radius.
+    StreamStatus stream_status{};
+    if (world_runtime_initialized_) stream_status = world_runtime_->snapshot_stream_status();
+    if (stream_status.edit_latency_samples > 0) {
+        hud_len = std::strlen(hud);
+        std::snprintf(hud + hud_len, sizeof(hud) - hud_len, "\nEdit: visible in %.1fms (%d frames)  avg %.1fms  peak %.1fms",
+                      stream_status.edit_latency_ms, stream_status.edit_latency_frames,
+                      stream_status.edit_latency_avg_ms, stream_status.edit_latency_peak_ms);
+    }
+    if (profile_csv_enabled_) {
+        double tsec = std::chrono::duration<double>(std::chrono::steady_clock::now() - app_start_tp_).count();
+        for (const auto& [name, st] : qos) {
+            char line[160];
+            std::snprintf(line, sizeof(line), "qos_%s,%.3f,%zu,%zu,%.3f,%.3f,%llu\n",
+                          name, tsec, st.pending, st.active, st.wait_ms_avg, st.wait_ms_peak,
+                          (unsigned long long)st.completed);
+            profile_append_csv(line);
+        }
+        char line[160];
+        std::snprintf(line, sizeof(line), "mesh_cache,%.3f,%llu,%llu,%.3f,%zu,%zu\n",
+                      tsec, (unsigned long long)mc.hits, (unsigned long long)mc.misses, mc.saved_ms,
+                      mc.entries, mc.bytes);
+        profile_append_csv(line);
+        if (stream_status.edit_latency_samples > 0) {
+            std::snprintf(line, sizeof(line), "edit_latency,%.3f,%llu,%d,%.3f,%.3f,%.3f\n",
+                          tsec, (unsigned long long)stream_status.edit_latency_samples,
+                          stream_status.edit_latency_frames, stream_status.edit_latency_ms,
+                          stream_status.edit_latency_avg_ms, stream_status.edit_latency_peak_ms);
+            profile_append_csv(line);
+        }
+    }
+}
+
 std::string manager_path = config_path_used_;
 if (world_runtime_initialized_) {
     manager_path = world_runtime_->active_config().config_path;
@@ -799,6 +1064,19 @@ void VulkanApp::load_config() {
     }
 }
 
+void VulkanApp::load_materials() {
+    const char* env = std::getenv("WF_MATERIALS");
+    const std::string path = env ? env : "materials.cfg";
+    MaterialTable table;
+    std::string error;
+    if (!table.load_file(path, &error)) {
+        std::cout << "[materials] " << error << " (using built-in materials)\n";
+        return;
+    }
+    std::cout << "[materials] " << table.size() << " ids from " << path << "\n";
+    set_material_table(std::move(table));
+}
+
 void VulkanApp::reload_config_from_disk() {
     if (!world_runtime_) {
         return;
@@ -844,6 +1122,9 @@ AppConfig VulkanApp::snapshot_config() const {
     cfg.ring_radius = ring_radius_;
     cfg.prune_margin = prune_margin_;
     cfg.cull_enabled = cull_enabled_;
+    cfg.gpu_cull = gpu_cull_enabled_;
+    cfg.gpu_cull_check = gpu_cull_check_;
+    cfg.draw_sort = draw_sort_enabled_;
     cfg.draw_stats_enabled = draw_stats_enabled_;
 
     cfg.hud_scale = hud_scale_;
@@ -853,6 +1134,8 @@ AppConfig VulkanApp::snapshot_config() const {
     cfg.log_stream = log_stream_;
     cfg.log_pool = log_pool_;
     cfg.save_chunks_enabled = save_chunks_enabled_;
+    cfg.rebase_stale_deltas = rebase_stale_deltas_;
+    cfg.autosave_sec = autosave_sec_;
     cfg.debug_chunk_keys = debug_chunk_keys_;
 
     cfg.profile_csv_enabled = profile_csv_enabled_;
@@ -864,6 +1147,11 @@ AppConfig VulkanApp::snapshot_config() const {
 
     cfg.uploads_per_frame_limit = uploads_per_frame_limit_;
     cfg.loader_threads = loader_threads_;
+    cfg.edit_threads = edit_threads_;
+    cfg.far_threads = far_threads_;
+    cfg.io_threads = io_threads_;
+    cfg.io_nice = io_nice_;
+    cfg.record_threads = record_threads_;
     cfg.k_down = k_down_;
     cfg.k_up = k_up_;
     cfg.k_prune_margin = k_prune_margin_;
@@ -877,6 +1165,7 @@ AppConfig VulkanApp::snapshot_config() const {
 }
 
 void VulkanApp::apply_config_local(const AppConfig& cfg) {
+    const AppConfigDiff diff = diff_configs(snapshot_config(), cfg);
     invert_mouse_x_ = cfg.invert_mouse_x;
     invert_mouse_y_ = cfg.invert_mouse_y;
     cam_sensitivity_ = cfg.cam_sensitivity;
@@ -910,6 +1199,8 @@ void VulkanApp::apply_config_local(const AppConfig& cfg) {
     log_stream_ = cfg.log_stream;
     log_pool_ = cfg.log_pool;
     save_chunks_enabled_ = cfg.save_chunks_enabled;
+    rebase_stale_deltas_ = cfg.rebase_stale_deltas;
+    autosave_sec_ = cfg.autosave_sec;
     debug_chunk_keys_ = cfg.debug_chunk_keys;
 
     profile_csv_enabled_ = cfg.profile_csv_enabled;
@@ -918,9 +1209,26 @@ void VulkanApp::apply_config_local(const AppConfig& cfg) {
     device_local_enabled_ = cfg.device_local_enabled;
     pool_vtx_mb_ = cfg.pool_vtx_mb;
     pool_idx_mb_ = cfg.pool_idx_mb;
+    if (diff.pools && render_system_ && render_system_->device() != VK_NULL_HANDLE) {
+        render_system_->resize_chunk_pools(device_local_enabled_,
+                                           static_cast<VkDeviceSize>(pool_vtx_mb_) * 1024ull * 1024ull,
+                                           static_cast<VkDeviceSize>(pool_idx_mb_) * 1024ull * 1024ull);
+    }
 
     uploads_per_frame_limit_ = cfg.uploads_per_frame_limit;
     loader_threads_ = cfg.loader_threads;
+    edit_threads_ = cfg.edit_threads;
+    far_threads_ = cfg.far_threads;
+    io_threads_ = cfg.io_threads;
+    io_nice_ = cfg.io_nice;
+    if (record_threads_ != cfg.record_threads || gpu_cull_enabled_ != cfg.gpu_cull) {
+        record_threads_ = cfg.record_threads;
+        gpu_cull_enabled_ = cfg.gpu_cull;
+        apply_chunk_record_settings();
+    }
+    gpu_cull_check_ = cfg.gpu_cull_check;
+    if (render_system_) render_system_->chunk_renderer().set_gpu_cull_check(gpu_cull_check_);
+    draw_sort_enabled_ = cfg.draw_sort;
     k_down_ = cfg.k_down;
     k_up_ = cfg.k_up;
     k_prune_margin_ = cfg.k_prune_margin;
@@ -944,8 +1252,12 @@ void VulkanApp::apply_config(const AppConfig& cfg) {
                              region_root_,
                              save_chunks_enabled_,
                              log_stream_,
-                             /*remesh_per_frame_cap=*/4,
+                             /*remesh_per_frame_cap=*/8,
                              loader_threads_ > 0 ? static_cast<std::size_t>(loader_threads_) : 0);
+        streaming_.set_rebase_stale_deltas(rebase_stale_deltas_);
+        streaming_.set_autosave_interval(autosave_sec_);
+        streaming_.set_class_threads(static_cast<std::size_t>(edit_threads_), static_cast<std::size_t>(far_threads_));
+        streaming_.set_io_threads(static_cast<std::size_t>(io_threads_), io_nice_);
 
         std::cout << "[config] region_root=" << region_root_ << " (active)\n";
         std::cout << "[config] debug_chunk_keys=" << (debug_chunk_keys_ ? "true" : "false") << " (active)\n";
@@ -1022,36 +1334,12 @@ void VulkanApp::apply_resolution_option(std::size_t index) {
 
 
 bool VulkanApp::world_to_chunk_coords(const double pos[3], FaceChunkKey& key, int& lx, int& ly, int& lz, Int3& voxel_out) const {
-    const PlanetConfig& cfg = planet_cfg_;
-    const double voxel_m = cfg.voxel_size_m;
-    const double chunk_m = (double)Chunk64::N * voxel_m;
-    double px = pos[0];
-    double py = pos[1];
-    double pz = pos[2];
-    double radius = std::sqrt(px * px + py * py + pz * pz);
-    if (radius <= 0.0) return false;
-    Float3 dir = wf::normalize(Float3{static_cast<float>(px), static_cast<float>(py), static_cast<float>(pz)});
-    int face = 0; float u = 0.0f, v = 0.0f;
-    if (!face_uv_from_direction(dir, face, u, v)) return false;
-    Float3 right, up, forward; face_basis(face, right, up, forward);
-    double s = px * right.x + py * right.y + pz * right.z;
-    double t = px * up.x    + py * up.y    + pz * up.z;
-    std::int64_t i = (std::int64_t)std::floor(s / chunk_m);
-    std::int64_t j = (std::int64_t)std::floor(t / chunk_m);
-    std::int64_t k = (std::int64_t)std::floor(radius / chunk_m);
-    key = FaceChunkKey{ face, i, j, k };
-
-    double s_local = s - (double)i * chunk_m;
-    double t_local = t - (double)j * chunk_m;
-    double r_local = radius - (double)k * chunk_m;
-    int xi = (int)std::floor(s_local / voxel_m);
-    int yi = (int)std::floor(t_local / voxel_m);
-    int zi = (int)std::floor(r_local / voxel_m);
-    if (xi < 0 || xi >= Chunk64::N || yi < 0 || yi >= Chunk64::N || zi < 0 || zi >= Chunk64::N) return false;
-    lx = xi; ly = yi; lz = zi;
-    voxel_out = Int3{ (i64)std::llround(px / voxel_m),
-                      (i64)std::llround(py / voxel_m),
-                      (i64)std::llround(pz / voxel_m) };
+    const double voxel_m = planet_cfg_.voxel_size_m;
+    // Near a cube edge the voxel around pos may belong to the neighbor face's chunk.
+    if (!owned_voxel_at(planet_cfg_, Double3{pos[0], pos[1], pos[2]}, key, lx, ly, lz)) return false;
+    voxel_out = Int3{ (i64)std::llround(pos[0] / voxel_m),
+                      (i64)std::llround(pos[1] / voxel_m),
+                      (i64)std::llround(pos[2] / voxel_m) };
     return true;
 }
 
@@ -1151,20 +1439,29 @@ void VulkanApp::apply_runtime_result(const WorldUpdateResult& result) {
 }
 
 bool VulkanApp::process_runtime_mesh_upload(const MeshUpload& upload) {
+    ChunkResidencyTable& residency = streaming_.residency();
+    // Evicted or superseded while waiting in the upload queue.
+    if (!residency.accepts_upload(upload.key, upload.residency_ticket)) {
+        return false;
+    }
     RenderSystem::ChunkMeshData mesh_data{};
     mesh_data.key = upload.key;
     mesh_data.vertices = upload.mesh.vertices.data();
     mesh_data.vertex_count = upload.mesh.vertices.size();
     mesh_data.indices = upload.mesh.indices.data();
     mesh_data.index_count = upload.mesh.indices.size();
+    mesh_data.segments = upload.mesh.segments.data();
+    mesh_data.segment_count = upload.mesh.segments.size();
     mesh_data.center[0] = upload.center[0];
     mesh_data.center[1] = upload.center[1];
     mesh_data.center[2] = upload.center[2];
     mesh_data.radius = upload.radius;
 
     if (!render_system_->upload_chunk_mesh(mesh_data, log_stream_)) {
+        residency.finish_upload(upload.key, upload.residency_ticket, false);
         return false;
     }
+    residency.finish_upload(upload.key, upload.residency_ticket, true);
 
     if (debug_chunk_keys_) {
         if (!upload.mesh.vertices.empty()) {
@@ -1182,9 +1479,9 @@ bool VulkanApp::process_runtime_mesh_upload(const MeshUpload& upload) {
     }
 
     if (debug_chunk_keys_ && !debug_auto_aim_done_) {
-        Float3 eye{static_cast<float>(cam_pos_[0]), static_cast<float>(cam_pos_[1]), static_cast<float>(cam_pos_[2])};
-        Float3 center{mesh_data.center[0], mesh_data.center[1], mesh_data.center[2]};
-        Float3 dir = wf::normalize(center - eye);
+        Double3 eye{cam_pos_[0], cam_pos_[1], cam_pos_[2]};
+        Double3 center{mesh_data.center[0], mesh_data.center[1], mesh_data.center[2]};
+        Float3 dir = to_float3(wf::normalize(center - eye));
         cam_yaw_ = std::atan2(dir.z, dir.x);
         cam_pitch_ = std::asin(std::clamp(dir.y, -1.0f, 1.0f));
         debug_auto_aim_done_ = true;
@@ -1195,6 +1492,10 @@ bool VulkanApp::process_runtime_mesh_upload(const MeshUpload& upload) {
 }
 
 void VulkanApp::process_runtime_mesh_release(const FaceChunkKey& key) {
+    // Re-requested while the release was queued: its newer mesh replaces this one in place.
+    if (!streaming_.residency().finish_evict(key)) {
+        return;
+    }
     if (render_system_->release_chunk(key, log_stream_)) {
         streaming_.erase_chunk(key);
     }
@@ -1329,11 +1630,37 @@ void VulkanApp::rebuild_swapchain_dependents() {
                                                  static_cast<VkDeviceSize>(pool_vtx_mb_) * 1024ull * 1024ull,
                                                  static_cast<VkDeviceSize>(pool_idx_mb_) * 1024ull * 1024ull,
                                                  log_pool_);
+    apply_chunk_record_settings();
 
     create_graphics_pipeline();
     hud_force_refresh_ = true;
 }
 
+void VulkanApp::apply_chunk_record_settings() {
+    if (!render_system_ || !render_system_->device()) {
+        return;
+    }
+    std::size_t threads = 0;
+    if (record_threads_ < 0) {
+        unsigned int hw = std::thread::hardware_concurrency();
+        threads = std::clamp<std::size_t>(hw > 1 ? hw - 1 : 1, 1, 8);
+    } else {
+        threads = static_cast<std::size_t>(record_threads_);
+    }
+    render_system_->wait_idle();
+    ChunkRenderer& chunk_renderer = render_system_->chunk_renderer();
+    chunk_renderer.set_record_threads(threads, render_system_->graphics_queue_family());
+    chunk_renderer.set_inherited_statistics((frag_query_pool_ && frag_query_inherited_)
+                                                ? VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT
+                                                : 0);
+    const Renderer& renderer = render_system_->renderer();
+    chunk_renderer.set_indirect_first_instance(renderer.draw_indirect_first_instance_supported());
+    chunk_renderer.set_gpu_cull(gpu_cull_enabled_,
+                                renderer.draw_indirect_count_supported(),
+                                renderer.multi_draw_indirect_supported());
+    chunk_renderer.set_gpu_cull_check(gpu_cull_check_);
+}
+
 VkShaderModule VulkanApp::load_shader_module(const std::string& path) {
     size_t slash = path.find_last_of('/');
     std::string base = (slash == std::string::npos) ? path : path.substr(slash + 1);
@@ -1673,6 +2000,29 @@ void VulkanApp::create_compute_pipeline() {
     pipeline_compute_.reset(device, new_pipeline);
 }
 
+void VulkanApp::create_frag_stats_query() {
+    VkDevice device = render_system_->device();
+    frag_query_pool_.reset();
+    frag_query_issued_.clear();
+    const Renderer& renderer = render_system_->renderer();
+    if (!device || !renderer.pipeline_statistics_supported()) {
+        std::cout << "[info] Pipeline statistics queries unsupported; overdraw stats disabled." << std::endl;
+        return;
+    }
+    VkQueryPoolCreateInfo qci{};
+    qci.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    qci.queryType = VK_QUERY_TYPE_PIPELINE_STATISTICS;
+    qci.queryCount = static_cast<uint32_t>(renderer.frame_count());
+    qci.pipelineStatistics = VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT;
+    VkQueryPool pool = VK_NULL_HANDLE;
+    if (vkCreateQueryPool(device, &qci, nullptr, &pool) != VK_SUCCESS) {
+        return;
+    }
+    frag_query_pool_.reset(device, pool);
+    frag_query_inherited_ = renderer.inherited_queries_supported();
+    frag_query_issued_.assign(qci.queryCount, 0);
+}
+
 void VulkanApp::profile_append_csv(const std::string& line) {
     if (!profile_csv_enabled_) return;
     std::lock_guard<std::mutex> lk(profile_mutex_);
@@ -1726,6 +2076,8 @@ void VulkanApp::drain_mesh_results() {
                                            log_stream_,
                                            removed_keys);
         for (const auto& key : removed_keys) {
+            streaming_.residency().begin_evict(key);
+            streaming_.residency().finish_evict(key);
             streaming_.erase_chunk(key);
         }
     }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <vulkan/vulkan.h>
+#include <array>
 #include <vector>
 #include <string>
 #include <cstdint>
@@ -65,6 +66,8 @@ private:
     void create_compute_pipeline();
     void record_command_buffer(const Renderer::FrameContext& ctx);
     void load_config();
+    // Installs materials.cfg (or $WF_MATERIALS) over the built-in table; startup only.
+    void load_materials();
     AppConfig snapshot_config() const;
     void apply_config_local(const AppConfig& cfg);
     void apply_config(const AppConfig& cfg);
@@ -167,12 +170,15 @@ private:
     int pool_vtx_mb_ = 256;
     int pool_idx_mb_ = 128;
     bool save_chunks_enabled_ = false; // skip disk saves by default for faster streaming
+    bool rebase_stale_deltas_ = true;
+    float autosave_sec_ = 60.0f;
     std::string region_root_ = "regions";
 
     size_t overlay_draw_slot_ = 0;
     ui::UiController ui_controller_;
     // Reused per-frame container to avoid allocations when building draw items
     std::vector<ChunkDrawItem> chunk_items_tmp_;
+    std::vector<ChunkDrawItem> translucent_items_tmp_;
 
     // Parity toggle: use new ChunkRenderer path vs legacy pipeline
     bool use_chunk_renderer_ = true;
@@ -184,11 +190,15 @@ private:
     int ring_radius_ = 14;        // loads (2*ring_radius_+1)^2 chunks
     int prune_margin_ = 3;        // hysteresis: keep extra radius around load ring
     bool cull_enabled_ = true;    // CPU frustum culling toggle
+    bool gpu_cull_enabled_ = true; // compute-shader culling with indirect-count draws
+    bool gpu_cull_check_ = false;  // debug: compare GPU cull read-backs with a CPU replay
+    bool draw_sort_enabled_ = true; // front-to-back chunk draw order
     bool draw_stats_enabled_ = true; // show draw stats in HUD
     // Per-frame draw stats captured last frame
     int last_draw_total_ = 0;
     int last_draw_visible_ = 0;
     uint64_t last_draw_indices_ = 0;
+    ChunkRecordStats last_record_stats_{}; // zero unless chunks were recorded in parallel
 
     bool device_local_enabled_ = true; // default to device-local pools with staging
     bool debug_chunk_keys_ = false;
@@ -239,6 +249,21 @@ private:
     // Async loading/meshing
     int uploads_per_frame_limit_ = 16;
     int loader_threads_ = 0; // 0 = auto
+    int edit_threads_ = 1;
+    int far_threads_ = 0;    // 0 = half of loader_threads
+    int io_threads_ = 4;
+    int io_nice_ = 0;
+    int record_threads_ = -1; // -1 = auto, 0 = inline chunk recording
+    double last_record_ms_ = 0.0; // main-thread time spent recording the primary
+    std::array<std::vector<uint32_t>, ChunkRenderer::kRecordBuckets> record_bucket_chunks_;
+    std::vector<VkCommandBuffer> record_secondaries_;
+    // One fragment-shader-invocation query per frame slot; read back after the slot's fence.
+    wf::vk::UniqueQueryPool frag_query_pool_;
+    bool frag_query_inherited_ = false; // secondaries count toward the query
+    std::vector<uint8_t> frag_query_issued_;
+    uint64_t last_frag_invocations_ = 0;
+    void create_frag_stats_query();
+    void apply_chunk_record_settings();
     void drain_mesh_results();
 
     // Streaming state: current face and ring center
@@ -5,6 +5,9 @@
 #include <cmath>
 #include <cstdlib>
 #include <functional>
+#include <iostream>
+#include <iterator>
+#include <optional>
 #include <span>
 #include <unordered_map>
 #include <utility>
@@ -13,6 +16,7 @@
 #include "world_streaming_subsystem.h"
 #include "chunk.h"
 #include "chunk_delta.h"
+#include "material_table.h"
 
 namespace wf {
 namespace {
@@ -46,11 +50,44 @@ struct WorldRuntime::Impl {
     std::vector<FaceChunkKey> mesh_releases_;
     std::unordered_map<FaceChunkKey, std::size_t, FaceChunkKeyHash> renderable_lookup_;
 
+    // Edited chunks waiting for their remesh to reach the renderer.
+    struct PendingEditLatency {
+        std::chrono::steady_clock::time_point applied;
+        std::uint64_t frame = 0;
+    };
+    std::unordered_map<FaceChunkKey, PendingEditLatency, FaceChunkKeyHash> edit_latency_pending_;
+    std::uint64_t update_frame_ = 0;
+    double edit_latency_ms_ = 0.0;
+    double edit_latency_avg_ms_ = 0.0;
+    double edit_latency_peak_ms_ = 0.0;
+    int edit_latency_frames_ = 0;
+    std::uint64_t edit_latency_samples_ = 0;
+
     float face_switch_hysteresis_ = 0.05f;
     std::function<void(const std::string&)> profile_sink_;
     bool camera_initialized_ = false;
     double last_camera_spawn_radius_m_ = 0.0;
 
+    // Live reconfiguration: the last applied config is diffed against the next one.
+    std::optional<AppConfig> applied_config_;
+    std::optional<int> ring_delta_keep_;   // pending in-place ring request (keep radius, -1 = remesh all)
+    bool terrain_restream_pending_ = false;
+
+    // Neighbor-face extents of the current and previous rings, so prune keeps cross-face tiles.
+    struct FaceExtent {
+        int face = -1;
+        std::int64_t i0 = 0, i1 = 0, j0 = 0, j1 = 0;
+    };
+    struct RingExtents {
+        int face = -1;
+        std::int64_t ci = 0, cj = 0, ck = 0;
+        int ring_radius = -1, k_down = 0, k_up = 0;
+        std::uint64_t planet_hash = 0;
+        std::vector<FaceExtent> extents;
+    };
+    RingExtents ring_extents_[2];
+    int ring_extents_victim_ = 0;
+
     bool initialize(const CreateParams& params) {
         deps_ = params.deps;
         config_manager_ = std::make_unique<AppConfigManager>(params.initial_config);
@@ -170,6 +207,7 @@ struct WorldRuntime::Impl {
             return result;
         }
 
+        ++update_frame_;
         double dt = std::max(0.0, input.dt);
         bool reloaded = input.reload_config ? reload_config() : false;
         bool saved = input.save_config ? save_config() : false;
@@ -220,6 +258,7 @@ struct WorldRuntime::Impl {
         bool streaming_changed = update_streaming_state(dt, forward);
         bool uploads = drain_mesh_results();
         bool releases = prune_renderables();
+        if (deps_.streaming) deps_.streaming->tick_autosave();
         if (streaming_changed || uploads || releases) {
             result.streaming_dirty = true;
         }
@@ -247,6 +286,11 @@ struct WorldRuntime::Impl {
         status.last_mesh_ms = deps_.streaming->last_mesh_ms();
         status.last_meshed_chunks = deps_.streaming->last_meshed_chunks();
         status.loader_busy = deps_.streaming->loader_busy();
+        status.edit_latency_ms = edit_latency_ms_;
+        status.edit_latency_avg_ms = edit_latency_avg_ms_;
+        status.edit_latency_peak_ms = edit_latency_peak_ms_;
+        status.edit_latency_frames = edit_latency_frames_;
+        status.edit_latency_samples = edit_latency_samples_;
         return status;
     }
 
@@ -274,7 +318,7 @@ struct WorldRuntime::Impl {
         profile_sink_ = std::move(sink);
     }
 
-    void sync_camera_state(const Float3& position, float yaw_rad, float pitch_rad, bool walk_mode) {
+    void sync_camera_state(const Double3& position, float yaw_rad, float pitch_rad, bool walk_mode) {
         camera_.sync_state(position, yaw_rad, pitch_rad, walk_mode);
         camera_.set_aspect_ratio(aspect_ratio_);
         camera_settings_ = camera_.settings();
@@ -293,6 +337,9 @@ struct WorldRuntime::Impl {
     void consume_mesh_transfers(std::size_t uploads_processed, std::size_t releases_processed) {
         uploads_processed = std::min(uploads_processed, mesh_uploads_.size());
         releases_processed = std::min(releases_processed, mesh_releases_.size());
+        if (uploads_processed > 0 && !edit_latency_pending_.empty()) {
+            record_edit_latency(std::span<const MeshUpload>(mesh_uploads_.data(), uploads_processed));
+        }
         if (uploads_processed > 0) {
             mesh_uploads_.erase(mesh_uploads_.begin(), mesh_uploads_.begin() + uploads_processed);
         }
@@ -301,6 +348,29 @@ struct WorldRuntime::Impl {
         }
     }
 
+    // Closes the edit latency of every edited chunk among the uploads the renderer just took.
+    void record_edit_latency(std::span<const MeshUpload> uploads) {
+        constexpr double kLatencySmoothing = 0.1;
+        const auto now = std::chrono::steady_clock::now();
+        for (const MeshUpload& upload : uploads) {
+            auto it = edit_latency_pending_.find(upload.key);
+            if (it == edit_latency_pending_.end()) continue;
+            const double ms = std::chrono::duration<double, std::milli>(now - it->second.applied).count();
+            edit_latency_ms_ = ms;
+            edit_latency_frames_ = static_cast<int>(update_frame_ - it->second.frame);
+            edit_latency_avg_ms_ = edit_latency_samples_ > 0
+                                       ? edit_latency_avg_ms_ + (ms - edit_latency_avg_ms_) * kLatencySmoothing
+                                       : ms;
+            edit_latency_peak_ms_ = std::max(edit_latency_peak_ms_, ms);
+            ++edit_latency_samples_;
+            edit_latency_pending_.erase(it);
+        }
+        // An edit whose chunk never remeshes (unloaded, or pruned first) would otherwise linger.
+        std::erase_if(edit_latency_pending_, [&](const auto& entry) {
+            return now - entry.second.applied > std::chrono::seconds(2);
+        });
+    }
+
     void queue_chunk_remesh(const FaceChunkKey& key) {
         if (!deps_.streaming) {
             return;
@@ -313,17 +383,39 @@ struct WorldRuntime::Impl {
             return false;
         }
 
+        // Edits are relit first and queue their own remeshes; meshing meanwhile would store
+        // chunk copies over the light the task is writing.
+        deps_.streaming->dispatch_light_edits();
+        if (deps_.streaming->light_task_active()) {
+            return false;
+        }
+
         std::size_t count = max_count > 0 ? max_count : deps_.streaming->remesh_per_frame_cap();
         auto batch = deps_.streaming->take_remesh_batch(count);
         if (batch.empty()) {
             return false;
         }
 
-        bool any_uploads = false;
-        for (const auto& key : batch) {
+        // Meshed in parallel on the edit class (this thread helps), then queued ahead of ring
+        // uploads so an edit is visible the frame it lands. Residency tickets make the reorder
+        // safe: an older ring mesh of the same key queued behind is refused at upload.
+        ChunkResidencyTable& residency = deps_.streaming->residency();
+        std::vector<FaceChunkKey> keys(batch.begin(), batch.end());
+        std::vector<std::optional<MeshUpload>> ready(keys.size());
+        deps_.streaming->parallel_for(StreamingClass::kEdit, keys.size(), [&](std::size_t n) {
+            const FaceChunkKey& key = keys[n];
             auto chunk_opt = deps_.streaming->find_chunk_copy(key);
             if (!chunk_opt.has_value()) {
-                continue;
+                return;
+            }
+            // Retried while a ring job or an upload still owns the key; dropped once it is evicting.
+            uint64_t ticket = residency.begin_mesh(key, 0);
+            if (ticket == 0) {
+                ChunkResidencyState state{};
+                if (residency.state(key, state) && state != ChunkResidencyState::kEvicting) {
+                    deps_.streaming->queue_remesh(key);
+                }
+                return;
             }
 
             Chunk64 chunk = *chunk_opt;
@@ -332,27 +424,38 @@ struct WorldRuntime::Impl {
             apply_chunk_delta(delta, chunk);
 
             ChunkStreamingManager::MeshResult res;
-            if (!deps_.streaming->build_chunk_mesh(key, chunk, res)) {
-                deps_.streaming->store_chunk(key, chunk);
-                continue;
+            bool has_mesh = deps_.streaming->build_chunk_mesh(key, chunk, res);
+            residency.finish_mesh(key, ticket, has_mesh);
+            deps_.streaming->store_chunk(key, chunk);
+            if (!has_mesh || !residency.begin_upload(key, ticket)) {
+                return;
             }
 
-            MeshUpload upload{};
+            MeshUpload& upload = ready[n].emplace();
             upload.key = key;
             upload.mesh.vertices = std::move(res.vertices);
             upload.mesh.indices = std::move(res.indices);
+            upload.mesh.segments = std::move(res.segments);
             upload.center[0] = res.center[0];
             upload.center[1] = res.center[1];
             upload.center[2] = res.center[2];
             upload.radius = res.radius;
             upload.job_generation = res.job_gen;
-            mesh_uploads_.push_back(std::move(upload));
+            upload.residency_ticket = ticket;
+        });
 
-            deps_.streaming->store_chunk(key, chunk);
-            any_uploads = true;
+        std::vector<MeshUpload> edits;
+        edits.reserve(ready.size());
+        for (auto& upload : ready) {
+            if (upload) edits.push_back(std::move(*upload));
         }
-
-        return any_uploads;
+        if (edits.empty()) {
+            return false;
+        }
+        mesh_uploads_.insert(mesh_uploads_.begin(),
+                             std::make_move_iterator(edits.begin()),
+                             std::make_move_iterator(edits.end()));
+        return true;
     }
 
     bool apply_voxel_edit(const VoxelHit& target,
@@ -381,7 +484,15 @@ struct WorldRuntime::Impl {
         };
 
         std::vector<PendingEdit> edits;
+        std::vector<Int3> edit_voxels;
         edits.reserve(static_cast<std::size_t>(brush_dim * brush_dim * brush_dim));
+        edit_voxels.reserve(edits.capacity());
+
+        // On a seam chunk the brush skips the voxels the neighbor face owns and meshes.
+        std::vector<std::uint64_t> owned;
+        if (chunk_face_ownership(cfg, target.key) == FaceOwnership::kPartial) {
+            chunk_ownership_mask(cfg, target.key, owned);
+        }
 
         for (int dz = start; dz <= end; ++dz) {
             int lz = target.z + dz;
@@ -392,11 +503,12 @@ struct WorldRuntime::Impl {
                 for (int dx = start; dx <= end; ++dx) {
                     int lx = target.x + dx;
                     if (lx < 0 || lx >= Chunk64::N) continue;
+                    if (!owned.empty() && ((owned[ly + lz * Chunk64::N] >> lx) & 1ull) == 0) continue;
                     wf::i64 vx = target.voxel.x + static_cast<wf::i64>(dx);
                     wf::i64 vy = target.voxel.y + static_cast<wf::i64>(dy);
                     wf::i64 vz = target.voxel.z + static_cast<wf::i64>(dz);
-                    BaseSample base = sample_base(cfg, Int3{vx, vy, vz});
-                    edits.push_back(PendingEdit{lx, ly, lz, base.material});
+                    edit_voxels.push_back(Int3{vx, vy, vz});
+                    edits.push_back(PendingEdit{lx, ly, lz, MAT_AIR});
                 }
             }
         }
@@ -405,10 +517,29 @@ struct WorldRuntime::Impl {
             return false;
         }
 
-        std::vector<FaceChunkKey> neighbors_to_remesh;
+        // Base materials for the delta, sampled for the whole brush at once.
+        std::vector<BaseSample> base(edit_voxels.size());
+        sample_base_batch(cfg, edit_voxels, base);
+        for (std::size_t e = 0; e < edits.size(); ++e) {
+            edits[e].base_material = base[e].material;
+        }
+
+        // Digging leaves indestructible materials alone; placing only displaces fluids and gases.
+        const MaterialTable& materials = material_table();
+        const bool dig = new_material == MAT_AIR;
+        auto replaceable = [&](uint16_t current) {
+            if (current == new_material) return false;
+            if (dig) return materials.info(current).hardness >= 0.0f;
+            const SimClass sim = materials.sim(current);
+            return sim == SimClass::Fluid || sim == SimClass::Gas;
+        };
+
         bool updated = deps_.streaming->modify_chunk_and_delta(
             target.key,
             [&](Chunk64& chunk_in_cache) {
+                std::erase_if(edits, [&](const PendingEdit& edit) {
+                    return !replaceable(chunk_in_cache.get_material(edit.lx, edit.ly, edit.lz));
+                });
                 for (const PendingEdit& edit : edits) {
                     chunk_in_cache.set_voxel(edit.lx, edit.ly, edit.lz, new_material);
                 }
@@ -418,18 +549,38 @@ struct WorldRuntime::Impl {
                     uint32_t lidx = Chunk64::lindex(edit.lx, edit.ly, edit.lz);
                     delta.apply_edit(lidx, edit.base_material, new_material);
                 }
-            },
-            neighbors_to_remesh);
+            });
 
-        if (!updated) {
+        if (!updated || edits.empty()) {
             return false;
         }
 
-        deps_.streaming->queue_remesh(target.key);
-        for (const FaceChunkKey& neighbor : neighbors_to_remesh) {
-            deps_.streaming->queue_remesh(neighbor);
+        std::vector<uint32_t> voxels;
+        voxels.reserve(edits.size());
+        for (const PendingEdit& edit : edits) {
+            voxels.push_back(Chunk64::lindex(edit.lx, edit.ly, edit.lz));
+        }
+        deps_.streaming->queue_light_edit(target.key, std::move(voxels));
+        edit_latency_pending_.try_emplace(target.key,
+                                          PendingEditLatency{std::chrono::steady_clock::now(), update_frame_});
+
+        // Columns stream only their terrain band: digging through a chunk's floor or building
+        // to its ceiling may need the next shell, which a ring refresh in place now adds.
+        bool floor_edit = false, ceiling_edit = false;
+        for (const PendingEdit& edit : edits) {
+            floor_edit |= edit.lz == 0;
+            ceiling_edit |= edit.lz == Chunk64::N - 1;
+        }
+        auto streamed = [&](std::int64_t k) {
+            ChunkResidencyState state{};
+            return deps_.streaming->residency().state(FaceChunkKey{target.key.face, target.key.i, target.key.j, k},
+                                                      state);
+        };
+        if ((dig && floor_edit && !streamed(target.key.k - 1)) ||
+            (!dig && ceiling_edit && !streamed(target.key.k + 1))) {
+            const int keep = active_config_.ring_radius + 1;
+            ring_delta_keep_ = ring_delta_keep_ ? std::min(*ring_delta_keep_, keep) : keep;
         }
-
         return true;
     }
 
@@ -440,12 +591,21 @@ private:
         }
 
         bool changed = false;
+        if (terrain_restream_pending_) {
+            // Wait until the renderer has released the old meshes before streaming new terrain.
+            if (!mesh_releases_.empty()) {
+                return false;
+            }
+            deps_.streaming->set_stream_face(-1);
+            terrain_restream_pending_ = false;
+        }
+
         const PlanetConfig& cfg = active_config_.planet_cfg;
         const int N = Chunk64::N;
         const double chunk_m = static_cast<double>(N) * cfg.voxel_size_m;
 
-        Float3 eye = camera_.position();
-        Float3 dir = wf::normalize(eye);
+        Double3 eye = camera_.position();
+        Float3 dir = to_float3(wf::normalize(eye));
 
         int raw_face = face_from_direction(dir);
         int prev_face = deps_.streaming->stream_face();
@@ -519,8 +679,24 @@ private:
                                      fwd_s,
                                      fwd_t);
                 changed = true;
+            } else if (ring_delta_keep_) {
+                // A running job would leave the inner tiles unmeshed if aborted; rebuild all of them then.
+                int keep = deps_.streaming->loader_idle() ? *ring_delta_keep_ : -1;
+                enqueue_ring_request(chosen_face,
+                                     active_config_.ring_radius,
+                                     ci,
+                                     cj,
+                                     ck,
+                                     active_config_.k_down,
+                                     active_config_.k_up,
+                                     fwd_s,
+                                     fwd_t,
+                                     true,
+                                     keep);
+                changed = true;
             }
         }
+        ring_delta_keep_.reset();
 
         float timer = deps_.streaming->face_keep_timer_s();
         if (timer > 0.0f) {
@@ -533,16 +709,29 @@ private:
 
         allow_regions_prev_ = allow_regions_;
         allow_regions_.clear();
+        std::vector<std::int64_t> shells;
         auto build_region = [&](int face, std::int64_t aci, std::int64_t acj, std::int64_t ack, bool relaxed) {
+            // Columns stream terrain shells outside the k window too; keep everything between.
+            WorldStreamingSubsystem::ring_shells(cfg, ack, active_config_.k_down, active_config_.k_up, shells);
             AllowRegion region{};
             region.face = face;
             region.ci = aci;
             region.cj = acj;
             region.ck = ack;
             region.span = active_config_.ring_radius + active_config_.prune_margin + (relaxed ? 1 : 0);
-            region.k_down = active_config_.k_down + active_config_.k_prune_margin + (relaxed ? 1 : 0);
-            region.k_up = active_config_.k_up + active_config_.k_prune_margin + (relaxed ? 1 : 0);
+            region.k_down = static_cast<int>(ack - shells.front()) + active_config_.k_prune_margin + (relaxed ? 1 : 0);
+            region.k_up = static_cast<int>(shells.back() - ack) + active_config_.k_prune_margin + (relaxed ? 1 : 0);
             allow_regions_.push_back(region);
+            if (face < 0) return;
+            for (const FaceExtent& ext : cross_face_extents(face, aci, acj, ack)) {
+                AllowRegion cross = region;
+                cross.face = ext.face;
+                cross.ci = ext.i0 + (ext.i1 - ext.i0) / 2;
+                cross.cj = ext.j0 + (ext.j1 - ext.j0) / 2;
+                int half = static_cast<int>(std::max(ext.i1 - cross.ci, ext.j1 - cross.cj));
+                cross.span = half + active_config_.prune_margin + (relaxed ? 1 : 0);
+                allow_regions_.push_back(cross);
+            }
         };
 
         bool relaxed = !deps_.streaming->stream_face_ready();
@@ -569,6 +758,40 @@ private:
         return changed;
     }
 
+    const std::vector<FaceExtent>& cross_face_extents(int face, std::int64_t ci, std::int64_t cj, std::int64_t ck) {
+        const PlanetConfig& cfg = active_config_.planet_cfg;
+        const std::uint64_t planet_hash = planet_config_hash(cfg);
+        for (RingExtents& cached : ring_extents_) {
+            if (cached.face == face && cached.ci == ci && cached.cj == cj && cached.ck == ck &&
+                cached.ring_radius == active_config_.ring_radius && cached.k_down == active_config_.k_down &&
+                cached.k_up == active_config_.k_up && cached.planet_hash == planet_hash) {
+                return cached.extents;
+            }
+        }
+        RingExtents& slot = ring_extents_[ring_extents_victim_];
+        ring_extents_victim_ ^= 1;
+        slot = RingExtents{face, ci, cj, ck, active_config_.ring_radius, active_config_.k_down,
+                           active_config_.k_up, planet_hash, {}};
+
+        std::vector<WorldStreamingSubsystem::RingTile> tiles;
+        WorldStreamingSubsystem::collect_ring_tiles(cfg, face, ci, cj, ck, active_config_.ring_radius,
+                                                    active_config_.k_down, active_config_.k_up, 0.0f, 0.0f, tiles);
+        for (const auto& tile : tiles) {
+            if (tile.key.face == face) continue;
+            auto it = std::find_if(slot.extents.begin(), slot.extents.end(),
+                                   [&](const FaceExtent& ext) { return ext.face == tile.key.face; });
+            if (it == slot.extents.end()) {
+                slot.extents.push_back(FaceExtent{tile.key.face, tile.key.i, tile.key.i, tile.key.j, tile.key.j});
+                continue;
+            }
+            it->i0 = std::min(it->i0, tile.key.i);
+            it->i1 = std::max(it->i1, tile.key.i);
+            it->j0 = std::min(it->j0, tile.key.j);
+            it->j1 = std::max(it->j1, tile.key.j);
+        }
+        return slot.extents;
+    }
+
     void enqueue_ring_request(int face,
                               int ring_radius,
                               std::int64_t center_i,
@@ -577,7 +800,9 @@ private:
                               int k_down,
                               int k_up,
                               float fwd_s,
-                              float fwd_t) {
+                              float fwd_t,
+                              bool reuse_cached = false,
+                              int keep_radius = -1) {
         if (!deps_.streaming) {
             return;
         }
@@ -591,6 +816,8 @@ private:
         req.k_up = k_up;
         req.fwd_s = fwd_s;
         req.fwd_t = fwd_t;
+        req.reuse_cached = reuse_cached;
+        req.keep_radius = keep_radius;
         uint64_t gen = deps_.streaming->enqueue_request(req);
         deps_.streaming->set_stream_face_ready(false);
         deps_.streaming->set_pending_request_gen(gen);
@@ -601,18 +828,25 @@ private:
             return false;
         }
 
+        ChunkResidencyTable& residency = deps_.streaming->residency();
         bool any = false;
         WorldStreamingSubsystem::MeshResult res;
         while (deps_.streaming->try_pop_result(res)) {
+            // Evicted or superseded by a newer mesh of the same key since the worker finished.
+            if (!residency.begin_upload(res.key, res.ticket)) {
+                continue;
+            }
             MeshUpload upload{};
             upload.key = res.key;
             upload.mesh.vertices = std::move(res.vertices);
             upload.mesh.indices = std::move(res.indices);
+            upload.mesh.segments = std::move(res.segments);
             upload.center[0] = res.center[0];
             upload.center[1] = res.center[1];
             upload.center[2] = res.center[2];
             upload.radius = res.radius;
             upload.job_generation = res.job_gen;
+            upload.residency_ticket = res.ticket;
             mesh_uploads_.push_back(std::move(upload));
 
             if (!deps_.streaming->stream_face_ready() &&
@@ -657,6 +891,7 @@ private:
             if (!inside_any(renderable.key)) {
                 mesh_releases_.push_back(renderable.key);
                 if (deps_.streaming) {
+                    deps_.streaming->residency().begin_evict(renderable.key);
                     deps_.streaming->erase_chunk(renderable.key);
                 }
                 remove_renderable(idx);
@@ -665,25 +900,37 @@ private:
                 ++idx;
             }
         }
+
+        // Keys that never got a mesh (empty, culled, or still in flight) leave through the
+        // same release path so their cache entries and residency do not accumulate.
+        if (deps_.streaming) {
+            std::vector<FaceChunkKey> evicted;
+            deps_.streaming->residency().evict_if([&](const FaceChunkKey& key) { return !inside_any(key); }, evicted);
+            for (const FaceChunkKey& key : evicted) {
+                mesh_releases_.push_back(key);
+                deps_.streaming->erase_chunk(key);
+            }
+            removed = removed || !evicted.empty();
+        }
         return removed;
     }
 
     void update_renderable_entry(const FaceChunkKey& key,
-                                 const float center[3],
+                                 const double center[3],
                                  float radius,
                                  uint64_t handle) {
         auto it = renderable_lookup_.find(key);
         if (it == renderable_lookup_.end()) {
             ChunkRenderable renderable{};
             renderable.key = key;
-            renderable.center = Float3{center[0], center[1], center[2]};
+            renderable.center = Double3{center[0], center[1], center[2]};
             renderable.radius = radius;
             renderable.mesh_handle = handle;
             renderable_lookup_[key] = chunk_renderables_.size();
             chunk_renderables_.push_back(renderable);
         } else {
             auto& renderable = chunk_renderables_[it->second];
-            renderable.center = Float3{center[0], center[1], center[2]};
+            renderable.center = Double3{center[0], center[1], center[2]};
             renderable.radius = radius;
             renderable.mesh_handle = handle;
         }
@@ -705,6 +952,10 @@ private:
     }
 
     void apply_config_internal(const AppConfig& cfg) {
+        AppConfigDiff diff{};
+        if (applied_config_) {
+            diff = diff_configs(*applied_config_, cfg);
+        }
         active_config_ = cfg;
         camera_settings_.cam_speed = cfg.cam_speed;
         camera_settings_.cam_sensitivity = cfg.cam_sensitivity;
@@ -725,7 +976,15 @@ private:
         config_dirty_ = true;
 
         if (deps_.streaming) {
-            std::size_t remesh_cap = 4;
+            StreamingDiffPlan plan;
+            if (applied_config_) {
+                plan = plan_streaming_diff(diff, *applied_config_, cfg, !deps_.streaming->loader_idle());
+            }
+            if (plan.stop_loader) {
+                deps_.streaming->stop_workers();
+            }
+            // An edit plus its six face neighbors remesh in the same frame.
+            std::size_t remesh_cap = 8;
             std::size_t worker_hint = cfg.loader_threads > 0 ? static_cast<std::size_t>(cfg.loader_threads) : 0;
             deps_.streaming->configure(cfg.planet_cfg,
                                        cfg.region_root,
@@ -733,6 +992,11 @@ private:
                                        cfg.log_stream,
                                        remesh_cap,
                                        worker_hint);
+            deps_.streaming->set_rebase_stale_deltas(cfg.rebase_stale_deltas);
+            deps_.streaming->set_autosave_interval(cfg.autosave_sec);
+            deps_.streaming->set_class_threads(static_cast<std::size_t>(cfg.edit_threads),
+                                               static_cast<std::size_t>(cfg.far_threads));
+            deps_.streaming->set_io_threads(static_cast<std::size_t>(cfg.io_threads), cfg.io_nice);
             std::function<void(const std::string&)> sink;
             if (cfg.profile_csv_enabled && profile_sink_) {
                 sink = profile_sink_;
@@ -742,6 +1006,34 @@ private:
                                                     cfg.profile_csv_enabled,
                                                     std::move(sink),
                                                     start_tp_);
+            apply_streaming_diff(plan);
+        }
+        if (!diff.empty()) {
+            std::cout << "[config] live: " << describe_config_diff(diff) << "\n";
+        }
+        applied_config_ = cfg;
+    }
+
+    // Act only on the streaming state the changed fields actually affect.
+    void apply_streaming_diff(const StreamingDiffPlan& plan) {
+        if (plan.invalidate) {
+            // Generated chunks and meshes are stale; player deltas are kept.
+            deps_.streaming->invalidate_generated();
+            mesh_uploads_.clear();
+            for (const auto& renderable : chunk_renderables_) {
+                mesh_releases_.push_back(renderable.key);
+            }
+            chunk_renderables_.clear();
+            renderable_lookup_.clear();
+            ring_delta_keep_.reset();
+            terrain_restream_pending_ = true;
+            return;
+        }
+        if (plan.restart_loader) {
+            deps_.streaming->restart_workers();
+        }
+        if (plan.ring_delta_keep) {
+            ring_delta_keep_ = ring_delta_keep_ ? std::min(*ring_delta_keep_, *plan.ring_delta_keep) : *plan.ring_delta_keep;
         }
     }
 
@@ -781,19 +1073,20 @@ private:
             right.z * cr + up.z * cu + forward.z * cf
         });
 
-        Float3 chunk_center = dirc * static_cast<float>(Rc);
-        float view_back = static_cast<float>(std::max(12.0, chunk_m * 1.5));
-        Float3 eye = dirc * static_cast<float>(Rc + view_back) + up * 2.0f;
-        Float3 look = wf::normalize(chunk_center - eye);
+        Double3 dirc_d = wf::normalize(to_double3(dirc));
+        Double3 chunk_center = dirc_d * Rc;
+        double view_back = std::max(12.0, chunk_m * 1.5);
+        Double3 eye = dirc_d * (Rc + view_back) + to_double3(up) * 2.0;
+        Float3 look = to_float3(wf::normalize(chunk_center - eye));
         float yaw = std::atan2(look.z, look.x);
         float pitch = std::asin(std::clamp(look.y, -1.0f, 1.0f));
-        double dot = eye.x * dirc.x + eye.y * dirc.y + eye.z * dirc.z;
+        double dot = wf::dot(eye, dirc_d);
         if (Rc > dot) {
             yaw += 3.14159265f;
             pitch = -pitch;
         }
 
-        camera_.sync_state(Float3{eye.x, eye.y, eye.z}, yaw, pitch, camera_settings_.walk_mode);
+        camera_.sync_state(eye, yaw, pitch, camera_settings_.walk_mode);
         camera_initialized_ = true;
         last_camera_spawn_radius_m_ = planet_cfg.radius_m;
     }
@@ -866,7 +1159,7 @@ void WorldRuntime::set_profile_sink(std::function<void(const std::string&)> sink
     impl_->set_profile_sink(std::move(sink));
 }
 
-void WorldRuntime::sync_camera_state(const Float3& position, float yaw_rad, float pitch_rad, bool walk_mode) {
+void WorldRuntime::sync_camera_state(const Double3& position, float yaw_rad, float pitch_rad, bool walk_mode) {
     impl_->sync_camera_state(position, yaw_rad, pitch_rad, walk_mode);
 }
 
@@ -6,12 +6,19 @@
 #include <chrono>
 #include <cmath>
 #include <cstdio>
+#include <cstdlib>
+#include <future>
 #include <iostream>
+#include <memory>
 #include <mutex>
 #include <thread>
+#include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
+#include "base_generator.h"
+#include "light_engine.h"
 #include "mesh.h"
 #include "planet.h"
 #include "wf_math.h"
@@ -19,6 +26,23 @@
 
 namespace wf {
 
+namespace {
+
+// All air under full sunlight: what generation makes of a shell above its column's terrain.
+const Chunk64& open_sky_chunk() {
+    static const Chunk64 sky = [] {
+        Chunk64 c;
+        c.fill_all_air();
+        uint64_t open_sky[Chunk64::N];
+        std::fill(std::begin(open_sky), std::end(open_sky), ~0ull);
+        light_chunk(c, nullptr, open_sky);
+        return c;
+    }();
+    return sky;
+}
+
+} // namespace
+
 void WorldStreamingSubsystem::configure(const PlanetConfig& planet_cfg,
                                         const std::string& region_root,
                                         bool save_chunks,
@@ -27,13 +51,17 @@ void WorldStreamingSubsystem::configure(const PlanetConfig& planet_cfg,
                                         std::size_t worker_count_hint) {
     manager_.set_planet_config(planet_cfg);
     manager_.set_region_root(region_root);
+
+    // Keep what the previous configuration built, then pick up this one's file.
+    if (!terrain_bounds_path_.empty() && terrain_bounds_.stats().tiles > 0) terrain_bounds_.save(terrain_bounds_path_);
+    terrain_bounds_path_ = region_root + "/terrain_pyramid.bin";
+    terrain_bounds_.set_config(planet_cfg);
+    terrain_bounds_.load(terrain_bounds_path_);
     manager_.set_save_chunks_enabled(save_chunks);
     manager_.set_log_stream(log_stream);
     manager_.set_remesh_per_frame_cap(remesh_per_frame_cap);
     manager_.set_worker_count(worker_count_hint);
 
-    worker_count_hint_ = worker_count_hint;
-
     manager_.set_load_job([this](const LoadRequest& req) {
         this->build_ring_job(req);
     });
@@ -61,6 +89,7 @@ void WorldStreamingSubsystem::start() {
 
 void WorldStreamingSubsystem::stop() {
     manager_.stop();
+    if (!terrain_bounds_path_.empty() && terrain_bounds_.stats().tiles > 0) terrain_bounds_.save(terrain_bounds_path_);
 }
 
 void WorldStreamingSubsystem::wait_for_pending_saves() {
@@ -121,6 +150,59 @@ std::deque<FaceChunkKey> WorldStreamingSubsystem::take_remesh_batch(std::size_t
     return batch;
 }
 
+void WorldStreamingSubsystem::queue_light_edit(const FaceChunkKey& key, std::vector<uint32_t> voxels) {
+    std::scoped_lock lock(light_mutex_);
+    light_edits_.push_back(LightEdit{key, std::move(voxels)});
+}
+
+void WorldStreamingSubsystem::dispatch_light_edits() {
+    {
+        std::scoped_lock lock(light_mutex_);
+        if (light_edits_.empty()) return;
+    }
+    if (light_task_active_.exchange(true, std::memory_order_acq_rel)) return;
+    // Cleared when the task is destroyed: after it ran, or when a stopping pool drops it.
+    std::shared_ptr<void> done(nullptr, [this](void*) { light_task_active_.store(false, std::memory_order_release); });
+    manager_.submit(StreamingClass::kEdit, [this, done]() { run_light_edits(); });
+}
+
+void WorldStreamingSubsystem::run_light_edits() {
+    std::vector<LightEdit> edits;
+    {
+        std::scoped_lock lock(light_mutex_);
+        edits.swap(light_edits_);
+    }
+    const int N = Chunk64::N;
+    std::unordered_set<FaceChunkKey, FaceChunkKeyHash> remesh;
+    for (const LightEdit& edit : edits) {
+        manager_.with_neighborhood(edit.key, [&](LightNeighborhood& nbh, const FaceChunkKey (&keys)[27]) {
+            if (!nbh.chunks[LightNeighborhood::kCenter]) return;
+            uint32_t slots = relight_edit(nbh, edit.voxels) | (1u << LightNeighborhood::kCenter);
+            // Edited boundary voxels also change the seam faces of the chunk across that face
+            // and the AO of the chunks across that face, edge or corner.
+            for (uint32_t i : edit.voxels) {
+                const int p[3] = {static_cast<int>(i % N), static_cast<int>((i / N) % N), static_cast<int>(i / (N * N))};
+                int lo[3], hi[3];
+                for (int a = 0; a < 3; ++a) {
+                    lo[a] = p[a] == 0 ? -1 : 0;
+                    hi[a] = p[a] == N - 1 ? 1 : 0;
+                }
+                for (int dz = lo[2]; dz <= hi[2]; ++dz) {
+                    for (int dy = lo[1]; dy <= hi[1]; ++dy) {
+                        for (int dx = lo[0]; dx <= hi[0]; ++dx) slots |= 1u << LightNeighborhood::slot(dx, dy, dz);
+                    }
+                }
+            }
+            for (int s = 0; s < 27; ++s) {
+                if (((slots >> s) & 1u) && nbh.chunks[s]) remesh.insert(keys[s]);
+            }
+        });
+    }
+    for (const FaceChunkKey& key : remesh) {
+        queue_remesh(key);
+    }
+}
+
 std::optional<Chunk64> WorldStreamingSubsystem::find_chunk_copy(const FaceChunkKey& key) const {
     std::optional<Chunk64> copy;
     manager_.with_chunk(key, [&](const Chunk64& chunk) {
@@ -144,18 +226,45 @@ ChunkDelta WorldStreamingSubsystem::load_delta_copy(const FaceChunkKey& key) con
 
 WorldStreamingSubsystem::NeighborChunks WorldStreamingSubsystem::gather_neighbor_chunks(const FaceChunkKey& key) const {
     NeighborChunks neighbors;
-    manager_.visit_neighbors(key, [&](const FaceChunkKey& neighbor_key, const Chunk64* chunk) {
-        if (!chunk) return;
+    auto slot = [&](const FaceChunkKey& neighbor_key) -> std::optional<Chunk64>* {
         int di = neighbor_key.i - key.i;
         int dj = neighbor_key.j - key.j;
         int dk = neighbor_key.k - key.k;
-        if (di == -1 && dj == 0 && dk == 0) neighbors.neg_x = *chunk;
-        else if (di == 1 && dj == 0 && dk == 0) neighbors.pos_x = *chunk;
-        else if (di == 0 && dj == -1 && dk == 0) neighbors.neg_y = *chunk;
-        else if (di == 0 && dj == 1 && dk == 0) neighbors.pos_y = *chunk;
-        else if (di == 0 && dj == 0 && dk == -1) neighbors.neg_z = *chunk;
-        else if (di == 0 && dj == 0 && dk == 1) neighbors.pos_z = *chunk;
+        if (di == -1 && dj == 0 && dk == 0) return &neighbors.neg_x;
+        if (di == 1 && dj == 0 && dk == 0) return &neighbors.pos_x;
+        if (di == 0 && dj == -1 && dk == 0) return &neighbors.neg_y;
+        if (di == 0 && dj == 1 && dk == 0) return &neighbors.pos_y;
+        if (di == 0 && dj == 0 && dk == -1) return &neighbors.neg_z;
+        if (di == 0 && dj == 0 && dk == 1) return &neighbors.pos_z;
+        return nullptr;
+    };
+    FaceChunkKey missing[6];
+    int missing_count = 0;
+    // Face neighbors are copied; edge and corner neighbors only lend the cells AO reads.
+    manager_.visit_neighborhood(key, [&](const Chunk64* const (&chunks)[27]) {
+        for (int a = 0; a < 3; ++a) {
+            for (int side = -1; side <= 1; side += 2) {
+                int d[3] = {0, 0, 0};
+                d[a] = side;
+                const FaceChunkKey neighbor_key{key.face, key.i + d[0], key.j + d[1], key.k + d[2]};
+                const Chunk64* chunk = chunks[LightNeighborhood::slot(d[0], d[1], d[2])];
+                if (!chunk) {
+                    missing[missing_count++] = neighbor_key;
+                } else if (auto* s = slot(neighbor_key)) {
+                    *s = *chunk;
+                }
+            }
+        }
+        gather_edge_cells(chunks, neighbors.edges);
     });
+    // Ring jobs skip shells above a column's terrain band; those read as open sky here too,
+    // outside the cache lock since the bounds may build a pyramid tile.
+    for (int m = 0; m < missing_count; ++m) {
+        std::int64_t k_lo = 0, k_hi = 0;
+        column_shells(missing[m], k_lo, k_hi);
+        if (missing[m].k <= k_hi) continue;
+        if (auto* s = slot(missing[m])) *s = open_sky_chunk();
+    }
     return neighbors;
 }
 
@@ -167,8 +276,9 @@ bool WorldStreamingSubsystem::build_chunk_mesh(const FaceChunkKey& key,
                                                const Chunk64* py,
                                                const Chunk64* nz,
                                                const Chunk64* pz,
+                                               const ChunkEdgeCells* edges,
                                                MeshResult& out) const {
-    return build_chunk_mesh_result(key, chunk, nx, px, ny, py, nz, pz, out);
+    return build_chunk_mesh_result(key, chunk, nx, px, ny, py, nz, pz, edges, out);
 }
 
 bool WorldStreamingSubsystem::build_chunk_mesh(const FaceChunkKey& key,
@@ -183,38 +293,38 @@ bool WorldStreamingSubsystem::build_chunk_mesh(const FaceChunkKey& key,
                                    neighbors.py_ptr(),
                                    neighbors.nz_ptr(),
                                    neighbors.pz_ptr(),
+                                   &neighbors.edges,
                                    out);
 }
 
-void WorldStreamingSubsystem::build_ring_job(const LoadRequest& request) {
-    const int face = request.face;
-    const int ring_radius = request.ring_radius;
-    const std::int64_t center_i = request.ci;
-    const std::int64_t center_j = request.cj;
-    const std::int64_t center_k = request.ck;
-    const int k_down = request.k_down;
-    const int k_up = request.k_up;
-    const float fwd_s = request.fwd_s;
-    const float fwd_t = request.fwd_t;
-    const uint64_t job_gen = request.gen;
-
-    const PlanetConfig& cfg = manager_.planet_config();
-    const int N = Chunk64::N;
-    const double chunk_m = static_cast<double>(N) * cfg.voxel_size_m;
-
-    Float3 right, up, forward;
-    face_basis(face, right, up, forward);
+void WorldStreamingSubsystem::collect_ring_tiles(const PlanetConfig& cfg,
+                                                 int face,
+                                                 std::int64_t center_i,
+                                                 std::int64_t center_j,
+                                                 std::int64_t center_k,
+                                                 int ring_radius,
+                                                 int k_down,
+                                                 int k_up,
+                                                 float fwd_s,
+                                                 float fwd_t,
+                                                 std::vector<RingTile>& out) {
+    std::vector<std::int64_t> shells;
+    for (int dk = -k_down; dk <= k_up; ++dk) shells.push_back(center_k + dk);
+    collect_ring_tiles(cfg, face, center_i, center_j, ring_radius, shells, fwd_s, fwd_t, out);
+}
 
+void WorldStreamingSubsystem::collect_ring_tiles(const PlanetConfig& cfg,
+                                                 int face,
+                                                 std::int64_t center_i,
+                                                 std::int64_t center_j,
+                                                 int ring_radius,
+                                                 std::span<const std::int64_t> shells,
+                                                 float fwd_s,
+                                                 float fwd_t,
+                                                 std::vector<RingTile>& out) {
+    out.clear();
+    const double chunk_m = static_cast<double>(Chunk64::N) * cfg.voxel_size_m;
     const int tile_span = ring_radius;
-    const int W = 2 * tile_span + 1;
-    const int KD = k_down + k_up + 1;
-    auto idx_of = [&](int di, int dj, int dk) {
-        int ix = di + tile_span;
-        int jy = dj + tile_span;
-        int kz = dk + k_down;
-        return (kz * W + jy) * W + ix;
-    };
-    std::vector<Chunk64> chunks(W * W * KD);
 
     struct Off {
         int di;
@@ -223,7 +333,7 @@ void WorldStreamingSubsystem::build_ring_job(const LoadRequest& request) {
         float dot;
     };
     std::vector<Off> order;
-    order.reserve(W * W);
+    order.reserve((2 * tile_span + 1) * (2 * tile_span + 1));
 
     float len = std::sqrt(fwd_s * fwd_s + fwd_t * fwd_t);
     float dir_s = (len > 1e-6f) ? (fwd_s / len) : 0.0f;
@@ -242,64 +352,184 @@ void WorldStreamingSubsystem::build_ring_job(const LoadRequest& request) {
         return a.di < b.di;
     });
 
-    struct Task {
-        int di;
-        int dj;
-        int dk;
-    };
-    std::vector<Task> tasks;
-    tasks.reserve(W * W * KD);
-    for (int dj = -tile_span; dj <= tile_span; ++dj) {
-        for (int di = -tile_span; di <= tile_span; ++di) {
-            for (int dk = -k_down; dk <= k_up; ++dk) {
-                tasks.push_back(Task{di, dj, dk});
-            }
-        }
+    int edge_faces[4];
+    for (int e = 0; e < 4; ++e) {
+        edge_faces[e] = face_edge_neighbor(face, e).face;
     }
 
-    auto t0 = std::chrono::steady_clock::now();
-    std::atomic<size_t> task_index{0};
-    int nthreads = worker_count_hint_ > 0 ? static_cast<int>(worker_count_hint_)
-                                          : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
-    std::vector<std::thread> workers;
-    workers.reserve(nthreads);
-    for (int w = 0; w < nthreads; ++w) {
-        workers.emplace_back([&, job_gen]() {
-            for (;;) {
-                if (manager_.should_abort(job_gen)) return;
-                size_t idx = task_index.fetch_add(1, std::memory_order_relaxed);
-                if (idx >= tasks.size()) break;
-                const Task task = tasks[idx];
-                int di = task.di;
-                int dj = task.dj;
-                int dk = task.dk;
-                std::int64_t kk = center_k + dk;
-                FaceChunkKey key{face, center_i + di, center_j + dj, kk};
-                if (debug_chunk_keys_) {
-                    static std::atomic<int> debug_chunk_log_count{0};
-                    if (debug_chunk_log_count.load(std::memory_order_relaxed) < 32) {
-                        int prev = debug_chunk_log_count.fetch_add(1, std::memory_order_relaxed);
-                        if (prev < 32) {
-                            std::cout << "[chunk-load] face=" << key.face
-                                      << " i=" << key.i << " j=" << key.j << " k=" << key.k << '\n';
-                        }
+    std::unordered_set<FaceChunkKey, FaceChunkKeyHash> seen;
+    for (const Off& off : order) {
+        for (std::int64_t k : shells) {
+            FaceChunkKey key{face, center_i + off.di, center_j + off.dj, k};
+            FaceOwnership own = chunk_face_ownership(cfg, key);
+            if (own != FaceOwnership::kNone && seen.insert(key).second) {
+                out.push_back(RingTile{key, off.di, off.dj});
+            }
+            if (own == FaceOwnership::kFull) continue;
+
+            // The rest of the tile lies past an edge (or two, near a corner): cover it with
+            // the tiles of the neighbor faces' own grids.
+            const double S0 = static_cast<double>(key.i) * chunk_m;
+            const double T0 = static_cast<double>(key.j) * chunk_m;
+            const double R0 = std::max(static_cast<double>(key.k) * chunk_m, 0.5 * chunk_m);
+            for (int g : edge_faces) {
+                double s_min = 0.0, s_max = 0.0, t_min = 0.0, t_max = 0.0;
+                bool any = false;
+                for (int c = 0; c < 8; ++c) {
+                    double S = S0 + ((c & 1) ? chunk_m : 0.0);
+                    double T = T0 + ((c & 2) ? chunk_m : 0.0);
+                    double R = R0 + ((c & 4) ? chunk_m : 0.0);
+                    if (S * S + T * T >= R * R) continue;
+                    double gs = 0.0, gt = 0.0;
+                    if (!face_grid_coords(g, face_grid_direction(face, S, T, R), R, gs, gt)) continue;
+                    s_min = any ? std::min(s_min, gs) : gs;
+                    s_max = any ? std::max(s_max, gs) : gs;
+                    t_min = any ? std::min(t_min, gt) : gt;
+                    t_max = any ? std::max(t_max, gt) : gt;
+                    any = true;
+                }
+                if (!any) continue;
+                std::int64_t i0 = static_cast<std::int64_t>(std::floor(s_min / chunk_m));
+                std::int64_t i1 = static_cast<std::int64_t>(std::floor(s_max / chunk_m));
+                std::int64_t j0 = static_cast<std::int64_t>(std::floor(t_min / chunk_m));
+                std::int64_t j1 = static_cast<std::int64_t>(std::floor(t_max / chunk_m));
+                for (std::int64_t gj = j0; gj <= j1; ++gj) {
+                    for (std::int64_t gi = i0; gi <= i1; ++gi) {
+                        FaceChunkKey gkey{g, gi, gj, key.k};
+                        if (seen.count(gkey) || chunk_face_ownership(cfg, gkey) == FaceOwnership::kNone) continue;
+                        seen.insert(gkey);
+                        out.push_back(RingTile{gkey, off.di, off.dj});
                     }
                 }
-                Chunk64& chunk = chunks[idx_of(di, dj, dk)];
-                generate_base_chunk(key, right, up, forward, chunk);
-                manager_.overlay_chunk_delta(key, chunk);
-                manager_.store_chunk(key, chunk);
             }
-        });
+        }
     }
-    for (auto& th : workers) {
-        th.join();
+}
+
+void WorldStreamingSubsystem::ring_shells(const PlanetConfig& cfg, std::int64_t center_k, int k_down, int k_up,
+                                          std::vector<std::int64_t>& out) {
+    out.clear();
+    std::int64_t band_lo = 0, band_hi = 0;
+    const HeightBounds any{0.0f, static_cast<float>(cfg.terrain_amp_m), 0.0f};
+    surface_shell_range(cfg, any, kSurfaceBandMarginM, band_lo, band_hi);
+    ++band_hi; // the headroom column_shells keeps
+    for (std::int64_t k = std::min(center_k - k_down, band_lo); k <= std::max(center_k + k_up, band_hi); ++k) {
+        const bool window = k >= center_k - k_down && k <= center_k + k_up;
+        if (window || (k >= band_lo && k <= band_hi)) out.push_back(k);
     }
+}
 
-    auto t1 = std::chrono::steady_clock::now();
-    double gen_ms = std::chrono::duration<double, std::milli>(t1 - t0).count();
-    manager_.update_generation_stats(gen_ms, static_cast<int>(tasks.size()));
-    if (manager_.should_abort(job_gen)) return;
+void WorldStreamingSubsystem::column_shells(const FaceChunkKey& key, std::int64_t& k_lo, std::int64_t& k_hi) const {
+    surface_shell_range(terrain_bounds_.config(), terrain_bounds_.column_bounds(key), kSurfaceBandMarginM, k_lo, k_hi);
+    // One air shell of headroom, so a voxel placed on the highest terrain lands in a resident chunk.
+    ++k_hi;
+}
+
+std::size_t WorldStreamingSubsystem::select_ring_shells(
+    std::int64_t window_lo,
+    std::int64_t window_hi,
+    std::vector<RingTile>& tiles,
+    std::unordered_map<FaceChunkKey, std::int64_t, FaceChunkKeyHash>& band_top) {
+    struct ColumnShells {
+        std::int64_t lo = 0;
+        std::int64_t hi = 0;
+    };
+    std::vector<FaceChunkKey> keys;
+    keys.reserve(tiles.size());
+    for (const RingTile& tile : tiles) keys.push_back(tile.key);
+    std::vector<uint8_t> edited;
+    manager_.may_have_chunk_deltas(keys, edited);
+
+    // Per column: the terrain band, widened to a shell past every shell that may hold edits.
+    std::unordered_map<FaceChunkKey, ColumnShells, FaceChunkKeyHash> columns;
+    band_top.clear();
+    for (std::size_t t = 0; t < tiles.size(); ++t) {
+        const FaceChunkKey& key = tiles[t].key;
+        const FaceChunkKey column{key.face, key.i, key.j, 0};
+        auto [it, fresh] = columns.try_emplace(column);
+        if (fresh) {
+            column_shells(key, it->second.lo, it->second.hi);
+            band_top.emplace(column, it->second.hi);
+        }
+        if (edited[t]) {
+            it->second.lo = std::min(it->second.lo, key.k - 1);
+            it->second.hi = std::max(it->second.hi, key.k + 1);
+        }
+    }
+
+    std::size_t dropped = 0;
+    std::erase_if(tiles, [&](const RingTile& tile) {
+        const ColumnShells& shells = columns[FaceChunkKey{tile.key.face, tile.key.i, tile.key.j, 0}];
+        if (tile.key.k >= shells.lo && tile.key.k <= shells.hi) return false;
+        if (tile.key.k >= window_lo && tile.key.k <= window_hi) ++dropped;
+        return true;
+    });
+    return dropped;
+}
+
+void WorldStreamingSubsystem::build_ring_job(const LoadRequest& request) {
+    const int face = request.face;
+    const int ring_radius = request.ring_radius;
+    const std::int64_t center_i = request.ci;
+    const std::int64_t center_j = request.cj;
+    const std::int64_t center_k = request.ck;
+    const int k_down = request.k_down;
+    const int k_up = request.k_up;
+    const float fwd_s = request.fwd_s;
+    const float fwd_t = request.fwd_t;
+    const uint64_t job_gen = request.gen;
+    const bool reuse_cached = request.reuse_cached;
+    const int keep_radius = request.keep_radius;
+
+    // A copy: the job runs for many frames and must not see a config change halfway through.
+    const PlanetConfig cfg = manager_.planet_config();
+    const int N = Chunk64::N;
+    const double chunk_m = static_cast<double>(N) * cfg.voxel_size_m;
+    terrain_bounds_.set_config(cfg);
+
+    Float3 right, up, forward;
+    face_basis(face, right, up, forward);
+
+    // Tiles come nearest-first and may span up to three faces near a cube corner. Columns
+    // keep only the shells their terrain or edits reach, inside or outside the window.
+    std::vector<std::int64_t> shells;
+    ring_shells(cfg, center_k, k_down, k_up, shells);
+    std::vector<RingTile> tiles;
+    collect_ring_tiles(cfg, face, center_i, center_j, ring_radius, shells, fwd_s, fwd_t, tiles);
+    std::unordered_map<FaceChunkKey, std::int64_t, FaceChunkKeyHash> band_top;
+    band_skipped_chunks_.fetch_add(select_ring_shells(center_k - k_down, center_k + k_up, tiles, band_top),
+                                   std::memory_order_relaxed);
+    std::unordered_map<FaceChunkKey, std::size_t, FaceChunkKeyHash> tile_index;
+    tile_index.reserve(tiles.size());
+    for (std::size_t t = 0; t < tiles.size(); ++t) {
+        tile_index.emplace(tiles[t].key, t);
+    }
+    std::vector<Chunk64> chunks(tiles.size());
+
+    // Tiles kept from the previous ring stay resident untouched (shells that joined a kept
+    // column since are streamed); a refused request means a newer job or an in-flight upload
+    // owns the key, so this job only uses it as a neighbor.
+    ChunkResidencyTable& residency = manager_.residency();
+    auto kept_tile = [&](const RingTile& tile) {
+        ChunkResidencyState state{};
+        return tile.key.face == face && std::max(std::abs(tile.di), std::abs(tile.dj)) < keep_radius &&
+               residency.state(tile.key, state);
+    };
+    std::vector<uint8_t> tracked(tiles.size(), 0);
+    std::vector<uint8_t> lit(tiles.size(), 0);
+    for (std::size_t t = 0; t < tiles.size(); ++t) {
+        if (!kept_tile(tiles[t])) tracked[t] = residency.request(tiles[t].key, job_gen) ? 1 : 0;
+    }
+    // Skipped shells above a ring column's terrain read as open sky, so the shells below
+    // still mesh and light the faces toward them.
+    auto sky_above_band = [&](int f, std::int64_t i, std::int64_t j, std::int64_t k) -> const Chunk64* {
+        auto it = band_top.find(FaceChunkKey{f, i, j, 0});
+        return (it != band_top.end() && k > it->second) ? &open_sky_chunk() : nullptr;
+    };
+    auto ring_chunk = [&](int f, std::int64_t i, std::int64_t j, std::int64_t k) -> const Chunk64* {
+        auto it = tile_index.find(FaceChunkKey{f, i, j, k});
+        return (it != tile_index.end()) ? &chunks[it->second] : sky_above_band(f, i, j, k);
+    };
 
     Float3 fwd_world_cam = normalize(Float3{fwd_s * right.x + fwd_t * up.x + forward.x,
                                             fwd_s * right.y + fwd_t * up.y + forward.y,
@@ -307,80 +537,211 @@ void WorldStreamingSubsystem::build_ring_job(const LoadRequest& request) {
     constexpr float kDegToRad = 0.01745329251994329577f;
     float cone_cos = std::cos(75.0f * kDegToRad);
 
-    struct MeshTask {
-        int di;
-        int dj;
-        int dk;
+    auto lit_chunk = [&](int f, std::int64_t i, std::int64_t j, std::int64_t k) -> const Chunk64* {
+        auto it = tile_index.find(FaceChunkKey{f, i, j, k});
+        if (it == tile_index.end()) return sky_above_band(f, i, j, k);
+        return lit[it->second] ? &chunks[it->second] : nullptr;
     };
-    std::vector<MeshTask> mtasks;
-    mtasks.reserve(order.size() * KD);
-    for (const Off& off : order) {
-        for (int dk = -k_down; dk <= k_up; ++dk) {
-            mtasks.push_back(MeshTask{off.di, off.dj, dk});
+
+    auto generate_tile = [&](std::size_t idx, const Chunk64* above) {
+        if (manager_.should_abort(job_gen)) return;
+        const FaceChunkKey key = tiles[idx].key;
+        if (debug_chunk_keys_) {
+            static std::atomic<int> debug_chunk_log_count{0};
+            if (debug_chunk_log_count.load(std::memory_order_relaxed) < 32) {
+                int prev = debug_chunk_log_count.fetch_add(1, std::memory_order_relaxed);
+                if (prev < 32) {
+                    std::cout << "[chunk-load] face=" << key.face
+                              << " i=" << key.i << " j=" << key.j << " k=" << key.k << '\n';
+                }
+            }
         }
-    }
+        Chunk64& chunk = chunks[idx];
+        // Cached chunks already carry their delta overlay.
+        if (reuse_cached && manager_.with_chunk(key, [&](const Chunk64& cached) { chunk = cached; })) {
+            lit[idx] = 1;
+            if (tracked[idx]) residency.advance(key, ChunkResidencyState::kGenerated, job_gen);
+            return;
+        }
+        if (tracked[idx] && !residency.advance(key, ChunkResidencyState::kGenerating, job_gen)) {
+            tracked[idx] = 0;
+        }
+        uint64_t open_sky[Chunk64::N];
+        const double lowest_center_r = (static_cast<double>(key.k) * N + 0.5) * cfg.voxel_size_m;
+        if (lowest_center_r > cfg.radius_m + terrain_bounds_.column_bounds(key).max_m) {
+            // Above the highest terrain the column can reach: air under open sky.
+            chunk.fill_all_air();
+            std::fill(std::begin(open_sky), std::end(open_sky), ~0ull);
+            bounds_air_chunks_.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            // Every shell of the column reads the same cached terrain heights.
+            std::shared_ptr<const HeightTile> heights = height_tiles_.get(cfg, key.face, key.i, key.j);
+            generate_base_chunk(cfg, key, *heights, chunk, open_sky);
+        }
+        manager_.overlay_chunk_delta(key, chunk);
+        // Sunlight enters from the chunk above when the ring has it, else through the
+        // columns where the base terrain leaves the voxel above the chunk open.
+        light_chunk(chunk, above, open_sky);
+        lit[idx] = 1;
+        manager_.store_chunk(key, chunk);
+        if (tracked[idx] && !residency.advance(key, ChunkResidencyState::kGenerated, job_gen)) {
+            tracked[idx] = 0;
+        }
+    };
+
+    // Columns generate top-down so each chunk takes its sunlight from the one above.
+    auto generate_column = [&](const std::vector<std::size_t>& column) {
+        const Chunk64* above = nullptr;
+        std::int64_t above_k = 0;
+        for (std::size_t idx : column) {
+            const FaceChunkKey& key = tiles[idx].key;
+            generate_tile(idx, (above && above_k == key.k + 1) ? above : nullptr);
+            above = lit[idx] ? &chunks[idx] : nullptr;
+            above_k = key.k;
+        }
+    };
+    auto columns_of = [&](const std::vector<std::size_t>& list) {
+        std::unordered_map<FaceChunkKey, std::size_t, FaceChunkKeyHash> column_index;
+        std::vector<std::vector<std::size_t>> columns;
+        for (std::size_t t : list) {
+            const FaceChunkKey& key = tiles[t].key;
+            auto [it, fresh] = column_index.try_emplace(FaceChunkKey{key.face, key.i, key.j, 0}, columns.size());
+            if (fresh) columns.emplace_back();
+            columns[it->second].push_back(t);
+        }
+        for (auto& column : columns) {
+            std::sort(column.begin(), column.end(), [&](std::size_t a, std::size_t b) {
+                return tiles[a].key.k > tiles[b].key.k;
+            });
+        }
+        return columns;
+    };
+    // Light crosses chunk faces once the band is lit: each chunk gathers from its lit ring
+    // neighbors in parallel (neighbors are only read), then the results are committed.
+    auto gather_light = [&](StreamingClass cls, const std::vector<std::size_t>& list) {
+        std::vector<std::optional<ChunkLight>> gathered(list.size());
+        manager_.parallel_for(cls, list.size(), [&](std::size_t n) {
+            const std::size_t idx = list[n];
+            if (manager_.should_abort(job_gen) || !lit[idx]) return;
+            const FaceChunkKey& key = tiles[idx].key;
+            const Chunk64* nb[6] = {
+                lit_chunk(key.face, key.i - 1, key.j, key.k), lit_chunk(key.face, key.i + 1, key.j, key.k),
+                lit_chunk(key.face, key.i, key.j - 1, key.k), lit_chunk(key.face, key.i, key.j + 1, key.k),
+                lit_chunk(key.face, key.i, key.j, key.k - 1), lit_chunk(key.face, key.i, key.j, key.k + 1)};
+            ChunkLight out;
+            if (light_gather(chunks[idx], nb, out)) gathered[n] = std::move(out);
+        });
+        for (std::size_t n = 0; n < list.size(); ++n) {
+            if (!gathered[n]) continue;
+            const std::size_t idx = list[n];
+            chunks[idx].light = std::move(*gathered[n]);
+            manager_.update_chunk(tiles[idx].key, [&](Chunk64& cached) { cached.light = chunks[idx].light; });
+        }
+    };
 
-    std::atomic<size_t> mesh_index{0};
     std::atomic<int> meshed_accum{0};
-    std::vector<std::thread> mesh_workers;
-    mesh_workers.reserve(nthreads);
-    auto mesh_worker = [&]() {
-        int local_meshed = 0;
-        while (true) {
-            if (manager_.should_abort(job_gen)) break;
-            size_t idx = mesh_index.fetch_add(1, std::memory_order_relaxed);
-            if (idx >= mtasks.size()) break;
-            const MeshTask mt = mtasks[idx];
-            int di = mt.di;
-            int dj = mt.dj;
-            int dk = mt.dk;
-            std::int64_t kk = center_k + dk;
-            const Chunk64& chunk = chunks[idx_of(di, dj, dk)];
-
-            float Sc = static_cast<float>((center_i + di) * chunk_m + (chunk_m * 0.5));
-            float Tc = static_cast<float>((center_j + dj) * chunk_m + (chunk_m * 0.5));
-            float Rc = static_cast<float>((kk) * chunk_m + (chunk_m * 0.5));
-            float cr = Sc / Rc;
-            float cu = Tc / Rc;
-            float cf = std::sqrt(std::max(0.0f, 1.0f - (cr * cr + cu * cu)));
-            Float3 dirc = normalize(Float3{right.x * cr + up.x * cu + forward.x * cf,
-                                           right.y * cr + up.y * cu + forward.y * cf,
-                                           right.z * cr + up.z * cu + forward.z * cf});
-            float dcam = fwd_world_cam.x * dirc.x + fwd_world_cam.y * dirc.y + fwd_world_cam.z * dirc.z;
-            if (!debug_chunk_keys_ && dcam < cone_cos) {
-                continue;
-            }
+    auto mesh_tile = [&](std::size_t idx) {
+        if (manager_.should_abort(job_gen)) return;
+        const FaceChunkKey& key = tiles[idx].key;
+        // Kept interior of the previous ring, or a key a newer request or upload owns.
+        if (!tracked[idx]) {
+            return;
+        }
+        const Chunk64& chunk = chunks[idx];
+
+        double Sc = static_cast<double>(key.i) * chunk_m + chunk_m * 0.5;
+        double Tc = static_cast<double>(key.j) * chunk_m + chunk_m * 0.5;
+        double Rc = static_cast<double>(key.k) * chunk_m + chunk_m * 0.5;
+        Float3 dirc = to_float3(face_grid_direction(key.face, Sc, Tc, Rc));
+        float dcam = fwd_world_cam.x * dirc.x + fwd_world_cam.y * dirc.y + fwd_world_cam.z * dirc.z;
+        if (!debug_chunk_keys_ && dcam < cone_cos) {
+            return;
+        }
 
-            const Chunk64* nx = (di > -tile_span) ? &chunks[idx_of(di - 1, dj, dk)] : nullptr;
-            const Chunk64* px = (di < tile_span) ? &chunks[idx_of(di + 1, dj, dk)] : nullptr;
-            const Chunk64* ny = (dj > -tile_span) ? &chunks[idx_of(di, dj - 1, dk)] : nullptr;
-            const Chunk64* py = (dj < tile_span) ? &chunks[idx_of(di, dj + 1, dk)] : nullptr;
-            const Chunk64* nz = (dk > -k_down) ? &chunks[idx_of(di, dj, dk - 1)] : nullptr;
-            const Chunk64* pz = (dk < k_up) ? &chunks[idx_of(di, dj, dk + 1)] : nullptr;
-
-            MeshResult result;
-            if (!build_chunk_mesh_result(FaceChunkKey{face, center_i + di, center_j + dj, kk},
-                                         chunk, nx, px, ny, py, nz, pz, result)) {
-                continue;
+        // Neighbors come from the chunk's own face grid, which extends past the cube
+        // edge, so seams are culled without re-orienting slabs between faces. Edge and
+        // corner neighbors only lend the cells AO reads.
+        const Chunk64* nbh[27];
+        for (int dz = -1; dz <= 1; ++dz) {
+            for (int dy = -1; dy <= 1; ++dy) {
+                for (int dx = -1; dx <= 1; ++dx) {
+                    nbh[LightNeighborhood::slot(dx, dy, dz)] = ring_chunk(key.face, key.i + dx, key.j + dy, key.k + dz);
+                }
             }
-            result.job_gen = job_gen;
-            manager_.push_mesh_result(std::move(result));
-            ++local_meshed;
         }
-        if (local_meshed) {
-            meshed_accum.fetch_add(local_meshed, std::memory_order_relaxed);
+        const Chunk64* nx = nbh[LightNeighborhood::slot(-1, 0, 0)];
+        const Chunk64* px = nbh[LightNeighborhood::slot(1, 0, 0)];
+        const Chunk64* ny = nbh[LightNeighborhood::slot(0, -1, 0)];
+        const Chunk64* py = nbh[LightNeighborhood::slot(0, 1, 0)];
+        const Chunk64* nz = nbh[LightNeighborhood::slot(0, 0, -1)];
+        const Chunk64* pz = nbh[LightNeighborhood::slot(0, 0, 1)];
+        ChunkEdgeCells edges;
+        gather_edge_cells(nbh, edges);
+
+        uint64_t ticket = residency.begin_mesh(key, job_gen);
+        if (ticket == 0) {
+            return;
+        }
+        MeshResult result;
+        bool has_mesh = build_chunk_mesh_result(key, chunk, nx, px, ny, py, nz, pz, &edges, result);
+        if (!residency.finish_mesh(key, ticket, has_mesh) || !has_mesh) {
+            return;
         }
+        result.job_gen = job_gen;
+        result.ticket = ticket;
+        manager_.push_mesh_result(std::move(result));
+        meshed_accum.fetch_add(1, std::memory_order_relaxed);
     };
-    for (int w = 0; w < nthreads; ++w) {
-        mesh_workers.emplace_back(mesh_worker);
-    }
-    for (auto& th : mesh_workers) {
-        th.join();
+
+    // Tiles around the ring center are generated and meshed on the near class first, so the
+    // camera's surroundings are visible before far tiles start. Near generation covers a
+    // band past the near meshes because cross-face tiles are only about ±1 from their origin.
+    const int near_radius = std::max(1, ring_radius / 2);
+    constexpr int kNearNeighborPad = 2;
+    std::vector<std::size_t> gen_near, gen_far, mesh_near, mesh_far;
+    for (std::size_t t = 0; t < tiles.size(); ++t) {
+        int dist = std::max(std::abs(tiles[t].di), std::abs(tiles[t].dj));
+        (dist <= near_radius + kNearNeighborPad ? gen_near : gen_far).push_back(t);
+        (dist <= near_radius ? mesh_near : mesh_far).push_back(t);
     }
+    double gen_ms = 0.0;
+    double mesh_ms = 0.0;
+    auto run_phase = [&](StreamingClass cls, const std::vector<std::size_t>& list, auto& fn, double& ms) {
+        auto start = std::chrono::steady_clock::now();
+        manager_.parallel_for(cls, list.size(), [&](std::size_t n) { fn(list[n]); });
+        ms += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    };
+    auto run_generation = [&](StreamingClass cls, const std::vector<std::size_t>& list) {
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::vector<std::size_t>> columns = columns_of(list);
+        manager_.parallel_for(cls, columns.size(), [&](std::size_t n) { generate_column(columns[n]); });
+        gather_light(cls, list);
+        gen_ms += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    // Deltas are read in batches ahead of generation: the near band blocks, the far band
+    // streams in on the IO worker while the near tiles generate and mesh.
+    auto delta_keys = [&](const std::vector<std::size_t>& list) {
+        std::vector<FaceChunkKey> keys;
+        keys.reserve(list.size());
+        for (std::size_t t : list) keys.push_back(tiles[t].key);
+        return keys;
+    };
+    manager_.prefetch_chunk_deltas(delta_keys(gen_near));
+    std::future<void> far_deltas = manager_.prefetch_chunk_deltas_async(delta_keys(gen_far));
+
+    run_generation(StreamingClass::kNear, gen_near);
+    if (manager_.should_abort(job_gen)) return;
+    run_phase(StreamingClass::kNear, mesh_near, mesh_tile, mesh_ms);
+    if (manager_.should_abort(job_gen)) return;
+    far_deltas.wait();
+    run_generation(StreamingClass::kFar, gen_far);
+    manager_.update_generation_stats(gen_ms, static_cast<int>(tiles.size()));
+    if (manager_.should_abort(job_gen)) return;
+    run_phase(StreamingClass::kFar, mesh_far, mesh_tile, mesh_ms);
 
     int meshed_count = meshed_accum.load(std::memory_order_relaxed);
     auto t2 = std::chrono::steady_clock::now();
-    double mesh_ms = std::chrono::duration<double, std::milli>(t2 - t1).count();
     manager_.update_mesh_stats(mesh_ms, meshed_count, gen_ms + mesh_ms);
 
     if (profile_enabled_ && profile_sink_) {
@@ -389,7 +750,7 @@ void WorldStreamingSubsystem::build_ring_job(const LoadRequest& request) {
         std::snprintf(line, sizeof(line),
                       "job,%.3f,%d,%d,%.3f,%.3f,%.3f\n",
                       tsec,
-                      static_cast<int>(tasks.size()),
+                      static_cast<int>(tiles.size()),
                       meshed_count,
                       gen_ms,
                       mesh_ms,
@@ -398,99 +759,6 @@ void WorldStreamingSubsystem::build_ring_job(const LoadRequest& request) {
     }
 }
 
-void WorldStreamingSubsystem::generate_base_chunk(const FaceChunkKey& key,
-                                                  const Float3& right,
-                                                  const Float3& up,
-                                                  const Float3& forward,
-                                                  Chunk64& chunk) {
-    const PlanetConfig& cfg = manager_.planet_config();
-    const int N = Chunk64::N;
-    const double voxel_m = cfg.voxel_size_m;
-    const double chunk_m = static_cast<double>(N) * voxel_m;
-    const double s_origin = static_cast<double>(key.i) * chunk_m;
-    const double t_origin = static_cast<double>(key.j) * chunk_m;
-    const double r_origin = static_cast<double>(key.k) * chunk_m;
-
-    chunk.fill_all_air();
-
-    std::array<double, Chunk64::N> radial_m{};
-    for (int z = 0; z < N; ++z) {
-        radial_m[z] = r_origin + (z + 0.5) * voxel_m;
-    }
-
-    struct ColumnGenData {
-        Float3 dir_unit;
-        double surface_r;
-    };
-    std::vector<ColumnGenData> column_cache(N * N);
-
-    const double r_reference = std::max(cfg.radius_m, r_origin + 0.5 * chunk_m);
-    const uint32_t cave_seed = cfg.seed + 777u;
-
-    for (int y = 0; y < N; ++y) {
-        double t0 = t_origin + (y + 0.5) * voxel_m;
-        for (int x = 0; x < N; ++x) {
-            double s0 = s_origin + (x + 0.5) * voxel_m;
-            Float3 dir_cart{
-                static_cast<float>(right.x * s0 + up.x * t0 + forward.x * r_reference),
-                static_cast<float>(right.y * s0 + up.y * t0 + forward.y * r_reference),
-                static_cast<float>(right.z * s0 + up.z * t0 + forward.z * r_reference)};
-            Float3 dir_unit = normalize(dir_cart);
-
-            ColumnGenData data{};
-            data.dir_unit = dir_unit;
-            double surface_h = terrain_height_m(cfg, dir_unit);
-            data.surface_r = cfg.radius_m + surface_h;
-            column_cache[y * N + x] = data;
-        }
-    }
-
-    constexpr double kWaterBandDepthM = 5.0;
-    constexpr double kDirtDepthM = 2.0;
-    constexpr double kCaveDepthM = 3.0;
-    constexpr float kCaveScale = 0.05f;
-    constexpr float kCaveThreshold = 0.35f;
-
-    for (int y = 0; y < N; ++y) {
-        for (int x = 0; x < N; ++x) {
-            const ColumnGenData& col = column_cache[y * N + x];
-            const Float3 dir = col.dir_unit;
-            const float dir_x = dir.x;
-            const float dir_y = dir.y;
-            const float dir_z = dir.z;
-            for (int z = 0; z < N; ++z) {
-                double r0 = radial_m[z];
-                uint16_t mat = MAT_AIR;
-                if (r0 <= col.surface_r) {
-                    double depth = col.surface_r - r0;
-                    if (r0 > cfg.sea_level_m && depth < kWaterBandDepthM) {
-                        mat = MAT_WATER;
-                    } else {
-                        bool carve_cave = false;
-                        if (depth > kCaveDepthM) {
-                            float radius_f = static_cast<float>(r0);
-                            float px = dir_x * radius_f;
-                            float py = dir_y * radius_f;
-                            float pz = dir_z * radius_f;
-                            Float3 cave_pt{px * kCaveScale, py * kCaveScale, pz * kCaveScale};
-                            float cave = fbm(cave_pt, 4, 2.2f, 0.5f, cave_seed);
-                            carve_cave = (cave > kCaveThreshold);
-                        }
-                        if (carve_cave) {
-                            mat = MAT_AIR;
-                        } else if (depth < kDirtDepthM) {
-                            mat = MAT_DIRT;
-                        } else {
-                            mat = MAT_ROCK;
-                        }
-                    }
-                }
-                chunk.set_voxel(x, y, z, mat);
-            }
-        }
-    }
-}
-
 bool WorldStreamingSubsystem::build_chunk_mesh_result(const FaceChunkKey& key,
                                                       const Chunk64& chunk,
                                                       const Chunk64* nx,
@@ -499,6 +767,7 @@ bool WorldStreamingSubsystem::build_chunk_mesh_result(const FaceChunkKey& key,
                                                       const Chunk64* py,
                                                       const Chunk64* nz,
                                                       const Chunk64* pz,
+                                                      const ChunkEdgeCells* edges,
                                                       MeshResult& out) const {
     const PlanetConfig& cfg = manager_.planet_config();
     const int N = Chunk64::N;
@@ -506,44 +775,40 @@ bool WorldStreamingSubsystem::build_chunk_mesh_result(const FaceChunkKey& key,
     const float chunk_m = voxel_m * static_cast<float>(N);
     const float halfm = chunk_m * 0.5f;
 
-    Float3 right, up, forward;
-    face_basis(key.face, right, up, forward);
-
-    float S0 = static_cast<float>(key.i * chunk_m);
-    float T0 = static_cast<float>(key.j * chunk_m);
-    float R0 = static_cast<float>(key.k * chunk_m);
-    float Sc = S0 + halfm;
-    float Tc = T0 + halfm;
-    float Rc = R0 + halfm;
-    if (Rc <= 0.0f) Rc = halfm;
-
-    float cr = Sc / Rc;
-    float cu = Tc / Rc;
-    float cf = std::sqrt(std::max(0.0f, 1.0f - (cr * cr + cu * cu)));
-    Float3 dirc = normalize(Float3{right.x * cr + up.x * cu + forward.x * cf,
-                                   right.y * cr + up.y * cu + forward.y * cf,
-                                   right.z * cr + up.z * cu + forward.z * cf});
-
-    Mesh mesh;
-    mesh_chunk_greedy_neighbors(chunk, nx, px, ny, py, nz, pz, mesh, voxel_m);
-    if (mesh.indices.empty()) return false;
+    // Placement runs in double so chunks on Earth-scale radii keep sub-mm
+    // precision; vertices are stored as float offsets from the chunk center.
+    const double chunk_d = static_cast<double>(cfg.voxel_size_m) * N;
+    const double half_d = chunk_d * 0.5;
+    auto cube_to_sphere = [&](double S, double T, double R) -> Double3 {
+        return face_grid_direction(key.face, S, T, R) * R;
+    };
+
+    double S0 = static_cast<double>(key.i) * chunk_d;
+    double T0 = static_cast<double>(key.j) * chunk_d;
+    double R0 = static_cast<double>(key.k) * chunk_d;
+    double Rc = R0 + half_d;
+    if (Rc <= 0.0) Rc = half_d;
+    const Double3 center = cube_to_sphere(S0 + half_d, T0 + half_d, Rc);
+
+    // Near cube edges only the voxels this face owns are meshed; the neighbor face meshes the rest.
+    FaceOwnership ownership = chunk_face_ownership(cfg, key);
+    if (ownership == FaceOwnership::kNone) return false;
+    std::vector<uint64_t> owned;
+    if (ownership == FaceOwnership::kPartial) chunk_ownership_mask(cfg, key, owned);
+
+    // The voxel-space mesh is shared between identical contents; the sphere placement below
+    // depends on the key, so each chunk still gets its own copy.
+    std::shared_ptr<const Mesh> local =
+        mesh_cache_.mesh_greedy(chunk, nx, px, ny, py, nz, pz, voxel_m, owned.empty() ? nullptr : owned.data(), edges);
+    if (local->indices.empty()) return false;
+    Mesh mesh = *local;
 
     for (auto& vert : mesh.vertices) {
-        Float3 lp{vert.x, vert.y, vert.z};
-        float S = S0 + lp.x;
-        float T = T0 + lp.y;
-        float R = R0 + lp.z;
-        float uc = (R != 0.0f) ? (S / R) : 0.0f;
-        float vc = (R != 0.0f) ? (T / R) : 0.0f;
-        float w2 = std::max(0.0f, 1.0f - (uc * uc + vc * vc));
-        float wc = std::sqrt(w2);
-        Float3 dir_sph = normalize(Float3{right.x * uc + up.x * vc + forward.x * wc,
-                                          right.y * uc + up.y * vc + forward.y * wc,
-                                          right.z * uc + up.z * vc + forward.z * wc});
-        Float3 wp = dir_sph * R;
-        vert.x = wp.x;
-        vert.y = wp.y;
-        vert.z = wp.z;
+        Double3 wp = cube_to_sphere(S0 + vert.x, T0 + vert.y, R0 + vert.z);
+        Float3 lp = to_float3(wp - center);
+        vert.x = lp.x;
+        vert.y = lp.y;
+        vert.z = lp.z;
     }
 
     auto cross3 = [](Float3 a, Float3 b) -> Float3 {
@@ -557,17 +822,14 @@ bool WorldStreamingSubsystem::build_chunk_mesh_result(const FaceChunkKey& key,
 
     if (surface_push_m_ > 0.0f) {
         const float push = surface_push_m_;
-        for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3) {
-            uint32_t i0 = mesh.indices[i];
-            uint32_t i1 = mesh.indices[i + 1];
-            uint32_t i2 = mesh.indices[i + 2];
+        mesh.for_each_triangle([&](uint32_t i0, uint32_t i1, uint32_t i2) {
             Float3 p0{mesh.vertices[i0].x, mesh.vertices[i0].y, mesh.vertices[i0].z};
             Float3 p1{mesh.vertices[i1].x, mesh.vertices[i1].y, mesh.vertices[i1].z};
             Float3 p2{mesh.vertices[i2].x, mesh.vertices[i2].y, mesh.vertices[i2].z};
             Float3 e1 = sub3(p1, p0);
             Float3 e2 = sub3(p2, p0);
             Float3 n = normalize(cross3(e1, e2));
-            Float3 r0 = normalize(p0);
+            Float3 r0 = to_float3(normalize(to_double3(p0) + center));
             float radial = std::fabs(n.x * r0.x + n.y * r0.y + n.z * r0.z);
             if (radial > 0.8f) {
                 Float3 push_vec{r0.x * push, r0.y * push, r0.z * push};
@@ -581,13 +843,10 @@ bool WorldStreamingSubsystem::build_chunk_mesh_result(const FaceChunkKey& key,
                 mesh.vertices[i2].y = p2.y + push_vec.y;
                 mesh.vertices[i2].z = p2.z + push_vec.z;
             }
-        }
+        });
     }
 
-    for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3) {
-        uint32_t i0 = mesh.indices[i];
-        uint32_t i1 = mesh.indices[i + 1];
-        uint32_t i2 = mesh.indices[i + 2];
+    mesh.for_each_triangle([&](uint32_t i0, uint32_t i1, uint32_t i2) {
         const Vertex& v0 = mesh.vertices[i0];
         const Vertex& v1 = mesh.vertices[i1];
         const Vertex& v2 = mesh.vertices[i2];
@@ -606,14 +865,15 @@ bool WorldStreamingSubsystem::build_chunk_mesh_result(const FaceChunkKey& key,
         mesh.vertices[i2].nx = n.x;
         mesh.vertices[i2].ny = n.y;
         mesh.vertices[i2].nz = n.z;
-    }
+    });
 
     out.key = key;
     out.vertices = std::move(mesh.vertices);
     out.indices = std::move(mesh.indices);
-    out.center[0] = dirc.x * Rc;
-    out.center[1] = dirc.y * Rc;
-    out.center[2] = dirc.z * Rc;
+    out.segments = std::move(mesh.segments);
+    out.center[0] = center.x;
+    out.center[1] = center.y;
+    out.center[2] = center.z;
     out.radius = halfm * 1.73205080757f;
     return true;
 }
@@ -1,3 +1,5 @@
+#include <algorithm>
+#include <cmath>
 #include <cstdio>
 #include <cstdlib>
 #include "chunk.h"
@@ -8,6 +10,39 @@ using namespace wf;
 // Forward declare mesher in namespace
 namespace wf { void mesh_chunk_naive(const Chunk64&, Mesh&, float); }
 
+static int g_failures = 0;
+
+static void expect(const char* what, double got, double want) {
+    const bool ok = std::fabs(got - want) < 1e-3;
+    std::printf("%-44s got %6.0f want %6.0f  %s\n", what, got, want, ok ? "ok" : "FAIL");
+    if (!ok) ++g_failures;
+}
+
+// Summed area of the triangles of one pass whose normal is `axis` (0..2) with `sign`, lying on
+// plane `plane`; a negative plane matches any.
+static double face_area(const Mesh& m, bool translucent, int axis, float sign, float plane) {
+    double area = 0.0;
+    for (const MeshSegment& seg : m.segments) {
+        if (seg.translucent != translucent) continue;
+        const uint16_t* idx = m.indices.data() + seg.first_index;
+        for (uint32_t i = 0; i + 2 < seg.index_count; i += 3) {
+            const Vertex& a = m.vertices[seg.base_vertex + idx[i]];
+            const Vertex& b = m.vertices[seg.base_vertex + idx[i + 1]];
+            const Vertex& c = m.vertices[seg.base_vertex + idx[i + 2]];
+            const float n[3] = {a.nx, a.ny, a.nz};
+            const float p[3] = {a.x, a.y, a.z};
+            if (n[axis] != sign || (plane >= 0.0f && p[axis] != plane)) continue;
+            const double e1[3] = {b.x - a.x, b.y - a.y, b.z - a.z};
+            const double e2[3] = {c.x - a.x, c.y - a.y, c.z - a.z};
+            const double cx = e1[1] * e2[2] - e1[2] * e2[1];
+            const double cy = e1[2] * e2[0] - e1[0] * e2[2];
+            const double cz = e1[0] * e2[1] - e1[1] * e2[0];
+            area += 0.5 * std::sqrt(cx * cx + cy * cy + cz * cz);
+        }
+    }
+    return area;
+}
+
 int main() {
     Chunk64 c;
     // Simple test: fill a flat ground of rock at y<32, air above; add a small dirt pillar
@@ -26,5 +61,72 @@ int main() {
     wf::mesh_chunk_greedy(c, m2, 0.10f);
     std::printf("Naive  -> Vertices: %zu, Tris: %zu\n", m1.vertices.size(), m1.indices.size() / 3);
     std::printf("Greedy -> Vertices: %zu, Tris: %zu\n", m2.vertices.size(), m2.indices.size() / 3);
-    return 0;
+
+    // Rock ground up to z = 24 (z points away from the planet) with a 10x10x4 pit of water.
+    Chunk64 pool;
+    for (int z = 0; z < Chunk64::N; ++z) {
+        for (int y = 0; y < Chunk64::N; ++y) {
+            for (int x = 0; x < Chunk64::N; ++x) {
+                const bool pit = x >= 10 && x < 20 && y >= 10 && y < 20 && z >= 20;
+                pool.set_voxel(x, y, z, z >= 24 ? MAT_AIR : (pit ? MAT_WATER : MAT_ROCK));
+            }
+        }
+    }
+    Mesh mp;
+    wf::mesh_chunk_greedy(pool, mp, 1.0f);
+    std::size_t translucent_vertices = 0;
+    bool opaque_first = true, seen_translucent = false;
+    for (const MeshSegment& seg : mp.segments) {
+        if (seg.translucent) { translucent_vertices += seg.vertex_count; seen_translucent = true; }
+        else if (seen_translucent) opaque_first = false;
+    }
+    std::printf("Pool   -> Vertices: %zu (translucent %zu), Tris: %zu\n", mp.vertices.size(), translucent_vertices,
+                mp.indices.size() / 3);
+    expect("opaque segments precede translucent ones", opaque_first ? 1 : 0, 1);
+    // Water meets air only at its surface, merged into one quad; water-water and water-rock
+    // faces are culled.
+    expect("translucent vertices (one surface quad)", (double)translucent_vertices, 4);
+    expect("water surface area", face_area(mp, true, 2, 1.0f, 24.0f), 100);
+    expect("translucent area elsewhere", face_area(mp, true, 2, -1.0f, -1.0f) + face_area(mp, true, 0, 1.0f, -1.0f) +
+                                          face_area(mp, true, 0, -1.0f, -1.0f) + face_area(mp, true, 1, 1.0f, -1.0f) +
+                                          face_area(mp, true, 1, -1.0f, -1.0f), 0);
+    // Rock under and around the water keeps its faces; the ground top skips the pit.
+    expect("pit floor area (rock facing water)", face_area(mp, false, 2, 1.0f, 20.0f), 100);
+    expect("pit wall area at x = 10", face_area(mp, false, 0, 1.0f, 10.0f), 40);
+    expect("pit wall area at y = 20", face_area(mp, false, 1, -1.0f, 20.0f), 40);
+    expect("ground top area", face_area(mp, false, 2, 1.0f, 24.0f), 64 * 64 - 100);
+
+    // Ground filling the chunk under an open chunk, with a wall along y on top of the +X
+    // neighbor: the top face's vertices at x = N only see the wall through the edge cells.
+    Chunk64 ground, sky, wall;
+    for (int z = 0; z < Chunk64::N; ++z) {
+        for (int y = 0; y < Chunk64::N; ++y) {
+            for (int x = 0; x < Chunk64::N; ++x) ground.set_voxel(x, y, z, MAT_ROCK);
+        }
+    }
+    for (int y = 0; y < Chunk64::N; ++y) wall.set_voxel(0, y, 0, MAT_ROCK);
+    auto slot = [](int dx, int dy, int dz) { return (dx + 1) + (dy + 1) * 3 + (dz + 1) * 9; };
+    const Chunk64* nbh[27] = {};
+    nbh[slot(1, 0, 0)] = &ground;
+    nbh[slot(0, 0, 1)] = &sky;
+    nbh[slot(1, 0, 1)] = &wall;
+    ChunkEdgeCells edges;
+    gather_edge_cells(nbh, edges);
+    auto edge_ao = [](const Mesh& m) {
+        int ao = 3;
+        for (const Vertex& v : m.vertices) {
+            if (v.nz == 1.0f && v.z == 64.0f && v.x == 64.0f) ao = std::min<int>(ao, v.ao);
+        }
+        return ao;
+    };
+    Mesh open_edge, walled_edge;
+    wf::mesh_chunk_greedy_neighbors(ground, nullptr, &ground, nullptr, nullptr, nullptr, &sky, open_edge, 1.0f);
+    wf::mesh_chunk_greedy_neighbors(ground, nullptr, &ground, nullptr, nullptr, nullptr, &sky, walled_edge, 1.0f,
+                                    nullptr, &edges);
+    expect("top AO at x = N without edge cells", edge_ao(open_edge), 3);
+    // Side and diagonal cells both lie in the wall: 3 - 1 - 1.
+    expect("top AO at x = N beside the edge wall", edge_ao(walled_edge), 1);
+
+    std::printf("%s\n", g_failures == 0 ? "All mesh checks passed" : "Mesh checks FAILED");
+    return g_failures == 0 ? 0 : 1;
 }
@@ -0,0 +1,188 @@
+// Live config change check: for each class of field a config reload can change (terrain,
+// ring growth and shrink, k window, loader and IO threads, remesh, camera), diff_configs must
+// group the change as expected and plan_streaming_diff must pick the expected response.
+// Each case is then applied to a running WorldStreamingSubsystem in the order WorldRuntime
+// uses, while a ring job is in flight: stop the loader, configure, then invalidate or
+// restart. The new planet config must be in place, generated chunks dropped on terrain
+// changes and kept otherwise, and a ring request under the new config must complete.
+// Exits non-zero when any check fails.
+// Usage: wf_config_diff_check [ring_radius] [root]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <optional>
+#include <string>
+#include <thread>
+
+#include "chunk.h"
+#include "config_loader.h"
+#include "planet.h"
+#include "wf_math.h"
+#include "world_streaming_subsystem.h"
+
+using namespace wf;
+
+static int g_failures = 0;
+
+static void check(bool ok, const char* name, const char* what) {
+    if (ok) return;
+    if (g_failures++ < 20) std::printf("FAIL %-22s %s\n", name, what);
+}
+
+struct Case {
+    const char* name;
+    std::function<void(AppConfig&)> change;
+    bool busy;  // the loader counts as busy when the plan is made
+    bool terrain, ring, ring_grew_only, loader_threads, remesh;
+    std::optional<int> keep;  // expected ring_delta_keep; the base ring radius stands in as kBase
+};
+
+static constexpr int kBase = -100;  // placeholder for "keep the old ring radius"
+
+static void configure(WorldStreamingSubsystem& streaming, const AppConfig& cfg) {
+    streaming.configure(cfg.planet_cfg, cfg.region_root, false, false, 8,
+                        cfg.loader_threads > 0 ? static_cast<std::size_t>(cfg.loader_threads) : 0);
+    streaming.set_class_threads(static_cast<std::size_t>(cfg.edit_threads), static_cast<std::size_t>(cfg.far_threads));
+    streaming.set_io_threads(static_cast<std::size_t>(cfg.io_threads), cfg.io_nice);
+}
+
+static uint64_t request_ring(WorldStreamingSubsystem& streaming, const AppConfig& cfg) {
+    const PlanetConfig& p = cfg.planet_cfg;
+    const Double3 dir = normalize(Double3{1.0, 0.3, 0.2});
+    const double r = p.radius_m + terrain_height_m(p, to_float3(dir)) + 1.7;
+    const int face = face_from_direction(dir);
+    double s = 0.0, t = 0.0;
+    face_grid_coords(face, dir, r, s, t);
+    const double chunk_m = p.voxel_size_m * Chunk64::N;
+    WorldStreamingSubsystem::LoadRequest req{};
+    req.face = face;
+    req.ring_radius = cfg.ring_radius;
+    req.ci = static_cast<std::int64_t>(std::floor(s / chunk_m));
+    req.cj = static_cast<std::int64_t>(std::floor(t / chunk_m));
+    req.ck = static_cast<std::int64_t>(std::floor(r / chunk_m));
+    req.k_down = cfg.k_down;
+    req.k_up = cfg.k_up;
+    return streaming.enqueue_request(req);
+}
+
+// Waits for the loader to finish and drains its mesh results; false on timeout.
+static bool wait_idle(WorldStreamingSubsystem& streaming, int& results) {
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(600);
+    WorldStreamingSubsystem::MeshResult res;
+    for (;;) {
+        while (streaming.try_pop_result(res)) ++results;
+        if (streaming.loader_idle() && streaming.result_queue_depth() == 0) return true;
+        if (std::chrono::steady_clock::now() > deadline) return false;
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+}
+
+static std::size_t cached_chunks(const WorldStreamingSubsystem& streaming) {
+    return streaming.manager().chunk_cache().size();
+}
+
+int main(int argc, char** argv) {
+    AppConfig base;
+    base.ring_radius = 2;
+    base.k_down = 1;
+    base.k_up = 1;
+    base.loader_threads = 2;
+    base.region_root = "config_diff_check";
+    if (argc > 1) base.ring_radius = std::max(1, std::atoi(argv[1]));
+    if (argc > 2) base.region_root = argv[2];
+
+    const Case cases[] = {
+        {"terrain", [](AppConfig& c) { c.planet_cfg.terrain_amp_m += 4.0; }, true, true, false, false, false, false, {}},
+        {"terrain + ring", [](AppConfig& c) { c.planet_cfg.seed += 1; c.ring_radius += 1; }, true, true, true, true, false,
+         false, {}},
+        {"ring growth", [](AppConfig& c) { c.ring_radius += 1; }, false, false, true, true, false, false, kBase},
+        {"ring shrink", [](AppConfig& c) { c.ring_radius -= 1; }, false, false, true, false, false, false, {}},
+        {"k change", [](AppConfig& c) { c.k_up += 1; }, false, false, true, false, false, false, -1},
+        {"ring growth + k", [](AppConfig& c) { c.ring_radius += 1; c.k_down += 1; }, false, false, true, false, false,
+         false, -1},
+        {"loader threads idle", [](AppConfig& c) { c.loader_threads += 1; }, false, false, false, false, true, false, {}},
+        {"loader threads busy", [](AppConfig& c) { c.loader_threads += 1; }, true, false, false, false, true, false, -1},
+        {"edit threads", [](AppConfig& c) { c.edit_threads += 1; }, false, false, false, false, true, false, {}},
+        {"io threads", [](AppConfig& c) { c.io_threads += 1; c.io_nice = 2; }, false, false, false, false, true, false, {}},
+        {"far threads + growth", [](AppConfig& c) { c.far_threads = 1; c.ring_radius += 1; }, true, false, true, true,
+         true, false, -1},
+        {"remesh", [](AppConfig& c) { c.surface_push_m += 0.05f; }, false, false, false, false, false, true, -1},
+        {"camera only", [](AppConfig& c) { c.cam_speed *= 2.0f; }, true, false, false, false, false, false, {}},
+    };
+
+    // Groups and plans alone.
+    for (const Case& cs : cases) {
+        AppConfig after = base;
+        cs.change(after);
+        const AppConfigDiff diff = diff_configs(base, after);
+        check(!diff.empty(), cs.name, "diff is empty");
+        check(diff.terrain == cs.terrain, cs.name, "terrain group");
+        check(diff.ring == cs.ring, cs.name, "ring group");
+        check(diff.ring_grew_only == cs.ring_grew_only, cs.name, "ring_grew_only");
+        check(diff.loader_threads == cs.loader_threads, cs.name, "loader_threads group");
+        check(diff.remesh == cs.remesh, cs.name, "remesh group");
+
+        const StreamingDiffPlan plan = plan_streaming_diff(diff, base, after, cs.busy);
+        check(plan.stop_loader == cs.terrain, cs.name, "plan stops the loader");
+        check(plan.invalidate == cs.terrain, cs.name, "plan invalidates");
+        check(plan.restart_loader == (cs.loader_threads && !cs.terrain), cs.name, "plan restarts the loader");
+        const std::optional<int> keep = cs.keep && *cs.keep == kBase ? std::optional<int>(base.ring_radius) : cs.keep;
+        check(plan.ring_delta_keep == keep, cs.name, "plan ring delta");
+    }
+    check(diff_configs(base, base).empty(), "identical", "diff is not empty");
+
+    // Each change applied to a running subsystem with a ring job in flight.
+    WorldStreamingSubsystem streaming;
+    configure(streaming, base);
+    streaming.start();
+    int results = 0;
+    request_ring(streaming, base);
+    check(wait_idle(streaming, results), "warmup", "ring job did not finish");
+    check(cached_chunks(streaming) > 0, "warmup", "ring job cached no chunks");
+
+    AppConfig current = base;
+    std::size_t settled = cached_chunks(streaming);  // read only while the loader is idle
+    for (const Case& cs : cases) {
+        AppConfig after = current;
+        cs.change(after);
+        const AppConfigDiff diff = diff_configs(current, after);
+        request_ring(streaming, current);
+        const StreamingDiffPlan plan = plan_streaming_diff(diff, current, after, !streaming.loader_idle());
+
+        if (plan.stop_loader) streaming.stop_workers();
+        configure(streaming, after);
+        if (plan.invalidate) {
+            streaming.invalidate_generated();
+            check(cached_chunks(streaming) == 0, cs.name, "generated chunks survived invalidation");
+        } else if (plan.restart_loader) {
+            streaming.restart_workers();
+        }
+        check(streaming.manager().current_stamp() == generator_stamp(after.planet_cfg), cs.name, "stamp is stale");
+        check(planet_config_hash(streaming.manager().planet_config()) == planet_config_hash(after.planet_cfg), cs.name,
+              "planet config not applied");
+
+        // What WorldRuntime requests next: a restream after invalidation, otherwise the ring.
+        request_ring(streaming, after);
+        const bool idle = wait_idle(streaming, results);
+        check(idle, cs.name, "ring job under the new config did not finish");
+        const std::size_t chunks = cached_chunks(streaming);
+        check(chunks > 0, cs.name, "ring job cached no chunks");
+        if (!plan.invalidate) check(chunks >= settled, cs.name, "cached chunks dropped without a terrain change");
+        std::printf("%-22s %-40s plan:%s%s%s keep %-3s chunks %5zu -> %5zu  %s\n", cs.name,
+                    describe_config_diff(diff).c_str(), plan.stop_loader ? " stop" : "",
+                    plan.invalidate ? " invalidate" : "", plan.restart_loader ? " restart" : "",
+                    plan.ring_delta_keep ? std::to_string(*plan.ring_delta_keep).c_str() : "-", settled, chunks,
+                    idle ? "ok" : "FAIL");
+        settled = chunks;
+        current = after;
+    }
+    streaming.stop();
+
+    std::printf("mesh results %d\n", results);
+    std::printf("%s\n", g_failures == 0 ? "All config diff checks passed" : "Config diff checks FAILED");
+    return g_failures == 0 ? 0 : 1;
+}
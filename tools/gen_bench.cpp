@@ -0,0 +1,123 @@
+// Base generation benchmark: generates the chunks of a few consecutive ring jobs (camera
+// stepping one chunk along +i per job, k_down + k_up + 1 shells per column) once with a
+// height tile built per chunk and once through the shared HeightTileCache, and reports
+// the terrain height evaluations and time of each. A last pass keeps only the shells each
+// column's terrain bounds reach (as ring jobs do) and checks the skipped ones above are air.
+// Usage: wf_gen_bench [ring_radius] [k_down] [k_up] [jobs]
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+#include "base_generator.h"
+#include "height_tile_cache.h"
+#include "terrain_pyramid.h"
+
+using namespace wf;
+
+static void report(const char* name, std::size_t chunks, uint64_t height_evals, double ms, std::size_t solid) {
+    std::printf("%-16s chunks=%zu height_evals=%llu time=%.1f ms  %.3f ms/chunk  (solid voxels %zu)\n",
+                name, chunks, (unsigned long long)height_evals, ms,
+                chunks ? ms / static_cast<double>(chunks) : 0.0, solid);
+}
+
+int main(int argc, char** argv) {
+    int ring_radius = 2;
+    int k_down = 3;
+    int k_up = 3;
+    int jobs = 2;
+    if (argc > 1) ring_radius = std::max(0, std::atoi(argv[1]));
+    if (argc > 2) k_down = std::max(0, std::atoi(argv[2]));
+    if (argc > 3) k_up = std::max(0, std::atoi(argv[3]));
+    if (argc > 4) jobs = std::max(1, std::atoi(argv[4]));
+
+    PlanetConfig cfg;
+    const int N = Chunk64::N;
+    const double chunk_m = cfg.voxel_size_m * N;
+    const std::int64_t surface_k = static_cast<std::int64_t>(std::floor((cfg.radius_m + 0.5 * cfg.terrain_amp_m) / chunk_m));
+
+    std::vector<FaceChunkKey> keys;
+    for (int job = 0; job < jobs; ++job) {
+        for (int dj = -ring_radius; dj <= ring_radius; ++dj) {
+            for (int di = -ring_radius; di <= ring_radius; ++di) {
+                for (int dk = k_up; dk >= -k_down; --dk) {
+                    keys.push_back(FaceChunkKey{0, job + di, dj, surface_k + dk});
+                }
+            }
+        }
+    }
+    const uint64_t tile_evals = static_cast<uint64_t>(N) * N;
+
+    auto run = [&](auto&& heights_for) {
+        std::size_t solid = 0;
+        Chunk64 chunk;
+        uint64_t open_sky[Chunk64::N];
+        auto t0 = std::chrono::steady_clock::now();
+        for (const FaceChunkKey& key : keys) {
+            std::shared_ptr<const HeightTile> heights = heights_for(key);
+            generate_base_chunk(cfg, key, *heights, chunk, open_sky);
+            for (uint64_t w : chunk.occ) solid += static_cast<std::size_t>(std::popcount(w));
+        }
+        return std::make_pair(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count(), solid);
+    };
+
+    uint64_t per_chunk_evals = 0;
+    auto [per_chunk_ms, per_chunk_solid] = run([&](const FaceChunkKey& key) {
+        auto tile = std::make_shared<HeightTile>();
+        build_height_tile(cfg, key.face, key.i, key.j, *tile);
+        per_chunk_evals += tile_evals;
+        return std::shared_ptr<const HeightTile>(std::move(tile));
+    });
+    HeightTileCache cache;
+    auto [cached_ms, cached_solid] = run([&](const FaceChunkKey& key) { return cache.get(cfg, key.face, key.i, key.j); });
+    const HeightTileCache::Stats st = cache.stats();
+    const uint64_t cached_evals = st.misses * tile_evals;
+
+    std::printf("ring radius %d, shells %d, jobs %d\n", ring_radius, k_down + k_up + 1, jobs);
+    report("per-chunk tiles", keys.size(), per_chunk_evals, per_chunk_ms, per_chunk_solid);
+    report("cached tiles", keys.size(), cached_evals, cached_ms, cached_solid);
+    std::printf("height evaluations saved: %.1f%%  (tile hits %llu, misses %llu)\n",
+                per_chunk_evals ? 100.0 * (1.0 - static_cast<double>(cached_evals) / static_cast<double>(per_chunk_evals)) : 0.0,
+                (unsigned long long)st.hits, (unsigned long long)st.misses);
+    if (per_chunk_solid != cached_solid) {
+        std::printf("MISMATCH: cached generation produced different voxels\n");
+        return 1;
+    }
+
+    // Surface band: the same margin and headroom shell as WorldStreamingSubsystem.
+    TerrainHeightPyramid pyramid;
+    pyramid.set_config(cfg);
+    std::vector<FaceChunkKey> band_keys;
+    std::size_t above = 0, below = 0, above_solid = 0;
+    Chunk64 chunk;
+    uint64_t open_sky[Chunk64::N];
+    for (const FaceChunkKey& key : keys) {
+        std::int64_t k_lo = 0, k_hi = 0;
+        surface_shell_range(cfg, pyramid.column_bounds(key), 8.0, k_lo, k_hi);
+        ++k_hi;
+        if (key.k >= k_lo && key.k <= k_hi) {
+            band_keys.push_back(key);
+        } else if (key.k > k_hi) {
+            ++above;
+            generate_base_chunk(cfg, key, *cache.get(cfg, key.face, key.i, key.j), chunk, open_sky);
+            for (uint64_t w : chunk.occ) above_solid += static_cast<std::size_t>(std::popcount(w));
+        } else {
+            ++below;
+        }
+    }
+    keys = band_keys;
+    HeightTileCache band_cache;
+    auto [band_ms, band_solid] = run([&](const FaceChunkKey& key) { return band_cache.get(cfg, key.face, key.i, key.j); });
+    report("surface band", keys.size(), band_cache.stats().misses * tile_evals, band_ms, band_solid);
+    std::printf("band skipped %zu above, %zu below  (solid voxels above %zu)\n", above, below, above_solid);
+    if (above_solid != 0) {
+        std::printf("MISMATCH: a skipped shell above the band holds terrain\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,122 @@
+// Headless light engine check: lights small scripted scenes, applies edits through the
+// incremental passes and compares light levels against hand-computed values.
+// Exits non-zero when any check fails.
+
+#include <cstdio>
+#include <cstdint>
+#include <vector>
+
+#include "chunk.h"
+#include "light_engine.h"
+
+using namespace wf;
+
+static int g_failures = 0;
+
+static void expect(const char* what, int got, int want) {
+    std::printf("%-44s got %2d want %2d  %s\n", what, got, want, got == want ? "ok" : "FAIL");
+    if (got != want) ++g_failures;
+}
+
+static int sky_at(const Chunk64& c, int x, int y, int z) { return light_sky(c.light.get(Chunk64::lindex(x, y, z))); }
+static int block_at(const Chunk64& c, int x, int y, int z) { return light_block(c.light.get(Chunk64::lindex(x, y, z))); }
+
+// Rock below z = ground, air above (z points away from the planet).
+static void fill_ground(Chunk64& c, int ground) {
+    for (int z = 0; z < Chunk64::N; ++z)
+        for (int y = 0; y < Chunk64::N; ++y)
+            for (int x = 0; x < Chunk64::N; ++x) c.set_voxel(x, y, z, z < ground ? MAT_ROCK : MAT_AIR);
+}
+
+// Sets voxels of the neighborhood center and runs the incremental relight for them.
+static uint32_t edit(LightNeighborhood& nbh, const std::vector<uint32_t>& voxels, uint16_t mat) {
+    Chunk64& c = *nbh.chunks[LightNeighborhood::kCenter];
+    for (uint32_t i : voxels) {
+        c.set_voxel(static_cast<int>(i % Chunk64::N), static_cast<int>((i / Chunk64::N) % Chunk64::N),
+                    static_cast<int>(i / (Chunk64::N * Chunk64::N)), mat);
+    }
+    return relight_edit(nbh, voxels);
+}
+
+int main() {
+    std::vector<uint64_t> open_sky(Chunk64::N, ~0ull);
+
+    // Open ground under full sky.
+    Chunk64 a;
+    fill_ground(a, 20);
+    light_chunk(a, nullptr, open_sky.data());
+    expect("sky above ground", sky_at(a, 5, 5, 40), 15);
+    expect("sky on the ground layer", sky_at(a, 5, 5, 20), 15);
+    expect("sky inside rock", sky_at(a, 5, 5, 19), 0);
+
+    LightNeighborhood nbh;
+    nbh.chunks[LightNeighborhood::kCenter] = &a;
+
+    // A 7x7 roof at z = 30: the cell under its middle is lit sideways, 4 steps from open sky.
+    std::vector<uint32_t> roof;
+    for (int y = 19; y <= 25; ++y)
+        for (int x = 19; x <= 25; ++x) roof.push_back(Chunk64::lindex(x, y, 30));
+    edit(nbh, roof, MAT_ROCK);
+    expect("sky under roof center", sky_at(a, 22, 22, 29), 11);
+    expect("sky under roof center, ground", sky_at(a, 22, 22, 20), 11);
+    expect("sky under roof edge", sky_at(a, 19, 22, 25), 14);
+    expect("sky on the roof", sky_at(a, 22, 22, 31), 15);
+    edit(nbh, roof, MAT_AIR);
+    expect("sky after roof removal", sky_at(a, 22, 22, 29), 15);
+
+    // Lava on the ground emits block light that fades by one per step and goes away with it.
+    const uint32_t lava = Chunk64::lindex(40, 40, 20);
+    edit(nbh, {lava}, MAT_LAVA);
+    expect("block light of lava", block_at(a, 40, 40, 20), 15);
+    expect("block light next to lava", block_at(a, 40, 40, 21), 14);
+    expect("block light 4 steps away", block_at(a, 44, 40, 20), 11);
+    edit(nbh, {lava}, MAT_AIR);
+    expect("block light after lava removal", block_at(a, 44, 40, 20), 0);
+
+    // Light crosses into the +X neighbor, and the edit reports that chunk as changed.
+    Chunk64 b;
+    fill_ground(b, 20);
+    light_chunk(b, nullptr, open_sky.data());
+    nbh.chunks[LightNeighborhood::slot(1, 0, 0)] = &b;
+    uint32_t slots = edit(nbh, {Chunk64::lindex(62, 10, 20)}, MAT_LAVA);
+    expect("block light across the chunk seam", block_at(b, 2, 10, 20), 11);
+    expect("+X neighbor reported changed", (slots >> LightNeighborhood::slot(1, 0, 0)) & 1u, 1);
+    edit(nbh, {Chunk64::lindex(62, 10, 20)}, MAT_AIR);
+    expect("seam light after lava removal", block_at(b, 2, 10, 20), 0);
+
+    // A sealed tunnel only lights up once it gathers from its lit -X neighbor.
+    Chunk64 rock;
+    rock.fill_all_solid(MAT_ROCK);
+    for (int x = 0; x <= 10; ++x) rock.set_voxel(x, 5, 5, MAT_AIR);
+    light_chunk(rock, nullptr, nullptr);
+    expect("sealed tunnel before gather", sky_at(rock, 0, 5, 5), 0);
+    Chunk64 air;
+    air.fill_all_air();
+    light_chunk(air, nullptr, open_sky.data());
+    const Chunk64* nb[6] = {&air, nullptr, nullptr, nullptr, nullptr, nullptr};
+    ChunkLight gathered;
+    bool brightened = light_gather(rock, nb, gathered);
+    rock.light = std::move(gathered);
+    expect("gather brightened the tunnel", brightened ? 1 : 0, 1);
+    expect("tunnel mouth", sky_at(rock, 0, 5, 5), 14);
+    expect("tunnel end", sky_at(rock, 10, 5, 5), 4);
+
+    // Water is not opaque: sunlight reaches the floor of a pool.
+    Chunk64 pool;
+    fill_ground(pool, 20);
+    for (int z = 20; z < 30; ++z)
+        for (int y = 0; y < Chunk64::N; ++y)
+            for (int x = 0; x < Chunk64::N; ++x) pool.set_voxel(x, y, z, MAT_WATER);
+    light_chunk(pool, nullptr, open_sky.data());
+    expect("sky at the bottom of a pool", sky_at(pool, 5, 5, 20), 15);
+
+    // Full sunlight continues down a shaft into the chunk below.
+    Chunk64 below;
+    below.fill_all_solid(MAT_ROCK);
+    for (int z = 0; z < Chunk64::N; ++z) below.set_voxel(7, 7, z, MAT_AIR);
+    light_chunk(below, &air, nullptr);
+    expect("shaft bottom keeps full sky", sky_at(below, 7, 7, 0), 15);
+
+    std::printf("%s\n", g_failures == 0 ? "All light checks passed" : "Light checks FAILED");
+    return g_failures == 0 ? 0 : 1;
+}
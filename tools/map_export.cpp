@@ -0,0 +1,461 @@
+// Planet map export: renders layers of the base world and of the saved player state over a
+// whole-planet projection, with rows tiled across threads. Heights come straight from
+// terrain_height_uv per pixel; surface materials and cave noise from batched row samples.
+// Layers (one PPM each, <out_prefix>_<layer>.ppm):
+//   height     terrain height, blue where the surface lies below sea level
+//   material   material of the topmost voxel under the surface, in materials.cfg colors
+//   cave       cave noise on a shell cave_depth_m below the surface, red where it carves
+//   deltas     chunk columns with region files (blue) and edited voxels (red) under region_root
+//   residency  chunk shells per column that reach the surface: what streaming generates
+//              and meshes there (from the terrain height pyramid, loaded from and saved
+//              back to <region_root>/terrain_pyramid.bin)
+// Planet, region root and materials come from wanderforge.cfg and WF_* like the game.
+// Finishes by timing the old per-pixel surface bisection on a sparse subset of pixels.
+// Usage: wf_mapexport [equirect|cubenet|face0..face5] [size] [layers|all] [out_prefix] [threads] [cave_depth_m]
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "chunk.h"
+#include "chunk_delta.h"
+#include "config_loader.h"
+#include "material_table.h"
+#include "planet.h"
+#include "region_io.h"
+#include "terrain_pyramid.h"
+#include "wf_math.h"
+
+using namespace wf;
+namespace fs = std::filesystem;
+
+namespace {
+
+enum class Projection { Equirect, CubeNet, Face };
+
+enum Layer : int { kHeight, kMaterial, kCave, kDeltas, kResidency, kLayerCount };
+const char* const kLayerNames[kLayerCount] = {"height", "material", "cave", "deltas", "residency"};
+
+struct MapSpec {
+    Projection projection = Projection::Equirect;
+    int face = 0;
+    int size = 1024; // pixels per cube face side, or the equirect map height
+    int width = 0;
+    int height = 0;
+};
+
+// Saved state per chunk column (k = 0 in the key), summed over its shells.
+struct ColumnEdits {
+    uint64_t edits = 0;
+    bool region = false;
+};
+using EditMap = std::unordered_map<FaceChunkKey, ColumnEdits, FaceChunkKeyHash>;
+
+struct Rgb { uint8_t r, g, b; };
+
+Rgb lerp_rgb(Rgb a, Rgb b, double t) {
+    t = std::clamp(t, 0.0, 1.0);
+    return Rgb{static_cast<uint8_t>(a.r + (b.r - a.r) * t), static_cast<uint8_t>(a.g + (b.g - a.g) * t),
+               static_cast<uint8_t>(a.b + (b.b - a.b) * t)};
+}
+
+// Unit direction under pixel (x, y); false outside the projection (cube net margins).
+bool pixel_direction(const MapSpec& spec, int x, int y, Float3& dir) {
+    switch (spec.projection) {
+    case Projection::Face: {
+        const float u = float((x + 0.5) / spec.size * 2.0 - 1.0);
+        const float v = float(1.0 - (y + 0.5) / spec.size * 2.0);
+        dir = direction_from_face_uv(spec.face, u, v);
+        return true;
+    }
+    case Projection::Equirect: {
+        const double lon = (x + 0.5) / spec.width * 2.0 * M_PI - M_PI;
+        const double lat = 0.5 * M_PI - (y + 0.5) / spec.height * M_PI;
+        dir = direction_from_lat_lon(lat, lon);
+        return true;
+    }
+    case Projection::CubeNet: {
+        // Cross layout seen from outside: -X, +Z, +X, -Z around the middle row, +Y above
+        // and -Y below +Z; neighboring cells share their edges.
+        const int cx = x / spec.size, cy = y / spec.size;
+        const float a = float(((x % spec.size) + 0.5) / spec.size * 2.0 - 1.0);
+        const float b = float(1.0 - ((y % spec.size) + 0.5) / spec.size * 2.0);
+        if (cy == 1) {
+            switch (cx) {
+            case 0: dir = Float3{-1.0f, b, a}; break;
+            case 1: dir = Float3{a, b, 1.0f}; break;
+            case 2: dir = Float3{1.0f, b, -a}; break;
+            default: dir = Float3{-a, b, -1.0f}; break;
+            }
+        } else if (cx == 1) {
+            dir = cy == 0 ? Float3{a, 1.0f, -b} : Float3{a, -1.0f, b};
+        } else {
+            return false;
+        }
+        dir = normalize(dir);
+        return true;
+    }
+    }
+    return false;
+}
+
+// Chunk column (k = 0) holding the direction in its dominant face's grid.
+FaceChunkKey column_key(const PlanetConfig& cfg, int face, const Float3& dir) {
+    const double chunk_m = cfg.voxel_size_m * Chunk64::N;
+    double S = 0.0, T = 0.0;
+    face_grid_coords(face, to_double3(dir), cfg.radius_m, S, T);
+    return FaceChunkKey{face, static_cast<std::int64_t>(std::floor(S / chunk_m)),
+                        static_cast<std::int64_t>(std::floor(T / chunk_m)), 0};
+}
+
+// Walks <root>/face{f}/k{k}/r_{i0}_{j0}.wfr and sums the saved edits of every chunk column.
+EditMap load_column_edits(const std::string& root, std::size_t& regions) {
+    EditMap out;
+    regions = 0;
+    std::error_code ec;
+    if (!fs::is_directory(root, ec)) return out;
+    constexpr int kTile = 32;
+    for (const auto& entry : fs::recursive_directory_iterator(root, ec)) {
+        if (!entry.is_regular_file()) continue;
+        int face = -1;
+        long long k = 0, i0 = 0, j0 = 0;
+        const std::string face_dir = entry.path().parent_path().parent_path().filename().string();
+        const std::string k_dir = entry.path().parent_path().filename().string();
+        const std::string name = entry.path().filename().string();
+        if (std::sscanf(face_dir.c_str(), "face%d", &face) != 1 || face < 0 || face > 5) continue;
+        if (std::sscanf(k_dir.c_str(), "k%lld", &k) != 1) continue;
+        if (std::sscanf(name.c_str(), "r_%lld_%lld.wfr", &i0, &j0) != 2) continue;
+        std::vector<FaceChunkKey> keys;
+        keys.reserve(kTile * kTile);
+        for (int tj = 0; tj < kTile; ++tj) {
+            for (int ti = 0; ti < kTile; ++ti) keys.push_back(FaceChunkKey{face, i0 + ti, j0 + tj, k});
+        }
+        std::vector<std::optional<ChunkDelta>> deltas;
+        RegionIO::load_chunk_deltas(keys, deltas, kTile, root);
+        for (std::size_t n = 0; n < keys.size(); ++n) {
+            ColumnEdits& column = out[FaceChunkKey{face, keys[n].i, keys[n].j, 0}];
+            column.region = true;
+            if (n < deltas.size() && deltas[n]) column.edits += deltas[n]->edit_count();
+        }
+        ++regions;
+    }
+    return out;
+}
+
+// The ring map's old surface search: 24 bisection steps of sample_base along the direction.
+double bisect_surface_radius(const PlanetConfig& cfg, const Float3& dir) {
+    double low = cfg.radius_m - 200.0;
+    double high = cfg.radius_m + 200.0;
+    auto is_solid_at = [&](double r) {
+        Float3 p = {dir.x * (float)r, dir.y * (float)r, dir.z * (float)r};
+        Int3 v{(i64)std::llround(p.x / cfg.voxel_size_m), (i64)std::llround(p.y / cfg.voxel_size_m),
+               (i64)std::llround(p.z / cfg.voxel_size_m)};
+        return sample_base(cfg, v).material != MAT_AIR;
+    };
+    if (!is_solid_at(low)) low = cfg.radius_m - 400.0;
+    if (is_solid_at(high)) high = cfg.radius_m + 400.0;
+    for (int i = 0; i < 24; ++i) {
+        double mid = 0.5 * (low + high);
+        if (is_solid_at(mid)) low = mid; else high = mid;
+    }
+    return low;
+}
+
+void write_ppm(const std::string& path, int W, int H, const std::vector<uint8_t>& rgb) {
+    FILE* f = std::fopen(path.c_str(), "wb");
+    if (!f) { std::perror("fopen"); std::exit(1); }
+    std::fprintf(f, "P6\n%d %d\n255\n", W, H);
+    std::fwrite(rgb.data(), 1, rgb.size(), f);
+    std::fclose(f);
+}
+
+struct Renderer {
+    const PlanetConfig& cfg;
+    const MapSpec& spec;
+    const std::array<bool, kLayerCount>& enabled;
+    const EditMap& edits;
+    TerrainHeightPyramid& bounds;
+    double cave_depth_m;
+    std::array<std::vector<uint8_t>, kLayerCount>& images;
+
+    // Scratch of one worker, reused across its rows.
+    struct Row {
+        std::vector<Float3> dir;
+        std::vector<int> face;
+        std::vector<double> height;
+        std::vector<int> pixel; // x of the valid pixels, in order
+        std::vector<Int3> voxels;
+        std::vector<BaseSample> samples;
+        std::vector<float> xs, ys, zs, cave;
+        FaceChunkKey last_key{-1, 0, 0, 0};
+        int last_shells = 0;
+    };
+
+    void put(Layer layer, int x, int y, Rgb c) const {
+        uint8_t* p = images[layer].data() + (static_cast<std::size_t>(y) * spec.width + x) * 3;
+        p[0] = c.r; p[1] = c.g; p[2] = c.b;
+    }
+
+    Rgb height_color(double h) const {
+        const double t = cfg.terrain_amp_m > 0.0 ? h / cfg.terrain_amp_m : 0.0;
+        if (cfg.radius_m + h < cfg.sea_level_m) {
+            return lerp_rgb(Rgb{10, 25, 80}, Rgb{40, 90, 170}, 1.0 - (cfg.sea_level_m - cfg.radius_m - h) / 20.0);
+        }
+        return t < 0.6 ? lerp_rgb(Rgb{40, 90, 40}, Rgb{130, 110, 70}, t / 0.6)
+                       : lerp_rgb(Rgb{130, 110, 70}, Rgb{240, 240, 240}, (t - 0.6) / 0.4);
+    }
+
+    void render_row(int y, Row& row) const {
+        const int W = spec.width;
+        row.dir.resize(W);
+        row.face.resize(W);
+        row.height.resize(W);
+        row.pixel.clear();
+        for (int x = 0; x < W; ++x) {
+            Float3 dir{};
+            if (!pixel_direction(spec, x, y, dir)) continue;
+            int face = 0;
+            float u = 0.0f, v = 0.0f;
+            if (spec.projection == Projection::Face) {
+                face = spec.face;
+                u = float((x + 0.5) / spec.size * 2.0 - 1.0);
+                v = float(1.0 - (y + 0.5) / spec.size * 2.0);
+            } else {
+                face_uv_from_direction(dir, face, u, v);
+            }
+            row.dir[x] = dir;
+            row.face[x] = face;
+            row.height[x] = terrain_height_uv(cfg, u, v);
+            row.pixel.push_back(x);
+        }
+        const std::size_t n = row.pixel.size();
+
+        if (enabled[kHeight]) {
+            for (int x : row.pixel) put(kHeight, x, y, height_color(row.height[x]));
+        }
+
+        if (enabled[kMaterial]) {
+            // The voxel a voxel-length under the surface, sampled as one batch per row.
+            row.voxels.resize(n);
+            row.samples.resize(n);
+            for (std::size_t i = 0; i < n; ++i) {
+                const int x = row.pixel[i];
+                const float r = float(cfg.radius_m + row.height[x] - cfg.voxel_size_m);
+                const Float3& d = row.dir[x];
+                row.voxels[i] = Int3{(i64)std::llround(d.x * r / cfg.voxel_size_m), (i64)std::llround(d.y * r / cfg.voxel_size_m),
+                                     (i64)std::llround(d.z * r / cfg.voxel_size_m)};
+            }
+            sample_base_batch(cfg, row.voxels, row.samples);
+            const MaterialTable& materials = material_table();
+            for (std::size_t i = 0; i < n; ++i) {
+                const float* c = materials.info(row.samples[i].material).color;
+                put(kMaterial, row.pixel[i], y, Rgb{static_cast<uint8_t>(std::clamp(c[0], 0.0f, 1.0f) * 255.0f),
+                                                    static_cast<uint8_t>(std::clamp(c[1], 0.0f, 1.0f) * 255.0f),
+                                                    static_cast<uint8_t>(std::clamp(c[2], 0.0f, 1.0f) * 255.0f)});
+            }
+        }
+
+        if (enabled[kCave]) {
+            row.xs.resize(n);
+            row.ys.resize(n);
+            row.zs.resize(n);
+            row.cave.resize(n);
+            for (std::size_t i = 0; i < n; ++i) {
+                const int x = row.pixel[i];
+                const float r = float(cfg.radius_m + row.height[x] - cave_depth_m);
+                row.xs[i] = row.dir[x].x * r;
+                row.ys[i] = row.dir[x].y * r;
+                row.zs[i] = row.dir[x].z * r;
+            }
+            cave_noise_batch(cfg, row.xs.data(), row.ys.data(), row.zs.data(), n, row.cave.data());
+            for (std::size_t i = 0; i < n; ++i) {
+                const float c = row.cave[i];
+                const double t = 0.5 * (double(c) + 1.0);
+                put(kCave, row.pixel[i], y, c > kCaveNoiseThreshold ? lerp_rgb(Rgb{150, 40, 30}, Rgb{255, 120, 60}, t)
+                                                                    : lerp_rgb(Rgb{0, 0, 0}, Rgb{200, 200, 200}, t));
+            }
+        }
+
+        if (enabled[kDeltas]) {
+            for (int x : row.pixel) {
+                const double t = cfg.terrain_amp_m > 0.0 ? row.height[x] / cfg.terrain_amp_m : 0.0;
+                Rgb c = lerp_rgb(Rgb{30, 30, 30}, Rgb{90, 90, 90}, t);
+                auto it = edits.find(column_key(cfg, row.face[x], row.dir[x]));
+                if (it != edits.end()) {
+                    if (it->second.edits > 0) {
+                        const double e = std::log2(1.0 + double(it->second.edits)) / 16.0;
+                        c = lerp_rgb(Rgb{150, 40, 40}, Rgb{255, 230, 120}, e);
+                    } else {
+                        c = lerp_rgb(c, Rgb{50, 80, 200}, 0.6);
+                    }
+                }
+                put(kDeltas, x, y, c);
+            }
+        }
+
+        if (enabled[kResidency]) {
+            static const Rgb kHeat[] = {{0, 0, 0}, {30, 40, 140}, {30, 150, 60}, {220, 200, 40}, {230, 60, 30}};
+            const double chunk_m = cfg.voxel_size_m * Chunk64::N;
+            for (int x : row.pixel) {
+                const FaceChunkKey key = column_key(cfg, row.face[x], row.dir[x]);
+                if (!(key == row.last_key)) {
+                    const HeightBounds b = bounds.column_bounds(key);
+                    const auto k0 = static_cast<std::int64_t>(std::floor((cfg.radius_m + b.min_m) / chunk_m));
+                    const auto k1 = static_cast<std::int64_t>(std::floor((cfg.radius_m + b.max_m) / chunk_m));
+                    row.last_key = key;
+                    row.last_shells = static_cast<int>(k1 - k0 + 1);
+                }
+                put(kResidency, x, y, kHeat[std::clamp(row.last_shells, 0, 4)]);
+            }
+        }
+    }
+};
+
+} // namespace
+
+int main(int argc, char** argv) {
+    MapSpec spec;
+    std::string projection = "equirect";
+    std::string layers = "all";
+    std::string out = "map";
+    int threads = 0;
+    double cave_depth_m = 6.0;
+    if (argc > 1) projection = argv[1];
+    if (argc > 2) spec.size = std::max(16, std::atoi(argv[2]));
+    if (argc > 3) layers = argv[3];
+    if (argc > 4) out = argv[4];
+    if (argc > 5) threads = std::max(0, std::atoi(argv[5]));
+    if (argc > 6) cave_depth_m = std::max(kCaveMinDepthM, std::atof(argv[6]));
+
+    if (projection == "equirect") {
+        spec.projection = Projection::Equirect;
+        spec.width = spec.size * 2;
+        spec.height = spec.size;
+    } else if (projection == "cubenet") {
+        spec.projection = Projection::CubeNet;
+        spec.width = spec.size * 4;
+        spec.height = spec.size * 3;
+    } else if (projection.size() == 5 && projection.compare(0, 4, "face") == 0 && projection[4] >= '0' && projection[4] <= '5') {
+        spec.projection = Projection::Face;
+        spec.face = projection[4] - '0';
+        spec.width = spec.height = spec.size;
+    } else {
+        std::fprintf(stderr, "unknown projection '%s' (equirect, cubenet, face0..face5)\n", projection.c_str());
+        return 1;
+    }
+
+    std::array<bool, kLayerCount> enabled{};
+    for (std::size_t start = 0; start <= layers.size();) {
+        std::size_t end = layers.find(',', start);
+        if (end == std::string::npos) end = layers.size();
+        const std::string name = layers.substr(start, end - start);
+        bool known = name == "all";
+        for (int l = 0; l < kLayerCount; ++l) {
+            if (name == "all" || name == kLayerNames[l]) { enabled[l] = true; known = true; }
+        }
+        if (!known) {
+            std::fprintf(stderr, "unknown layer '%s' (height, material, cave, deltas, residency, all)\n", name.c_str());
+            return 1;
+        }
+        start = end + 1;
+    }
+
+    AppConfigManager config{AppConfig{}};
+    config.reload();
+    const PlanetConfig cfg = config.active().planet_cfg;
+    const std::string region_root = config.active().region_root;
+    if (enabled[kMaterial]) {
+        const char* env = std::getenv("WF_MATERIALS");
+        const std::string path = env ? env : "materials.cfg";
+        std::error_code ec;
+        if (fs::exists(path, ec)) {
+            MaterialTable table;
+            std::string error;
+            if (table.load_file(path, &error)) set_material_table(std::move(table));
+            else std::fprintf(stderr, "%s: %s (built-in materials)\n", path.c_str(), error.c_str());
+        }
+    }
+
+    TerrainHeightPyramid bounds;
+    bounds.set_config(cfg);
+    const std::string pyramid_path = (fs::path(region_root) / "terrain_pyramid.bin").string();
+    if (enabled[kResidency]) bounds.load(pyramid_path);
+    EditMap edits;
+    if (enabled[kDeltas]) {
+        std::size_t regions = 0;
+        edits = load_column_edits(region_root, regions);
+        std::printf("%zu region files, %zu chunk columns under %s\n", regions, edits.size(), region_root.c_str());
+    }
+
+    std::array<std::vector<uint8_t>, kLayerCount> images;
+    for (int l = 0; l < kLayerCount; ++l) {
+        if (enabled[l]) images[l].assign(static_cast<std::size_t>(spec.width) * spec.height * 3, 0);
+    }
+    const Renderer renderer{cfg, spec, enabled, edits, bounds, cave_depth_m, images};
+
+    // Workers take bands of rows until the map is done.
+    if (threads == 0) threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    constexpr int kBandRows = 8;
+    std::atomic<int> next_band{0};
+    auto worker = [&]() {
+        Renderer::Row row;
+        for (;;) {
+            const int y0 = next_band.fetch_add(kBandRows, std::memory_order_relaxed);
+            if (y0 >= spec.height) return;
+            for (int y = y0; y < std::min(spec.height, y0 + kBandRows); ++y) renderer.render_row(y, row);
+        }
+    };
+    const auto t0 = std::chrono::steady_clock::now();
+    std::vector<std::thread> pool;
+    for (int t = 1; t < threads; ++t) pool.emplace_back(worker);
+    worker();
+    for (std::thread& t : pool) t.join();
+    const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+
+    int layer_count = 0;
+    for (int l = 0; l < kLayerCount; ++l) {
+        if (!enabled[l]) continue;
+        const std::string path = out + "_" + kLayerNames[l] + ".ppm";
+        write_ppm(path, spec.width, spec.height, images[l]);
+        std::printf("Wrote %s (%dx%d)\n", path.c_str(), spec.width, spec.height);
+        ++layer_count;
+    }
+    const double pixels = double(spec.width) * double(spec.height);
+    std::printf("%d layers in %.1f ms on %d threads  %.1f ns/pixel\n", layer_count, ms, threads, ms * 1e6 / pixels);
+    if (enabled[kResidency]) {
+        // Hand the tiles built here on to later exports and the game, like the game does.
+        const TerrainHeightPyramid::Stats st = bounds.stats();
+        std::error_code ec;
+        const bool saved = st.tiles_built > 0 && fs::is_directory(region_root, ec) && bounds.save(pyramid_path);
+        std::printf("height pyramid: %zu tiles (%llu loaded, %llu built)%s\n", st.tiles, (unsigned long long)st.tiles_loaded,
+                    (unsigned long long)st.tiles_built, saved ? ", saved" : "");
+    }
+
+    // Reference: the per-pixel bisection on a sparse subset, scaled to the whole map.
+    const std::size_t total = static_cast<std::size_t>(spec.width) * spec.height;
+    const std::size_t stride = std::max<std::size_t>(1, total / 2000);
+    std::size_t probes = 0;
+    double sink = 0.0;
+    const auto r0 = std::chrono::steady_clock::now();
+    for (std::size_t p = stride / 2; p < total; p += stride) {
+        Float3 dir{};
+        if (!pixel_direction(spec, int(p % spec.width), int(p / spec.width), dir)) continue;
+        sink += bisect_surface_radius(cfg, dir);
+        ++probes;
+    }
+    const double ref_ns = probes ? std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - r0).count() / double(probes) : 0.0;
+    std::printf("per-pixel bisection (1 thread, %zu probes): %.1f ns/pixel, ~%.0f ms for the map  (%.1fx slower; checksum %.1f)\n",
+                probes, ref_ns, ref_ns * pixels * 1e-6, ms > 0.0 ? ref_ns * pixels * 1e-6 / ms : 0.0, sink);
+    return 0;
+}
@@ -0,0 +1,146 @@
+// Greedy meshing benchmark: generates and lights the surface-band chunks of a ring (plus a
+// border of neighbors) and meshes each ring chunk with its face neighbors three ways:
+// without AO (the mesher before AO, the cost baseline), with AO from the face neighbors
+// only, and with AO that also reads the edge and corner cells. Reports the time of each
+// (best of a few passes) and the AO cost against the 15% budget. Exits non-zero when the
+// edge cells change anything but AO.
+// Usage: wf_mesh_bench [ring_radius] [passes]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <unordered_map>
+#include <vector>
+
+#include "base_generator.h"
+#include "height_tile_cache.h"
+#include "light_engine.h"
+#include "mesh.h"
+#include "terrain_pyramid.h"
+
+using namespace wf;
+
+struct Neighborhood {
+    const Chunk64* chunks[27] = {};
+    const Chunk64* face(int dx, int dy, int dz) const { return chunks[LightNeighborhood::slot(dx, dy, dz)]; }
+};
+
+static bool same_geometry(const Mesh& a, const Mesh& b) {
+    if (a.vertices.size() != b.vertices.size() || a.indices != b.indices) return false;
+    for (std::size_t i = 0; i < a.vertices.size(); ++i) {
+        const Vertex& u = a.vertices[i];
+        const Vertex& v = b.vertices[i];
+        if (u.x != v.x || u.y != v.y || u.z != v.z || u.nx != v.nx || u.ny != v.ny || u.nz != v.nz ||
+            u.mat != v.mat || u.ao != v.ao || u.light != v.light) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    int ring_radius = 2;
+    int passes = 5;
+    if (argc > 1) ring_radius = std::max(0, std::atoi(argv[1]));
+    if (argc > 2) passes = std::max(1, std::atoi(argv[2]));
+
+    PlanetConfig cfg;
+    TerrainHeightPyramid pyramid;
+    pyramid.set_config(cfg);
+    HeightTileCache tiles;
+
+    // Surface band of every column, with the same margin and headroom shell as ring jobs;
+    // the border ring and the shells around each band are generated for neighbors only.
+    std::unordered_map<FaceChunkKey, Chunk64, FaceChunkKeyHash> chunks;
+    std::vector<FaceChunkKey> ring;
+    const int pad = ring_radius + 1;
+    for (int dj = -pad; dj <= pad; ++dj) {
+        for (int di = -pad; di <= pad; ++di) {
+            std::int64_t k_lo = 0, k_hi = 0;
+            surface_shell_range(cfg, pyramid.column_bounds(FaceChunkKey{0, di, dj, 0}), 8.0, k_lo, k_hi);
+            ++k_hi;
+            const bool in_ring = std::max(std::abs(di), std::abs(dj)) <= ring_radius;
+            // Light falls from the top shell down, so each chunk lights under the one above.
+            const Chunk64* above = nullptr;
+            for (std::int64_t k = k_hi + 1; k >= k_lo - 1; --k) {
+                const FaceChunkKey key{0, di, dj, k};
+                Chunk64& chunk = chunks[key];
+                uint64_t open_sky[Chunk64::N];
+                generate_base_chunk(cfg, key, *tiles.get(cfg, 0, di, dj), chunk, open_sky);
+                light_chunk(chunk, above, above ? nullptr : open_sky);
+                above = &chunk;
+                if (in_ring && k >= k_lo && k <= k_hi) ring.push_back(key);
+            }
+        }
+    }
+    std::vector<Neighborhood> nbhs(ring.size());
+    for (std::size_t n = 0; n < ring.size(); ++n) {
+        const FaceChunkKey& key = ring[n];
+        for (int dz = -1; dz <= 1; ++dz) {
+            for (int dy = -1; dy <= 1; ++dy) {
+                for (int dx = -1; dx <= 1; ++dx) {
+                    auto it = chunks.find(FaceChunkKey{key.face, key.i + dx, key.j + dy, key.k + dz});
+                    nbhs[n].chunks[LightNeighborhood::slot(dx, dy, dz)] = it != chunks.end() ? &it->second : nullptr;
+                }
+            }
+        }
+    }
+
+    const float voxel_m = static_cast<float>(cfg.voxel_size_m);
+    auto mesh_ring = [&](bool ao, bool edges, std::vector<Mesh>& out) {
+        out.resize(ring.size());
+        auto t0 = std::chrono::steady_clock::now();
+        for (std::size_t n = 0; n < ring.size(); ++n) {
+            const Neighborhood& nb = nbhs[n];
+            ChunkEdgeCells cells;
+            if (edges) gather_edge_cells(nb.chunks, cells);
+            mesh_chunk_greedy_neighbors(*nb.face(0, 0, 0), nb.face(-1, 0, 0), nb.face(1, 0, 0), nb.face(0, -1, 0),
+                                        nb.face(0, 1, 0), nb.face(0, 0, -1), nb.face(0, 0, 1), out[n], voxel_m,
+                                        nullptr, edges ? &cells : nullptr, ao);
+        }
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    };
+    auto vertices = [](const std::vector<Mesh>& meshes) {
+        std::size_t v = 0;
+        for (const Mesh& m : meshes) v += m.vertices.size();
+        return v;
+    };
+
+    // Modes alternate within each pass so warm-up and drift hit all of them alike.
+    std::vector<Mesh> plain, face_ao, edge_ao, plain_edges;
+    mesh_ring(false, true, plain_edges);
+    double plain_ms = 0.0, face_ms = 0.0, edge_ms = 0.0;
+    for (int p = 0; p < passes; ++p) {
+        const double a = mesh_ring(false, false, plain);
+        const double b = mesh_ring(true, false, face_ao);
+        const double c = mesh_ring(true, true, edge_ao);
+        plain_ms = p == 0 ? a : std::min(plain_ms, a);
+        face_ms = p == 0 ? b : std::min(face_ms, b);
+        edge_ms = p == 0 ? c : std::min(edge_ms, c);
+    }
+
+    std::printf("ring radius %d, %zu surface chunks, best of %d passes\n", ring_radius, ring.size(), passes);
+    auto report = [&](const char* name, double ms, const std::vector<Mesh>& meshes) {
+        std::printf("%-16s time=%.1f ms  %.3f ms/chunk  vertices=%zu  cost %+.1f%%\n", name, ms,
+                    ring.empty() ? 0.0 : ms / static_cast<double>(ring.size()), vertices(meshes),
+                    plain_ms > 0.0 ? 100.0 * (ms / plain_ms - 1.0) : 0.0);
+    };
+    report("no AO", plain_ms, plain);
+    report("AO, face nbrs", face_ms, face_ao);
+    report("AO + edge cells", edge_ms, edge_ao);
+    std::size_t changed = 0, mismatched = 0;
+    for (std::size_t n = 0; n < ring.size(); ++n) {
+        changed += same_geometry(face_ao[n], edge_ao[n]) ? 0 : 1;
+        mismatched += same_geometry(plain[n], plain_edges[n]) ? 0 : 1;
+    }
+    std::printf("edge cells changed the AO of %zu of %zu chunks\n", changed, ring.size());
+    const double cost = plain_ms > 0.0 ? 100.0 * (edge_ms / plain_ms - 1.0) : 0.0;
+    std::printf("AO cost %.1f%% of the mesh time without AO (budget 15%%): %s\n", cost, cost <= 15.0 ? "within" : "OVER");
+    if (mismatched != 0) {
+        std::printf("MISMATCH: edge cells changed %zu meshes without AO\n", mismatched);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,152 @@
+// Noise check and benchmark: pins fbm outputs of every basis per seed, checks the unrolled
+// fbm instantiations against the runtime-octave loops, checks the 2D slope bounds against
+// finite differences, then times the runtime fbm against the dispatched fbm2 of each basis.
+// Exits non-zero when any check fails.
+// Usage: wf_noise_bench [samples]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "wf_noise.h"
+
+using namespace wf;
+
+static int g_failures = 0;
+
+static void expect_near(const char* what, double got, double want, double tol) {
+    const bool ok = std::fabs(got - want) <= tol;
+    if (!ok) {
+        std::printf("%-44s got %.9f want %.9f  FAIL\n", what, got, want);
+        ++g_failures;
+    }
+}
+
+struct Pin {
+    NoiseBasis basis;
+    uint32_t seed;
+    float values[4];
+};
+
+// 4-octave fbm2 (lacunarity 2, gain 0.5) at kPinPoints. The value rows are also what the
+// pre-template fbm({x, y, 0}, 4, ...) returned; change them only with kGeneratorVersion.
+static const float kPinPoints[4][2] = {{0.37f, -12.25f}, {101.5f, 7.125f}, {-3.75f, -0.5f}, {2048.3f, -777.7f}};
+static const Pin kPins[] = {
+    {NoiseBasis::Value, 1337u, {0x1.50fce2p-4f, 0x1.1b03d6p-4f, -0x1.5ed1cep-5f, 0x1.3934a4p-2f}},
+    {NoiseBasis::Value, 424242u, {0x1.079adep-3f, 0x1.2e53e8p-5f, 0x1.600e74p-3f, -0x1.f5cda8p-3f}},
+    {NoiseBasis::Gradient, 1337u, {0x1.446fbep-5f, -0x1.8bca4ap-6f, 0x1.0ced56p-2f, 0x1.27b656p-3f}},
+    {NoiseBasis::Gradient, 424242u, {0x1.7e2822p-4f, 0x1.53e1eep-7f, -0x1.94ccc8p-3f, -0x1.1e1f36p-4f}},
+    {NoiseBasis::Simplex, 1337u, {0x1.d35568p-3f, -0x1.274058p-3f, 0x1.1615dap-3f, -0x1.29d3c8p-1f}},
+    {NoiseBasis::Simplex, 424242u, {0x1.8337a2p-2f, -0x1.2dd7c2p-1f, -0x1.274d04p-4f, 0x1.457658p-2f}},
+};
+// The cave fbm of the base generator: fbm<4>(p, 2.2, 0.5, 777) at (x, y, x) * 0.05.
+static const float kCavePins[4] = {0x1.81ccf8p-2f, -0x1.2840dep-5f, 0x1.4cfbe4p-2f, -0x1.10d9acp-2f};
+
+// Pinned values tolerate FMA contraction differences between compilers and targets.
+static constexpr double kPinTolerance = 1e-6;
+
+template <typename Fn>
+static double time_ns(const std::vector<float>& xs, const std::vector<float>& ys, Fn&& fn, float& sink) {
+    const auto t0 = std::chrono::steady_clock::now();
+    float acc = 0.0f;
+    for (std::size_t i = 0; i < xs.size(); ++i) acc += fn(xs[i], ys[i]);
+    const auto t1 = std::chrono::steady_clock::now();
+    sink += acc;
+    return std::chrono::duration<double, std::nano>(t1 - t0).count() / static_cast<double>(xs.size());
+}
+
+int main(int argc, char** argv) {
+    std::size_t samples = 2000000;
+    if (argc > 1) samples = static_cast<std::size_t>(std::max(1000L, std::atol(argv[1])));
+
+    // Determinism: pinned outputs per basis and seed.
+    for (const Pin& pin : kPins) {
+        const Fbm2Fn fn = select_fbm2(pin.basis, 4);
+        for (int p = 0; p < 4; ++p) {
+            char what[64];
+            std::snprintf(what, sizeof(what), "%s seed %u point %d", noise_basis_name(pin.basis), pin.seed, p);
+            expect_near(what, fn(kPinPoints[p][0], kPinPoints[p][1], 4, 2.0f, 0.5f, pin.seed), pin.values[p], kPinTolerance);
+        }
+    }
+    for (int p = 0; p < 4; ++p) {
+        const Float3 q{kPinPoints[p][0] * 0.05f, kPinPoints[p][1] * 0.05f, kPinPoints[p][0] * 0.05f};
+        expect_near("cave fbm<4>", fbm<4>(q, 2.2f, 0.5f, 777u), kCavePins[p], kPinTolerance);
+    }
+
+    std::mt19937 rng(12345u);
+    std::uniform_real_distribution<float> coord(-4096.0f, 4096.0f);
+    std::vector<float> xs(samples), ys(samples);
+    for (std::size_t i = 0; i < samples; ++i) {
+        xs[i] = coord(rng);
+        ys[i] = coord(rng);
+    }
+
+    // Unrolled instantiations agree with the loops; the value basis with the runtime fbm.
+    double worst_unrolled = 0.0, worst_runtime = 0.0;
+    for (std::size_t i = 0; i < std::min<std::size_t>(samples, 20000); ++i) {
+        const uint32_t seed = static_cast<uint32_t>(i);
+        for (int b = 0; b < kNoiseBasisCount; ++b) {
+            const NoiseBasis basis = static_cast<NoiseBasis>(b);
+            for (int oct = 1; oct <= kMaxUnrolledOctaves + 2; ++oct) {
+                const float fast = select_fbm2(basis, oct)(xs[i], ys[i], oct, 2.0f, 0.5f, seed);
+                const float loop = b == 0 ? fbm2_loop<NoiseBasis::Value>(xs[i], ys[i], oct, 2.0f, 0.5f, seed)
+                                 : b == 1 ? fbm2_loop<NoiseBasis::Gradient>(xs[i], ys[i], oct, 2.0f, 0.5f, seed)
+                                          : fbm2_loop<NoiseBasis::Simplex>(xs[i], ys[i], oct, 2.0f, 0.5f, seed);
+                worst_unrolled = std::max(worst_unrolled, (double)std::fabs(fast - loop));
+                if (b == 0) {
+                    const float runtime = fbm({xs[i], ys[i], 0.0f}, oct, 2.0f, 0.5f, seed);
+                    worst_runtime = std::max(worst_runtime, (double)std::fabs(fast - runtime));
+                }
+            }
+        }
+    }
+    expect_near("unrolled fbm2 vs loop (max diff)", worst_unrolled, 0.0, kPinTolerance);
+    expect_near("value fbm2 vs runtime fbm (max diff)", worst_runtime, 0.0, kPinTolerance);
+
+    // Slope bounds hold for finite differences along both axes.
+    for (int b = 0; b < kNoiseBasisCount; ++b) {
+        const NoiseBasis basis = static_cast<NoiseBasis>(b);
+        const Fbm2Fn noise = select_fbm2(basis, 1); // one octave is the basis itself
+        const float h = 1.0f / 512.0f;
+        double steepest = 0.0;
+        for (std::size_t i = 0; i < std::min<std::size_t>(samples, 200000); ++i) {
+            // Near the origin, where x + h is exact enough to difference over.
+            const float x = xs[i] / 64.0f, y = ys[i] / 64.0f;
+            const float n = noise(x, y, 1, 2.0f, 0.5f, 9u);
+            const float nx = noise(x + h, y, 1, 2.0f, 0.5f, 9u);
+            const float ny = noise(x, y + h, 1, 2.0f, 0.5f, 9u);
+            steepest = std::max(steepest, static_cast<double>(std::max(std::fabs(nx - n), std::fabs(ny - n)) / h));
+        }
+        std::printf("%-8s slope: steepest %.3f bound %.3f\n", noise_basis_name(basis), steepest, noise2_slope_bound(basis));
+        if (steepest > noise2_slope_bound(basis)) {
+            std::printf("%s slope bound exceeded  FAIL\n", noise_basis_name(basis));
+            ++g_failures;
+        }
+    }
+
+    // Benchmarks at the default terrain octave count.
+    float sink = 0.0f;
+    const int oct = 4;
+    const double runtime_ns = time_ns(xs, ys, [&](float x, float y) { return fbm({x, y, 0.0f}, oct, 2.0f, 0.5f, 1337u); }, sink);
+    std::printf("%-26s %7.1f ns/sample\n", "fbm (runtime octaves)", runtime_ns);
+    for (int b = 0; b < kNoiseBasisCount; ++b) {
+        const NoiseBasis basis = static_cast<NoiseBasis>(b);
+        const Fbm2Fn fn = select_fbm2(basis, oct);
+        const double ns = time_ns(xs, ys, [&](float x, float y) { return fn(x, y, oct, 2.0f, 0.5f, 1337u); }, sink);
+        std::printf("fbm2<%d> %-17s %7.1f ns/sample  (%.2fx runtime fbm)\n", oct, noise_basis_name(basis), ns,
+                    ns > 0.0 ? runtime_ns / ns : 0.0);
+    }
+    const double warp_ns = time_ns(xs, ys, [&](float x, float y) {
+        domain_warp2(x, y, 0.5f, 1337u);
+        return fbm2<4, NoiseBasis::Gradient>(x, y, 2.0f, 0.5f, 1337u);
+    }, sink);
+    std::printf("%-26s %7.1f ns/sample\n", "warped gradient fbm2<4>", warp_ns);
+
+    std::printf("(checksum %.3f)\n", sink);
+    std::printf("%s\n", g_failures == 0 ? "All noise checks passed" : "Noise checks FAILED");
+    return g_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,116 @@
+// Camera-relative precision check: places chunk vertices the way the mesher and renderer do
+// (float offsets from a double chunk center, plus the float center-minus-camera offset the
+// vertex shader adds) on an Earth-radius planet, and compares them against the same points
+// computed in double. Cameras sit at a face center, near a cube edge and near a corner.
+// Exits non-zero when a vertex within kCheckDistanceM of the camera is off by a millimeter.
+// Usage: wf_precision_check [ring_radius] [radius_m]
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+#include "chunk.h"
+#include "planet.h"
+#include "wf_math.h"
+
+using namespace wf;
+
+static int g_failures = 0;
+
+static constexpr double kToleranceM = 1e-3;
+static constexpr double kCheckDistanceM = 4000.0;
+
+struct ErrorStats {
+    double worst = 0.0;      // camera-relative path
+    double worst_far = 0.0;  // same, past kCheckDistanceM
+    double naive = 0.0;      // float world positions minus a float camera, for comparison
+    long vertices = 0;
+};
+
+static Double3 grid_point(int face, double S, double T, double R) { return face_grid_direction(face, S, T, R) * R; }
+
+// One chunk: the voxel corners its meshes can place vertices on (every 4th voxel per axis
+// plus the far faces), through the renderer's float path and in double.
+static void check_chunk(const PlanetConfig& cfg, const FaceChunkKey& key, const Double3& cam, ErrorStats& st) {
+    const int N = Chunk64::N;
+    const double chunk_d = cfg.voxel_size_m * N;
+    const double half_d = chunk_d * 0.5;
+    const double S0 = static_cast<double>(key.i) * chunk_d;
+    const double T0 = static_cast<double>(key.j) * chunk_d;
+    const double R0 = static_cast<double>(key.k) * chunk_d;
+    const Double3 center = grid_point(key.face, S0 + half_d, T0 + half_d, R0 + half_d);
+    // update_draw_offsets: subtract in double, narrow once per draw.
+    const Float3 offset = to_float3(center - cam);
+    const Float3 cam_f = to_float3(cam);
+    for (int z = 0; z <= N; z += 4) {
+        for (int y = 0; y <= N; y += 4) {
+            for (int x = 0; x <= N; x += 4) {
+                const Double3 wp = grid_point(key.face, S0 + x * cfg.voxel_size_m, T0 + y * cfg.voxel_size_m,
+                                              R0 + z * cfg.voxel_size_m);
+                // build_chunk_mesh_result stores float offsets from the chunk center; chunk.vert adds them.
+                const Float3 local = to_float3(wp - center);
+                const Float3 gpu{local.x + offset.x, local.y + offset.y, local.z + offset.z};
+                const Double3 ref = wp - cam;
+                const double err = length(to_double3(gpu) - ref);
+                if (length(ref) <= kCheckDistanceM) st.worst = std::max(st.worst, err);
+                else st.worst_far = std::max(st.worst_far, err);
+                const Float3 world_f = to_float3(wp);
+                const Float3 naive{world_f.x - cam_f.x, world_f.y - cam_f.y, world_f.z - cam_f.z};
+                st.naive = std::max(st.naive, length(to_double3(naive) - ref));
+                ++st.vertices;
+            }
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    int ring_radius = 14;
+    PlanetConfig cfg;
+    cfg.radius_m = 6371000.0;
+    if (argc > 1) ring_radius = std::max(0, std::atoi(argv[1]));
+    if (argc > 2) cfg.radius_m = std::max(1000.0, std::atof(argv[2]));
+    const double chunk_d = cfg.voxel_size_m * Chunk64::N;
+
+    struct Site {
+        const char* name;
+        int face;
+        double s, t; // face-grid coordinates as a fraction of the radius
+    };
+    // 1/sqrt(3) is a cube corner on the face grid; the edge sits at s = 1/sqrt(2) when t = 0.
+    const Site sites[] = {
+        {"face center", 0, 0.0, 0.0},
+        {"face edge", 2, 0.7070, 0.0},
+        {"cube corner", 4, 0.5772, 0.5772},
+    };
+
+    std::printf("radius %.0f m, ring radius %d, tolerance %.3f mm within %.0f m\n", cfg.radius_m, ring_radius,
+                kToleranceM * 1e3, kCheckDistanceM);
+    for (const Site& site : sites) {
+        // The eye stands 1.7 m above the sphere, off the voxel grid.
+        const double S = site.s * cfg.radius_m + 0.37;
+        const double T = site.t * cfg.radius_m - 0.81;
+        const Double3 dir = face_grid_direction(site.face, S, T, cfg.radius_m);
+        const Double3 cam = dir * (cfg.radius_m + 1.7);
+        const std::int64_t ci = static_cast<std::int64_t>(std::floor(S / chunk_d));
+        const std::int64_t cj = static_cast<std::int64_t>(std::floor(T / chunk_d));
+        const std::int64_t ck = static_cast<std::int64_t>(std::floor(cfg.radius_m / chunk_d));
+
+        ErrorStats st;
+        for (std::int64_t dj = -ring_radius; dj <= ring_radius; ++dj)
+            for (std::int64_t di = -ring_radius; di <= ring_radius; ++di)
+                for (std::int64_t dk = -2; dk <= 2; ++dk)
+                    check_chunk(cfg, FaceChunkKey{site.face, ci + di, cj + dj, ck + dk}, cam, st);
+        // A few chunks toward the far plane along the face's right axis.
+        for (std::int64_t di = 100; di <= 1600; di *= 2)
+            check_chunk(cfg, FaceChunkKey{site.face, ci + di, cj, ck}, cam, st);
+
+        const bool ok = st.worst <= kToleranceM;
+        std::printf("%-12s vertices %7ld  camera-relative %.4f mm (far %.4f mm)  float world %.1f mm  %s\n", site.name,
+                    st.vertices, st.worst * 1e3, st.worst_far * 1e3, st.naive * 1e3, ok ? "ok" : "FAIL");
+        if (!ok) ++g_failures;
+    }
+
+    std::printf("%s\n", g_failures == 0 ? "All precision checks passed" : "Precision checks FAILED");
+    return g_failures == 0 ? 0 : 1;
+}
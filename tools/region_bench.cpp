@@ -0,0 +1,166 @@
+// Region IO benchmark: loads every delta of a pre-generated region set from a cold page
+// cache, once per key through the blocking path and once per async IO backend. Then saves
+// the same deltas region by region with save_region_deltas (temp file, sync, rename)
+// through each backend and reports write throughput.
+// Usage: wf_region_bench [root] [regions_per_side] [edits_per_chunk] [runs]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "async_io.h"
+#include "region_io.h"
+
+using namespace wf;
+namespace fs = std::filesystem;
+
+// Evicts the set's pages; without root this is the closest thing to dropping the caches.
+static std::uintmax_t evict_page_cache(const std::string& root) {
+    std::uintmax_t bytes = 0;
+    std::error_code ec;
+    for (const auto& entry : fs::recursive_directory_iterator(root, ec)) {
+        if (!entry.is_regular_file()) continue;
+        bytes += entry.file_size();
+        int fd = ::open(entry.path().c_str(), O_RDONLY);
+        if (fd < 0) continue;
+#if defined(POSIX_FADV_DONTNEED)
+        ::fdatasync(fd);
+        ::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+#endif
+        ::close(fd);
+    }
+    return bytes;
+}
+
+static void report(const char* name, std::size_t keys, std::size_t found, double ms, std::uintmax_t bytes) {
+    double mb = static_cast<double>(bytes) / (1024.0 * 1024.0);
+    std::printf("%-20s keys=%zu found=%zu time=%.2f ms  %.1f MB/s  %.2f us/key\n",
+                name, keys, found, ms, ms > 0.0 ? mb / (ms / 1000.0) : 0.0,
+                keys ? ms * 1000.0 / static_cast<double>(keys) : 0.0);
+}
+
+static ChunkDelta bench_delta(const FaceChunkKey& key, int edits, const GeneratorStamp& stamp) {
+    ChunkDelta delta;
+    delta.base = stamp;
+    for (int e = 0; e < edits; ++e) {
+        uint32_t index = static_cast<uint32_t>((key.i * 7919 + key.j * 104729 + e * 2654435761ull) % Chunk64::N3);
+        delta.apply_edit(index, MAT_AIR, MAT_DIRT);
+    }
+    return delta;
+}
+
+static std::uintmax_t tree_bytes(const std::string& root) {
+    std::uintmax_t bytes = 0;
+    std::error_code ec;
+    for (const auto& entry : fs::recursive_directory_iterator(root, ec)) {
+        if (entry.is_regular_file()) bytes += entry.file_size();
+    }
+    return bytes;
+}
+
+int main(int argc, char** argv) {
+    std::string root = "bench_regions";
+    int regions_per_side = 2;
+    int edits = 256;
+    int runs = 3;
+    if (argc > 1) root = argv[1];
+    if (argc > 2) regions_per_side = std::max(1, std::atoi(argv[2]));
+    if (argc > 3) edits = std::max(1, std::atoi(argv[3]));
+    if (argc > 4) runs = std::max(1, std::atoi(argv[4]));
+
+    const int tile = 32;
+    const std::int64_t side = static_cast<std::int64_t>(regions_per_side) * tile;
+    std::vector<FaceChunkKey> keys;
+    keys.reserve(static_cast<std::size_t>(side * side));
+    for (std::int64_t j = 0; j < side; ++j) {
+        for (std::int64_t i = 0; i < side; ++i) {
+            keys.push_back(FaceChunkKey{0, i, j, 0});
+        }
+    }
+
+    if (!fs::exists(root)) {
+        std::printf("Generating %zu deltas (%d edits each) under %s\n", keys.size(), edits, root.c_str());
+        const GeneratorStamp stamp = generator_stamp(PlanetConfig{});
+        for (const FaceChunkKey& key : keys) {
+            if (!RegionIO::save_chunk_delta(key, bench_delta(key, edits, stamp), tile, root)) {
+                std::fprintf(stderr, "Save failed\n");
+                return 1;
+            }
+        }
+    }
+
+    // The save path's input: every delta, grouped by region.
+    std::vector<std::vector<std::pair<FaceChunkKey, ChunkDelta>>> region_batches(
+        static_cast<std::size_t>(regions_per_side * regions_per_side));
+    const GeneratorStamp stamp = generator_stamp(PlanetConfig{});
+    for (const FaceChunkKey& key : keys) {
+        const std::size_t r = static_cast<std::size_t>((key.j / tile) * regions_per_side + key.i / tile);
+        region_batches[r].emplace_back(key, bench_delta(key, edits, stamp));
+    }
+    const std::string write_root = root + "_write";
+
+    AsyncIO pool(AsyncIO::Backend::kThreadPool);
+    AsyncIO uring(AsyncIO::Backend::kIoUring);
+    for (int run = 0; run < runs; ++run) {
+        std::printf("run %d\n", run + 1);
+
+        std::uintmax_t bytes = evict_page_cache(root);
+        auto t0 = std::chrono::steady_clock::now();
+        std::size_t found = 0;
+        for (const FaceChunkKey& key : keys) {
+            ChunkDelta delta;
+            if (RegionIO::load_chunk_delta(key, delta, tile, root)) ++found;
+        }
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+        report("blocking", keys.size(), found, ms, bytes);
+
+        for (AsyncIO* io : {&pool, &uring}) {
+            if (io == &uring && uring.backend() != AsyncIO::Backend::kIoUring) continue;
+            bytes = evict_page_cache(root);
+            std::vector<std::optional<ChunkDelta>> out;
+            t0 = std::chrono::steady_clock::now();
+            found = RegionIO::load_chunk_deltas(keys, out, tile, root, io);
+            ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+            std::string name = std::string("batched/") + io->backend_name();
+            report(name.c_str(), keys.size(), found, ms, bytes);
+        }
+
+        // Writes: a fresh root each time, so every save rewrites a region of the same size.
+        for (AsyncIO* io : {&pool, &uring}) {
+            if (io == &uring && uring.backend() != AsyncIO::Backend::kIoUring) continue;
+            std::error_code ec;
+            fs::remove_all(write_root, ec);
+            std::size_t saved = 0;
+            std::uintmax_t written = 0;
+            ms = 0.0;
+            for (int pass = 0; pass < 2; ++pass) {
+                // The second pass rewrites existing regions: carried blobs are read back too.
+                t0 = std::chrono::steady_clock::now();
+                for (const auto& batch : region_batches) {
+                    const std::size_t half = batch.size() / 2;
+                    const std::size_t begin = pass == 0 ? 0 : half;
+                    const std::size_t end = pass == 0 ? half : batch.size();
+                    std::span<const std::pair<FaceChunkKey, ChunkDelta>> part(batch.data() + begin, end - begin);
+                    if (RegionIO::save_region_deltas(part, tile, write_root, io)) saved += part.size();
+                }
+                ms += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+                written += tree_bytes(write_root);  // each pass rewrote every region whole
+            }
+            std::string name = std::string("save/") + io->backend_name();
+            report(name.c_str(), keys.size(), saved, ms, written);
+        }
+    }
+    std::error_code ec;
+    fs::remove_all(write_root, ec);
+    return 0;
+}
@@ -0,0 +1,196 @@
+// Region crash-safety check: a child process saves batches of chunk deltas into one region
+// with save_region_deltas, back to back, and the parent SIGKILLs it at a random moment.
+// Every batch's contents follow from (seed, sequence), so after each kill the parent knows
+// what the last acknowledged save wrote. The region must load as exactly that state, or as
+// the state of the one save that was in flight. Either way every chunk saved before still loads.
+// The next child continues from whatever survived, over any temp file the kill left behind.
+// Exits non-zero when any check fails.
+// Usage: wf_region_crash [rounds] [seed] [root]
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "chunk.h"
+#include "region_io.h"
+
+using namespace wf;
+
+static int g_failures = 0;
+
+static constexpr int kTile = 32;
+static constexpr int kSlots = 48;  // chunks of region (0,0) the batches touch
+static constexpr std::int64_t kShell = 100;
+
+static FaceChunkKey slot_key(int slot) { return FaceChunkKey{0, slot % 8, slot / 8, kShell}; }
+
+// Which slots batch `seq` rewrites.
+static std::vector<int> batch_slots(uint32_t seed, std::uint64_t seq) {
+    std::mt19937_64 rng(seed * 0x9E3779B97F4A7C15ull + seq);
+    std::vector<int> slots;
+    for (int s = 0; s < kSlots; ++s) {
+        if (rng() % 3 == 0) slots.push_back(s);
+    }
+    if (slots.empty()) slots.push_back(static_cast<int>(rng() % kSlots));
+    return slots;
+}
+
+// The delta batch `seq` writes for `slot`: empty (erases the chunk), sparse or dense.
+static ChunkDelta make_delta(uint32_t seed, std::uint64_t seq, int slot) {
+    std::mt19937_64 rng((seed * 0x9E3779B97F4A7C15ull + seq) * 131 + static_cast<unsigned>(slot) + 1);
+    ChunkDelta d;
+    d.base = generator_stamp(PlanetConfig{});
+    const int kind = static_cast<int>(rng() % 8);
+    if (kind == 0) return d;
+    if (kind <= 2) {
+        d.clear(ChunkDelta::Mode::kDense);
+        d.base = generator_stamp(PlanetConfig{});
+        d.dense_data.assign(Chunk64::N3, ChunkDelta::kNoOverride);
+        for (std::size_t i = rng() % 64; i < d.dense_data.size(); i += 1 + rng() % 64) {
+            d.dense_data[i] = static_cast<uint16_t>(1 + rng() % 8);
+            ++d.override_count;
+        }
+        return d;
+    }
+    for (uint32_t index = static_cast<uint32_t>(rng() % 512); index < Chunk64::N3;
+         index += 1 + static_cast<uint32_t>(rng() % 2048)) {
+        d.entries.push_back(ChunkDeltaEntry{index, static_cast<uint16_t>(1 + rng() % 8)});
+    }
+    d.override_count = static_cast<uint32_t>(d.entries.size());
+    return d;
+}
+
+// Content fingerprint; 0 means "no delta stored".
+static std::uint64_t fingerprint(const ChunkDelta& d) {
+    if (d.empty()) return 0;
+    std::uint64_t h = 1469598103934665603ull;
+    auto mix = [&](std::uint64_t v) { h = (h ^ v) * 1099511628211ull; };
+    mix(static_cast<std::uint64_t>(d.mode));
+    mix(d.override_count);
+    for (const ChunkDeltaEntry& e : d.entries) mix((std::uint64_t(e.index) << 16) | e.material);
+    for (std::size_t i = 0; i < d.dense_data.size(); ++i) {
+        if (d.dense_data[i] != ChunkDelta::kNoOverride) mix((std::uint64_t(i) << 16) | d.dense_data[i]);
+    }
+    return h | 1;
+}
+
+// Per-slot fingerprints after every save up to and including `seq`.
+static std::vector<std::uint64_t> expected_state(uint32_t seed, std::uint64_t seq) {
+    std::vector<std::uint64_t> state(kSlots, 0);
+    for (std::uint64_t s = 1; s <= seq; ++s) {
+        for (int slot : batch_slots(seed, s)) state[slot] = fingerprint(make_delta(seed, s, slot));
+    }
+    return state;
+}
+
+static std::vector<std::uint64_t> loaded_state(const std::string& root) {
+    std::vector<std::uint64_t> state(kSlots, 0);
+    for (int slot = 0; slot < kSlots; ++slot) {
+        ChunkDelta d;
+        if (RegionIO::load_chunk_delta(slot_key(slot), d, kTile, root)) state[slot] = fingerprint(d);
+    }
+    return state;
+}
+
+static bool save_batch(uint32_t seed, std::uint64_t seq, const std::string& root) {
+    std::vector<std::pair<FaceChunkKey, ChunkDelta>> batch;
+    for (int slot : batch_slots(seed, seq)) batch.emplace_back(slot_key(slot), make_delta(seed, seq, slot));
+    return RegionIO::save_region_deltas(batch, kTile, root);
+}
+
+// Saves batches from `seq` on until killed, writing each acknowledged sequence to `ack_fd`.
+[[noreturn]] static void writer(uint32_t seed, std::uint64_t seq, const std::string& root, int ack_fd) {
+    for (;; ++seq) {
+        if (!save_batch(seed, seq, root)) _exit(2);
+        if (::write(ack_fd, &seq, sizeof(seq)) != static_cast<ssize_t>(sizeof(seq))) _exit(3);
+    }
+}
+
+int main(int argc, char** argv) {
+    int rounds = 40;
+    uint32_t seed = 1234u;
+    std::string root = "region_crash";
+    if (argc > 1) rounds = std::max(1, std::atoi(argv[1]));
+    if (argc > 2) seed = static_cast<uint32_t>(std::strtoul(argv[2], nullptr, 10));
+    if (argc > 3) root = argv[3];
+
+    const std::string path = RegionIO::region_path(slot_key(0), kTile, root);
+    std::error_code ec;
+    std::filesystem::remove(path, ec);
+    std::filesystem::remove(path + ".tmp", ec);
+
+    std::mt19937 rng(seed);
+    std::uint64_t committed = 0;  // last save known to be on disk
+    int mid_save = 0, advanced = 0;
+    for (int round = 0; round < rounds && g_failures == 0; ++round) {
+        int fds[2];
+        if (::pipe(fds) != 0) {
+            std::perror("pipe");
+            return 1;
+        }
+        const pid_t pid = ::fork();
+        if (pid < 0) {
+            std::perror("fork");
+            return 1;
+        }
+        if (pid == 0) {
+            ::close(fds[0]);
+            writer(seed, committed + 1, root, fds[1]);
+        }
+        ::close(fds[1]);
+        ::usleep(static_cast<useconds_t>(500 + rng() % 40000));
+        ::kill(pid, SIGKILL);
+        int status = 0;
+        while (::waitpid(pid, &status, 0) < 0 && errno == EINTR) {}
+        if (!WIFSIGNALED(status)) {
+            std::printf("FAIL round %d: writer exited with status %d before the kill\n", round,
+                        WIFEXITED(status) ? WEXITSTATUS(status) : -1);
+            ++g_failures;
+        }
+        std::uint64_t acked = committed, seq = 0;
+        while (::read(fds[0], &seq, sizeof(seq)) == static_cast<ssize_t>(sizeof(seq))) acked = seq;
+        ::close(fds[0]);
+        if (std::filesystem::exists(path + ".tmp", ec)) ++mid_save;
+
+        // The region holds the last acknowledged save, or the one in flight if its rename landed.
+        const std::vector<std::uint64_t> got = loaded_state(root);
+        if (got == expected_state(seed, acked)) {
+            committed = acked;
+        } else if (got == expected_state(seed, acked + 1)) {
+            committed = acked + 1;
+        } else {
+            const std::vector<std::uint64_t> want = expected_state(seed, acked);
+            int bad = 0;
+            for (int slot = 0; slot < kSlots; ++slot) bad += got[slot] != want[slot];
+            std::printf("FAIL round %d: region matches neither save %llu nor %llu (%d chunks differ)\n", round,
+                        (unsigned long long)acked, (unsigned long long)(acked + 1), bad);
+            ++g_failures;
+        }
+        advanced += committed > acked ? 1 : 0;
+    }
+
+    // One save after the last kill must still go through over the leftover temp file.
+    if (g_failures == 0) {
+        if (!save_batch(seed, committed + 1, root) || loaded_state(root) != expected_state(seed, committed + 1)) {
+            std::printf("FAIL final save over the crashed region\n");
+            ++g_failures;
+        } else {
+            ++committed;
+        }
+    }
+
+    std::printf("rounds %d  saves committed %llu  killed mid-save %d  in-flight save landed %d\n", rounds,
+                (unsigned long long)committed, mid_save, advanced);
+    std::printf("%s\n", g_failures == 0 ? "All region crash checks passed" : "Region crash checks FAILED");
+    return g_failures == 0 ? 0 : 1;
+}
@@ -29,15 +29,18 @@ int main(int argc, char** argv) {
         }
     }
 
+    PlanetConfig planet{};
+    const GeneratorStamp stamp = generator_stamp(planet);
+
     // Save
-    if (!RegionIO::save_chunk(key, c, 32, root)) {
+    if (!RegionIO::save_chunk(key, c, 32, root, stamp)) {
         std::fprintf(stderr, "Save failed\n");
         return 1;
     }
 
     // Load back
     Chunk64 d{};
-    if (!RegionIO::load_chunk(key, d, 32, root)) {
+    if (!RegionIO::load_chunk(key, d, 32, root, &stamp)) {
         std::fprintf(stderr, "Load failed\n");
         return 1;
     }
@@ -54,6 +57,31 @@ int main(int argc, char** argv) {
 
     Mesh m; mesh_chunk_greedy(d, m, 0.10f);
     std::printf("Round-trip mismatches: %zu, Mesh tris: %zu, verts: %zu\n", mism, m.indices.size()/3, m.vertices.size());
-    return 0;
+
+    // Stale generated data must be refused under another config
+    PlanetConfig reseeded = planet;
+    reseeded.seed += 1;
+    const GeneratorStamp other = generator_stamp(reseeded);
+    Chunk64 stale{};
+    bool refused = !RegionIO::load_chunk(key, stale, 32, root, &other);
+
+    // Deltas keep their stamp; rebasing drops overrides that match the new base
+    ChunkDelta delta;
+    delta.base = stamp;
+    delta.apply_edit(Chunk64::lindex(1, 40, 1), MAT_AIR, MAT_ROCK);  // real edit: rock placed in air
+    delta.apply_edit(Chunk64::lindex(2, 10, 2), MAT_ROCK, MAT_DIRT); // becomes a no-op on the new base
+    bool delta_ok = RegionIO::save_chunk_delta(key, delta, 32, root);
+    ChunkDelta loaded;
+    delta_ok = delta_ok && RegionIO::load_chunk_delta(key, loaded, 32, root) && loaded.base == stamp;
+    Chunk64 new_base = c;
+    new_base.set_voxel(2, 10, 2, MAT_DIRT);
+    uint32_t dropped = rebase_chunk_delta(loaded, new_base, other);
+
+    GeneratorStamp region_stamp{};
+    RegionIO::read_region_stamp(RegionIO::region_path(key, 32, root), region_stamp);
+    std::printf("Stamp: generator=%u config=%016llx, stale chunk refused: %s, delta round-trip: %s, rebase dropped %u kept %u\n",
+                region_stamp.generator_version, (unsigned long long)region_stamp.config_hash,
+                refused ? "yes" : "NO", delta_ok ? "ok" : "FAILED", dropped, loaded.override_count);
+    return (refused && delta_ok && dropped == 1 && loaded.override_count == 1) ? 0 : 1;
 }
 
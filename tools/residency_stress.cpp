@@ -0,0 +1,368 @@
+// Residency stress check: drives ChunkResidencyTable with randomized camera jumps the way
+// ring jobs, remeshes, uploads and prune do. Requests of newer generations supersede
+// in-flight work, old generations arrive late, and keys are evicted mid-pipeline.
+// A single-threaded pass checks every transition against the legal ones and a shadow of
+// the entry generations. A threaded pass races workers against the jumping camera.
+// Both drain at the end and require every key of the last ring to be settled (Generated
+// or Resident) and every other key forgotten.
+// Exits non-zero when any check fails.
+// Usage: wf_residency_stress [steps] [seed] [threads]
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "chunk_residency.h"
+
+using namespace wf;
+using State = ChunkResidencyState;
+
+static int g_failures = 0;
+
+static void fail(const char* what, const FaceChunkKey& key, const char* detail) {
+    if (g_failures++ < 20) {
+        std::printf("FAIL %-28s face=%d i=%lld j=%lld k=%lld  %s\n", what, key.face, (long long)key.i,
+                    (long long)key.j, (long long)key.k, detail);
+    }
+}
+
+// One key's trip through a ring job and its upload, one table call per step.
+struct Task {
+    FaceChunkKey key{};
+    uint64_t gen = 0;   // 0 = main-thread remesh of a resident key
+    int step = 0;
+    uint64_t ticket = 0;
+};
+
+enum class Op { kRequest, kGenerating, kGenerated, kBeginMesh, kFinishMesh, kBeginUpload, kFinishUpload, kEvict };
+
+// Whether an accepted call may move `from` (nullopt = no entry) to `to`.
+static bool legal(Op op, std::optional<State> from, State to) {
+    auto is = [&](State s) { return from && *from == s; };
+    switch (op) {
+        case Op::kRequest: return to == State::kRequested && !is(State::kUploading);
+        case Op::kGenerating: return to == State::kGenerating && is(State::kRequested);
+        case Op::kGenerated: return to == State::kGenerated && (is(State::kRequested) || is(State::kGenerating));
+        case Op::kBeginMesh:
+            return to == State::kMeshing && (is(State::kGenerated) || is(State::kMeshing) ||
+                                             is(State::kMeshReady) || is(State::kResident));
+        case Op::kFinishMesh: return (to == State::kMeshReady || to == State::kGenerated) && is(State::kMeshing);
+        case Op::kBeginUpload: return to == State::kUploading && is(State::kMeshReady);
+        case Op::kFinishUpload: return (to == State::kResident || to == State::kGenerated) && is(State::kUploading);
+        case Op::kEvict: return to == State::kEvicting && from.has_value();
+    }
+    return false;
+}
+
+static std::optional<State> state_of(const ChunkResidencyTable& table, const FaceChunkKey& key) {
+    State s{};
+    if (!table.state(key, s)) return std::nullopt;
+    return s;
+}
+
+// Camera rings: a square of columns over a few shells around a center, on one face.
+static void ring_keys(int face, std::int64_t ci, std::int64_t cj, int radius, std::vector<FaceChunkKey>& out) {
+    out.clear();
+    for (std::int64_t dj = -radius; dj <= radius; ++dj)
+        for (std::int64_t di = -radius; di <= radius; ++di)
+            for (std::int64_t k = 178; k <= 180; ++k) out.push_back(FaceChunkKey{face, ci + di, cj + dj, k});
+}
+
+// Runs one step of a task. `check` validates the transition against the state read just
+// before (single-threaded only). Returns false once the task is finished or dropped.
+template <typename Rng>
+static bool run_step(ChunkResidencyTable& table, Task& t, Rng& rng, bool check) {
+    std::optional<State> before = check ? state_of(table, t.key) : std::nullopt;
+    auto verify = [&](Op op, bool accepted, const char* name) {
+        if (!check) return;
+        std::optional<State> after = state_of(table, t.key);
+        if (accepted) {
+            if (!after || !legal(op, before, *after)) fail("illegal transition", t.key, name);
+        } else if (after != before) {
+            fail("refused call changed state", t.key, name);
+        }
+    };
+    const int step = t.step++;
+    if (t.gen == 0) {
+        // Remesh: Meshing under a gen-0 ticket, then the upload steps below.
+        if (step == 0) {
+            t.ticket = table.begin_mesh(t.key, 0);
+            verify(Op::kBeginMesh, t.ticket != 0, "remesh begin_mesh");
+            t.step = 3;
+            return t.ticket != 0;
+        }
+    } else if (step == 0) {
+        bool ok = table.advance(t.key, State::kGenerating, t.gen);
+        verify(Op::kGenerating, ok, "advance generating");
+        return ok;
+    } else if (step == 1) {
+        bool ok = table.advance(t.key, State::kGenerated, t.gen);
+        verify(Op::kGenerated, ok, "advance generated");
+        return ok;
+    } else if (step == 2) {
+        t.ticket = table.begin_mesh(t.key, t.gen);
+        verify(Op::kBeginMesh, t.ticket != 0, "begin_mesh");
+        return t.ticket != 0;
+    }
+    if (t.step - 1 == 3) {
+        const bool has_mesh = rng() % 10 != 0; // all-air chunks mesh to nothing
+        bool ok = table.finish_mesh(t.key, t.ticket, has_mesh);
+        verify(Op::kFinishMesh, ok, "finish_mesh");
+        return ok && has_mesh;
+    }
+    if (t.step - 1 == 4) {
+        bool ok = table.begin_upload(t.key, t.ticket);
+        verify(Op::kBeginUpload, ok, "begin_upload");
+        return ok;
+    }
+    const bool uploaded = rng() % 30 != 0; // the renderer may refuse a mesh (pool full)
+    const bool accepted = table.accepts_upload(t.key, t.ticket);
+    bool ok = table.finish_upload(t.key, t.ticket, uploaded);
+    verify(Op::kFinishUpload, ok, "finish_upload");
+    if (check && ok != accepted) fail("accepts_upload disagrees", t.key, "finish_upload");
+    return false;
+}
+
+// After the drain: keys of the last ring are settled, everything else is forgotten.
+static void check_settled(const ChunkResidencyTable& table, const std::vector<FaceChunkKey>& ring, const char* pass) {
+    std::size_t settled = 0;
+    for (const FaceChunkKey& key : ring) {
+        std::optional<State> s = state_of(table, key);
+        if (!s) {
+            fail("ring key missing", key, pass);
+        } else if (*s != State::kResident && *s != State::kGenerated) {
+            fail("ring key stuck", key, chunk_residency_state_name(*s));
+        } else {
+            ++settled;
+        }
+    }
+    const ChunkResidencyStats st = table.stats();
+    std::size_t total = 0;
+    for (std::size_t n : st.counts) total += n;
+    if (total != settled) {
+        char detail[96];
+        std::snprintf(detail, sizeof(detail), "%zu entries, %zu settled ring keys", total, settled);
+        fail("stale entries left", FaceChunkKey{}, detail);
+    }
+    std::printf("%-16s ring %zu  resident %zu  generated %zu  rejected %llu\n", pass, ring.size(),
+                st.counts[static_cast<std::size_t>(State::kResident)],
+                st.counts[static_cast<std::size_t>(State::kGenerated)], (unsigned long long)st.rejected);
+}
+
+// Moves the camera: small steps mostly, sometimes a jump to another face.
+template <typename Rng>
+static void jump(Rng& rng, int& face, std::int64_t& ci, std::int64_t& cj) {
+    const int roll = static_cast<int>(rng() % 10);
+    if (roll < 6) {
+        ci += static_cast<int>(rng() % 3) - 1;
+        cj += static_cast<int>(rng() % 3) - 1;
+    } else if (roll < 9) {
+        ci += static_cast<int>(rng() % 9) - 4;
+        cj += static_cast<int>(rng() % 9) - 4;
+    } else {
+        face = static_cast<int>(rng() % 6);
+        ci = static_cast<int>(rng() % 16) - 8;
+        cj = static_cast<int>(rng() % 16) - 8;
+    }
+}
+
+static void single_threaded(int steps, uint32_t seed) {
+    std::mt19937 rng(seed);
+    ChunkResidencyTable table;
+    std::vector<Task> tasks;
+    std::vector<FaceChunkKey> releases;       // evicted, waiting for the GPU release
+    std::unordered_map<FaceChunkKey, uint64_t, FaceChunkKeyHash> shadow_gen;
+    std::vector<FaceChunkKey> ring;
+    std::unordered_set<FaceChunkKey, FaceChunkKeyHash> in_ring;
+    uint64_t gen = 0;
+    int face = 0;
+    std::int64_t ci = 0, cj = 0;
+    const int radius = 3;
+
+    auto request = [&](const FaceChunkKey& key, uint64_t g) {
+        std::optional<State> before = state_of(table, key);
+        const bool ok = table.request(key, g);
+        auto it = shadow_gen.find(key);
+        const bool expect = !before || !(g < it->second || *before == State::kUploading);
+        if (ok != expect) fail("request acceptance", key, ok ? "accepted" : "refused");
+        std::optional<State> after = state_of(table, key);
+        if (ok) {
+            if (!after || !legal(Op::kRequest, before, *after)) fail("illegal transition", key, "request");
+            shadow_gen[key] = g;
+            tasks.push_back(Task{key, g, 0, 0});
+        } else if (after != before) {
+            fail("refused call changed state", key, "request");
+        }
+    };
+    auto move_camera = [&]() {
+        jump(rng, face, ci, cj);
+        ++gen;
+        ring_keys(face, ci, cj, radius, ring);
+        in_ring = std::unordered_set<FaceChunkKey, FaceChunkKeyHash>(ring.begin(), ring.end());
+        std::shuffle(ring.begin(), ring.end(), rng);
+        for (const FaceChunkKey& key : ring) request(key, gen);
+        // Prune: everything outside the new ring starts evicting, in-flight or not.
+        std::vector<FaceChunkKey> evicted;
+        table.evict_if([&](const FaceChunkKey& key) { return in_ring.count(key) == 0; }, evicted);
+        for (const FaceChunkKey& key : evicted) {
+            if (state_of(table, key) != State::kEvicting) fail("evict_if", key, "not evicting");
+        }
+        releases.insert(releases.end(), evicted.begin(), evicted.end());
+    };
+    auto release = [&](std::size_t idx) {
+        const FaceChunkKey key = releases[idx];
+        releases[idx] = releases.back();
+        releases.pop_back();
+        std::optional<State> before = state_of(table, key);
+        const bool forgotten = table.finish_evict(key);
+        const bool expect = !before || *before == State::kEvicting;
+        if (forgotten != expect) fail("finish_evict", key, forgotten ? "forgot a live key" : "kept an evicting key");
+        if (forgotten) shadow_gen.erase(key);
+    };
+
+    move_camera();
+    for (int s = 0; s < steps; ++s) {
+        const int roll = static_cast<int>(rng() % 1000);
+        if (roll < 3) {
+            move_camera();
+        } else if (roll < 20 && gen > 1) {
+            // A request of an aborted older job arriving late.
+            request(ring[rng() % ring.size()], gen - 1 - rng() % std::min<uint64_t>(gen - 1, 3));
+        } else if (roll < 60 && !releases.empty()) {
+            release(rng() % releases.size());
+        } else if (roll < 80) {
+            const FaceChunkKey key = ring[rng() % ring.size()];
+            if (state_of(table, key) == State::kResident) tasks.push_back(Task{key, 0, 0, 0});
+        } else if (roll < 90) {
+            // An edit-driven evict of a single key (face switch drops it immediately).
+            const FaceChunkKey key = ring[rng() % ring.size()];
+            std::optional<State> before = state_of(table, key);
+            table.begin_evict(key);
+            if (before && state_of(table, key) != State::kEvicting) fail("begin_evict", key, "not evicting");
+            if (before) {
+                releases.push_back(key);
+                // The ring re-requests it on its next refresh.
+                request(key, gen);
+            }
+        } else if (!tasks.empty()) {
+            const std::size_t idx = rng() % tasks.size();
+            if (!run_step(table, tasks[idx], rng, true)) {
+                tasks[idx] = tasks.back();
+                tasks.pop_back();
+            }
+        }
+    }
+    // Drain: finish every task, then release every evicted key.
+    while (!tasks.empty()) {
+        const std::size_t idx = rng() % tasks.size();
+        if (!run_step(table, tasks[idx], rng, true)) {
+            tasks[idx] = tasks.back();
+            tasks.pop_back();
+        }
+    }
+    while (!releases.empty()) release(releases.size() - 1);
+    check_settled(table, ring, "single-threaded");
+}
+
+static void threaded(int steps, uint32_t seed, int threads) {
+    ChunkResidencyTable table;
+    std::mutex queue_mutex;
+    std::deque<Task> queue;
+    std::atomic<bool> done{false};
+    std::atomic<uint64_t> steps_run{0};
+
+    std::vector<std::thread> workers;
+    for (int w = 0; w < threads; ++w) {
+        workers.emplace_back([&, w]() {
+            std::mt19937 rng(seed * 31u + static_cast<uint32_t>(w));
+            for (;;) {
+                Task t{};
+                bool have = false;
+                {
+                    std::lock_guard<std::mutex> lock(queue_mutex);
+                    if (!queue.empty()) {
+                        t = queue.front();
+                        queue.pop_front();
+                        have = true;
+                    } else if (done.load()) {
+                        return;
+                    }
+                }
+                if (!have) {
+                    std::this_thread::yield();
+                    continue;
+                }
+                steps_run.fetch_add(1, std::memory_order_relaxed);
+                if (run_step(table, t, rng, false)) {
+                    std::lock_guard<std::mutex> lock(queue_mutex);
+                    queue.push_back(t);
+                }
+            }
+        });
+    }
+
+    std::mt19937 rng(seed);
+    std::vector<FaceChunkKey> ring, evicted, releases;
+    std::unordered_set<FaceChunkKey, FaceChunkKeyHash> in_ring;
+    uint64_t gen = 0;
+    int face = 0;
+    std::int64_t ci = 0, cj = 0;
+    for (int s = 0; s < steps / 200; ++s) {
+        jump(rng, face, ci, cj);
+        ++gen;
+        ring_keys(face, ci, cj, 3, ring);
+        in_ring = std::unordered_set<FaceChunkKey, FaceChunkKeyHash>(ring.begin(), ring.end());
+        for (const FaceChunkKey& key : ring) {
+            if (!table.request(key, gen)) continue;
+            std::lock_guard<std::mutex> lock(queue_mutex);
+            queue.push_back(Task{key, gen, 0, 0});
+        }
+        evicted.clear();
+        table.evict_if([&](const FaceChunkKey& key) { return in_ring.count(key) == 0; }, evicted);
+        releases.insert(releases.end(), evicted.begin(), evicted.end());
+        // Releases trail the evictions by a frame or two, like the GPU fences.
+        while (releases.size() > evicted.size() * 2) {
+            table.finish_evict(releases.front());
+            releases.erase(releases.begin());
+        }
+        for (int r = 0; r < 4; ++r) {
+            const FaceChunkKey key = ring[rng() % ring.size()];
+            State st{};
+            if (table.state(key, st) && st == State::kResident) {
+                std::lock_guard<std::mutex> lock(queue_mutex);
+                queue.push_back(Task{key, 0, 0, 0});
+            }
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(rng() % 200));
+    }
+    done.store(true);
+    for (std::thread& t : workers) t.join();
+    for (const FaceChunkKey& key : releases) table.finish_evict(key);
+    std::printf("threaded         %d workers, %llu steps\n", threads, (unsigned long long)steps_run.load());
+    check_settled(table, ring, "threaded");
+}
+
+int main(int argc, char** argv) {
+    int steps = 200000;
+    uint32_t seed = 1234u;
+    int threads = 4;
+    if (argc > 1) steps = std::max(1000, std::atoi(argv[1]));
+    if (argc > 2) seed = static_cast<uint32_t>(std::strtoul(argv[2], nullptr, 10));
+    if (argc > 3) threads = std::max(1, std::atoi(argv[3]));
+
+    single_threaded(steps, seed);
+    threaded(steps, seed, threads);
+
+    std::printf("%s\n", g_failures == 0 ? "All residency checks passed" : "Residency checks FAILED");
+    return g_failures == 0 ? 0 : 1;
+}
@@ -1,3 +1,4 @@
+#include <array>
 #include <cstdio>
 #include <cstdlib>
 #include <cstdint>
@@ -5,26 +6,31 @@
 #include <string>
 #include <cmath>
 #include "planet.h"
+#include "terrain_pyramid.h"
 #include "wf_math.h"
 
 using namespace wf;
 
-static double find_surface_radius(const PlanetConfig& cfg, const Float3& dir) {
-    // Binary search for air->solid boundary along radial direction
-    double low = cfg.radius_m - 200.0; // inside
-    double high = cfg.radius_m + 200.0; // outside
-    auto is_solid_at = [&](double r)->bool{
-        Float3 p = {dir.x * (float)r, dir.y * (float)r, dir.z * (float)r};
-        Int3 v{ (i64)std::llround(p.x / cfg.voxel_size_m), (i64)std::llround(p.y / cfg.voxel_size_m), (i64)std::llround(p.z / cfg.voxel_size_m) };
-        auto s = sample_base(cfg, v);
-        return s.material != MAT_AIR;
-    };
-    // Ensure bracket: low should be solid, high should be air
-    if (!is_solid_at(low)) low = cfg.radius_m - 400.0;
-    if (is_solid_at(high)) high = cfg.radius_m + 400.0;
-    for (int i=0; i<24; ++i) {
-        double mid = 0.5 * (low + high);
-        if (is_solid_at(mid)) low = mid; else high = mid;
+static double find_surface_radius(const PlanetConfig& cfg, TerrainHeightPyramid& bounds, const Float3& dir) {
+    // Topmost solid sample along the radial direction, narrowed over rounds of radial
+    // batches that share the direction's terrain height. The first bracket comes from the
+    // terrain height bounds, padded a voxel.
+    const HeightBounds b = bounds.bounds_at(dir);
+    double low = cfg.radius_m + b.min_m - cfg.voxel_size_m; // inside
+    double high = cfg.radius_m + b.max_m + cfg.voxel_size_m; // outside
+    constexpr int kSamples = 32;
+    std::array<double, kSamples> radii{};
+    std::array<BaseSample, kSamples> samples{};
+    for (int round = 0; round < 6 && high - low > 1e-4; ++round) {
+        for (int i = 0; i < kSamples; ++i) radii[i] = low + (high - low) * double(i) / double(kSamples - 1);
+        sample_base_radial(cfg, dir, radii, samples);
+        int top = kSamples - 1;
+        while (top >= 0 && samples[top].material == MAT_AIR) --top;
+        // Widen when the bracket missed the surface (no solid, or solid at its top)
+        if (top < 0) { low = cfg.radius_m - 400.0; continue; }
+        if (top == kSamples - 1) { high = cfg.radius_m + 400.0; continue; }
+        low = radii[top];
+        high = radii[top + 1];
     }
     return low; // last solid
 }
@@ -47,23 +53,30 @@ int main(int argc, char** argv) {
     if (argc > 4) out = argv[4];
 
     PlanetConfig cfg;
+    TerrainHeightPyramid bounds;
+    bounds.set_config(cfg);
     std::vector<uint8_t> img(W * H * 3, 0);
 
     const double span_m = 40.0; // vertical span +-20m around surface
     const double lat_rad = lat_deg * M_PI / 180.0;
+    std::vector<Int3> column(H);
+    std::vector<BaseSample> column_samples(H);
     for (int x = 0; x < W; ++x) {
         double theta = (double(x) / double(W)) * 2.0 * M_PI;
         // Direction at constant latitude
         Float3 dir = { (float)(std::cos(lat_rad) * std::cos(theta)), (float)std::sin(lat_rad), (float)(std::cos(lat_rad) * std::sin(theta)) };
         dir = normalize(dir);
-        double r_surface = find_surface_radius(cfg, dir);
+        double r_surface = find_surface_radius(cfg, bounds, dir);
         for (int y = 0; y < H; ++y) {
             double t = (double(y) / double(H - 1));
             double offset = (t * 2.0 - 1.0) * (span_m * 0.5);
             double r = r_surface + offset;
             Float3 p = {dir.x * (float)r, dir.y * (float)r, dir.z * (float)r};
-            Int3 v{ (i64)std::llround(p.x / cfg.voxel_size_m), (i64)std::llround(p.y / cfg.voxel_size_m), (i64)std::llround(p.z / cfg.voxel_size_m) };
-            auto s = sample_base(cfg, v);
+            column[y] = Int3{ (i64)std::llround(p.x / cfg.voxel_size_m), (i64)std::llround(p.y / cfg.voxel_size_m), (i64)std::llround(p.z / cfg.voxel_size_m) };
+        }
+        sample_base_batch(cfg, column, column_samples);
+        for (int y = 0; y < H; ++y) {
+            const BaseSample& s = column_samples[y];
             uint8_t r8=0,g8=0,b8=0;
             switch (s.material) {
                 case MAT_AIR:   r8=0;   g8=0;   b8=0;   break;
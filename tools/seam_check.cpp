@@ -0,0 +1,181 @@
+// Cube-seam ownership check: walks a camera across a cube edge and through a cube corner,
+// collects the ring tiles streaming would request at each stop, and samples the terrain
+// surface around the camera on every face grid that reaches it. Every surface voxel center
+// must be owned by exactly one face. Its chunk's ownership class and chunk_ownership_mask
+// bit must agree with face_owns_grid_point, and the owning chunk must be in the ring.
+// At the corner the ring must span all three faces.
+// Exits non-zero when any check fails.
+// Usage: wf_seam_check [ring_radius] [radius_m]
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "chunk.h"
+#include "planet.h"
+#include "wf_math.h"
+#include "world_streaming_subsystem.h"
+
+using namespace wf;
+
+static int g_failures = 0;
+
+static void fail(const char* stop, const char* what, const FaceChunkKey& key) {
+    if (g_failures++ < 20) {
+        std::printf("FAIL %-14s %-40s face=%d i=%lld j=%lld k=%lld\n", stop, what, key.face, (long long)key.i,
+                    (long long)key.j, (long long)key.k);
+    }
+}
+
+// Ownership class and mask per chunk, computed once.
+struct OwnershipCache {
+    const PlanetConfig& cfg;
+    std::unordered_map<FaceChunkKey, FaceOwnership, FaceChunkKeyHash> classes;
+    std::unordered_map<FaceChunkKey, std::vector<std::uint64_t>, FaceChunkKeyHash> masks;
+
+    FaceOwnership ownership(const FaceChunkKey& key) {
+        auto it = classes.find(key);
+        if (it == classes.end()) it = classes.emplace(key, chunk_face_ownership(cfg, key)).first;
+        return it->second;
+    }
+    bool mask_bit(const FaceChunkKey& key, int x, int y, int z) {
+        auto it = masks.find(key);
+        if (it == masks.end()) {
+            it = masks.emplace(key, std::vector<std::uint64_t>{}).first;
+            chunk_ownership_mask(cfg, key, it->second);
+        }
+        return ((it->second[y + z * Chunk64::N] >> x) & 1ull) != 0;
+    }
+};
+
+struct StopStats {
+    int faces_in_ring = 0;
+    long voxels = 0;
+    long seam_voxels = 0;  // sampled on a face that does not own them
+};
+
+static std::int64_t floor_index(double v, double step) { return static_cast<std::int64_t>(std::floor(v / step)); }
+
+// One camera stop: ring tiles around the camera's chunk, then the surface voxels within
+// `reach_m` of the camera on every face grid that covers them.
+static StopStats check_stop(const PlanetConfig& cfg, OwnershipCache& cache, const char* name, const Double3& cam_dir,
+                            int ring_radius, double reach_m) {
+    const double voxel_m = cfg.voxel_size_m;
+    const double chunk_m = voxel_m * Chunk64::N;
+    const int face = face_from_direction(cam_dir);
+    const double cam_r = cfg.radius_m + terrain_height_m(cfg, to_float3(cam_dir)) + 1.7;
+    double cam_s = 0.0, cam_t = 0.0;
+    face_grid_coords(face, cam_dir, cam_r, cam_s, cam_t);
+
+    std::vector<WorldStreamingSubsystem::RingTile> tiles;
+    WorldStreamingSubsystem::collect_ring_tiles(cfg, face, floor_index(cam_s, chunk_m), floor_index(cam_t, chunk_m),
+                                                floor_index(cam_r, chunk_m), ring_radius, 2, 2, 0.0f, 0.0f, tiles);
+    std::unordered_set<FaceChunkKey, FaceChunkKeyHash> ring;
+    bool faces[6] = {};
+    for (const auto& tile : tiles) {
+        ring.insert(tile.key);
+        faces[tile.key.face] = true;
+    }
+
+    StopStats st;
+    st.faces_in_ring = static_cast<int>(std::count(std::begin(faces), std::end(faces), true));
+    // Sample points a voxel apart on the camera face's grid (past its edge too), then take
+    // the voxel each face grid puts around the point.
+    const int span = static_cast<int>(reach_m / voxel_m);
+    std::unordered_set<FaceChunkKey, FaceChunkKeyHash> missing;
+    for (int b = -span; b <= span; ++b) {
+        for (int a = -span; a <= span; ++a) {
+            const double S = cam_s + a * voxel_m, T = cam_t + b * voxel_m;
+            if (S * S + T * T >= cam_r * cam_r) continue;
+            const Double3 dir = face_grid_direction(face, S, T, cam_r);
+            const double r = cfg.radius_m + terrain_height_m(cfg, to_float3(dir));
+            for (int g = 0; g < 6; ++g) {
+                double gs = 0.0, gt = 0.0;
+                if (!face_grid_coords(g, dir, r, gs, gt)) continue;
+                const std::int64_t vs = floor_index(gs, voxel_m), vt = floor_index(gt, voxel_m);
+                const std::int64_t vr = floor_index(r, voxel_m);
+                const double cs = (vs + 0.5) * voxel_m, ct = (vt + 0.5) * voxel_m, cr = (vr + 0.5) * voxel_m;
+                if (cs * cs + ct * ct >= cr * cr) continue;
+                const Double3 center_dir = face_grid_direction(g, cs, ct, cr);
+                const FaceChunkKey key{g, floor_index(cs, chunk_m), floor_index(ct, chunk_m), floor_index(cr, chunk_m)};
+                const int lx = static_cast<int>(vs - key.i * Chunk64::N);
+                const int ly = static_cast<int>(vt - key.j * Chunk64::N);
+                const int lz = static_cast<int>(vr - key.k * Chunk64::N);
+                ++st.voxels;
+
+                // Exactly one face claims the voxel center, through its own grid coordinates.
+                int owners = 0, owner = -1;
+                for (int f = 0; f < 6; ++f) {
+                    double fs = 0.0, ft = 0.0;
+                    if (face_grid_coords(f, center_dir, cr, fs, ft) && face_owns_grid_point(f, fs, ft, cr)) {
+                        ++owners;
+                        owner = f;
+                    }
+                }
+                if (owners != 1) {
+                    fail(name, owners == 0 ? "voxel owned by no face" : "voxel owned by several faces", key);
+                    continue;
+                }
+                if (owner != face_from_direction(center_dir)) fail(name, "owner is not the dominant face", key);
+
+                const bool owned = face_owns_grid_point(g, cs, ct, cr);
+                const FaceOwnership cls = cache.ownership(key);
+                if (owned && cls == FaceOwnership::kNone) fail(name, "owned voxel in a chunk classed as none", key);
+                if (!owned && cls == FaceOwnership::kFull) fail(name, "foreign voxel in a chunk classed as full", key);
+                if (cls == FaceOwnership::kPartial && cache.mask_bit(key, lx, ly, lz) != owned) {
+                    fail(name, "ownership mask disagrees", key);
+                }
+                if (!owned) {
+                    ++st.seam_voxels;
+                } else if (!ring.count(key) && missing.insert(key).second) {
+                    fail(name, "owning chunk missing from the ring", key);
+                }
+            }
+        }
+    }
+    return st;
+}
+
+int main(int argc, char** argv) {
+    int ring_radius = 3;
+    PlanetConfig cfg;
+    if (argc > 1) ring_radius = std::max(2, std::atoi(argv[1]));
+    if (argc > 2) cfg.radius_m = std::max(100.0, std::atof(argv[2]));
+    OwnershipCache cache{cfg, {}, {}};
+    // Sampled reach stays a chunk inside the ring so every owning chunk is in range.
+    const double reach_m = (ring_radius - 1) * cfg.voxel_size_m * Chunk64::N;
+
+    struct Walk {
+        const char* name;
+        Double3 from, to;
+        bool corner;  // passes through the +X/+Y/+Z corner at the midpoint
+    };
+    const Walk walks[] = {
+        {"edge +X/+Y", Double3{1.0, 0.9, 0.2}, Double3{0.9, 1.0, 0.2}, false},
+        {"corner", Double3{1.2, 1.0, 0.8}, Double3{0.8, 1.0, 1.2}, true},
+    };
+    const int kStops = 9;
+
+    std::printf("radius %.0f m, ring radius %d, surface sampled within %.1f m\n", cfg.radius_m, ring_radius, reach_m);
+    for (const Walk& walk : walks) {
+        for (int i = 0; i < kStops; ++i) {
+            const double t = static_cast<double>(i) / (kStops - 1);
+            const Double3 dir = normalize(walk.from * (1.0 - t) + walk.to * t);
+            const int failures_before = g_failures;
+            const StopStats st = check_stop(cfg, cache, walk.name, dir, ring_radius, reach_m);
+            if (walk.corner && i == kStops / 2 && st.faces_in_ring < 3) {
+                fail(walk.name, "ring does not span the three corner faces", FaceChunkKey{face_from_direction(dir), 0, 0, 0});
+            }
+            std::printf("%-11s stop %d  face %d  ring faces %d  voxels %7ld  off-face %6ld  %s\n", walk.name, i,
+                        face_from_direction(dir), st.faces_in_ring, st.voxels, st.seam_voxels,
+                        g_failures == failures_before ? "ok" : "FAIL");
+        }
+    }
+
+    std::printf("%s\n", g_failures == 0 ? "All seam checks passed" : "Seam checks FAILED");
+    return g_failures == 0 ? 0 : 1;
+}